@@ -0,0 +1,108 @@
+// This file is a part of muu and is subject to the the terms of the MIT license.
+// Copyright (c) Mark Gillard <mark.gillard@outlook.com.au>
+// See https://github.com/marzer/muu/blob/master/LICENSE for the full license text.
+// SPDX-License-Identifier: MIT
+
+// Compares muu::thread_pool::sort() against std::sort().
+
+#include <muu/thread_pool.h>
+#include <muu/uuid.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string_view>
+#include <vector>
+
+using namespace std::string_view_literals;
+
+namespace
+{
+	using clock_type = std::chrono::steady_clock;
+
+	inline constexpr size_t element_count = 10000000;
+	inline constexpr size_t iterations	  = 5;
+
+	template <typename T, typename Func>
+	static double best_of(const std::vector<T>& input, Func&& func)
+	{
+		double best = 1.0e100;
+		for (size_t i = 0; i < iterations; i++)
+		{
+			auto vals		 = input;
+			const auto start = clock_type::now();
+			func(vals);
+			const auto end = clock_type::now();
+			best		   = (std::min)(best, std::chrono::duration<double, std::milli>(end - start).count());
+		}
+		return best;
+	}
+
+	template <typename T, typename... Compare>
+	static void run(muu::thread_pool& pool, std::string_view name, const std::vector<T>& input, Compare... compare)
+	{
+		const auto std_ms  = best_of(input, [&](std::vector<T>& vals) { std::sort(vals.begin(), vals.end(), compare...); });
+		const auto pool_ms = best_of(input,
+									 [&](std::vector<T>& vals) { pool.sort(vals.begin(), vals.end(), compare...); });
+
+		std::cout << std::left << std::setw(28) << name << std::right << std::fixed << std::setprecision(2)
+				  << std::setw(12) << std_ms << " ms" << std::setw(12) << pool_ms << " ms" << std::setw(10)
+				  << (std_ms / pool_ms) << "x\n";
+	}
+}
+
+int main()
+{
+	std::ios_base::sync_with_stdio(false);
+
+	muu::thread_pool pool;
+	std::mt19937_64 rng{ 0xC0FFEEu };
+
+	std::cout << element_count << " elements, " << pool.workers() << " workers, best of " << iterations << "\n\n"
+			  << std::left << std::setw(28) << "input"sv << std::right << std::setw(15) << "std::sort"sv
+			  << std::setw(15) << "pool.sort"sv << std::setw(11) << "speedup"sv << "\n";
+
+	{
+		std::vector<uint32_t> vals(element_count);
+		for (auto& v : vals)
+			v = static_cast<uint32_t>(rng());
+		run(pool, "uint32_t (radix)"sv, vals);
+	}
+
+	{
+		std::vector<int64_t> vals(element_count);
+		for (auto& v : vals)
+			v = static_cast<int64_t>(rng());
+		run(pool, "int64_t (radix)"sv, vals);
+	}
+
+	{
+		std::vector<muu::uuid> vals(element_count);
+		for (auto& v : vals)
+			v = muu::uuid{ static_cast<uint32_t>(rng()),
+						   static_cast<uint16_t>(rng()),
+						   static_cast<uint16_t>(rng()),
+						   static_cast<uint16_t>(rng()),
+						   rng() };
+		run(pool, "muu::uuid (radix)"sv, vals);
+	}
+
+	{
+		std::vector<uint32_t> vals(element_count);
+		for (auto& v : vals)
+			v = static_cast<uint32_t>(rng());
+		run(pool, "uint32_t (comparator)"sv, vals, [](uint32_t a, uint32_t b) noexcept { return a > b; });
+	}
+
+	{
+		std::vector<double> vals(element_count);
+		std::uniform_real_distribution<double> dist{ -1.0e6, 1.0e6 };
+		for (auto& v : vals)
+			v = dist(rng);
+		run(pool, "double"sv, vals);
+	}
+
+	return 0;
+}
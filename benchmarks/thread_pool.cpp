@@ -0,0 +1,321 @@
+// This file is a part of muu and is subject to the the terms of the MIT license.
+// Copyright (c) Mark Gillard <mark.gillard@outlook.com.au>
+// See https://github.com/marzer/muu/blob/master/LICENSE for the full license text.
+// SPDX-License-Identifier: MIT
+
+// Measures muu::thread_pool dispatch overhead and scaling against plain std::thread.
+
+#include <muu/thread_pool.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+using namespace std::string_view_literals;
+
+namespace
+{
+	using clock_type = std::chrono::steady_clock;
+
+	inline constexpr size_t iterations			= 5;
+	inline constexpr size_t empty_task_count	= 1000000;
+	inline constexpr size_t std_thread_count	= 2000; // one std::thread per task is orders of magnitude slower
+	inline constexpr size_t enqueues_per_thread = 200000;
+	inline constexpr size_t element_count		= 1u << 20;
+	inline constexpr size_t round_trip_count	= 20000;
+
+	volatile uint64_t sink;
+
+	// returns the best time of several runs, in nanoseconds
+	template <typename Func>
+	static double best_of(Func&& func)
+	{
+		double best = 1.0e100;
+		for (size_t i = 0; i < iterations; i++)
+		{
+			const auto start = clock_type::now();
+			func();
+			const auto end = clock_type::now();
+			best		   = (std::min)(best, std::chrono::duration<double, std::nano>(end - start).count());
+		}
+		return best;
+	}
+
+	// a deterministic amount of work the optimizer can't see through
+	static uint64_t work(uint64_t seed, uint32_t rounds) noexcept
+	{
+		uint64_t x = seed | 1u;
+		for (uint32_t i = 0; i < rounds; i++)
+		{
+			x = x * 6364136223846793005ull + 1442695040888963407ull;
+			x ^= x >> 29;
+		}
+		return x;
+	}
+
+	// uniform: every element costs the same.
+	// skewed: the first eighth of the range is 32x as expensive as the rest, which starves static partitioning.
+	static uint32_t uniform_rounds(size_t) noexcept
+	{
+		return 64u;
+	}
+
+	static uint32_t skewed_rounds(size_t i) noexcept
+	{
+		return i < element_count / 8u ? 512u : 16u;
+	}
+
+	static std::vector<size_t> thread_counts()
+	{
+		const size_t hw = (std::max)(std::thread::hardware_concurrency(), 1u);
+		std::vector<size_t> counts;
+		for (size_t i = 1; i < hw; i *= 2u)
+			counts.push_back(i);
+		counts.push_back(hw);
+		return counts;
+	}
+
+	static void print_title(std::string_view title)
+	{
+		std::cout << "\n" << title << "\n" << std::string(title.length(), '-') << "\n";
+	}
+
+	template <typename... Columns>
+	static void print_header(std::string_view first, Columns... columns)
+	{
+		std::cout << std::left << std::setw(28) << first << std::right;
+		((std::cout << std::setw(18) << columns), ...);
+		std::cout << "\n";
+	}
+
+	template <typename... Values>
+	static void print_row(std::string_view first, Values... values)
+	{
+		std::cout << std::left << std::setw(28) << first << std::right << std::fixed << std::setprecision(1);
+		((std::cout << std::setw(15) << values << " ns"), ...);
+		std::cout << "\n";
+	}
+
+	static void empty_tasks(muu::thread_pool& pool)
+	{
+		print_title("empty task throughput"sv);
+		print_header("method"sv, "ns/task"sv);
+
+		const auto enqueue_ns = best_of([&]()
+		{
+			for (size_t i = 0; i < empty_task_count; i++)
+				pool.enqueue([]() noexcept {});
+			pool.wait();
+		});
+		print_row("pool.enqueue()"sv, enqueue_ns / empty_task_count);
+
+		const auto for_each_ns = best_of([&]()
+		{
+			pool.for_each(empty_task_count, [](size_t) noexcept {});
+			pool.wait();
+		});
+		print_row("pool.for_each()"sv, for_each_ns / empty_task_count);
+
+		struct empty_task
+		{
+			void operator()() const noexcept
+			{}
+		};
+		const std::vector<empty_task> tasks(empty_task_count);
+		const auto bulk_ns = best_of([&]() { pool.enqueue_bulk(tasks).wait(); });
+		print_row("pool.enqueue_bulk()"sv, bulk_ns / empty_task_count);
+
+		const auto batch_ns = best_of([&]()
+		{
+			muu::task_batch batch{ pool };
+			batch.reserve(empty_task_count);
+			for (size_t i = 0; i < empty_task_count; i++)
+				batch.add([]() noexcept {});
+			batch.submit().wait();
+		});
+		print_row("muu::task_batch"sv, batch_ns / empty_task_count);
+
+		const size_t hw = (std::max)(std::thread::hardware_concurrency(), 1u);
+
+		const auto std_ns = best_of([&]()
+		{
+			std::vector<std::thread> threads;
+			threads.reserve(hw);
+			for (size_t i = 0; i < std_thread_count; i += hw)
+			{
+				for (size_t j = 0; j < hw; j++)
+					threads.emplace_back([]() noexcept {});
+				for (auto& t : threads)
+					t.join();
+				threads.clear();
+			}
+		});
+		print_row("std::thread per task"sv, std_ns / std_thread_count);
+	}
+
+	static void producers(muu::thread_pool& pool)
+	{
+		print_title("enqueue latency with N producers"sv);
+		print_header("producers"sv, "ns/enqueue"sv, "ns/task"sv);
+
+		for (auto producer_count : thread_counts())
+		{
+			double best_enqueue = 1.0e100;
+			double best_total	= 1.0e100;
+			for (size_t iter = 0; iter < iterations; iter++)
+			{
+				std::atomic_bool go{ false };
+				std::vector<double> enqueue_ns(producer_count);
+				std::vector<std::thread> threads;
+				threads.reserve(producer_count);
+				for (size_t p = 0; p < producer_count; p++)
+				{
+					threads.emplace_back([&, p]() noexcept
+					{
+						while (!go.load(std::memory_order_acquire))
+							std::this_thread::yield();
+
+						const auto start = clock_type::now();
+						for (size_t i = 0; i < enqueues_per_thread; i++)
+							pool.enqueue([]() noexcept {});
+						const auto end = clock_type::now();
+						enqueue_ns[p]  = std::chrono::duration<double, std::nano>(end - start).count();
+					});
+				}
+
+				const auto start = clock_type::now();
+				go.store(true, std::memory_order_release);
+				for (auto& t : threads)
+					t.join();
+				pool.wait();
+				const auto end = clock_type::now();
+
+				double mean = 0.0;
+				for (auto ns : enqueue_ns)
+					mean += ns / enqueues_per_thread;
+				mean /= static_cast<double>(producer_count);
+
+				best_enqueue = (std::min)(best_enqueue, mean);
+				best_total	 = (std::min)(best_total,
+										  std::chrono::duration<double, std::nano>(end - start).count()
+											  / static_cast<double>(producer_count * enqueues_per_thread));
+			}
+
+			print_row(std::to_string(producer_count), best_enqueue, best_total);
+		}
+	}
+
+	template <typename Rounds>
+	static void scaling(std::string_view title, Rounds rounds)
+	{
+		print_title(title);
+		print_header("threads"sv, "std::thread"sv, "pool (static)"sv, "pool (dynamic)"sv, "pool (guided)"sv);
+
+		std::vector<uint64_t> out(element_count);
+
+		const auto serial_ns = best_of([&]()
+		{
+			for (size_t i = 0; i < element_count; i++)
+				out[i] = work(i, rounds(i));
+		});
+		sink = out.front() ^ out.back();
+		print_row("serial"sv, serial_ns / element_count);
+
+		for (auto thread_count : thread_counts())
+		{
+			const auto std_ns = best_of([&]()
+			{
+				std::vector<std::thread> threads;
+				threads.reserve(thread_count);
+				const size_t chunk = (element_count + thread_count - 1u) / thread_count;
+				for (size_t t = 0; t < thread_count; t++)
+				{
+					threads.emplace_back([&, t]() noexcept
+					{
+						const auto last = (std::min)(element_count, (t + 1u) * chunk);
+						for (size_t i = t * chunk; i < last; i++)
+							out[i] = work(i, rounds(i));
+					});
+				}
+				for (auto& t : threads)
+					t.join();
+			});
+			sink = out.front() ^ out.back();
+
+			muu::thread_pool pool{ thread_count };
+			const auto body = [&](size_t i) noexcept { out[i] = work(i, rounds(i)); };
+
+			const auto static_ns = best_of([&]() { pool.for_each(element_count, body).wait(); });
+			sink				 = out.front() ^ out.back();
+
+			const auto dynamic_ns = best_of([&]()
+			{
+				pool.for_each(size_t{}, element_count, body, muu::thread_pool_dynamic_partitioner{}).wait();
+			});
+			sink = out.front() ^ out.back();
+
+			const auto guided_ns = best_of([&]()
+			{
+				pool.for_each(size_t{}, element_count, body, muu::thread_pool_guided_partitioner{}).wait();
+			});
+			sink = out.front() ^ out.back();
+
+			print_row(std::to_string(thread_count),
+					  std_ns / element_count,
+					  static_ns / element_count,
+					  dynamic_ns / element_count,
+					  guided_ns / element_count);
+		}
+	}
+
+	static void wait_latency(muu::thread_pool& pool)
+	{
+		print_title("wait() latency"sv);
+		print_header("method"sv, "ns/round trip"sv);
+
+		pool.wait();
+		const auto idle_ns = best_of([&]()
+		{
+			for (size_t i = 0; i < round_trip_count; i++)
+				pool.wait();
+		});
+		print_row("pool.wait() (idle)"sv, idle_ns / round_trip_count);
+
+		const auto pool_ns = best_of([&]()
+		{
+			for (size_t i = 0; i < round_trip_count; i++)
+				pool.enqueue([]() noexcept {}).wait();
+		});
+		print_row("pool.enqueue().wait()"sv, pool_ns / round_trip_count);
+
+		const auto std_ns = best_of([&]()
+		{
+			for (size_t i = 0; i < std_thread_count; i++)
+				std::thread{ []() noexcept {} }.join();
+		});
+		print_row("std::thread + join()"sv, std_ns / std_thread_count);
+	}
+}
+
+int main()
+{
+	std::ios_base::sync_with_stdio(false);
+
+	muu::thread_pool pool;
+	std::cout << pool.workers() << " workers, " << std::thread::hardware_concurrency() << " hardware threads, best of "
+			  << iterations << "\n";
+
+	empty_tasks(pool);
+	producers(pool);
+	scaling("for_each scaling (uniform work)"sv, uniform_rounds);
+	scaling("for_each scaling (skewed work)"sv, skewed_rounds);
+	wait_latency(pool);
+
+	return 0;
+}
@@ -73,6 +73,7 @@
 #include "utf16_decoder.h"
 #include "uuid.h"
 #include "vector.h"
+#include "vector_soa.h"
 //#include "bitset.h"
 //#include "bounding_sphere.h"
 //#include "concatenate.h"
@@ -308,6 +308,8 @@ namespace muu
 	struct ray;
 	template <typename, size_t>
 	struct packed_unit_vector;
+	template <typename, size_t, size_t>
+	struct vector_soa;
 	template <typename, size_t>
 	struct sat_tester;
 
@@ -327,6 +329,13 @@ namespace muu
 	class spin_mutex;
 	class string_param;
 	class thread_pool;
+	struct thread_pool_options;
+	template <typename>
+	class thread_pool_future;
+	class task_group;
+	class cancellation_token;
+	class task_graph;
+	class task_batch;
 	template <typename, typename>
 	class compressed_pair;
 	template <typename>
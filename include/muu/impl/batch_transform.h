@@ -0,0 +1,110 @@
+// This file is a part of muu and is subject to the the terms of the MIT license.
+// Copyright (c) Mark Gillard <mark.gillard@outlook.com.au>
+// See https://github.com/marzer/muu/blob/master/LICENSE for the full license text.
+// SPDX-License-Identifier: MIT
+#pragma once
+/// \cond
+
+#include "../vector_soa.h"
+
+#include "header_start.h"
+MUU_FORCE_NDEBUG_OPTIMIZATIONS;
+MUU_DISABLE_ARITHMETIC_WARNINGS;
+MUU_PRAGMA_MSVC(float_control(except, off))
+
+/*
+	BATCH TRANSFORMS - KEY POINTS
+
+	-	The span overloads of matrix::transform_position() (et al.) and quaternion::rotate_vector() gather the input into
+		vector_soa blocks, transform each block with a single loop over its lanes, then scatter the block back out.
+		The loop is written against plain component arrays so the compiler vectorizes it at whatever width the target
+		has, with the transform's coefficients broadcast once per block and no horizontal shuffling.
+
+	-	The trailing partial block, 'small' float types and constant evaluation all go through the single-vector
+		functions instead.
+
+	-	Transforming in-place is safe since each block is gathered in full before any of it is written back.
+
+	-	The thread_pool overloads split the span into contiguous runs of whole blocks, at most one per worker, and wait
+		on a task_group so they don't also end up waiting on unrelated work in the pool. Spans too small to be worth
+		waking the workers for are transformed on the calling thread.
+*/
+
+namespace muu::impl
+{
+	template <typename Scalar>
+	inline constexpr bool has_batch_transform_ = is_floating_point<Scalar> && !is_small_float_<Scalar>;
+
+	// one cache line of each component per block
+	template <typename Scalar>
+	inline constexpr size_t batch_transform_width = muu::max(size_t{ 64 } / sizeof(Scalar), size_t{ 4 });
+
+	template <typename Scalar>
+	using batch_transform_block = vector_soa<Scalar, 3, batch_transform_width<Scalar>>;
+
+	// below this many vectors per task it's cheaper to do the whole span on the calling thread
+	inline constexpr size_t batch_transform_min_task_size = 4096;
+
+	// block: void(batch_transform_block<Scalar>&), transforms all lanes of a block in-place
+	// single: vector<Scalar, 3>(const vector<Scalar, 3>&)
+	template <typename Scalar, typename Block, typename Single>
+	constexpr void batch_transform(span<const vector<Scalar, 3>> in,
+								   span<vector<Scalar, 3>> out,
+								   Block&& block,
+								   Single&& single) noexcept
+	{
+		MUU_CONSTEXPR_SAFE_ASSERT(out.size() >= in.size() && "output span is smaller than the input span");
+
+		size_t i = 0;
+		if constexpr (has_batch_transform_<Scalar> && build::supports_is_constant_evaluated)
+		{
+			MUU_IF_RUNTIME
+			{
+				constexpr size_t width = batch_transform_width<Scalar>;
+
+				for (const size_t end = in.size() - in.size() % width; i < end; i += width)
+				{
+					auto packet = batch_transform_block<Scalar>::gather(in.subspan(i, width));
+					block(packet);
+					packet.scatter(out.subspan(i, width));
+				}
+			}
+		}
+
+		for (; i < in.size(); i++)
+			out[i] = single(in[i]);
+	}
+
+	// func: void(size_t start, size_t end), transforms the vectors in the range [start, end)
+	// (Group is a template parameter so that task_group only needs to be complete at the point of instantiation)
+	template <typename Scalar, typename Group = task_group, typename Pool, typename Func>
+	void batch_transform_parallel(Pool& pool, size_t count, Func&& func) noexcept
+	{
+		const size_t tasks = muu::min(pool.workers(), count / batch_transform_min_task_size);
+		if (tasks <= 1u)
+		{
+			func(size_t{}, count);
+			return;
+		}
+
+		// whole blocks per task so only the last one has a partial block
+		constexpr size_t width = batch_transform_width<Scalar>;
+		const size_t task_size = ((count + width - 1u) / width + tasks - 1u) / tasks * width;
+
+		// passed by lvalue so the pool may reference it rather than copy it (it's too big to store)
+		const auto task = [&](size_t index) noexcept
+		{
+			const auto start = index * task_size;
+			if (start < count)
+				func(start, muu::min(start + task_size, count));
+		};
+
+		Group group{ pool };
+		group.for_each(size_t{}, tasks, task);
+		group.wait();
+	}
+}
+
+MUU_RESET_NDEBUG_OPTIMIZATIONS;
+#include "header_end.h"
+/// \endcond
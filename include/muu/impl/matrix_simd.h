@@ -0,0 +1,235 @@
+// This file is a part of muu and is subject to the the terms of the MIT license.
+// Copyright (c) Mark Gillard <mark.gillard@outlook.com.au>
+// See https://github.com/marzer/muu/blob/master/LICENSE for the full license text.
+// SPDX-License-Identifier: MIT
+#pragma once
+/// \cond
+
+#include "vector_simd.h"
+
+#include "header_start.h"
+MUU_FORCE_NDEBUG_OPTIMIZATIONS;
+MUU_PRAGMA_MSVC(float_control(except, off))
+
+/*
+	MATRIX SIMD - KEY POINTS
+
+	-	Matrices are column-major, so each column is loaded as one register using the lanes from vector_simd.h.
+		A matrix has a SIMD implementation whenever its column type does.
+
+	-	Products, transform_position() and transform_without_translating() are computed as linear combinations of
+		columns, which is the same order the scalar code in matrix.h accumulates in, so they agree to within rounding
+		(the scalar code may still be contracted into FMAs by the compiler, so not necessarily bit-for-bit).
+
+	-	The 4x4 inverse and the affine inverse are built from cross products (Eric Lengyel, "Foundations of Game Engine
+		Development, Volume 1", section 1.7.5) rather than the 2x2 cofactor expansion used by the scalar code, so they
+		agree to within rounding error, not bit-for-bit. Garbage in the w lanes of intermediate cross products never
+		reaches the result; it's either ignored by the three-lane dot products or overwritten.
+*/
+
+namespace muu::impl
+{
+	template <typename Scalar, size_t Rows>
+	inline constexpr bool has_matrix_simd_ = has_vector_simd_<Scalar, Rows>;
+
+	template <typename Scalar, size_t Rows, size_t Columns>
+	struct matrix_simd;
+
+#if MUU_VECTOR_SIMD
+
+	// runtime implementations of matrix's arithmetic, called from matrix.h when not in a constant-evaluated context
+	template <typename Scalar, size_t Rows, size_t Columns>
+	struct matrix_simd
+	{
+		static_assert(has_matrix_simd_<Scalar, Rows>);
+
+		using lanes		  = simd_lanes<Scalar, Rows>;
+		using reg		  = typename lanes::reg;
+		using matrix_type = matrix<Scalar, Rows, Columns>;
+		using column_type = vector<Scalar, Rows>;
+
+		MUU_PURE_INLINE_GETTER
+		static Scalar MUU_VECTORCALL dot_xyz(reg lhs, reg rhs) noexcept
+		{
+			return simd_lanes<Scalar, 3>::sum(lanes::mul(lhs, rhs));
+		}
+
+		MUU_PURE_INLINE_GETTER
+		static reg MUU_VECTORCALL cross_xyz(reg lhs, reg rhs) noexcept
+		{
+			return lanes::sub(lanes::mul(lanes::template permute<1, 2, 0, 3>(lhs), //
+										 lanes::template permute<2, 0, 1, 3>(rhs)),
+							  lanes::mul(lanes::template permute<2, 0, 1, 3>(lhs), //
+										 lanes::template permute<1, 2, 0, 3>(rhs)));
+		}
+
+		MUU_PURE_INLINE_GETTER
+		static reg MUU_VECTORCALL load(const column_type& col) noexcept
+		{
+			return lanes::load(col.data());
+		}
+
+		MUU_ALWAYS_INLINE
+		static void MUU_VECTORCALL store(column_type& col, reg val) noexcept
+		{
+			lanes::store(col.data(), val);
+		}
+
+		MUU_PURE_INLINE_GETTER
+		static vector<Scalar, 3> MUU_VECTORCALL store_xyz(reg val) noexcept
+		{
+			vector<Scalar, 3> out;
+			simd_lanes<Scalar, 3>::store(out.data(), val);
+			return out;
+		}
+
+		template <size_t C>
+		MUU_PURE_GETTER
+		static matrix<Scalar, Rows, C> MUU_VECTORCALL multiply(const matrix_type& lhs,
+															   const matrix<Scalar, Columns, C>& rhs) noexcept
+		{
+			reg cols[Columns];
+			for (size_t k = 0; k < Columns; k++)
+				cols[k] = load(lhs.m[k]);
+
+			matrix<Scalar, Rows, C> out;
+			for (size_t j = 0; j < C; j++)
+			{
+				const Scalar* rhs_col = rhs.m[j].data();
+
+				auto val = lanes::mul(cols[0], lanes::broadcast(rhs_col[0]));
+				for (size_t k = 1; k < Columns; k++)
+					val = lanes::add(val, lanes::mul(cols[k], lanes::broadcast(rhs_col[k])));
+
+				store(out.m[j], val);
+			}
+			return out;
+		}
+
+		MUU_PURE_GETTER
+		static column_type MUU_VECTORCALL multiply(const matrix_type& lhs, const vector<Scalar, Columns>& rhs) noexcept
+		{
+			const Scalar* vec = rhs.data();
+
+			auto val = lanes::mul(load(lhs.m[0]), lanes::broadcast(vec[0]));
+			for (size_t k = 1; k < Columns; k++)
+				val = lanes::add(val, lanes::mul(load(lhs.m[k]), lanes::broadcast(vec[k])));
+
+			column_type out;
+			store(out, val);
+			return out;
+		}
+
+		MUU_PURE_INLINE_GETTER
+		static reg MUU_VECTORCALL transform_xyz(const matrix_type& xform, const vector<Scalar, 3>& dir) noexcept
+		{
+			static_assert(Rows == 3 || Rows == 4);
+			static_assert(Columns == 3 || Columns == 4);
+
+			return lanes::add(lanes::add(lanes::mul(load(xform.m[0]), lanes::broadcast(dir.x)),
+										 lanes::mul(load(xform.m[1]), lanes::broadcast(dir.y))),
+							  lanes::mul(load(xform.m[2]), lanes::broadcast(dir.z)));
+		}
+
+		MUU_PURE_GETTER
+		static vector<Scalar, 3> MUU_VECTORCALL transform_position(const matrix_type& xform,
+																   const vector<Scalar, 3>& pos) noexcept
+		{
+			static_assert(Columns == 4);
+
+			auto val = lanes::add(transform_xyz(xform, pos), load(xform.m[3]));
+			if constexpr (Rows == 4)
+				val = lanes::mul(val, lanes::broadcast(Scalar{ 1 } / lanes::template get<3>(val)));
+
+			return store_xyz(val);
+		}
+
+		MUU_PURE_GETTER
+		static vector<Scalar, 3> MUU_VECTORCALL transform_without_translating(const matrix_type& xform,
+																			  const vector<Scalar, 3>& dir) noexcept
+		{
+			return store_xyz(transform_xyz(xform, dir));
+		}
+
+		MUU_PURE_GETTER
+		static matrix_type MUU_VECTORCALL invert(const matrix_type& m) noexcept
+		{
+			static_assert(Rows == 4 && Columns == 4);
+
+			const auto a = load(m.m[0]);
+			const auto b = load(m.m[1]);
+			const auto c = load(m.m[2]);
+			const auto d = load(m.m[3]);
+			const auto x = lanes::broadcast(lanes::template get<3>(a));
+			const auto y = lanes::broadcast(lanes::template get<3>(b));
+			const auto z = lanes::broadcast(lanes::template get<3>(c));
+			const auto w = lanes::broadcast(lanes::template get<3>(d));
+
+			auto s = cross_xyz(a, b);
+			auto t = cross_xyz(c, d);
+			auto u = lanes::sub(lanes::mul(a, y), lanes::mul(b, x));
+			auto v = lanes::sub(lanes::mul(c, w), lanes::mul(d, z));
+
+			const auto inv_det = lanes::broadcast(Scalar{ 1 } / (dot_xyz(s, v) + dot_xyz(t, u)));
+			s				   = lanes::mul(s, inv_det);
+			t				   = lanes::mul(t, inv_det);
+			u				   = lanes::mul(u, inv_det);
+			v				   = lanes::mul(v, inv_det);
+
+			// rows of the inverse
+			auto r0 = lanes::with_w(lanes::add(cross_xyz(b, v), lanes::mul(t, y)), -dot_xyz(b, t));
+			auto r1 = lanes::with_w(lanes::sub(cross_xyz(v, a), lanes::mul(t, x)), dot_xyz(a, t));
+			auto r2 = lanes::with_w(lanes::add(cross_xyz(d, u), lanes::mul(s, w)), -dot_xyz(d, s));
+			auto r3 = lanes::with_w(lanes::sub(cross_xyz(u, c), lanes::mul(s, z)), dot_xyz(c, s));
+			lanes::transpose(r0, r1, r2, r3);
+
+			matrix_type out;
+			store(out.m[0], r0);
+			store(out.m[1], r1);
+			store(out.m[2], r2);
+			store(out.m[3], r3);
+			return out;
+		}
+
+		MUU_PURE_GETTER
+		static matrix_type MUU_VECTORCALL invert_affine(const matrix_type& m) noexcept
+		{
+			static_assert(Rows == 3 || Rows == 4);
+			static_assert(Columns == 4);
+
+			const auto a = load(m.m[0]);
+			const auto b = load(m.m[1]);
+			const auto c = load(m.m[2]);
+			const auto t = load(m.m[3]);
+
+			// rows of the inverse of the 3x3 part
+			auto r0 = cross_xyz(b, c);
+			auto r1 = cross_xyz(c, a);
+			auto r2 = cross_xyz(a, b);
+
+			const auto inv_det = lanes::broadcast(Scalar{ 1 } / dot_xyz(a, r0));
+			r0				   = lanes::mul(r0, inv_det);
+			r1				   = lanes::mul(r1, inv_det);
+			r2				   = lanes::mul(r2, inv_det);
+
+			r0		= lanes::with_w(r0, -dot_xyz(r0, t));
+			r1		= lanes::with_w(r1, -dot_xyz(r1, t));
+			r2		= lanes::with_w(r2, -dot_xyz(r2, t));
+			auto r3 = lanes::with_w(lanes::broadcast(Scalar{}), Scalar{ 1 });
+			lanes::transpose(r0, r1, r2, r3);
+
+			matrix_type out;
+			store(out.m[0], r0);
+			store(out.m[1], r1);
+			store(out.m[2], r2);
+			store(out.m[3], r3);
+			return out;
+		}
+	};
+
+#endif // MUU_VECTOR_SIMD
+}
+
+MUU_RESET_NDEBUG_OPTIMIZATIONS;
+#include "header_end.h"
+/// \endcond
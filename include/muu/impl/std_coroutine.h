@@ -0,0 +1,25 @@
+// This file is a part of muu and is subject to the the terms of the MIT license.
+// Copyright (c) Mark Gillard <mark.gillard@outlook.com.au>
+// See https://github.com/marzer/muu/blob/master/LICENSE for the full license text.
+// SPDX-License-Identifier: MIT
+#ifndef MUU_STD_COROUTINE_H
+#define MUU_STD_COROUTINE_H
+
+#include "../preprocessor.h"
+
+MUU_DISABLE_WARNINGS;
+#if MUU_HAS_INCLUDE(<coroutine>) && defined(__cpp_impl_coroutine) && __cpp_impl_coroutine >= 201902
+
+	#include <coroutine>
+	#include <exception>
+
+	#define MUU_HAS_COROUTINES 1
+
+#else
+
+	#define MUU_HAS_COROUTINES 0
+
+#endif
+MUU_ENABLE_WARNINGS;
+
+#endif // MUU_STD_COROUTINE_H
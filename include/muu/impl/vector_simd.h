@@ -0,0 +1,554 @@
+// This file is a part of muu and is subject to the the terms of the MIT license.
+// Copyright (c) Mark Gillard <mark.gillard@outlook.com.au>
+// See https://github.com/marzer/muu/blob/master/LICENSE for the full license text.
+// SPDX-License-Identifier: MIT
+#pragma once
+/// \cond
+
+#include "../meta.h"
+
+// SSE2 is baseline on AMD64 so this is on for almost every x86 build; define MUU_VECTOR_SIMD as 0 to opt out
+#ifndef MUU_VECTOR_SIMD
+	#if (MUU_ARCH_X86 || MUU_ARCH_AMD64) && MUU_ISET_SSE2
+		#define MUU_VECTOR_SIMD 1
+	#else
+		#define MUU_VECTOR_SIMD 0
+	#endif
+#endif
+
+MUU_DISABLE_WARNINGS;
+#if MUU_VECTOR_SIMD
+	#if MUU_MSVC
+		#include <intrin.h>
+	#else
+		#include <immintrin.h>
+	#endif
+#endif
+MUU_ENABLE_WARNINGS;
+
+#include "header_start.h"
+MUU_FORCE_NDEBUG_OPTIMIZATIONS;
+MUU_PRAGMA_MSVC(float_control(except, off))
+MUU_PRAGMA_GCC(diagnostic ignored "-Wold-style-cast") // _MM_SHUFFLE
+
+/*
+	VECTOR SIMD - KEY POINTS
+
+	-	Only float vectors of 2-4 dimensions and double vectors of 2 (SSE2) or 3-4 (AVX) dimensions have SIMD
+		implementations. Everything else (and everything evaluated at compile time) goes through the scalar code in
+		vector.h.
+
+	-	Every kernel agrees with the scalar implementation to within rounding: horizontal sums are done lane-by-lane
+		in the same order as COMPONENTWISE_ACCUMULATE (so no _mm_dp_ps or _mm_hadd_ps, which reassociate), and min/max
+		operands are ordered so NaNs and signed zeroes pick the same side as muu::min/max. Results aren't guaranteed
+		to be bit-identical, though; the compiler is free to contract the scalar code into FMAs (e.g. with -mfma or
+		-ffp-contract=fast) but never does so to the intrinsics.
+
+	-	Vectors with fewer than four components are loaded without reading past their last member, leaving the
+		unused lanes zeroed. Those lanes are never stored or summed.
+*/
+
+namespace muu::impl
+{
+	template <typename Scalar, size_t Dimensions>
+	inline constexpr bool has_vector_simd_ = MUU_VECTOR_SIMD						//
+										  && Dimensions >= 2 && Dimensions <= 4 //
+										  && (std::is_same_v<Scalar, float>		//
+											  || (std::is_same_v<Scalar, double> && (Dimensions == 2 || MUU_ISET_AVX)));
+
+	template <typename Scalar, size_t Dimensions>
+	struct simd_lanes;
+
+	template <typename Scalar, size_t Dimensions>
+	struct vector_simd;
+
+#if MUU_VECTOR_SIMD
+
+	template <size_t Dimensions>
+	struct simd_lanes<float, Dimensions>
+	{
+		using reg = __m128;
+
+		MUU_PURE_INLINE_GETTER
+		static reg MUU_VECTORCALL load(const float* src) noexcept
+		{
+			if constexpr (Dimensions == 4)
+				return _mm_loadu_ps(src);
+			else
+			{
+				const auto xy = _mm_loadl_pi(_mm_setzero_ps(), reinterpret_cast<const __m64*>(src));
+				if constexpr (Dimensions == 2)
+					return xy;
+	#if MUU_ISET_SSE4_1
+				else
+					return _mm_insert_ps(xy, _mm_load_ss(src + 2), 0x20);
+	#else
+				else
+					return _mm_movelh_ps(xy, _mm_load_ss(src + 2));
+	#endif
+			}
+		}
+
+		MUU_ALWAYS_INLINE
+		static void MUU_VECTORCALL store(float* dest, reg val) noexcept
+		{
+			if constexpr (Dimensions == 4)
+				_mm_storeu_ps(dest, val);
+			else
+			{
+				_mm_storel_pi(reinterpret_cast<__m64*>(dest), val);
+				if constexpr (Dimensions == 3)
+					_mm_store_ss(dest + 2, _mm_movehl_ps(val, val));
+			}
+		}
+
+		MUU_CONST_INLINE_GETTER
+		static reg MUU_VECTORCALL broadcast(float val) noexcept
+		{
+			return _mm_set1_ps(val);
+		}
+
+		MUU_CONST_INLINE_GETTER
+		static reg MUU_VECTORCALL add(reg lhs, reg rhs) noexcept
+		{
+			return _mm_add_ps(lhs, rhs);
+		}
+
+		MUU_CONST_INLINE_GETTER
+		static reg MUU_VECTORCALL sub(reg lhs, reg rhs) noexcept
+		{
+			return _mm_sub_ps(lhs, rhs);
+		}
+
+		MUU_CONST_INLINE_GETTER
+		static reg MUU_VECTORCALL mul(reg lhs, reg rhs) noexcept
+		{
+			return _mm_mul_ps(lhs, rhs);
+		}
+
+		MUU_CONST_INLINE_GETTER
+		static reg MUU_VECTORCALL div(reg lhs, reg rhs) noexcept
+		{
+			return _mm_div_ps(lhs, rhs);
+		}
+
+		// minps returns its second operand unless the first compares less, same as muu::min
+		MUU_CONST_INLINE_GETTER
+		static reg MUU_VECTORCALL min(reg lhs, reg rhs) noexcept
+		{
+			return _mm_min_ps(lhs, rhs);
+		}
+
+		// maxps returns its second operand unless the first compares greater, so the operands are swapped
+		MUU_CONST_INLINE_GETTER
+		static reg MUU_VECTORCALL max(reg lhs, reg rhs) noexcept
+		{
+			return _mm_max_ps(rhs, lhs);
+		}
+
+		MUU_CONST_INLINE_GETTER
+		static reg MUU_VECTORCALL negate(reg val) noexcept
+		{
+			return _mm_xor_ps(val, _mm_set1_ps(-0.0f));
+		}
+
+		MUU_CONST_INLINE_GETTER
+		static float MUU_VECTORCALL sum(reg val) noexcept
+		{
+			auto out = _mm_add_ss(val, _mm_shuffle_ps(val, val, _MM_SHUFFLE(1, 1, 1, 1)));
+			if constexpr (Dimensions >= 3)
+				out = _mm_add_ss(out, _mm_movehl_ps(val, val));
+			if constexpr (Dimensions == 4)
+				out = _mm_add_ss(out, _mm_shuffle_ps(val, val, _MM_SHUFFLE(3, 3, 3, 3)));
+			return _mm_cvtss_f32(out);
+		}
+
+		MUU_CONST_INLINE_GETTER
+		static float MUU_VECTORCALL sqrt(float val) noexcept
+		{
+			return _mm_cvtss_f32(_mm_sqrt_ss(_mm_set_ss(val)));
+		}
+
+		// shuffles and lane access used by the matrix kernels in matrix_simd.h
+
+		template <size_t I0, size_t I1, size_t I2, size_t I3>
+		MUU_CONST_INLINE_GETTER
+		static reg MUU_VECTORCALL permute(reg val) noexcept
+		{
+			return _mm_shuffle_ps(val, val, _MM_SHUFFLE(I3, I2, I1, I0));
+		}
+
+		template <size_t I>
+		MUU_CONST_INLINE_GETTER
+		static float MUU_VECTORCALL get(reg val) noexcept
+		{
+			if constexpr (I == 0)
+				return _mm_cvtss_f32(val);
+			else
+				return _mm_cvtss_f32(permute<I, I, I, I>(val));
+		}
+
+		MUU_CONST_INLINE_GETTER
+		static reg MUU_VECTORCALL with_w(reg val, float w) noexcept
+		{
+	#if MUU_ISET_SSE4_1
+			return _mm_insert_ps(val, _mm_set_ss(w), 0x30);
+	#else
+			const auto zw = _mm_shuffle_ps(val, _mm_set_ss(w), _MM_SHUFFLE(0, 0, 2, 2));
+			return _mm_shuffle_ps(val, zw, _MM_SHUFFLE(2, 0, 1, 0));
+	#endif
+		}
+
+		MUU_ALWAYS_INLINE
+		static void MUU_VECTORCALL transpose(reg& r0, reg& r1, reg& r2, reg& r3) noexcept
+		{
+			_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+		}
+	};
+
+	template <>
+	struct simd_lanes<double, 2>
+	{
+		using reg = __m128d;
+
+		MUU_PURE_INLINE_GETTER
+		static reg MUU_VECTORCALL load(const double* src) noexcept
+		{
+			return _mm_loadu_pd(src);
+		}
+
+		MUU_ALWAYS_INLINE
+		static void MUU_VECTORCALL store(double* dest, reg val) noexcept
+		{
+			_mm_storeu_pd(dest, val);
+		}
+
+		MUU_CONST_INLINE_GETTER
+		static reg MUU_VECTORCALL broadcast(double val) noexcept
+		{
+			return _mm_set1_pd(val);
+		}
+
+		MUU_CONST_INLINE_GETTER
+		static reg MUU_VECTORCALL add(reg lhs, reg rhs) noexcept
+		{
+			return _mm_add_pd(lhs, rhs);
+		}
+
+		MUU_CONST_INLINE_GETTER
+		static reg MUU_VECTORCALL sub(reg lhs, reg rhs) noexcept
+		{
+			return _mm_sub_pd(lhs, rhs);
+		}
+
+		MUU_CONST_INLINE_GETTER
+		static reg MUU_VECTORCALL mul(reg lhs, reg rhs) noexcept
+		{
+			return _mm_mul_pd(lhs, rhs);
+		}
+
+		MUU_CONST_INLINE_GETTER
+		static reg MUU_VECTORCALL div(reg lhs, reg rhs) noexcept
+		{
+			return _mm_div_pd(lhs, rhs);
+		}
+
+		MUU_CONST_INLINE_GETTER
+		static reg MUU_VECTORCALL min(reg lhs, reg rhs) noexcept
+		{
+			return _mm_min_pd(lhs, rhs);
+		}
+
+		MUU_CONST_INLINE_GETTER
+		static reg MUU_VECTORCALL max(reg lhs, reg rhs) noexcept
+		{
+			return _mm_max_pd(rhs, lhs);
+		}
+
+		MUU_CONST_INLINE_GETTER
+		static reg MUU_VECTORCALL negate(reg val) noexcept
+		{
+			return _mm_xor_pd(val, _mm_set1_pd(-0.0));
+		}
+
+		MUU_CONST_INLINE_GETTER
+		static double MUU_VECTORCALL sum(reg val) noexcept
+		{
+			return _mm_cvtsd_f64(_mm_add_sd(val, _mm_unpackhi_pd(val, val)));
+		}
+
+		MUU_CONST_INLINE_GETTER
+		static double MUU_VECTORCALL sqrt(double val) noexcept
+		{
+			const auto v = _mm_set_sd(val);
+			return _mm_cvtsd_f64(_mm_sqrt_sd(v, v));
+		}
+	};
+
+	#if MUU_ISET_AVX
+
+	template <size_t Dimensions>
+	struct simd_lanes<double, Dimensions>
+	{
+		static_assert(Dimensions == 3 || Dimensions == 4);
+
+		using reg = __m256d;
+
+		MUU_PURE_INLINE_GETTER
+		static reg MUU_VECTORCALL load(const double* src) noexcept
+		{
+			if constexpr (Dimensions == 4)
+				return _mm256_loadu_pd(src);
+			else
+				return _mm256_insertf128_pd(_mm256_castpd128_pd256(_mm_loadu_pd(src)), _mm_load_sd(src + 2), 1);
+		}
+
+		MUU_ALWAYS_INLINE
+		static void MUU_VECTORCALL store(double* dest, reg val) noexcept
+		{
+			if constexpr (Dimensions == 4)
+				_mm256_storeu_pd(dest, val);
+			else
+			{
+				_mm_storeu_pd(dest, _mm256_castpd256_pd128(val));
+				_mm_store_sd(dest + 2, _mm256_extractf128_pd(val, 1));
+			}
+		}
+
+		MUU_CONST_INLINE_GETTER
+		static reg MUU_VECTORCALL broadcast(double val) noexcept
+		{
+			return _mm256_set1_pd(val);
+		}
+
+		MUU_CONST_INLINE_GETTER
+		static reg MUU_VECTORCALL add(reg lhs, reg rhs) noexcept
+		{
+			return _mm256_add_pd(lhs, rhs);
+		}
+
+		MUU_CONST_INLINE_GETTER
+		static reg MUU_VECTORCALL sub(reg lhs, reg rhs) noexcept
+		{
+			return _mm256_sub_pd(lhs, rhs);
+		}
+
+		MUU_CONST_INLINE_GETTER
+		static reg MUU_VECTORCALL mul(reg lhs, reg rhs) noexcept
+		{
+			return _mm256_mul_pd(lhs, rhs);
+		}
+
+		MUU_CONST_INLINE_GETTER
+		static reg MUU_VECTORCALL div(reg lhs, reg rhs) noexcept
+		{
+			return _mm256_div_pd(lhs, rhs);
+		}
+
+		MUU_CONST_INLINE_GETTER
+		static reg MUU_VECTORCALL min(reg lhs, reg rhs) noexcept
+		{
+			return _mm256_min_pd(lhs, rhs);
+		}
+
+		MUU_CONST_INLINE_GETTER
+		static reg MUU_VECTORCALL max(reg lhs, reg rhs) noexcept
+		{
+			return _mm256_max_pd(rhs, lhs);
+		}
+
+		MUU_CONST_INLINE_GETTER
+		static reg MUU_VECTORCALL negate(reg val) noexcept
+		{
+			return _mm256_xor_pd(val, _mm256_set1_pd(-0.0));
+		}
+
+		MUU_CONST_INLINE_GETTER
+		static double MUU_VECTORCALL sum(reg val) noexcept
+		{
+			const auto xy = _mm256_castpd256_pd128(val);
+			const auto zw = _mm256_extractf128_pd(val, 1);
+			auto out	  = _mm_add_sd(_mm_add_sd(xy, _mm_unpackhi_pd(xy, xy)), zw);
+			if constexpr (Dimensions == 4)
+				out = _mm_add_sd(out, _mm_unpackhi_pd(zw, zw));
+			return _mm_cvtsd_f64(out);
+		}
+
+		MUU_CONST_INLINE_GETTER
+		static double MUU_VECTORCALL sqrt(double val) noexcept
+		{
+			return simd_lanes<double, 2>::sqrt(val);
+		}
+
+		// shuffles and lane access used by the matrix kernels in matrix_simd.h
+
+		template <size_t I0, size_t I1, size_t I2, size_t I3>
+		MUU_CONST_INLINE_GETTER
+		static reg MUU_VECTORCALL permute(reg val) noexcept
+		{
+		#if MUU_ISET_AVX2
+			return _mm256_permute4x64_pd(val, _MM_SHUFFLE(I3, I2, I1, I0));
+		#else
+			// AVX1 can only shuffle within each 128-bit half, so pick from copies of both halves and blend
+			constexpr int odd  = (I0 & 1) | ((I1 & 1) << 1) | ((I2 & 1) << 2) | ((I3 & 1) << 3);
+			constexpr int high = (I0 >> 1) | ((I1 >> 1) << 1) | ((I2 >> 1) << 2) | ((I3 >> 1) << 3);
+			return _mm256_blend_pd(_mm256_permute_pd(_mm256_permute2f128_pd(val, val, 0x00), odd),
+								   _mm256_permute_pd(_mm256_permute2f128_pd(val, val, 0x11), odd),
+								   high);
+		#endif
+		}
+
+		template <size_t I>
+		MUU_CONST_INLINE_GETTER
+		static double MUU_VECTORCALL get(reg val) noexcept
+		{
+			__m128d half;
+			if constexpr (I < 2)
+				half = _mm256_castpd256_pd128(val);
+			else
+				half = _mm256_extractf128_pd(val, 1);
+
+			if constexpr ((I & 1) == 0)
+				return _mm_cvtsd_f64(half);
+			else
+				return _mm_cvtsd_f64(_mm_unpackhi_pd(half, half));
+		}
+
+		MUU_CONST_INLINE_GETTER
+		static reg MUU_VECTORCALL with_w(reg val, double w) noexcept
+		{
+			return _mm256_blend_pd(val, _mm256_set1_pd(w), 0b1000);
+		}
+
+		MUU_ALWAYS_INLINE
+		static void MUU_VECTORCALL transpose(reg& r0, reg& r1, reg& r2, reg& r3) noexcept
+		{
+			const auto t0 = _mm256_unpacklo_pd(r0, r1);
+			const auto t1 = _mm256_unpackhi_pd(r0, r1);
+			const auto t2 = _mm256_unpacklo_pd(r2, r3);
+			const auto t3 = _mm256_unpackhi_pd(r2, r3);
+			r0			  = _mm256_permute2f128_pd(t0, t2, 0x20);
+			r1			  = _mm256_permute2f128_pd(t1, t3, 0x20);
+			r2			  = _mm256_permute2f128_pd(t0, t2, 0x31);
+			r3			  = _mm256_permute2f128_pd(t1, t3, 0x31);
+		}
+	};
+
+	#endif // MUU_ISET_AVX
+
+	// runtime implementations of vector's arithmetic, called from vector.h when not in a constant-evaluated context
+	template <typename Scalar, size_t Dimensions>
+	struct vector_simd
+	{
+		static_assert(has_vector_simd_<Scalar, Dimensions>);
+
+		using lanes		  = simd_lanes<Scalar, Dimensions>;
+		using vector_type = vector<Scalar, Dimensions>;
+
+		MUU_PURE_INLINE_GETTER
+		static typename lanes::reg MUU_VECTORCALL load(const vector_type& v) noexcept
+		{
+			return lanes::load(v.data());
+		}
+
+		MUU_PURE_INLINE_GETTER
+		static vector_type MUU_VECTORCALL store(typename lanes::reg val) noexcept
+		{
+			vector_type out;
+			lanes::store(out.data(), val);
+			return out;
+		}
+
+		MUU_PURE_INLINE_GETTER
+		static vector_type MUU_VECTORCALL add(const vector_type& lhs, const vector_type& rhs) noexcept
+		{
+			return store(lanes::add(load(lhs), load(rhs)));
+		}
+
+		MUU_PURE_INLINE_GETTER
+		static vector_type MUU_VECTORCALL sub(const vector_type& lhs, const vector_type& rhs) noexcept
+		{
+			return store(lanes::sub(load(lhs), load(rhs)));
+		}
+
+		MUU_PURE_INLINE_GETTER
+		static vector_type MUU_VECTORCALL mul(const vector_type& lhs, const vector_type& rhs) noexcept
+		{
+			return store(lanes::mul(load(lhs), load(rhs)));
+		}
+
+		MUU_PURE_INLINE_GETTER
+		static vector_type MUU_VECTORCALL mul(const vector_type& lhs, Scalar rhs) noexcept
+		{
+			return store(lanes::mul(load(lhs), lanes::broadcast(rhs)));
+		}
+
+		MUU_PURE_INLINE_GETTER
+		static vector_type MUU_VECTORCALL div(const vector_type& lhs, const vector_type& rhs) noexcept
+		{
+			return store(lanes::div(load(lhs), load(rhs)));
+		}
+
+		MUU_PURE_INLINE_GETTER
+		static vector_type MUU_VECTORCALL negate(const vector_type& v) noexcept
+		{
+			return store(lanes::negate(load(v)));
+		}
+
+		MUU_PURE_INLINE_GETTER
+		static vector_type MUU_VECTORCALL min(const vector_type& v1, const vector_type& v2) noexcept
+		{
+			return store(lanes::min(load(v1), load(v2)));
+		}
+
+		MUU_PURE_INLINE_GETTER
+		static vector_type MUU_VECTORCALL max(const vector_type& v1, const vector_type& v2) noexcept
+		{
+			return store(lanes::max(load(v1), load(v2)));
+		}
+
+		MUU_PURE_INLINE_GETTER
+		static Scalar MUU_VECTORCALL dot(const vector_type& v1, const vector_type& v2) noexcept
+		{
+			return lanes::sum(lanes::mul(load(v1), load(v2)));
+		}
+
+		MUU_PURE_INLINE_GETTER
+		static Scalar MUU_VECTORCALL length_squared(const vector_type& v) noexcept
+		{
+			const auto val = load(v);
+			return lanes::sum(lanes::mul(val, val));
+		}
+
+		MUU_PURE_INLINE_GETTER
+		static vector_type MUU_VECTORCALL lerp(const vector_type& start,
+											   const vector_type& finish,
+											   Scalar alpha) noexcept
+		{
+			return store(lanes::add(lanes::mul(load(start), lanes::broadcast(Scalar{ 1 } - alpha)),
+									lanes::mul(load(finish), lanes::broadcast(alpha))));
+		}
+
+		MUU_ALWAYS_INLINE
+		static vector_type MUU_VECTORCALL normalize(const vector_type& v, Scalar& length_out) noexcept
+		{
+			const auto val = load(v);
+			length_out	   = lanes::sqrt(lanes::sum(lanes::mul(val, val)));
+			return store(lanes::mul(val, lanes::broadcast(Scalar{ 1 } / length_out)));
+		}
+
+		MUU_PURE_INLINE_GETTER
+		static vector_type MUU_VECTORCALL normalize(const vector_type& v) noexcept
+		{
+			const auto val = load(v);
+			const auto len = lanes::sqrt(lanes::sum(lanes::mul(val, val)));
+			return store(lanes::mul(val, lanes::broadcast(Scalar{ 1 } / len)));
+		}
+	};
+
+#endif // MUU_VECTOR_SIMD
+}
+
+MUU_RESET_NDEBUG_OPTIMIZATIONS;
+#include "header_end.h"
+/// \endcond
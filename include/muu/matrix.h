@@ -10,6 +10,8 @@
 #include "vector.h"
 #include "quaternion.h"
 #include "impl/matrix_base.h"
+#include "impl/matrix_simd.h"
+#include "impl/batch_transform.h"
 #include "impl/header_start.h"
 MUU_FORCE_NDEBUG_OPTIMIZATIONS;
 MUU_DISABLE_SHADOW_WARNINGS;
@@ -43,6 +45,72 @@ namespace muu
 
 /// \cond
 
+// runtime-only SIMD fast path (see impl/matrix_simd.h); falls through to the scalar code in constant evaluation
+#define SIMD_RETURN(func, ...)                                                                                         \
+	if constexpr (impl::has_matrix_simd_<Scalar, Rows> && build::supports_is_constant_evaluated)                       \
+	{                                                                                                                  \
+		MUU_IF_RUNTIME                                                                                                 \
+		{                                                                                                              \
+			return impl::matrix_simd<Scalar, Rows, Columns>::func(__VA_ARGS__);                                        \
+		}                                                                                                              \
+	}                                                                                                                  \
+	static_assert(true)
+
+// the in-place, thread_pool and member overloads of a span-based batch transform, given the static (in, out) overload
+#define BATCH_TRANSFORM_OVERLOADS(func)                                                                                \
+	static constexpr void func(const matrix<Scalar, Rows, Columns>& xform, span<vector<Scalar, 3>> vectors) noexcept   \
+	{                                                                                                                  \
+		func(xform, span<const vector<Scalar, 3>>{ vectors }, vectors);                                                \
+	}                                                                                                                  \
+                                                                                                                       \
+	MUU_CONSTRAINED_TEMPLATE((std::is_same_v<Pool, thread_pool>), typename Pool)                                       \
+	static void func(const matrix<Scalar, Rows, Columns>& xform,                                                       \
+					 span<const vector<Scalar, 3>> vectors,                                                            \
+					 span<vector<Scalar, 3>> vectors_out,                                                              \
+					 Pool& pool) noexcept                                                                              \
+	{                                                                                                                  \
+		MUU_ASSERT(vectors_out.size() >= vectors.size() && "output span is smaller than the input span");              \
+                                                                                                                       \
+		impl::batch_transform_parallel<Scalar>(pool,                                                                   \
+											   vectors.size(),                                                         \
+											   [&](size_t start, size_t end) noexcept                                  \
+											   {                                                                       \
+												   func(xform,                                                         \
+														vectors.subspan(start, end - start),                           \
+														vectors_out.subspan(start, end - start));                      \
+											   });                                                                     \
+	}                                                                                                                  \
+                                                                                                                       \
+	MUU_CONSTRAINED_TEMPLATE((std::is_same_v<Pool, thread_pool>), typename Pool)                                       \
+	static void func(const matrix<Scalar, Rows, Columns>& xform, span<vector<Scalar, 3>> vectors, Pool& pool) noexcept \
+	{                                                                                                                  \
+		func(xform, span<const vector<Scalar, 3>>{ vectors }, vectors, pool);                                          \
+	}                                                                                                                  \
+                                                                                                                       \
+	constexpr void func(span<const vector<Scalar, 3>> vectors, span<vector<Scalar, 3>> vectors_out) const noexcept     \
+	{                                                                                                                  \
+		func(static_cast<const matrix<Scalar, Rows, Columns>&>(*this), vectors, vectors_out);                          \
+	}                                                                                                                  \
+                                                                                                                       \
+	constexpr void func(span<vector<Scalar, 3>> vectors) const noexcept                                                \
+	{                                                                                                                  \
+		func(static_cast<const matrix<Scalar, Rows, Columns>&>(*this), vectors);                                       \
+	}                                                                                                                  \
+                                                                                                                       \
+	MUU_CONSTRAINED_TEMPLATE((std::is_same_v<Pool, thread_pool>), typename Pool)                                       \
+	void func(span<const vector<Scalar, 3>> vectors, span<vector<Scalar, 3>> vectors_out, Pool& pool) const noexcept   \
+	{                                                                                                                  \
+		func(static_cast<const matrix<Scalar, Rows, Columns>&>(*this), vectors, vectors_out, pool);                    \
+	}                                                                                                                  \
+                                                                                                                       \
+	MUU_CONSTRAINED_TEMPLATE((std::is_same_v<Pool, thread_pool>), typename Pool)                                       \
+	void func(span<vector<Scalar, 3>> vectors, Pool& pool) const noexcept                                              \
+	{                                                                                                                  \
+		func(static_cast<const matrix<Scalar, Rows, Columns>&>(*this), vectors, pool);                                 \
+	}                                                                                                                  \
+                                                                                                                       \
+	static_assert(true)
+
 namespace muu::impl
 {
 	//--- x + y column getters -----------------------------------------------------------------------------------------
@@ -707,6 +775,34 @@ namespace muu::impl
 		}
 	};
 
+	//--- batch transforms ---------------------------------------------------------------------------------------------
+
+	// the 3x3 part of a matrix applied to every lane of a block (see impl/batch_transform.h)
+	template <typename Scalar, size_t Rows, size_t Columns>
+	MUU_ALWAYS_INLINE
+	constexpr void batch_transform_without_translating(const matrix<Scalar, Rows, Columns>& xform,
+													   batch_transform_block<Scalar>& block) noexcept
+	{
+		MUU_FMA_BLOCK;
+
+		for (size_t i = 0; i < batch_transform_width<Scalar>; i++)
+		{
+			const auto x = block.x[i];
+			const auto y = block.y[i];
+			const auto z = block.z[i];
+
+			block.x[i] = xform.template get<0, 0>() * x //
+					   + xform.template get<0, 1>() * y //
+					   + xform.template get<0, 2>() * z;
+			block.y[i] = xform.template get<1, 0>() * x //
+					   + xform.template get<1, 1>() * y //
+					   + xform.template get<1, 2>() * z;
+			block.z[i] = xform.template get<2, 0>() * x //
+					   + xform.template get<2, 1>() * y //
+					   + xform.template get<2, 2>() * z;
+		}
+	}
+
 	//--- transform_position() ----------------------------------------------------------------------------------------
 
 	template <typename Derived, bool = is_3d_transform_matrix_<Derived>>
@@ -734,6 +830,8 @@ namespace muu::impl
 			}
 			else
 			{
+				SIMD_RETURN(transform_position, xform, pos);
+
 				auto inv_w = Scalar{ 1 };
 				if constexpr (Rows == 4)
 				{
@@ -768,6 +866,62 @@ namespace muu::impl
 		{
 			return transform_position(static_cast<const matrix<Scalar, Rows, Columns>&>(*this), pos);
 		}
+
+		static constexpr void transform_position(const matrix<Scalar, Rows, Columns>& xform,
+												 span<const vector<Scalar, 3>> vectors,
+												 span<vector<Scalar, 3>> vectors_out) noexcept
+		{
+			impl::batch_transform<Scalar>(
+				vectors,
+				vectors_out,
+				[m = xform](auto& block) noexcept
+				{
+					MUU_FMA_BLOCK;
+
+					for (size_t i = 0; i < batch_transform_width<Scalar>; i++)
+					{
+						const auto x = block.x[i];
+						const auto y = block.y[i];
+						const auto z = block.z[i];
+
+						auto out_x = m.template get<0, 0>() * x	  //
+								   + m.template get<0, 1>() * y //
+								   + m.template get<0, 2>() * z;
+						auto out_y = m.template get<1, 0>() * x	  //
+								   + m.template get<1, 1>() * y //
+								   + m.template get<1, 2>() * z;
+						auto out_z = m.template get<2, 0>() * x	  //
+								   + m.template get<2, 1>() * y //
+								   + m.template get<2, 2>() * z;
+
+						if constexpr (Columns == 4)
+						{
+							out_x += m.template get<0, 3>();
+							out_y += m.template get<1, 3>();
+							out_z += m.template get<2, 3>();
+						}
+
+						if constexpr (Rows == 4)
+						{
+							const auto inv_w = Scalar{ 1 }
+											 / (m.template get<3, 0>() * x	 //
+												+ m.template get<3, 1>() * y //
+												+ m.template get<3, 2>() * z //
+												+ m.template get<3, 3>());
+							out_x *= inv_w;
+							out_y *= inv_w;
+							out_z *= inv_w;
+						}
+
+						block.x[i] = out_x;
+						block.y[i] = out_y;
+						block.z[i] = out_z;
+					}
+				},
+				[&](const vector<Scalar, 3>& pos) noexcept { return transform_position(xform, pos); });
+		}
+
+		BATCH_TRANSFORM_OVERLOADS(transform_position);
 	};
 
 	template <typename Derived, bool = (is_3d_transform_matrix_<Derived> && !is_matrix_<Derived, 3, 3, 3, 3>)>
@@ -807,6 +961,8 @@ namespace muu::impl
 			MUU_VPARAM(matrix<Scalar, Rows, Columns>) xform,
 			MUU_VPARAM(vector<Scalar, 3>) dir) noexcept
 		{
+			SIMD_RETURN(transform_without_translating, xform, dir);
+
 			MUU_FMA_BLOCK;
 
 			return vector<Scalar, 3>{ xform.template get<0, 0>() * dir.x	   //
@@ -828,6 +984,19 @@ namespace muu::impl
 		{
 			return transform_without_translating(static_cast<const matrix<Scalar, Rows, Columns>&>(*this), dir);
 		}
+
+		static constexpr void transform_without_translating(const matrix<Scalar, Rows, Columns>& xform,
+															span<const vector<Scalar, 3>> vectors,
+															span<vector<Scalar, 3>> vectors_out) noexcept
+		{
+			impl::batch_transform<Scalar>(
+				vectors,
+				vectors_out,
+				[m = xform](auto& block) noexcept { batch_transform_without_translating(m, block); },
+				[&](const vector<Scalar, 3>& dir) noexcept { return transform_without_translating(xform, dir); });
+		}
+
+		BATCH_TRANSFORM_OVERLOADS(transform_without_translating);
 	};
 
 	//--- transform_direction() ----------------------------------------------------------------------------------------
@@ -860,6 +1029,46 @@ namespace muu::impl
 		{
 			return transform_direction(static_cast<const matrix<Scalar, Rows, Columns>&>(*this), dir);
 		}
+
+		static constexpr void transform_direction(const matrix<Scalar, Rows, Columns>& xform,
+												  span<const vector<Scalar, 3>> vectors,
+												  span<vector<Scalar, 3>> vectors_out) noexcept
+		{
+			impl::batch_transform<Scalar>(
+				vectors,
+				vectors_out,
+				[m = xform](auto& block) noexcept
+				{
+					MUU_FMA_BLOCK;
+
+					for (size_t i = 0; i < batch_transform_width<Scalar>; i++)
+					{
+						const auto x = block.x[i];
+						const auto y = block.y[i];
+						const auto z = block.z[i];
+
+						const auto out_x = m.template get<0, 0>() * x	//
+										 + m.template get<0, 1>() * y //
+										 + m.template get<0, 2>() * z;
+						const auto out_y = m.template get<1, 0>() * x	//
+										 + m.template get<1, 1>() * y //
+										 + m.template get<1, 2>() * z;
+						const auto out_z = m.template get<2, 0>() * x	//
+										 + m.template get<2, 1>() * y //
+										 + m.template get<2, 2>() * z;
+
+						// restore the original length with a single square root
+						const auto scale = muu::sqrt((x * x + y * y + z * z) //
+													 / (out_x * out_x + out_y * out_y + out_z * out_z));
+						block.x[i]		 = out_x * scale;
+						block.y[i]		 = out_y * scale;
+						block.z[i]		 = out_z * scale;
+					}
+				},
+				[&](const vector<Scalar, 3>& dir) noexcept { return transform_direction(xform, dir); });
+		}
+
+		BATCH_TRANSFORM_OVERLOADS(transform_direction);
 	};
 
 	//--- extract_2d_scale() -----------------------------------------------------------------------------------------
@@ -1247,6 +1456,51 @@ namespace muu::impl
 		}
 	};
 
+	//--- invert_affine() ---------------------------------------------------------------------------------------------
+
+	template <typename Derived, bool = (is_3d_transform_matrix_<Derived> && is_3d_translation_matrix_<Derived>)>
+	struct matrix_invert_affine
+	{};
+
+	template <typename Scalar, size_t Rows, size_t Columns>
+	struct matrix_invert_affine<matrix<Scalar, Rows, Columns>, true>
+	{
+		static_assert(Rows == 3 || Rows == 4);
+		static_assert(Columns == 4);
+
+		MUU_PURE_GETTER
+		static constexpr matrix<Scalar, Rows, Columns> MUU_VECTORCALL invert_affine(
+			MUU_VPARAM(matrix<Scalar, Rows, Columns>) m) noexcept
+		{
+			if constexpr (is_small_float_<Scalar>)
+			{
+				using promoted_mat = matrix<promote_if_small_float<Scalar>, Rows, Columns>;
+
+				return matrix<Scalar, Rows, Columns>{ promoted_mat::invert_affine(promoted_mat{ m }) };
+			}
+			else
+			{
+				SIMD_RETURN(invert_affine, m);
+
+				// inverse of [R|t] is [R^-1|-(R^-1 * t)]
+				const auto rot = matrix<Scalar, 3, 3>::invert(matrix<Scalar, 3, 3>{ m });
+
+				matrix<Scalar, Rows, Columns> out{ rot };
+				out.m[3] = vector<Scalar, Rows>{ -(rot * vector<Scalar, 3>{ m.m[3] }) };
+				if constexpr (Rows == 4)
+					out.m[3].w = Scalar{ 1 };
+
+				return out;
+			}
+		}
+
+		constexpr matrix<Scalar, Rows, Columns>& invert_affine() noexcept
+		{
+			return static_cast<matrix<Scalar, Rows, Columns>&>(*this) =
+					   invert_affine(static_cast<matrix<Scalar, Rows, Columns>&>(*this));
+		}
+	};
+
 } // impl
 
 #define SPECIALIZED_IF(cond) , bool = (cond)
@@ -1293,6 +1547,7 @@ namespace muu
 			impl::matrix_extract_2d_scale<matrix<Scalar, Rows, Columns>>,
 			impl::matrix_extract_3d_scale<matrix<Scalar, Rows, Columns>>,
 			impl::matrix_orthonormalize<matrix<Scalar, Rows, Columns>>,
+			impl::matrix_invert_affine<matrix<Scalar, Rows, Columns>>,
 			impl::matrix_perspective_projection<matrix<Scalar, Rows, Columns>>
 		)
 	{
@@ -2409,6 +2664,8 @@ namespace muu
 			}
 			else
 			{
+				SIMD_RETURN(multiply, lhs, rhs);
+
 				MUU_FMA_BLOCK;
 
 	#define MULT_DOT(row, col, idx) lhs.m[idx].template get<row>() * rhs.m[col].template get<idx>()
@@ -2502,6 +2759,8 @@ namespace muu
 			}
 			else
 			{
+				SIMD_RETURN(multiply, lhs, rhs);
+
 				MUU_FMA_BLOCK;
 
 	#define MULT_COL(row, col, vec_elem) lhs.m[col].template get<row>() * rhs.vec_elem
@@ -2729,7 +2988,8 @@ namespace muu
 
 #if 1  // inverse & determinant -------------------------------------------------------------------------------------
 		/// \name Inverse & Determinant
-		/// \availability	These functions are only available when the matrix is square.
+		/// \availability	These functions are only available when the matrix is square
+		///					(or, for invert_affine(), a 3x4 or 4x4 transform).
 		/// @{
 
 		/// \brief	Calculates the determinant of a matrix.
@@ -2806,6 +3066,8 @@ namespace muu
 				}
 				if constexpr (Columns == 4)
 				{
+					SIMD_RETURN(invert, m);
+
 					// generated using https://github.com/willnode/N-Matrix-Programmer
 
 					const auto A2323 = MAT_GET(2, 2) * MAT_GET(3, 3) - MAT_GET(2, 3) * MAT_GET(3, 2);
@@ -2872,6 +3134,26 @@ namespace muu
 			return *this = invert(*this);
 		}
 
+	#if MUU_DOXYGEN
+
+		/// \brief	Returns the inverse of an affine transformation matrix.
+		///
+		/// \details	Treats the matrix as a 3x3 linear part plus a translation column and inverts it as
+		///			`[R^-1 | -(R^-1 * t)]`, which is considerably cheaper than a general #invert().
+		///			The bottom row of a 4x4 matrix is assumed to be `{ 0, 0, 0, 1 }`.
+		///
+		/// \availability	This function is only available when the matrix is 3x4 or 4x4 and has a floating-point
+		///					#scalar_type.
+		static constexpr matrix invert_affine(const matrix&) noexcept;
+
+		/// \brief	Inverts an affine transformation matrix (in-place).
+		///
+		/// \availability	This function is only available when the matrix is 3x4 or 4x4 and has a floating-point
+		///					#scalar_type.
+		constexpr matrix& invert_affine() noexcept;
+
+	#endif // DOXYGEN
+
 		/// @}
 #endif	// inverse & determinant
 
@@ -2983,6 +3265,157 @@ namespace muu
 		/// \return The result of transforming the 3D direction by the matrix.
 		constexpr vector<scalar_type, 3> transform_direction(const vector<scalar_type, 3>& dir) const noexcept;
 
+		/// \brief Applies a matrix's 3d transformation to a span of positions.
+		///
+		/// \details Equivalent to calling #transform_position() for each element in turn, but the
+		///			 positions are processed in structure-of-arrays blocks so the arithmetic is vectorized
+		///			 (see muu::vector_soa).
+		///
+		/// \param	xform		The transformation.
+		/// \param	vectors		The input positions.
+		/// \param	vectors_out	The output span. Must be at least as large as the input span, and may be the
+		///						same span as the input (but may not otherwise overlap it).
+		static constexpr void transform_position(const matrix& xform,
+												 span<const vector<scalar_type, 3>> vectors,
+												 span<vector<scalar_type, 3>> vectors_out) noexcept;
+
+		/// \brief Applies a matrix's 3d transformation to a span of positions (in-place).
+		static constexpr void transform_position(const matrix& xform, span<vector<scalar_type, 3>> vectors) noexcept;
+
+		/// \brief Applies a matrix's 3d transformation to a span of positions, splitting the work between the
+		///			workers of a thread_pool.
+		///
+		/// \details Spans too small to be worth splitting are transformed on the calling thread.
+		///			 Returns once all of the positions have been transformed.
+		static void transform_position(const matrix& xform,
+									   span<const vector<scalar_type, 3>> vectors,
+									   span<vector<scalar_type, 3>> vectors_out,
+									   thread_pool& pool) noexcept;
+
+		/// \brief Applies a matrix's 3d transformation to a span of positions (in-place), splitting the work
+		///			between the workers of a thread_pool.
+		static void transform_position(const matrix& xform,
+									   span<vector<scalar_type, 3>> vectors,
+									   thread_pool& pool) noexcept;
+
+		/// \brief Applies the matrix's 3d transformation to a span of positions.
+		constexpr void transform_position(span<const vector<scalar_type, 3>> vectors,
+										  span<vector<scalar_type, 3>> vectors_out) const noexcept;
+
+		/// \brief Applies the matrix's 3d transformation to a span of positions (in-place).
+		constexpr void transform_position(span<vector<scalar_type, 3>> vectors) const noexcept;
+
+		/// \brief Applies the matrix's 3d transformation to a span of positions, splitting the work between the
+		///			workers of a thread_pool.
+		void transform_position(span<const vector<scalar_type, 3>> vectors,
+								span<vector<scalar_type, 3>> vectors_out,
+								thread_pool& pool) const noexcept;
+
+		/// \brief Applies the matrix's 3d transformation to a span of positions (in-place), splitting the work
+		///			between the workers of a thread_pool.
+		void transform_position(span<vector<scalar_type, 3>> vectors, thread_pool& pool) const noexcept;
+
+		/// \brief Applies a matrix's 3d transformation to a span of vectors.
+		///
+		/// \details Equivalent to calling #transform_without_translating() for each element in turn, but the
+		///			 vectors are processed in structure-of-arrays blocks so the arithmetic is vectorized
+		///			 (see muu::vector_soa).
+		///
+		/// \param	xform		The transformation.
+		/// \param	vectors		The input vectors.
+		/// \param	vectors_out	The output span. Must be at least as large as the input span, and may be the
+		///						same span as the input (but may not otherwise overlap it).
+		static constexpr void transform_without_translating(const matrix& xform,
+															span<const vector<scalar_type, 3>> vectors,
+															span<vector<scalar_type, 3>> vectors_out) noexcept;
+
+		/// \brief Applies a matrix's 3d transformation to a span of vectors (in-place).
+		static constexpr void transform_without_translating(const matrix& xform,
+															span<vector<scalar_type, 3>> vectors) noexcept;
+
+		/// \brief Applies a matrix's 3d transformation to a span of vectors, splitting the work between the
+		///			workers of a thread_pool.
+		///
+		/// \details Spans too small to be worth splitting are transformed on the calling thread.
+		///			 Returns once all of the vectors have been transformed.
+		static void transform_without_translating(const matrix& xform,
+												  span<const vector<scalar_type, 3>> vectors,
+												  span<vector<scalar_type, 3>> vectors_out,
+												  thread_pool& pool) noexcept;
+
+		/// \brief Applies a matrix's 3d transformation to a span of vectors (in-place), splitting the work
+		///			between the workers of a thread_pool.
+		static void transform_without_translating(const matrix& xform,
+												  span<vector<scalar_type, 3>> vectors,
+												  thread_pool& pool) noexcept;
+
+		/// \brief Applies the matrix's 3d transformation to a span of vectors.
+		constexpr void transform_without_translating(span<const vector<scalar_type, 3>> vectors,
+													 span<vector<scalar_type, 3>> vectors_out) const noexcept;
+
+		/// \brief Applies the matrix's 3d transformation to a span of vectors (in-place).
+		constexpr void transform_without_translating(span<vector<scalar_type, 3>> vectors) const noexcept;
+
+		/// \brief Applies the matrix's 3d transformation to a span of vectors, splitting the work between the
+		///			workers of a thread_pool.
+		void transform_without_translating(span<const vector<scalar_type, 3>> vectors,
+										   span<vector<scalar_type, 3>> vectors_out,
+										   thread_pool& pool) const noexcept;
+
+		/// \brief Applies the matrix's 3d transformation to a span of vectors (in-place), splitting the work
+		///			between the workers of a thread_pool.
+		void transform_without_translating(span<vector<scalar_type, 3>> vectors, thread_pool& pool) const noexcept;
+
+		/// \brief Applies a matrix's 3d transformation to a span of directions.
+		///
+		/// \details Equivalent to calling #transform_direction() for each element in turn, but the
+		///			 directions are processed in structure-of-arrays blocks so the arithmetic is vectorized
+		///			 (see muu::vector_soa).
+		///
+		/// \param	xform		The transformation.
+		/// \param	vectors		The input directions.
+		/// \param	vectors_out	The output span. Must be at least as large as the input span, and may be the
+		///						same span as the input (but may not otherwise overlap it).
+		static constexpr void transform_direction(const matrix& xform,
+												  span<const vector<scalar_type, 3>> vectors,
+												  span<vector<scalar_type, 3>> vectors_out) noexcept;
+
+		/// \brief Applies a matrix's 3d transformation to a span of directions (in-place).
+		static constexpr void transform_direction(const matrix& xform, span<vector<scalar_type, 3>> vectors) noexcept;
+
+		/// \brief Applies a matrix's 3d transformation to a span of directions, splitting the work between the
+		///			workers of a thread_pool.
+		///
+		/// \details Spans too small to be worth splitting are transformed on the calling thread.
+		///			 Returns once all of the directions have been transformed.
+		static void transform_direction(const matrix& xform,
+										span<const vector<scalar_type, 3>> vectors,
+										span<vector<scalar_type, 3>> vectors_out,
+										thread_pool& pool) noexcept;
+
+		/// \brief Applies a matrix's 3d transformation to a span of directions (in-place), splitting the work
+		///			between the workers of a thread_pool.
+		static void transform_direction(const matrix& xform,
+										span<vector<scalar_type, 3>> vectors,
+										thread_pool& pool) noexcept;
+
+		/// \brief Applies the matrix's 3d transformation to a span of directions.
+		constexpr void transform_direction(span<const vector<scalar_type, 3>> vectors,
+										   span<vector<scalar_type, 3>> vectors_out) const noexcept;
+
+		/// \brief Applies the matrix's 3d transformation to a span of directions (in-place).
+		constexpr void transform_direction(span<vector<scalar_type, 3>> vectors) const noexcept;
+
+		/// \brief Applies the matrix's 3d transformation to a span of directions, splitting the work between the
+		///			workers of a thread_pool.
+		void transform_direction(span<const vector<scalar_type, 3>> vectors,
+								 span<vector<scalar_type, 3>> vectors_out,
+								 thread_pool& pool) const noexcept;
+
+		/// \brief Applies the matrix's 3d transformation to a span of directions (in-place), splitting the work
+		///			between the workers of a thread_pool.
+		void transform_direction(span<vector<scalar_type, 3>> vectors, thread_pool& pool) const noexcept;
+
 		/// \brief Extracts the scale from a 2D transform matrix.
 		///
 		/// \availability	This overload is only available when the matrix is 2x2, 2x3 or 3x3 with a floating-point #scalar_type.
@@ -3487,6 +3920,18 @@ namespace muu
 		return matrix<S, R, C>::invert(m);
 	}
 
+	/// \brief	Returns the inverse of an affine transformation matrix.
+	///
+	/// \relatesalso	muu::matrix
+	///
+	/// \availability	This function is only available for 3x4 and 4x4 matrices with a floating-point scalar_type.
+	MUU_CONSTRAINED_TEMPLATE((is_floating_point<S> && R >= 3 && R <= 4 && C == 4), typename S, size_t R, size_t C)
+	MUU_PURE_INLINE_GETTER
+	constexpr matrix<S, R, C> invert_affine(const matrix<S, R, C>& m) noexcept
+	{
+		return matrix<S, R, C>::invert_affine(m);
+	}
+
 	/// \brief	Returns a copy of a matrix with the 3x3 part orthonormalized.
 	///
 	/// \relatesalso	muu::matrix
@@ -3504,6 +3949,8 @@ namespace muu
 }
 
 #undef SPECIALIZED_IF
+#undef SIMD_RETURN
+#undef BATCH_TRANSFORM_OVERLOADS
 
 MUU_RESET_NDEBUG_OPTIMIZATIONS;
 #include "impl/header_end.h"
@@ -394,6 +394,11 @@ help me improve support for your target architecture. Thanks!
 #else
 	#define MUU_ISET_SSE2 0
 #endif
+#if defined(__SSE4_1__) || (MUU_MSVC && defined(__AVX__))
+	#define MUU_ISET_SSE4_1 1
+#else
+	#define MUU_ISET_SSE4_1 0
+#endif
 #if defined(__AVX__)
 	#define MUU_ISET_AVX 1
 #else
@@ -420,6 +425,9 @@ help me improve support for your target architecture. Thanks!
 /// \def MUU_ISET_SSE2
 /// \brief `1` when the target supports the SSE2 instruction set, otherwise `0`.
 ///
+/// \def MUU_ISET_SSE4_1
+/// \brief `1` when the target supports the SSE4.1 instruction set, otherwise `0`.
+///
 /// \def MUU_ISET_AVX
 /// \brief `1` when the target supports the AVX instruction set, otherwise `0`.
 ///
@@ -13,6 +13,7 @@
 #include "impl/std_initializer_list.h"
 #include "impl/std_iosfwd.h"
 #include "impl/matrix_base.h"
+#include "impl/batch_transform.h"
 #include "impl/header_start.h"
 MUU_FORCE_NDEBUG_OPTIMIZATIONS;
 MUU_DISABLE_SHADOW_WARNINGS;
@@ -864,6 +865,12 @@ namespace muu
 			}
 		}
 
+		/// \endcond
+
+	  public:
+		/// \brief Rotates a three-dimensional vector by the rotation encoded in a quaternion.
+		///
+		/// \see operator*(const quaternion&, const vector_type&)
 		MUU_PURE_GETTER
 		static constexpr vector_type MUU_VECTORCALL rotate_vector(MUU_VPARAM(quaternion) lhs,
 																  MUU_VPARAM(vector_type) rhs) noexcept
@@ -883,9 +890,127 @@ namespace muu
 			}
 		}
 
-		/// \endcond
+		/// \brief Rotates a three-dimensional vector by the rotation encoded in this quaternion.
+		MUU_PURE_INLINE_GETTER
+		constexpr vector_type MUU_VECTORCALL rotate_vector(MUU_VPARAM(vector_type) vec) const noexcept
+		{
+			return rotate_vector(*this, vec);
+		}
+
+		/// \brief Rotates a span of three-dimensional vectors by the rotation encoded in a quaternion.
+		///
+		/// \details Equivalent to calling #rotate_vector(const quaternion&, const vector_type&) for each vector in turn,
+		///			 but the vectors are processed in structure-of-arrays blocks so the arithmetic is vectorized
+		///			 (see muu::vector_soa).
+		///
+		/// \param	rot			The rotation.
+		/// \param	vectors		The vectors to rotate.
+		/// \param	vectors_out	The output span. Must be at least as large as the input span, and may be the
+		///						same span as the input (but may not otherwise overlap it).
+		static constexpr void rotate_vector(const quaternion& rot,
+											span<const vector_type> vectors,
+											span<vector_type> vectors_out) noexcept
+		{
+			impl::batch_transform<scalar_type>(
+				vectors,
+				vectors_out,
+				[q = rot](auto& block) noexcept
+				{
+					MUU_FMA_BLOCK;
+
+					for (size_t i = 0; i < impl::batch_transform_width<scalar_type>; i++)
+					{
+						const auto x = block.x[i];
+						const auto y = block.y[i];
+						const auto z = block.z[i];
+
+						// t = 2 * cross(q.v, v)
+						const auto t_x = scalar_type{ 2 } * (q.v.y * z - q.v.z * y);
+						const auto t_y = scalar_type{ 2 } * (q.v.z * x - q.v.x * z);
+						const auto t_z = scalar_type{ 2 } * (q.v.x * y - q.v.y * x);
+
+						// v + s * t + cross(q.v, t)
+						block.x[i] = x + q.s * t_x + (q.v.y * t_z - q.v.z * t_y);
+						block.y[i] = y + q.s * t_y + (q.v.z * t_x - q.v.x * t_z);
+						block.z[i] = z + q.s * t_z + (q.v.x * t_y - q.v.y * t_x);
+					}
+				},
+				[&](const vector_type& vec) noexcept { return rotate_vector(rot, vec); });
+		}
+
+		/// \brief Rotates a span of three-dimensional vectors by the rotation encoded in a quaternion (in-place).
+		static constexpr void rotate_vector(const quaternion& rot, span<vector_type> vectors) noexcept
+		{
+			rotate_vector(rot, span<const vector_type>{ vectors }, vectors);
+		}
+
+		/// \brief Rotates a span of three-dimensional vectors by the rotation encoded in a quaternion,
+		///			splitting the work between the workers of a thread_pool.
+		///
+		/// \details Spans too small to be worth splitting are rotated on the calling thread.
+		///			 Returns once all of the vectors have been rotated.
+		///
+		/// \param	rot			The rotation.
+		/// \param	vectors		The vectors to rotate.
+		/// \param	vectors_out	The output span. Must be at least as large as the input span, and may be the
+		///						same span as the input (but may not otherwise overlap it).
+		/// \param	pool		The thread pool to use.
+		MUU_CONSTRAINED_TEMPLATE((std::is_same_v<Pool, thread_pool>), typename Pool)
+		static void rotate_vector(const quaternion& rot,
+								  span<const vector_type> vectors,
+								  span<vector_type> vectors_out,
+								  Pool& pool) noexcept
+		{
+			MUU_ASSERT(vectors_out.size() >= vectors.size() && "output span is smaller than the input span");
+
+			impl::batch_transform_parallel<scalar_type>(pool,
+														vectors.size(),
+														[&](size_t start, size_t end) noexcept
+														{
+															rotate_vector(rot,
+																		  vectors.subspan(start, end - start),
+																		  vectors_out.subspan(start, end - start));
+														});
+		}
+
+		/// \brief Rotates a span of three-dimensional vectors by the rotation encoded in a quaternion (in-place),
+		///			splitting the work between the workers of a thread_pool.
+		MUU_CONSTRAINED_TEMPLATE((std::is_same_v<Pool, thread_pool>), typename Pool)
+		static void rotate_vector(const quaternion& rot, span<vector_type> vectors, Pool& pool) noexcept
+		{
+			rotate_vector(rot, span<const vector_type>{ vectors }, vectors, pool);
+		}
+
+		/// \brief Rotates a span of three-dimensional vectors by the rotation encoded in this quaternion.
+		///
+		/// \see rotate_vector(const quaternion&, span<const vector_type>, span<vector_type>)
+		constexpr void rotate_vector(span<const vector_type> vectors, span<vector_type> vectors_out) const noexcept
+		{
+			rotate_vector(*this, vectors, vectors_out);
+		}
+
+		/// \brief Rotates a span of three-dimensional vectors by the rotation encoded in this quaternion (in-place).
+		constexpr void rotate_vector(span<vector_type> vectors) const noexcept
+		{
+			rotate_vector(*this, vectors);
+		}
+
+		/// \brief Rotates a span of three-dimensional vectors by the rotation encoded in this quaternion,
+		///			splitting the work between the workers of a thread_pool.
+		MUU_CONSTRAINED_TEMPLATE((std::is_same_v<Pool, thread_pool>), typename Pool)
+		void rotate_vector(span<const vector_type> vectors, span<vector_type> vectors_out, Pool& pool) const noexcept
+		{
+			rotate_vector(*this, vectors, vectors_out, pool);
+		}
+
+		/// \brief Rotates a span of three-dimensional vectors by the rotation encoded in this quaternion (in-place),
+		///			splitting the work between the workers of a thread_pool.
+		MUU_CONSTRAINED_TEMPLATE((std::is_same_v<Pool, thread_pool>), typename Pool)
+		void rotate_vector(span<vector_type> vectors, Pool& pool) const noexcept
+		{
+			rotate_vector(*this, vectors, pool);
+		}
 
-	  public:
 		/// \brief Multiplies two quaternions.
 		MUU_PURE_GETTER
 		friend constexpr quaternion MUU_VECTORCALL operator*(MUU_VPARAM(quaternion) lhs,
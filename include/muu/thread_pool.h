@@ -10,9 +10,17 @@
 #include "string_param.h"
 #include "iterators.h"
 #include "aligned_alloc.h"
+#include "apply_alignment.h"
 #include "launder.h"
 #include "impl/std_utility.h"
 #include "impl/std_memcpy.h"
+#include "impl/std_new.h"
+#include "impl/std_coroutine.h"
+MUU_DISABLE_WARNINGS;
+#include <atomic>
+#include <algorithm>
+#include <chrono>
+MUU_ENABLE_WARNINGS;
 #include "impl/header_start.h"
 MUU_FORCE_NDEBUG_OPTIMIZATIONS;
 MUU_PRAGMA_CLANG(diagnostic ignored "-Wignored-attributes")
@@ -23,6 +31,46 @@ namespace muu::impl
 {
 	inline constexpr size_t thread_pool_alignment = 64;
 
+	// a count of outstanding work that can be waited on until it reaches zero.
+	//
+	// the count and a 'somebody is blocked waiting' flag share one word so that the decrement reaching zero is the
+	// final access a worker makes to the counter; the waiter is free to destroy it as soon as it observes zero
+	// (the wake-up that follows only uses the address as a key). task groups keep their 'cancelled' flag in there too.
+	struct thread_pool_counter
+	{
+		static constexpr uint32_t waiting_bit	= 0x80000000u;
+		static constexpr uint32_t cancelled_bit = 0x40000000u;
+		static constexpr uint32_t count_mask	= ~(waiting_bit | cancelled_bit);
+
+		std::atomic<uint32_t> value;
+
+		MUU_ALWAYS_INLINE
+		void increment(uint32_t i = 1u) noexcept
+		{
+			value.fetch_add(i, std::memory_order_relaxed);
+		}
+
+		inline void decrement(uint32_t i = 1u) noexcept;
+
+		MUU_PURE_INLINE_GETTER
+		bool done() const noexcept
+		{
+			return !(value.load(std::memory_order_acquire) & count_mask);
+		}
+
+		MUU_ALWAYS_INLINE
+		void cancel() noexcept
+		{
+			value.fetch_or(cancelled_bit, std::memory_order_relaxed);
+		}
+
+		MUU_PURE_INLINE_GETTER
+		bool cancelled() const noexcept
+		{
+			return value.load(std::memory_order_relaxed) & cancelled_bit;
+		}
+	};
+
 	/*
 		All of the following is a combination of type-erasure, devirtualization and small function optimization,
 		tailored to allow for heap-free moving of a task across a pimpl'd ABI boundary.
@@ -115,6 +163,8 @@ namespace muu::impl
 	static_assert(MUU_OFFSETOF(thread_pool_task, buffer) == 0);
 	static_assert(std::is_standard_layout_v<thread_pool_task>);
 
+	struct thread_pool_timer;
+
 	template <typename T>
 	struct thread_pool_task_traits_pointer_to_callable
 	{
@@ -580,12 +630,208 @@ namespace muu::impl
 	};
 }
 
+namespace muu
+{
+	/// \brief	The task scheduling strategies available to a muu::thread_pool.
+	enum class thread_pool_scheduler : uint8_t
+	{
+		/// \brief	Tasks are distributed between a set of mutex-guarded FIFO queues shared by all workers.
+		shared_queues,
+
+		/// \brief	Each worker additionally owns a lock-free (Chase-Lev) deque.
+		///
+		/// \details	Tasks enqueued from one of the pool's own workers are pushed onto that worker's deque
+		/// 			without taking a lock. Workers pop from the bottom of their own deque (LIFO) and idle
+		/// 			workers steal from the top of the others (FIFO).
+		work_stealing
+	};
+
+	/// \brief	How the workers of a muu::thread_pool are placed on the system's processors.
+	///
+	/// \details	When workers are pinned they are distributed across the system's NUMA nodes in proportion to
+	/// 			the number of processors in each node, such that workers sharing a node have adjacent indices.
+	/// 			Work-stealing pools then prefer to steal from workers on the same node before crossing nodes.
+	///
+	/// \remarks	Only the processors the process is allowed to run on are considered. Pinning is currently
+	/// 			implemented on Linux (NUMA topology is read from `/sys/devices/system/node`) and Windows
+	/// 			(first processor group only); elsewhere it has no effect.
+	enum class thread_pool_affinity : uint8_t
+	{
+		/// \brief	Workers are left for the operating system to schedule wherever it likes.
+		none,
+
+		/// \brief	Each worker is pinned to a single logical processor.
+		cores,
+
+		/// \brief	Each worker is pinned to all of the logical processors of one NUMA node.
+		numa_nodes
+	};
+
+	/// \brief	How the idle workers of a muu::thread_pool wait for new work.
+	///
+	/// \details	Idle workers first spin over the pool's queues, backing off exponentially between sweeps, then park
+	/// 			until an enqueuing thread wakes them. This controls how long they spin before parking.
+	enum class thread_pool_idle_strategy : uint8_t
+	{
+		/// \brief	Spin for a short while before parking. The default.
+		balanced,
+
+		/// \brief	Spin for much longer before parking, trading CPU time (and power) for lower wake-up latency.
+		low_latency,
+
+		/// \brief	Park after a single unsuccessful sweep, trading wake-up latency for CPU time (and power).
+		low_power
+	};
+
+	/// \brief	The priority lanes of a muu::thread_pool.
+	///
+	/// \details	Workers always drain higher-priority lanes before lower-priority ones, so a latency-sensitive
+	/// 			task enqueued at thread_pool_priority::high doesn't have to wait for a large batch of
+	/// 			normal- or low-priority work ahead of it to complete.
+	enum class thread_pool_priority : uint8_t
+	{
+		/// \brief	Background work; only run when there's nothing else to do.
+		low,
+
+		/// \brief	The default.
+		normal,
+
+		/// \brief	Latency-sensitive work; run before anything else.
+		high
+	};
+
+	/// \brief	A thread_pool::for_each() partitioner that splits the range evenly into one batch per worker.
+	///
+	/// \details	This is the default, and has the lowest overhead when every element costs roughly the same.
+	struct thread_pool_static_partitioner
+	{};
+
+	/// \brief	A thread_pool::for_each() partitioner that hands out fixed-size chunks of the range on demand.
+	///
+	/// \details	Each worker repeatedly claims the next chunk of the range from a shared atomic counter until the
+	/// 			range is exhausted, so workers that get through their chunks quickly simply claim more of them.
+	/// 			Use this when the cost of each element varies a lot.
+	struct thread_pool_dynamic_partitioner
+	{
+		/// \brief	The number of elements in each chunk. Leave as `0` for 'automatic'.
+		size_t grain_size;
+	};
+
+	/// \brief	A thread_pool::for_each() partitioner that hands out shrinking chunks of the range on demand.
+	///
+	/// \details	Like thread_pool_dynamic_partitioner, except chunks start large and get smaller as the range is
+	/// 			consumed (each chunk is a fixed fraction of what's left), giving good balance at the tail of
+	/// 			the range with fewer claims than small fixed-size chunks.
+	struct thread_pool_guided_partitioner
+	{
+		/// \brief	The minimum number of elements in each chunk. Leave as `0` for `1`.
+		size_t min_grain_size;
+	};
+
+	/// \brief	Construction options for a muu::thread_pool.
+	struct thread_pool_options
+	{
+		/// \brief	The number of worker threads the pool starts with. Leave as `0` for 'automatic'.
+		///
+		/// \details	When #auto_scale is enabled this is also the fewest workers the pool will shrink to,
+		/// 			and 'automatic' means `1`.
+		size_t worker_count;
+
+		/// \brief	The most worker threads the pool may grow to with thread_pool::set_workers() or auto-scaling.
+		///
+		/// \details	Leave as `0` for the same as #worker_count (i.e. a fixed-size pool), or, when #auto_scale is
+		/// 			enabled, the system's hardware concurrency.
+		///
+		/// \remarks	Queues are allocated for this many workers up-front, but threads are only started as needed.
+		size_t max_workers;
+
+		/// \brief	Max tasks that can be stored in the internal queues without blocking. Leave as `0` for 'automatic'.
+		///
+		/// \details	Half of this is shared between the workers' queues, a quarter goes to the queue for
+		/// 			normal-priority tasks enqueued from outside the pool, and an eighth each to the queues for
+		/// 			high- and low-priority tasks.
+		size_t task_queue_size;
+
+		/// \brief	The task scheduling strategy used by the pool.
+		thread_pool_scheduler scheduler;
+
+		/// \brief	Where the pool's workers are allowed to run.
+		thread_pool_affinity affinity;
+
+		/// \brief	How the pool's idle workers wait for new work.
+		thread_pool_idle_strategy idle_strategy;
+
+		/// \brief	Automatically resize the pool between #worker_count and #max_workers according to load.
+		///
+		/// \details	A worker is added whenever tasks are left waiting in the queues while none of the existing
+		/// 			workers are idle, and the highest-numbered worker is retired once it has been idle for
+		/// 			#idle_timeout_ms. Queued tasks are never affected by a resize.
+		bool auto_scale;
+
+		/// \brief	How long (in milliseconds) a worker must be idle before auto-scaling retires it.
+		/// 		Leave as `0` for 'automatic' (one second).
+		uint32_t idle_timeout_ms;
+
+		/// \brief	Collect statistics about the pool's behaviour (see thread_pool::stats()).
+		///
+		/// \details	When disabled (the default) the cost of the instrumentation is a predictable branch at each
+		/// 			point where a statistic would be recorded.
+		bool collect_stats;
+	};
+
+	/// \brief	Statistics collected by one of the workers of a muu::thread_pool.
+	///
+	/// \see muu::thread_pool_options::collect_stats
+	struct thread_pool_worker_stats
+	{
+		/// \brief	The number of tasks executed by the worker (including those run while helping in a wait()).
+		uint64_t tasks_executed;
+
+		/// \brief	The number of times the worker tried to steal a task from another worker (work-stealing only).
+		uint64_t steal_attempts;
+
+		/// \brief	The number of times the worker successfully stole a task from another worker.
+		uint64_t steals;
+
+		/// \brief	The number of times the worker looked everywhere it could find a task and came up empty.
+		uint64_t failed_pops;
+
+		/// \brief	The number of times the worker went to sleep waiting for work.
+		uint64_t sleeps;
+
+		/// \brief	Nanoseconds the worker has spent executing tasks.
+		uint64_t busy_nanoseconds;
+
+		/// \brief	Nanoseconds the worker has spent looking for work or sleeping.
+		uint64_t idle_nanoseconds;
+	};
+
+	/// \brief	Statistics collected by a muu::thread_pool.
+	///
+	/// \see muu::thread_pool_options::collect_stats
+	struct thread_pool_stats
+	{
+		/// \brief	The totals of the statistics collected by each worker.
+		thread_pool_worker_stats workers;
+
+		/// \brief	The number of times a thread enqueuing work had to spin because every queue it tried was full
+		/// 			(or locked by someone else).
+		uint64_t enqueue_spins;
+
+		/// \brief	The number of times a thread enqueuing work had to yield waiting for room in a queue.
+		uint64_t enqueue_sleeps;
+
+		/// \brief	The most tasks the pool has had pending (enqueued or running) at once.
+		size_t queue_high_water_mark;
+	};
+}
+
 extern "C" //
 {
 	MUU_NODISCARD
 	MUU_API
 	MUU_ATTR(returns_nonnull)
-	void* MUU_CALLCONV muu_impl_thread_pool_create(size_t, size_t, muu::string_param*, void*);
+	void* MUU_CALLCONV muu_impl_thread_pool_create(size_t, size_t, muu::string_param*, const muu::thread_pool_options*);
 
 	MUU_API
 	MUU_ATTR(nonnull)
@@ -594,12 +840,12 @@ extern "C" //
 	MUU_NODISCARD
 	MUU_API
 	MUU_ATTR(nonnull)
-	size_t MUU_CALLCONV muu_impl_thread_pool_lock_multiple(void*, size_t) noexcept;
+	size_t MUU_CALLCONV muu_impl_thread_pool_lock_multiple(void*, size_t, muu::thread_pool_priority) noexcept;
 
 	MUU_NODISCARD
 	MUU_API
 	MUU_ATTR(nonnull)
-	size_t MUU_CALLCONV muu_impl_thread_pool_lock(void*) noexcept;
+	size_t MUU_CALLCONV muu_impl_thread_pool_lock(void*, muu::thread_pool_priority) noexcept;
 
 	MUU_NODISCARD
 	MUU_API
@@ -620,634 +866,4380 @@ extern "C" //
 	MUU_API
 	size_t MUU_CALLCONV muu_impl_thread_pool_workers(void*) noexcept;
 
+	MUU_PURE_GETTER
+	MUU_API
+	size_t MUU_CALLCONV muu_impl_thread_pool_max_workers(void*) noexcept;
+
+	MUU_API
+	MUU_ATTR(nonnull)
+	size_t MUU_CALLCONV muu_impl_thread_pool_set_workers(void*, size_t) noexcept;
+
 	MUU_PURE_GETTER
 	MUU_API
 	size_t MUU_CALLCONV muu_impl_thread_pool_capacity(void*) noexcept;
+
+	MUU_PURE_GETTER
+	MUU_API
+	size_t MUU_CALLCONV muu_impl_thread_pool_max_batch(void*) noexcept;
+
+	MUU_API
+	MUU_ATTR(nonnull)
+	void MUU_CALLCONV muu_impl_thread_pool_stats(void*, muu::thread_pool_stats*) noexcept;
+
+	MUU_API
+	MUU_ATTR(nonnull)
+	void MUU_CALLCONV muu_impl_thread_pool_worker_stats(void*, size_t, muu::thread_pool_worker_stats*) noexcept;
+
+	MUU_API
+	MUU_ATTR(nonnull)
+	void MUU_CALLCONV muu_impl_thread_pool_reset_stats(void*) noexcept;
+
+	MUU_NODISCARD
+	MUU_API
+	MUU_ATTR(nonnull)
+	MUU_ATTR(returns_nonnull)
+	MUU_ATTR(assume_aligned(muu::impl::thread_pool_alignment))
+	void* MUU_CALLCONV muu_impl_thread_pool_allocate(void*, size_t) noexcept;
+
+	MUU_API
+	MUU_ATTR(nonnull)
+	void MUU_CALLCONV muu_impl_thread_pool_deallocate(void*, void*, size_t) noexcept;
+
+	MUU_API
+	MUU_ATTR(nonnull)
+	void MUU_CALLCONV muu_impl_thread_pool_schedule(void*, muu::impl::thread_pool_timer*, uint64_t, uint64_t) noexcept;
+
+	MUU_API
+	MUU_ATTR(nonnull)
+	void MUU_CALLCONV muu_impl_thread_pool_wait_for(void*, muu::impl::thread_pool_counter*) noexcept;
+
+	MUU_API
+	MUU_ATTR(nonnull)
+	void MUU_CALLCONV muu_impl_thread_pool_counter_wake(muu::impl::thread_pool_counter*) noexcept;
 }
-/// \endcond
 
-namespace muu
+namespace muu::impl
 {
-	/// \brief A thread pool.
-	class thread_pool
+	MUU_ALWAYS_INLINE
+	void thread_pool_counter::decrement(uint32_t i) noexcept
+	{
+		if ((value.fetch_sub(i, std::memory_order_acq_rel) & ~cancelled_bit) == (i | waiting_bit))
+			::muu_impl_thread_pool_counter_wake(this);
+	}
+
+	// holds a task's callable inside some other wrapping task (e.g. thread_pool_result_task)
+	template <typename Task, size_t StoragePenalty, bool = is_trivially_manifestable<remove_cvref<Task>>>
+	class thread_pool_callable_holder
 	{
+	  public:
+		using traits		= thread_pool_task_traits<Task, StoragePenalty>;
+		using storage_type	= typename traits::storage_type;
+		using callable_type = typename traits::callable_type;
+
 	  private:
-		void* storage_ = nullptr;
+		storage_type callable_;
 
-		template <typename T>
-		MUU_ALWAYS_INLINE
-		void enqueue(size_t queue_index, T&& task) noexcept
+	  public:
+		template <typename U>
+		MUU_NODISCARD_CTOR
+		explicit thread_pool_callable_holder(U&& callable) noexcept //
+			: callable_{ traits::select(static_cast<U&&>(callable)) }
+		{}
+
+		MUU_PURE_INLINE_GETTER
+		callable_type& get() noexcept
 		{
-			::new (
-				muu::assume_aligned<impl::thread_pool_alignment>(::muu_impl_thread_pool_acquire(storage_, queue_index)))
-				impl::thread_pool_task{ static_cast<T&&>(task) };
+			if constexpr (std::is_pointer_v<storage_type>)
+				return *callable_;
+			else
+				return callable_;
 		}
+	};
 
-		template <typename Task, bool = is_trivially_manifestable<Task>>
-		class batched_task
+	template <typename Task, size_t StoragePenalty>
+	class thread_pool_callable_holder<Task, StoragePenalty, true>
+	{
+	  public:
+		using callable_type = remove_cvref<Task>;
+
+		template <typename U>
+		MUU_NODISCARD_CTOR
+		explicit thread_pool_callable_holder(U&&) noexcept
+		{}
+
+		MUU_PURE_INLINE_GETTER
+		callable_type get() const noexcept
 		{
-		  public:
-			using traits		= impl::thread_pool_task_traits<Task, sizeof(void*) * 3>;
-			using storage_type	= typename traits::storage_type;
-			using callable_type = typename traits::callable_type;
+			return callable_type{};
+		}
+	};
 
-		  private:
-			storage_type task_;
+	template <typename Callable>
+	inline constexpr bool thread_pool_task_takes_index = std::is_nothrow_invocable_v<Callable&, size_t>;
 
-		  public:
-			template <typename Arg>
-			MUU_ALWAYS_INLINE
-			void operator()(Arg&& arg, size_t batch_index) noexcept
-			{
-				traits::invoke(task_, batch_index, static_cast<Arg&&>(arg));
-			}
+	template <typename Callable>
+	using thread_pool_task_result = std::conditional_t<thread_pool_task_takes_index<Callable>,
+													   std::invoke_result<Callable&, size_t>,
+													   std::invoke_result<Callable&>>;
 
-			template <typename Arg>
-			MUU_ALWAYS_INLINE
-			void operator()(Arg&& arg) noexcept
-			{
-				traits::invoke(task_, {}, static_cast<Arg&&>(arg));
-			}
+	// shared state between a thread_pool_future and the task producing its result
+	template <typename T>
+	struct alignas(thread_pool_alignment) thread_pool_future_state
+	{
+		static_assert(alignof(T) <= thread_pool_alignment,
+					  "Task results must not be over-aligned beyond muu::impl::thread_pool_alignment");
 
-			template <typename U>
-			MUU_NODISCARD_CTOR
-			batched_task(U&& task) noexcept //
-				: task_{ traits::select(static_cast<U&&>(task)) }
-			{}
-		};
+		thread_pool_counter pending{ { 1u } };
+		std::atomic<uint32_t> refs{ 2u }; // the future + the task
+		void* pool;
+		alignas(T) unsigned char value[sizeof(T)];
 
-		template <typename Task>
-		class batched_task<Task, true>
+		MUU_NODISCARD_CTOR
+		explicit thread_pool_future_state(void* pool_) noexcept //
+			: pool{ pool_ }
+		{}
+
+		MUU_PURE_INLINE_GETTER
+		T& get() noexcept
 		{
-		  public:
-			using traits = impl::thread_pool_task_traits<Task>;
+			return *MUU_LAUNDER(reinterpret_cast<T*>(value));
+		}
 
-			template <typename Arg>
-			MUU_ALWAYS_INLINE
-			void operator()(Arg&& arg, size_t batch_index) noexcept
-			{
-				traits::invoke(batch_index, static_cast<Arg&&>(arg));
-			}
+		template <typename... Args>
+		void set(Args&&... args) noexcept
+		{
+			::new (static_cast<void*>(value)) T(static_cast<Args&&>(args)...);
+			pending.decrement();
+		}
 
-			template <typename Arg>
-			MUU_ALWAYS_INLINE
-			void operator()(Arg&& arg) noexcept
+		void release() noexcept
+		{
+			if (refs.fetch_sub(1u, std::memory_order_acq_rel) != 1u)
+				return;
+
+			if constexpr (!std::is_trivially_destructible_v<T>)
 			{
-				traits::invoke({}, static_cast<Arg&&>(arg));
+				if (pending.done())
+					get().~T();
 			}
-		};
+			auto p = pool;
+			this->~thread_pool_future_state();
+			::muu_impl_thread_pool_deallocate(p, this, sizeof(thread_pool_future_state));
+		}
+	};
 
-		template <typename OriginalTask, typename Task>
-		MUU_NODISCARD
-		MUU_ALWAYS_INLINE
-		static auto wrap_batched_task(Task&& task) noexcept
+	template <>
+	struct alignas(thread_pool_alignment) thread_pool_future_state<void>
+	{
+		thread_pool_counter pending{ { 1u } };
+		std::atomic<uint32_t> refs{ 2u };
+		void* pool;
+
+		MUU_NODISCARD_CTOR
+		explicit thread_pool_future_state(void* pool_) noexcept //
+			: pool{ pool_ }
+		{}
+
+		void set() noexcept
 		{
-			static_assert(std::is_reference_v<OriginalTask>);
-			static_assert(std::is_same_v<std::remove_reference_t<OriginalTask>, std::remove_reference_t<Task>>);
+			pending.decrement();
+		}
 
-			if constexpr (is_trivially_manifestable<remove_cvref<Task>>)
-			{
-				return batched_task<remove_cvref<Task>>{};
-			}
-			else
-			{
-				if constexpr (std::is_lvalue_reference_v<OriginalTask>)
-				{
-					static_assert(std::is_same_v<OriginalTask, Task&&>);
-					return batched_task<OriginalTask>{ task };
-				}
-				else
-				{
-					if constexpr (std::is_rvalue_reference_v<Task&&>)
-						return batched_task<Task&&>{ static_cast<Task&&>(task) };
-					else
-						return batched_task<remove_cvref<Task>&&>{ remove_cvref<Task>{ task } };
-				}
-			}
+		void release() noexcept
+		{
+			if (refs.fetch_sub(1u, std::memory_order_acq_rel) != 1u)
+				return;
+
+			auto p = pool;
+			this->~thread_pool_future_state();
+			::muu_impl_thread_pool_deallocate(p, this, sizeof(thread_pool_future_state));
 		}
+	};
+
+	// wraps a task so its result is delivered to a thread_pool_future_state
+	template <typename Task, typename Result>
+	class thread_pool_result_task
+	{
+	  private:
+		using state_type = thread_pool_future_state<Result>;
+
+		state_type* state_;
+		thread_pool_callable_holder<Task, sizeof(void*) * 2> task_;
 
 	  public:
-		/// \brief	Constructs a thread pool.
-		///
-		/// \param	worker_count		The number of worker threads in the pool. Leave as `0` for 'automatic'.
-		/// \param	task_queue_size		Max tasks that can be stored in the internal queue without blocking. Leave as `0` for 'automatic'.
-		/// \param	name 				The name of your threadpool (for debugging purposes).
+		template <typename U>
 		MUU_NODISCARD_CTOR
-		explicit thread_pool(size_t worker_count = 0, size_t task_queue_size = 0, string_param name = {}) //
-			: storage_{ ::muu_impl_thread_pool_create(worker_count, task_queue_size, &name, nullptr) }
+		thread_pool_result_task(state_type* state, U&& task) noexcept //
+			: state_{ state },
+			  task_{ static_cast<U&&>(task) }
 		{}
 
-		/// \brief	Constructs a thread pool.
-		///
-		/// \param	name 		The name of your thread pool (for debugging purposes).
 		MUU_NODISCARD_CTOR
-		explicit thread_pool(string_param name) //
-			: thread_pool{ 0, 0, static_cast<string_param&&>(name) }
+		thread_pool_result_task(thread_pool_result_task&& other) noexcept //
+			: state_{ std::exchange(other.state_, nullptr) },
+			  task_{ static_cast<decltype(task_)&&>(other.task_) }
 		{}
 
-		/// \brief	Move constructor.
-		MUU_NODISCARD_CTOR
-		thread_pool(thread_pool&& other) noexcept //
-			: storage_{ std::exchange(other.storage_, nullptr) }
-		{}
+		thread_pool_result_task& operator=(thread_pool_result_task&&) = delete;
+		thread_pool_result_task(const thread_pool_result_task&)		  = delete;
+		thread_pool_result_task& operator=(const thread_pool_result_task&) = delete;
 
-		/// \brief	Move-assignment operator.
-		thread_pool& operator=(thread_pool&& rhs) noexcept
+		~thread_pool_result_task() noexcept
 		{
-			storage_ = std::exchange(rhs.storage_, nullptr);
-			return *this;
+			// never invoked (e.g. the pool was destroyed first)
+			if (state_)
+				state_->release();
 		}
 
-		/// \brief	Destructor.
-		/// \warning Any enqueued tasks *currently being executed* are allowed to finish;
-		/// 		 attempting to destroy a thread_pool with an enqueued task of indeterminate
-		/// 		 length may lead to a deadlock.
-		~thread_pool() noexcept
+		void operator()(size_t worker_index) noexcept
 		{
-			if (auto storage = std::exchange(storage_, nullptr))
-				::muu_impl_thread_pool_destroy(storage);
-		}
+			MUU_ASSUME(state_ != nullptr);
 
-		MUU_DELETE_COPY(thread_pool);
+			using callable_type = remove_cvref<decltype(task_.get())>;
 
-		/// \brief	The number of worker threads in the thread pool.
-		MUU_PURE_INLINE_GETTER
-		size_t workers() const noexcept
-		{
-			return ::muu_impl_thread_pool_workers(storage_);
+			if constexpr (std::is_void_v<Result>)
+			{
+				if constexpr (thread_pool_task_takes_index<callable_type>)
+					task_.get()(worker_index);
+				else
+					task_.get()();
+				state_->set();
+			}
+			else
+			{
+				if constexpr (thread_pool_task_takes_index<callable_type>)
+					state_->set(task_.get()(worker_index));
+				else
+					state_->set(task_.get()());
+			}
+
+			std::exchange(state_, nullptr)->release();
 		}
+	};
 
-		/// \brief	The maximum tasks that may be enqueued without blocking.
-		MUU_PURE_INLINE_GETTER
-		size_t capacity() const noexcept
+	// wraps a task so its completion is counted by a task_group
+	template <typename Task>
+	class thread_pool_group_task
+	{
+	  private:
+		thread_pool_counter* group_;
+		thread_pool_callable_holder<Task, sizeof(void*)> task_;
+
+	  public:
+		template <typename U>
+		MUU_NODISCARD_CTOR
+		thread_pool_group_task(thread_pool_counter* group, U&& task) noexcept //
+			: group_{ group },
+			  task_{ static_cast<U&&>(task) }
+		{}
+
+		MUU_NODISCARD_CTOR
+		thread_pool_group_task(thread_pool_group_task&& other) noexcept //
+			: group_{ std::exchange(other.group_, nullptr) },
+			  task_{ static_cast<decltype(task_)&&>(other.task_) }
+		{}
+
+		thread_pool_group_task& operator=(thread_pool_group_task&&) = delete;
+		thread_pool_group_task(const thread_pool_group_task&)		= delete;
+		thread_pool_group_task& operator=(const thread_pool_group_task&) = delete;
+
+		~thread_pool_group_task() noexcept
 		{
-			return ::muu_impl_thread_pool_capacity(storage_);
+			// never invoked (e.g. the pool was destroyed first)
+			if (group_)
+				group_->decrement();
 		}
 
-		/// \brief	Waits for the thread pool to finish all of its current work.
-		///
-		/// \warning Do not call this from one of the thread pool's workers.
-		MUU_ALWAYS_INLINE
-		void wait() noexcept
+		void operator()(size_t worker_index) noexcept
 		{
-			::muu_impl_thread_pool_wait(storage_);
+			MUU_ASSUME(group_ != nullptr);
+
+			// tasks from a cancelled group are dropped as soon as they're popped, without being run
+			if (!group_->cancelled())
+			{
+				if constexpr (thread_pool_task_takes_index<remove_cvref<decltype(task_.get())>>)
+					task_.get()(worker_index);
+				else
+					task_.get()();
+			}
+
+			std::exchange(group_, nullptr)->decrement();
 		}
+	};
+
+	// wraps a timed task so a periodic one can stop itself from repeating by returning false
+	template <typename Task>
+	class thread_pool_timer_task
+	{
+	  private:
+		thread_pool_timer* timer_;
+		thread_pool_callable_holder<remove_cvref<Task>&&, sizeof(void*)> task_; // always held by value
+
+	  public:
+		template <typename U>
+		MUU_NODISCARD_CTOR
+		thread_pool_timer_task(thread_pool_timer* timer, U&& task) noexcept //
+			: timer_{ timer },
+			  task_{ static_cast<U&&>(task) }
+		{}
+
+		inline void operator()(size_t worker_index) noexcept;
+	};
+
+	// a task waiting in a thread_pool's timing wheel (see thread_pool::enqueue_after() and enqueue_every())
+	struct alignas(thread_pool_alignment) thread_pool_timer
+	{
+		thread_pool_task task;
+		thread_pool_timer* next = nullptr;
+		uint64_t due			= {}; // in timing wheel ticks
+		uint64_t period			= {}; // in timing wheel ticks; zero for one-shot timers (and stopped periodic ones)
 
-		/// \brief	Enqueues a task.
-		///
-		/// \details Tasks must be callables with no parameters, or one parameter to recieve
-		/// 		 the index of the worker invoking the task:
-		/// \cpp
-		/// pool.enqueue([](size_t worker_index) noexcept
-		/// {
-		///		// worker_index is in the range [0, pool.workers() - 1]
-		///	});
-		/// pool.enqueue([]() noexcept
-		/// {
-		///		//...
-		///	});
-		/// \ecpp
-		///
-		/// \remarks Tasks must be finite, otherwise the pool will fill and wait() calls will never return.
-		/// \remarks Tasks must not throw exceptions.
-		///
-		/// \warning Do not call this from one of the thread_pool's workers.
-		///
-		/// \tparam	Task	The type of the task being enqueued.
-		/// \param	task  	The task to enqueue.
-		///
-		/// \returns	A reference to the thread pool.
 		template <typename Task>
-		thread_pool& enqueue(Task&& task) noexcept
+		MUU_NODISCARD_CTOR
+		explicit thread_pool_timer(Task&& task_) noexcept //
+			: task{ thread_pool_timer_task<Task&&>{ this, static_cast<Task&&>(task_) } }
+		{}
+	};
+
+	template <typename Task>
+	inline void thread_pool_timer_task<Task>::operator()(size_t worker_index) noexcept
+	{
+		using callable_type = remove_cvref<decltype(task_.get())>;
+		using result_type	= typename thread_pool_task_result<callable_type>::type;
+
+		if constexpr (std::is_void_v<result_type>)
 		{
-			static_assert(
-				std::is_nothrow_invocable_v<Task&, size_t> //
-					|| std::is_nothrow_invocable_v<Task&>,
-				"Tasks passed to thread_pool::enqueue() must be callable as void() noexcept or void(size_t) noexcept");
+			if constexpr (thread_pool_task_takes_index<callable_type>)
+				task_.get()(worker_index);
+			else
+				task_.get()();
+		}
+		else
+		{
+			bool repeat;
+			if constexpr (thread_pool_task_takes_index<callable_type>)
+				repeat = static_cast<bool>(task_.get()(worker_index));
+			else
+				repeat = static_cast<bool>(task_.get()());
+			if (!repeat)
+				timer_->period = {};
+		}
+	}
 
-			const auto qindex = ::muu_impl_thread_pool_lock(storage_);
-			enqueue(qindex, static_cast<Task&&>(task));
-			::muu_impl_thread_pool_unlock(storage_, qindex);
-			return *this;
+	template <typename T>
+	inline constexpr bool is_accumulator = false;
+
+	template <typename ValueType, typename Impl>
+	inline constexpr bool is_accumulator<accumulator<ValueType, Impl>> = true;
+
+	struct thread_pool_identity_transform
+	{
+		template <typename T>
+		MUU_CONST_INLINE_GETTER
+		constexpr T&& operator()(T&& val) const noexcept
+		{
+			return static_cast<T&&>(val);
 		}
+	};
 
-	  private:
-		static constexpr size_t no_available_queue = static_cast<size_t>(-1);
+	// shared state of a thread_pool::reduce() / transform_reduce() call (lives on the calling thread's stack)
+	template <typename T, typename Iter, typename Reduce, typename Transform>
+	struct thread_pool_reduce_job
+	{
+		static_assert(alignof(T) <= thread_pool_alignment,
+					  "Reduction results must not be over-aligned beyond muu::impl::thread_pool_alignment");
 
-		template <typename OriginalTask, typename ValueType, size_t Arity, typename T, typename Task>
-		void enqueue_for_each_batch(size_t shared_queue_index,
-									T batch_start,
-									T batch_end,
-									[[maybe_unused]] size_t batch_index,
-									Task&& task) noexcept
+		// each batch's partial result gets its own cache line(s) so workers don't false-share
+		struct alignas(thread_pool_alignment) batch
 		{
-			static_assert(std::is_reference_v<OriginalTask>);
-			static_assert(std::is_same_v<std::remove_reference_t<OriginalTask>, std::remove_reference_t<Task>>);
-			static_assert(Arity <= 2);
+			Iter begin;
+			size_t count;
+			alignas(T) unsigned char result[sizeof(T)];
 
-			MUU_ASSERT(batch_start < batch_end);
-			MUU_ASSERT(batch_index < workers());
+			MUU_PURE_INLINE_GETTER
+			T& get() noexcept
+			{
+				return *MUU_LAUNDER(reinterpret_cast<T*>(result));
+			}
+		};
 
-			const auto queue_index = shared_queue_index == no_available_queue //
-									   ? ::muu_impl_thread_pool_lock(storage_)
-									   : shared_queue_index;
+		batch* batches;
+		Reduce& reduce;
+		Transform& transform;
 
-			enqueue(queue_index,
-					[=, batch = wrap_batched_task<OriginalTask>(static_cast<Task&&>(task))]() mutable noexcept
-					{
-						for (; batch_start < batch_end; batch_start++)
-						{
-							if constexpr (Arity == 2)
-								batch(static_cast<ValueType>(batch_start), batch_index);
-							else
-								batch(static_cast<ValueType>(batch_start));
-						}
-					});
+		void operator()(size_t batch_index) noexcept
+		{
+			auto& b = batches[batch_index];
+			MUU_ASSUME(b.count > 0u);
 
-			if (shared_queue_index == no_available_queue)
-				::muu_impl_thread_pool_unlock(storage_, queue_index);
+			auto it = b.begin;
+			if constexpr (is_accumulator<T>)
+			{
+				auto& acc = *::new (static_cast<void*>(b.result)) T{};
+				for (size_t i = 0; i < b.count; i++, ++it)
+					acc(transform(*it));
+			}
+			else
+			{
+				T val = static_cast<T>(transform(*it));
+				++it;
+				for (size_t i = 1; i < b.count; i++, ++it)
+					val = reduce(static_cast<T&&>(val), transform(*it));
+				::new (static_cast<void*>(b.result)) T{ static_cast<T&&>(val) };
+			}
 		}
+	};
 
-	  public:
-		/// \brief	Enqueues a task to execute once for every value in a range.
-		///
-		/// \details	Tasks must be callables which accept at most two arguments: <br>
-		/// 			Argument 0: The current value from the range <br>
-		/// 			Argument 1: The task's batch (in the range `[0, pool.workers() - 1]`) <br>
-		/// \cpp
-		/// pool.for_each(0, 10, [](int i, size_t batch_index) noexcept
-		/// {
-		///		// i is in the range [0, 9]
-		///		// batch_index is in the range [0, pool.workers() - 1]
-		///	});
-		/// pool.for_each(0, 10, [](int i) noexcept
-		/// {
-		///		// i is in the range [0, 9]
-		///	});
-		/// pool.for_each(0, 10, []() noexcept
-		/// {
-		///		// no args is OK too
-		///	});
-		/// \ecpp
-		///
-		/// \remarks Tasks must be finite, otherwise the pool will fill and Wait() calls will never return.
-		/// \remarks Tasks must not throw exceptions.
-		///
-		/// \warning Do not call this from one of the thread_pool's workers.
-		///
-		/// \tparam	T 			An integer or enum type.
-		/// \tparam	Task		The type of the task being enqueued.
-		/// \param	start		The start of the value range (inclusive).
-		/// \param	end			The end of the value range (exclusive).
-		/// \param	task		The task to enqueue.
-		///
-		/// \return	A reference to the threadpool.
-		MUU_CONSTRAINED_TEMPLATE(muu::is_integral<T>, typename T, typename Task)
-		thread_pool& for_each(T start, T end, Task&& task) noexcept
+	struct thread_pool_plus
+	{
+		template <typename T, typename U>
+		MUU_PURE_INLINE_GETTER
+		constexpr decltype(auto) operator()(T&& lhs, U&& rhs) const
+			noexcept(noexcept(static_cast<T&&>(lhs) + static_cast<U&&>(rhs)))
 		{
-			static_assert(std::is_nothrow_invocable_v<Task&, T, size_t> //
-							  || std::is_nothrow_invocable_v<Task&, T>	//
-							  || std::is_nothrow_invocable_v<Task&>,
-						  "Tasks passed to thread_pool::for_each() must be callable as void() noexcept, void(T) "
-						  "noexcept or void(T, size_t) noexcept");
+			return static_cast<T&&>(lhs) + static_cast<U&&>(rhs);
+		}
+	};
 
-			if (start == end)
-				return *this;
+	// shared state of a thread_pool::inclusive_scan() / exclusive_scan() call (lives on the calling thread's stack)
+	// pass 1: every batch but the last reduces its elements to a partial sum
+	// (serial): the partial sums are scanned to give each batch its carry-in
+	// pass 2: every batch scans its elements into the output, starting from its carry-in
+	template <typename T, typename Iter, typename OutIter, typename Op, bool Exclusive>
+	struct thread_pool_scan_job
+	{
+		static_assert(alignof(T) <= thread_pool_alignment,
+					  "Scan results must not be over-aligned beyond muu::impl::thread_pool_alignment");
 
-			using value_type  = remove_cvref<T>;
-			using offset_type = largest<remove_enum<value_type>,
-										std::conditional_t<is_signed<remove_enum<value_type>>, signed, unsigned>>;
-			using size_type	  = largest<make_unsigned<offset_type>, size_t>;
+		using value_type = remove_cvref<iter_reference_t<Iter>>;
 
-			// reverse the start and end if they're backwards (this is a parallel for; order should be irrelevant)
-			if (start > end)
+		struct alignas(thread_pool_alignment) batch
+		{
+			Iter begin;
+			OutIter out;
+			size_t count;
+			alignas(T) unsigned char sum[sizeof(T)];
+			alignas(T) unsigned char carry[sizeof(T)];
+
+			MUU_PURE_INLINE_GETTER
+			T& get_sum() noexcept
 			{
-				T temp = end;
-				end	   = T{ static_cast<remove_enum<T>>(start) + remove_enum<T>{ 1 } };
-				start  = T{ static_cast<remove_enum<T>>(temp) + remove_enum<T>{ 1 } };
+				return *MUU_LAUNDER(reinterpret_cast<T*>(sum));
 			}
 
-			// determine batch count and distribute indices
-			const auto job_count =
-				static_cast<size_type>(static_cast<offset_type>(end) - static_cast<offset_type>(start));
-			MUU_ASSERT(job_count);
-			const auto worker_count		 = this->workers();
-			auto batch_generator		 = impl::batch_size_generator<size_type>{ job_count, worker_count };
-			offset_type next_batch_start = unwrap(start);
-			size_type next_batch_size	 = batch_generator();
-			size_t batch_index			 = 0u;
-			auto batch_count			 = muu::min(job_count, worker_count);
+			MUU_PURE_INLINE_GETTER
+			T& get_carry() noexcept
+			{
+				return *MUU_LAUNDER(reinterpret_cast<T*>(carry));
+			}
+		};
 
-			// try to get a shared queue for all the allocations
-			const auto shared_queue_index = ::muu_impl_thread_pool_lock_multiple(storage_, batch_count);
+		batch* batches;
+		Op& op;
+		bool first_has_carry; // false for an inclusive scan without an initial value
 
-			// dispatch tasks
-			static constexpr size_t task_arity =
-				(std::is_nothrow_invocable_v<Task&, T, size_t> ? 2 : (std::is_nothrow_invocable_v<Task&, T> ? 1 : 0));
-			while (true)
-			{
-				const auto batch_start = next_batch_start;
-				next_batch_start	   = static_cast<offset_type>(batch_start + next_batch_size);
-				next_batch_size		   = batch_generator();
+		void reduce_batch(size_t batch_index) noexcept
+		{
+			auto& b = batches[batch_index];
+			MUU_ASSUME(b.count > 0u);
+
+			auto it = b.begin;
+			T val	= static_cast<T>(*it);
+			++it;
+			for (size_t i = 1; i < b.count; i++, ++it)
+				val = op(static_cast<T&&>(val), *it);
+			::new (static_cast<void*>(b.sum)) T{ static_cast<T&&>(val) };
+		}
 
-				if (next_batch_size)
-					enqueue_for_each_batch<Task&&, value_type, task_arity>(shared_queue_index,
-																		   batch_start,
-																		   next_batch_start,
-																		   batch_index,
-																		   task);
-				else
+		void scan_batch(size_t batch_index) noexcept
+		{
+			auto& b = batches[batch_index];
+			MUU_ASSUME(b.count > 0u);
+
+			auto it	 = b.begin;
+			auto out = b.out;
+			if constexpr (Exclusive)
+			{
+				T acc = static_cast<T&&>(b.get_carry());
+				for (size_t i = 0; i < b.count; i++, ++it, ++out)
 				{
-					enqueue_for_each_batch<Task&&, value_type, task_arity>(shared_queue_index,
-																		   batch_start,
-																		   next_batch_start,
-																		   batch_index,
-																		   static_cast<Task&&>(task));
-					break;
+					value_type val = *it; // the output may alias the input
+					*out		   = acc;
+					acc			   = op(static_cast<T&&>(acc), static_cast<value_type&&>(val));
 				}
-				batch_index++;
 			}
+			else
+			{
+				T acc = batch_index || first_has_carry ? op(static_cast<T&&>(b.get_carry()), *it) : static_cast<T>(*it);
+				*out  = acc;
+				++it;
+				++out;
+				for (size_t i = 1; i < b.count; i++, ++it, ++out)
+				{
+					acc	 = op(static_cast<T&&>(acc), *it);
+					*out = acc;
+				}
+			}
+		}
 
-			// unlock shared queue
-			if (shared_queue_index != no_available_queue)
-				::muu_impl_thread_pool_unlock(storage_, shared_queue_index);
-
-			return *this;
+		// turns the partial sums of batches [0, batch_count - 1) into the carry-ins of batches [1, batch_count)
+		void compute_carries(size_t batch_count) noexcept
+		{
+			for (size_t i = 1; i < batch_count; i++)
+			{
+				auto& prev = batches[i - 1u];
+				auto& sum  = prev.get_sum();
+				if (i > 1u || first_has_carry)
+					::new (static_cast<void*>(batches[i].carry)) T{ op(prev.get_carry(), static_cast<T&&>(sum)) };
+				else
+					::new (static_cast<void*>(batches[i].carry)) T{ static_cast<T&&>(sum) };
+				sum.~T();
+			}
 		}
+	};
 
-		/// \brief	Enqueues a task to execute once for every value in a range.
-		///
+	struct alignas(thread_pool_alignment) task_graph_node
+	{
+		thread_pool_task task;
+		std::atomic<uint32_t> pending; // predecessors yet to finish during the current run
+		uint32_t predecessors;
+		uint32_t first_successor; // index into the graph's successor list
+		uint32_t successors;
+
+		template <typename T>
+		MUU_NODISCARD_CTOR
+		explicit task_graph_node(T&& task_) noexcept //
+			: task{ static_cast<T&&>(task_) },
+			  pending{ 0u },
+			  predecessors{ 0u },
+			  first_successor{ 0u },
+			  successors{ 0u }
+		{}
+
+		MUU_NODISCARD_CTOR
+		task_graph_node(task_graph_node&& other) noexcept //
+			: task{ static_cast<thread_pool_task&&>(other.task) },
+			  pending{ 0u },
+			  predecessors{ other.predecessors },
+			  first_successor{ other.first_successor },
+			  successors{ other.successors }
+		{}
+
+		MUU_DELETE_COPY(task_graph_node);
+	};
+
+	struct task_graph_edge
+	{
+		uint32_t from;
+		uint32_t to;
+	};
+
+	template <typename T>
+	inline constexpr bool is_thread_pool_partitioner = std::is_same_v<T, thread_pool_static_partitioner>
+													|| std::is_same_v<T, thread_pool_dynamic_partitioner>
+													|| std::is_same_v<T, thread_pool_guided_partitioner>;
+
+	template <typename ValueType, typename OffsetType>
+	struct thread_pool_integral_source
+	{
+		OffsetType start;
+
+		MUU_PURE_INLINE_GETTER
+		constexpr ValueType operator()(size_t i) const noexcept
+		{
+			return static_cast<ValueType>(static_cast<OffsetType>(start + static_cast<OffsetType>(i)));
+		}
+	};
+
+	template <typename Iter>
+	struct thread_pool_iterator_source
+	{
+		Iter begin;
+
+		MUU_PURE_INLINE_GETTER
+		constexpr decltype(auto) operator()(size_t i) const noexcept
+		{
+			return begin[static_cast<ptrdiff_t>(i)];
+		}
+	};
+
+	// shared state of a for_each() using a dynamic or guided partitioner.
+	// every task claims chunks of the range from an atomic cursor until it runs dry; the last one out cleans up.
+	template <typename Source, typename Task>
+	struct alignas(thread_pool_alignment) thread_pool_chunked_for_each
+	{
+		using task_type			= remove_cvref<Task>;
+		using element_reference = decltype(std::declval<const Source&>()(size_t{}));
+
+		Source source;
+		task_type task;
+		size_t count;
+		size_t grain;	// chunk size (dynamic) or minimum chunk size (guided)
+		size_t divisor; // zero for dynamic, otherwise guided chunks are (remaining / divisor)
+
+		// decremented once the state is gone, so waiting on the group waits for the task too
+		thread_pool_counter* owning_group;
+		alignas(thread_pool_alignment) std::atomic<size_t> next;
+		std::atomic<size_t> refs;
+
+		template <typename T>
+		MUU_NODISCARD_CTOR
+		thread_pool_chunked_for_each(const Source& source_,
+									 T&& task_,
+									 size_t count_,
+									 size_t grain_,
+									 size_t divisor_,
+									 thread_pool_counter* group_,
+									 size_t refs_) noexcept
+			: source{ source_ },
+			  task{ static_cast<T&&>(task_) },
+			  count{ count_ },
+			  grain{ grain_ },
+			  divisor{ divisor_ },
+			  owning_group{ group_ },
+			  next{ 0u },
+			  refs{ refs_ }
+		{}
+
+		MUU_NODISCARD
+		bool claim(size_t& first, size_t& last) noexcept
+		{
+			if (!divisor)
+			{
+				first = next.fetch_add(grain, std::memory_order_relaxed);
+				if (first >= count)
+					return false;
+				last = first + muu::min(grain, count - first);
+				return true;
+			}
+
+			auto pos = next.load(std::memory_order_relaxed);
+			while (pos < count)
+			{
+				const auto remaining = count - pos;
+				const auto chunk	 = muu::min(remaining, muu::max(grain, remaining / divisor));
+				if (next.compare_exchange_weak(pos, pos + chunk, std::memory_order_relaxed))
+				{
+					first = pos;
+					last  = pos + chunk;
+					return true;
+				}
+			}
+			return false;
+		}
+
+		// group is the task_group the for_each() belongs to (checked for cancellation between elements), or nullptr
+		template <typename Group>
+		void run(size_t batch_index, [[maybe_unused]] Group group) noexcept
+		{
+			size_t first, last;
+			while (claim(first, last))
+			{
+				for (; first < last; first++)
+				{
+					if constexpr (!std::is_null_pointer_v<Group>)
+					{
+						if (group->cancelled())
+							return;
+					}
+
+					if constexpr (std::is_nothrow_invocable_v<task_type&, element_reference, size_t>)
+						task(source(first), batch_index);
+					else if constexpr (std::is_nothrow_invocable_v<task_type&, element_reference>)
+						task(source(first));
+					else
+						task();
+				}
+			}
+		}
+
+		// true if the caller was the last task using the state
+		MUU_NODISCARD
+		bool release() noexcept
+		{
+			return refs.fetch_sub(1u, std::memory_order_acq_rel) == 1u;
+		}
+	};
+
+	// one chunk task's share of a thread_pool_chunked_for_each.
+	// the state (and the callable moved into it) is freed along with the last of these, whether or not the task
+	// holding it was ever run (e.g. its task_group was cancelled, or the pool was destroyed with it still queued).
+	template <typename State>
+	class thread_pool_chunked_for_each_ref
+	{
+	  private:
+		State* state_;
+		void* pool_;
+
+	  public:
+		MUU_NODISCARD_CTOR
+		thread_pool_chunked_for_each_ref(State* state, void* pool) noexcept //
+			: state_{ state },
+			  pool_{ pool }
+		{}
+
+		MUU_NODISCARD_CTOR
+		thread_pool_chunked_for_each_ref(thread_pool_chunked_for_each_ref&& other) noexcept //
+			: state_{ std::exchange(other.state_, nullptr) },
+			  pool_{ other.pool_ }
+		{}
+
+		thread_pool_chunked_for_each_ref& operator=(thread_pool_chunked_for_each_ref&&)		 = delete;
+		thread_pool_chunked_for_each_ref(const thread_pool_chunked_for_each_ref&)			 = delete;
+		thread_pool_chunked_for_each_ref& operator=(const thread_pool_chunked_for_each_ref&) = delete;
+
+		~thread_pool_chunked_for_each_ref() noexcept
+		{
+			if (!state_ || !state_->release())
+				return;
+
+			const auto group = state_->owning_group;
+			state_->~State();
+			::muu_impl_thread_pool_deallocate(pool_, state_, sizeof(State));
+			if (group)
+				group->decrement();
+		}
+
+		MUU_PURE_INLINE_GETTER
+		MUU_ATTR(returns_nonnull)
+		State* operator->() const noexcept
+		{
+			return state_;
+		}
+	};
+
+	struct thread_pool_less
+	{
+		template <typename T, typename U>
+		MUU_PURE_INLINE_GETTER
+		constexpr bool operator()(const T& lhs, const U& rhs) const noexcept(noexcept(lhs < rhs))
+		{
+			return lhs < rhs;
+		}
+	};
+
+	// the half-open range of indices covered by batch b of batch_count
+	MUU_CONST_INLINE_GETTER
+	constexpr size_t thread_pool_batch_start(size_t count, size_t batch_count, size_t b) noexcept
+	{
+		return static_cast<size_t>((static_cast<unsigned long long>(count) * b) / batch_count);
+	}
+
+	// parallel sample sort:
+	// 1. pick bucket_count - 1 splitters from an evenly-spaced sample of the input
+	// 2. each batch counts how many of its elements fall into each bucket
+	// 3. each batch moves its elements into their buckets in a scratch buffer
+	// 4. each bucket is sorted independently and moved back into the input range
+	template <typename Iter, typename Compare>
+	struct thread_pool_sample_sort_job
+	{
+		using value_type = remove_cvref<iter_reference_t<Iter>>;
+
+		Iter begin;
+		size_t count;
+		size_t batch_count;
+		size_t bucket_count;
+		Compare& compare;
+		const value_type* splitters; // [bucket_count - 1]
+		size_t* offsets;			 // [batch_count][bucket_count]
+		size_t* bucket_starts;		 // [bucket_count + 1]
+		value_type* buffer;			 // [count], uninitialized
+
+		// heavily-duplicated keys show up as runs of equal splitters. upper_bound() alone would put every element
+		// equal to such a run into the bucket after it (leaving the buckets between the splitters empty), so they're
+		// dealt out across all of those buckets by index instead. the buckets in the run hold nothing but that one
+		// key so they're still in order relative to each other.
+		MUU_PURE_GETTER
+		size_t bucket_of(const value_type& val, size_t index) const noexcept
+		{
+			const auto upper = std::upper_bound(splitters, splitters + (bucket_count - 1u), val, compare);
+			if (upper == splitters || compare(upper[-1], val))
+				return static_cast<size_t>(upper - splitters);
+
+			const auto lower = std::lower_bound(splitters, upper - 1, val, compare);
+			return static_cast<size_t>(lower - splitters) + 1u + index % static_cast<size_t>(upper - lower);
+		}
+
+		void count_batch(size_t b) noexcept
+		{
+			auto counts = offsets + b * bucket_count;
+			for (size_t i = thread_pool_batch_start(count, batch_count, b),
+						e = thread_pool_batch_start(count, batch_count, b + 1u);
+				 i < e;
+				 i++)
+				counts[bucket_of(begin[static_cast<ptrdiff_t>(i)], i)]++;
+		}
+
+		void scatter_batch(size_t b) noexcept
+		{
+			auto positions = offsets + b * bucket_count;
+			for (size_t i = thread_pool_batch_start(count, batch_count, b),
+						e = thread_pool_batch_start(count, batch_count, b + 1u);
+				 i < e;
+				 i++)
+			{
+				auto& val = begin[static_cast<ptrdiff_t>(i)];
+				::new (static_cast<void*>(buffer + positions[bucket_of(val, i)]++)) value_type(MUU_MOVE(val));
+			}
+		}
+
+		void sort_bucket(size_t k) noexcept
+		{
+			const auto first = bucket_starts[k];
+			const auto last	 = bucket_starts[k + 1u];
+			std::sort(buffer + first, buffer + last, compare);
+			for (size_t i = first; i < last; i++)
+			{
+				begin[static_cast<ptrdiff_t>(i)] = MUU_MOVE(buffer[i]);
+				buffer[i].~value_type();
+			}
+		}
+	};
+
+	template <typename T>
+	inline constexpr bool is_radix_sortable = (std::is_integral_v<T>			  //
+											   && !std::is_same_v<T, bool>	  //
+											   && !std::is_same_v<T, wchar_t>) //
+										   || std::is_same_v<T, uuid>;
+
+	// the radix digit (byte) of a value for a given pass, least-significant first,
+	// mapped such that the digits order the same way as the values themselves.
+	template <typename T>
+	MUU_PURE_INLINE_GETTER
+	constexpr size_t radix_sort_digit(const T& val, size_t pass) noexcept
+	{
+		if constexpr (std::is_same_v<T, uuid>)
+		{
+			// uuids compare lexicographically by byte
+			return static_cast<size_t>(unwrap(val.bytes.value[15u - pass]));
+		}
+		else
+		{
+			using unsigned_type = make_unsigned<T>;
+
+			auto bits = static_cast<unsigned_type>(val);
+			if constexpr (is_signed<T>)
+			{
+				constexpr auto all_bits = static_cast<unsigned_type>(~unsigned_type{});
+				bits ^= static_cast<unsigned_type>(all_bits ^ static_cast<unsigned_type>(all_bits >> 1)); // sign bit
+			}
+			return static_cast<size_t>(static_cast<unsigned_type>(bits >> (pass * 8u)) & 0xFFu);
+		}
+	}
+
+	// parallel LSD radix sort (one byte per pass, stable scatter between the input range and a scratch buffer)
+	template <typename Iter>
+	struct thread_pool_radix_sort_job
+	{
+		using value_type = remove_cvref<iter_reference_t<Iter>>;
+		static_assert(std::is_trivially_copyable_v<value_type>);
+
+		static constexpr size_t radix = 256;
+		static constexpr size_t passes = sizeof(value_type);
+
+		Iter begin;
+		size_t count;
+		size_t batch_count;
+		value_type* buffer; // [count]
+		size_t* offsets;	// [batch_count][radix]
+		size_t pass;
+		bool in_buffer; // whether the current data lives in the buffer or the input range
+
+		template <typename Src>
+		void histogram(Src src, size_t b) noexcept
+		{
+			auto counts = offsets + b * radix;
+			for (size_t i = 0; i < radix; i++)
+				counts[i] = 0u;
+			for (size_t i = thread_pool_batch_start(count, batch_count, b),
+						e = thread_pool_batch_start(count, batch_count, b + 1u);
+				 i < e;
+				 i++)
+				counts[radix_sort_digit(src[static_cast<ptrdiff_t>(i)], pass)]++;
+		}
+
+		template <typename Src, typename Dst>
+		void scatter(Src src, Dst dst, size_t b) noexcept
+		{
+			auto positions = offsets + b * radix;
+			for (size_t i = thread_pool_batch_start(count, batch_count, b),
+						e = thread_pool_batch_start(count, batch_count, b + 1u);
+				 i < e;
+				 i++)
+			{
+				const value_type& val = src[static_cast<ptrdiff_t>(i)];
+				::new (static_cast<void*>(&dst[static_cast<ptrdiff_t>(positions[radix_sort_digit(val, pass)]++)]))
+					value_type(val);
+			}
+		}
+
+		void histogram_batch(size_t b) noexcept
+		{
+			if (in_buffer)
+				histogram(buffer, b);
+			else
+				histogram(begin, b);
+		}
+
+		void scatter_batch(size_t b) noexcept
+		{
+			if (in_buffer)
+				scatter(buffer, begin, b);
+			else
+				scatter(begin, buffer, b);
+		}
+
+		void copy_back_batch(size_t b) noexcept
+		{
+			for (size_t i = thread_pool_batch_start(count, batch_count, b),
+						e = thread_pool_batch_start(count, batch_count, b + 1u);
+				 i < e;
+				 i++)
+				begin[static_cast<ptrdiff_t>(i)] = buffer[i];
+		}
+
+		// converts the per-batch digit counts into per-batch output positions.
+		// returns false if every value has the same digit (i.e. the pass would be a no-op).
+		bool prefix_sum() noexcept
+		{
+			size_t running = 0;
+			for (size_t d = 0; d < radix; d++)
+			{
+				const auto digit_start = running;
+				for (size_t b = 0; b < batch_count; b++)
+				{
+					auto& c = offsets[b * radix + d];
+					const auto n = c;
+					c = running;
+					running += n;
+				}
+				if (running - digit_start == count)
+					return false;
+			}
+			return true;
+		}
+	};
+
+#if MUU_HAS_COROUTINES
+
+	struct thread_pool_frame_allocator;
+
+	template <typename T>
+	class task_promise;
+
+	// awaitable returned by thread_pool::schedule().
+	// the coroutine handle is stored directly in the task slot, so resuming on a worker doesn't allocate.
+	struct thread_pool_schedule_awaiter
+	{
+		void* pool;
+		thread_pool_priority priority;
+
+		MUU_CONST_INLINE_GETTER
+		constexpr bool await_ready() const noexcept
+		{
+			return false;
+		}
+
+		void await_suspend(std::coroutine_handle<> handle) noexcept
+		{
+			const auto queue_index = ::muu_impl_thread_pool_lock(pool, priority);
+			::new (muu::assume_aligned<thread_pool_alignment>(::muu_impl_thread_pool_acquire(pool, queue_index)))
+				thread_pool_task{ [handle]() noexcept { handle.resume(); } };
+			::muu_impl_thread_pool_unlock(pool, queue_index);
+		}
+
+		constexpr void await_resume() const noexcept
+		{}
+	};
+
+#endif // MUU_HAS_COROUTINES
+}
+/// \endcond
+
+namespace muu
+{
+	/// \brief	A handle to the result of a task enqueued with muu::thread_pool::enqueue_with_result().
+	///
+	/// \details	The shared state is allocated from a slab owned by the thread pool (no `std::promise`, no
+	/// 			general-purpose heap allocation for results smaller than a few kilobytes).
+	///
+	/// \warning	A thread_pool_future must not outlive the thread_pool that created it.
+	///
+	/// \tparam	T	The task's result type.
+	template <typename T>
+	class thread_pool_future
+	{
+	  private:
+		using state_type = impl::thread_pool_future_state<T>;
+		state_type* state_ = nullptr;
+
+		friend class thread_pool;
+
+		MUU_NODISCARD_CTOR
+		explicit thread_pool_future(state_type* state) noexcept //
+			: state_{ state }
+		{}
+
+	  public:
+		/// \brief	Default constructor. Constructs an invalid future.
+		MUU_NODISCARD_CTOR
+		thread_pool_future() noexcept = default;
+
+		/// \brief	Move constructor.
+		MUU_NODISCARD_CTOR
+		thread_pool_future(thread_pool_future&& other) noexcept //
+			: state_{ std::exchange(other.state_, nullptr) }
+		{}
+
+		/// \brief	Move-assignment operator.
+		thread_pool_future& operator=(thread_pool_future&& rhs) noexcept
+		{
+			if (this != &rhs)
+			{
+				if (state_)
+					state_->release();
+				state_ = std::exchange(rhs.state_, nullptr);
+			}
+			return *this;
+		}
+
+		MUU_DELETE_COPY(thread_pool_future);
+
+		/// \brief	Destructor.
+		~thread_pool_future() noexcept
+		{
+			if (state_)
+				state_->release();
+		}
+
+		/// \brief	Returns true if the future refers to a task's shared state.
+		MUU_PURE_INLINE_GETTER
+		bool valid() const noexcept
+		{
+			return state_ != nullptr;
+		}
+
+		/// \brief	Returns true if the future refers to a task's shared state.
+		MUU_PURE_INLINE_GETTER
+		explicit operator bool() const noexcept
+		{
+			return state_ != nullptr;
+		}
+
+		/// \brief	Returns true if the task has finished and its result is available.
+		MUU_PURE_INLINE_GETTER
+		bool ready() const noexcept
+		{
+			MUU_ASSERT(state_ && "future is not valid");
+
+			return state_->pending.done();
+		}
+
+		/// \brief	Waits for the task to finish.
+		///
+		/// \details	When called from one of the pool's own workers, the worker executes other queued tasks while
+		/// 			it waits instead of blocking (so it may safely wait on work enqueued from within a task).
+		/// 			Other threads block until the result is available.
+		void wait() const noexcept
+		{
+			MUU_ASSERT(state_ && "future is not valid");
+
+			if (!state_->pending.done())
+				::muu_impl_thread_pool_wait_for(state_->pool, &state_->pending);
+		}
+
+		/// \brief	Waits for the task to finish and returns a reference to its result.
+		MUU_HIDDEN_CONSTRAINT(!std::is_void_v<U>, typename U = T)
+		MUU_NODISCARD
+		U& get() & noexcept
+		{
+			wait();
+			return state_->get();
+		}
+
+		/// \brief	Waits for the task to finish and returns its result.
+		MUU_HIDDEN_CONSTRAINT(!std::is_void_v<U>, typename U = T)
+		MUU_NODISCARD
+		U get() && noexcept
+		{
+			wait();
+			return static_cast<U&&>(state_->get());
+		}
+
+		/// \brief	Waits for the task to finish.
+		MUU_HIDDEN_CONSTRAINT(std::is_void_v<U>, typename U = T)
+		void get() const noexcept
+		{
+			wait();
+		}
+	};
+}
+
+namespace muu
+{
+#if MUU_HAS_COROUTINES
+	template <typename T = void>
+	class task;
+#endif
+
+	/// \brief	A handle for checking whether a muu::task_group has been cancelled.
+	///
+	/// \details	Long-running tasks can poll a token to stop early once the work they're part of has been
+	/// 			abandoned:
+	/// \cpp
+	/// group.enqueue([token = group.token()]() noexcept
+	/// {
+	///		for (auto& chunk : chunks)
+	///		{
+	///			if (token.cancelled())
+	///				return;
+	///			process(chunk);
+	///		}
+	///	});
+	/// \ecpp
+	///
+	/// \remarks	Tokens are trivially copyable. A default-constructed token is never cancelled.
+	///
+	/// \warning	A token must not be used after the task_group it came from has been destroyed.
+	///
+	/// \see muu::task_group::cancel()
+	class cancellation_token
+	{
+	  private:
+		friend class task_group;
+
+		const impl::thread_pool_counter* counter_ = nullptr;
+
+		MUU_NODISCARD_CTOR
+		explicit cancellation_token(const impl::thread_pool_counter* counter) noexcept //
+			: counter_{ counter }
+		{}
+
+	  public:
+		/// \brief	Constructs a token that is never cancelled.
+		MUU_NODISCARD_CTOR
+		cancellation_token() noexcept = default;
+
+		/// \brief	Returns true if the work this token belongs to has been cancelled.
+		MUU_PURE_INLINE_GETTER
+		bool cancelled() const noexcept
+		{
+			return counter_ && counter_->cancelled();
+		}
+	};
+
+	/// \brief	A group of tasks enqueued on a muu::thread_pool that can be waited on independently of the rest of
+	/// 		the pool's work.
+	///
+	/// \details	thread_pool::wait() waits for _everything_ enqueued on the pool, so unrelated producers sharing
+	/// 			one pool end up waiting on each other. Tasks enqueued through a task_group are also counted by
+	/// 			the group, and task_group::wait() only waits for those:
+	/// \cpp
+	/// muu::thread_pool pool;
+	///
+	/// muu::task_group group{ pool };
+	/// group.enqueue([]() noexcept { ... });
+	/// group.for_each(values, [](auto& val) noexcept { ... });
+	/// group.wait(); // doesn't wait for any other work in the pool
+	/// \ecpp
+	///
+	/// 			Groups can also be cancelled, so work that's no longer needed gives its workers back immediately:
+	/// \cpp
+	/// group.for_each(0, 10000000, [](int i) noexcept { ... });
+	///
+	/// // ...the request was abandoned:
+	/// group.cancel(); // tasks that haven't started are dropped; running for_each() batches stop between elements
+	/// group.wait();   // returns as soon as any tasks that were already running have finished
+	/// \ecpp
+	///
+	/// \warning	A task_group must not outlive the thread_pool it was created with.
+	class task_group
+	{
+	  private:
+		friend class thread_pool;
+
+		thread_pool& pool_;
+		impl::thread_pool_counter counter_{ { 0u } };
+
+	  public:
+		/// \brief	Constructs a task group for the given thread pool.
+		MUU_NODISCARD_CTOR
+		explicit task_group(thread_pool& pool) noexcept //
+			: pool_{ pool }
+		{}
+
+		/// \brief	Destructor. Waits for any of the group's unfinished tasks.
+		~task_group() noexcept
+		{
+			wait();
+		}
+
+		MUU_DELETE_COPY(task_group);
+		MUU_DELETE_MOVE(task_group);
+
+		/// \brief	The thread pool the group's tasks are enqueued on.
+		MUU_PURE_INLINE_GETTER
+		thread_pool& pool() const noexcept
+		{
+			return pool_;
+		}
+
+		/// \brief	Returns true if all of the tasks enqueued through the group have finished.
+		MUU_PURE_INLINE_GETTER
+		bool done() const noexcept
+		{
+			return counter_.done();
+		}
+
+		/// \brief	Waits for all of the tasks enqueued through the group to finish.
+		///
+		/// \details	When called from one of the pool's workers, the worker executes other queued tasks while it
+		/// 			waits instead of blocking.
+		inline void wait() noexcept;
+
+		/// \brief	Cancels the group's work.
+		///
+		/// \details	Cancellation is cooperative:
+		/// 			- Tasks that haven't started yet are dropped as soon as a worker pops them, without being run
+		/// 			- for_each() batches that are already running stop before their next element
+		/// 			- Other running tasks carry on, unless they poll the group's token()
+		///
+		/// \remarks	Cancellation is permanent; anything enqueued through the group afterwards is dropped too.
+		/// 			The group's tasks still count as unfinished until they've been dropped, so wait() remains
+		/// 			the way to know when they've all let go of whatever they reference.
+		/// \remarks	May be called from any thread, including from within one of the group's own tasks.
+		void cancel() noexcept
+		{
+			counter_.cancel();
+		}
+
+		/// \brief	Returns true if the group has been cancelled.
+		MUU_PURE_INLINE_GETTER
+		bool cancelled() const noexcept
+		{
+			return counter_.cancelled();
+		}
+
+		/// \brief	Returns a token for polling the group for cancellation from within its tasks.
+		MUU_PURE_INLINE_GETTER
+		cancellation_token token() const noexcept
+		{
+			return cancellation_token{ &counter_ };
+		}
+
+		/// \brief	Enqueues a task as part of the group.
+		///
+		/// \see thread_pool::enqueue()
+		template <typename Task>
+		inline task_group& enqueue(Task&& task) noexcept;
+
+		/// \brief	Enqueues a task to execute once for every value or element in a range, as part of the group.
+		///
+		/// \see thread_pool::for_each()
+		template <typename... Args>
+		inline task_group& for_each(Args&&... args) noexcept;
+	};
+
+	/// \brief A thread pool.
+	class thread_pool
+	{
+	  private:
+		void* storage_ = nullptr;
+
+		friend class task_group;
+		friend class task_graph;
+		friend class task_batch;
+#if MUU_HAS_COROUTINES
+		friend struct impl::thread_pool_frame_allocator;
+#endif
+
+		template <typename T>
+		MUU_ALWAYS_INLINE
+		void enqueue(size_t queue_index, T&& task) noexcept
+		{
+			::new (
+				muu::assume_aligned<impl::thread_pool_alignment>(::muu_impl_thread_pool_acquire(storage_, queue_index)))
+				impl::thread_pool_task{ static_cast<T&&>(task) };
+		}
+
+		template <typename Delay, typename Period, typename Task>
+		void enqueue_timer(const Delay& delay, const Period& period, Task&& task) noexcept
+		{
+			constexpr auto to_ns = [](const auto& d) noexcept
+			{
+				const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(d).count();
+				return ns > 0 ? static_cast<uint64_t>(ns) : uint64_t{};
+			};
+
+			auto timer = ::new (::muu_impl_thread_pool_allocate(storage_, sizeof(impl::thread_pool_timer)))
+				impl::thread_pool_timer{ static_cast<Task&&>(task) };
+			::muu_impl_thread_pool_schedule(storage_, timer, to_ns(delay), to_ns(period));
+		}
+
+		// grouped tasks pay an extra pointer for the group when stored in the queue
+		// (and another for the batch to check it for cancellation)
+		template <typename Group>
+		static constexpr size_t batch_storage_penalty = sizeof(void*) * (std::is_null_pointer_v<Group> ? 3u : 5u);
+
+		template <typename T, typename Group>
+		MUU_ALWAYS_INLINE
+		void enqueue(size_t queue_index, Group group, T&& task) noexcept
+		{
+			if constexpr (std::is_null_pointer_v<Group>)
+				enqueue(queue_index, static_cast<T&&>(task));
+			else
+			{
+				static_assert(std::is_same_v<Group, impl::thread_pool_counter*>);
+				MUU_ASSUME(group != nullptr);
+
+				group->increment();
+				enqueue(queue_index, impl::thread_pool_group_task<T&&>{ group, static_cast<T&&>(task) });
+			}
+		}
+
+		template <typename Task, size_t StoragePenalty, bool = is_trivially_manifestable<Task>>
+		class batched_task
+		{
+		  public:
+			using traits		= impl::thread_pool_task_traits<Task, StoragePenalty>;
+			using storage_type	= typename traits::storage_type;
+			using callable_type = typename traits::callable_type;
+
+		  private:
+			storage_type task_;
+
+		  public:
+			template <typename Arg>
+			MUU_ALWAYS_INLINE
+			void operator()(Arg&& arg, size_t batch_index) noexcept
+			{
+				traits::invoke(task_, batch_index, static_cast<Arg&&>(arg));
+			}
+
+			template <typename Arg>
+			MUU_ALWAYS_INLINE
+			void operator()(Arg&& arg) noexcept
+			{
+				traits::invoke(task_, {}, static_cast<Arg&&>(arg));
+			}
+
+			template <typename U>
+			MUU_NODISCARD_CTOR
+			batched_task(U&& task) noexcept //
+				: task_{ traits::select(static_cast<U&&>(task)) }
+			{}
+		};
+
+		template <typename Task, size_t StoragePenalty>
+		class batched_task<Task, StoragePenalty, true>
+		{
+		  public:
+			using traits = impl::thread_pool_task_traits<Task>;
+
+			template <typename Arg>
+			MUU_ALWAYS_INLINE
+			void operator()(Arg&& arg, size_t batch_index) noexcept
+			{
+				traits::invoke(batch_index, static_cast<Arg&&>(arg));
+			}
+
+			template <typename Arg>
+			MUU_ALWAYS_INLINE
+			void operator()(Arg&& arg) noexcept
+			{
+				traits::invoke({}, static_cast<Arg&&>(arg));
+			}
+		};
+
+		template <typename OriginalTask, size_t StoragePenalty, typename Task>
+		MUU_NODISCARD
+		MUU_ALWAYS_INLINE
+		static auto wrap_batched_task(Task&& task) noexcept
+		{
+			static_assert(std::is_reference_v<OriginalTask>);
+			static_assert(std::is_same_v<std::remove_reference_t<OriginalTask>, std::remove_reference_t<Task>>);
+
+			if constexpr (is_trivially_manifestable<remove_cvref<Task>>)
+			{
+				return batched_task<remove_cvref<Task>, StoragePenalty>{};
+			}
+			else
+			{
+				if constexpr (std::is_lvalue_reference_v<OriginalTask>)
+				{
+					static_assert(std::is_same_v<OriginalTask, Task&&>);
+					return batched_task<OriginalTask, StoragePenalty>{ task };
+				}
+				else
+				{
+					if constexpr (std::is_rvalue_reference_v<Task&&>)
+						return batched_task<Task&&, StoragePenalty>{ static_cast<Task&&>(task) };
+					else
+						return batched_task<remove_cvref<Task>&&, StoragePenalty>{ remove_cvref<Task>{ task } };
+				}
+			}
+		}
+
+	  public:
+		/// \brief	Constructs a thread pool.
+		///
+		/// \param	worker_count		The number of worker threads in the pool. Leave as `0` for 'automatic'.
+		/// \param	task_queue_size		Max tasks that can be stored in the internal queue without blocking. Leave as `0` for 'automatic'.
+		/// \param	name 				The name of your threadpool (for debugging purposes).
+		MUU_NODISCARD_CTOR
+		explicit thread_pool(size_t worker_count = 0, size_t task_queue_size = 0, string_param name = {}) //
+			: storage_{ ::muu_impl_thread_pool_create(worker_count, task_queue_size, &name, nullptr) }
+		{}
+
+		/// \brief	Constructs a thread pool.
+		///
+		/// \param	options		The pool's construction options.
+		/// \param	name 		The name of your threadpool (for debugging purposes).
+		MUU_NODISCARD_CTOR
+		explicit thread_pool(const thread_pool_options& options, string_param name = {}) //
+			: storage_{
+				  ::muu_impl_thread_pool_create(options.worker_count, options.task_queue_size, &name, &options)
+			  }
+		{}
+
+		/// \brief	Constructs a thread pool.
+		///
+		/// \param	name 		The name of your thread pool (for debugging purposes).
+		MUU_NODISCARD_CTOR
+		explicit thread_pool(string_param name) //
+			: thread_pool{ 0, 0, static_cast<string_param&&>(name) }
+		{}
+
+		/// \brief	Move constructor.
+		MUU_NODISCARD_CTOR
+		thread_pool(thread_pool&& other) noexcept //
+			: storage_{ std::exchange(other.storage_, nullptr) }
+		{}
+
+		/// \brief	Move-assignment operator.
+		thread_pool& operator=(thread_pool&& rhs) noexcept
+		{
+			storage_ = std::exchange(rhs.storage_, nullptr);
+			return *this;
+		}
+
+		/// \brief	Destructor.
+		/// \warning Any enqueued tasks *currently being executed* are allowed to finish;
+		/// 		 attempting to destroy a thread_pool with an enqueued task of indeterminate
+		/// 		 length may lead to a deadlock.
+		~thread_pool() noexcept
+		{
+			if (auto storage = std::exchange(storage_, nullptr))
+				::muu_impl_thread_pool_destroy(storage);
+		}
+
+		MUU_DELETE_COPY(thread_pool);
+
+		/// \brief	The number of worker threads currently in the thread pool.
+		MUU_PURE_INLINE_GETTER
+		size_t workers() const noexcept
+		{
+			return ::muu_impl_thread_pool_workers(storage_);
+		}
+
+		/// \brief	The most worker threads the thread pool may grow to.
+		///
+		/// \remarks	Worker indices (e.g. the argument passed to tasks accepting one) are always less than this,
+		/// 			so per-worker storage should be sized with it rather than with #workers().
+		///
+		/// \see muu::thread_pool_options::max_workers
+		MUU_PURE_INLINE_GETTER
+		size_t max_workers() const noexcept
+		{
+			return ::muu_impl_thread_pool_max_workers(storage_);
+		}
+
+		/// \brief	Changes the number of worker threads in the pool.
+		///
+		/// \details	New workers are started immediately. Retired workers finish whatever task they are currently
+		/// 			executing (and, for work-stealing pools, anything left in their own deque) before exiting.
+		/// 			Tasks waiting in the queues are unaffected either way; they are picked up by the remaining
+		/// 			workers.
+		///
+		/// \remarks	May be called from within a task running on one of the pool's own workers
+		/// 			(including one that is retired by the call).
+		/// \remarks	Auto-scaling pools may later grow or shrink again on their own.
+		///
+		/// \param	worker_count	The new number of workers. Clamped to `[1, max_workers()]`.
+		///
+		/// \returns	A reference to the thread pool.
+		thread_pool& set_workers(size_t worker_count) noexcept
+		{
+			if (storage_)
+				::muu_impl_thread_pool_set_workers(storage_, worker_count);
+			return *this;
+		}
+
+		/// \brief	The maximum tasks that may be enqueued without blocking.
+		///
+		/// \details	This is the total across all of the pool's queues (see thread_pool_options::task_queue_size);
+		/// 			tasks of any one priority can only use some of them.
+		MUU_PURE_INLINE_GETTER
+		size_t capacity() const noexcept
+		{
+			return ::muu_impl_thread_pool_capacity(storage_);
+		}
+
+		/// \brief	Returns the statistics collected by the pool so far.
+		///
+		/// \details	Statistics are only collected when the pool was created with
+		/// 			muu::thread_pool_options::collect_stats; otherwise everything is zero.
+		/// 			The counters are read without stopping the workers, so the result is a close approximation
+		/// 			when the pool is busy.
+		MUU_NODISCARD
+		thread_pool_stats stats() const noexcept
+		{
+			thread_pool_stats result{};
+			if (storage_)
+				::muu_impl_thread_pool_stats(storage_, &result);
+			return result;
+		}
+
+		/// \brief	Returns the statistics collected by one of the pool's workers so far.
+		///
+		/// \see stats()
+		MUU_NODISCARD
+		thread_pool_worker_stats stats(size_t worker_index) const noexcept
+		{
+			MUU_ASSERT(worker_index < max_workers());
+
+			thread_pool_worker_stats result{};
+			if (storage_)
+				::muu_impl_thread_pool_worker_stats(storage_, worker_index, &result);
+			return result;
+		}
+
+		/// \brief	Resets all of the pool's statistics to zero.
+		void reset_stats() noexcept
+		{
+			if (storage_)
+				::muu_impl_thread_pool_reset_stats(storage_);
+		}
+
+		/// \brief	Waits for the thread pool to finish all of its current work.
+		///
+		/// \details	When called from within a task running on one of the pool's own workers, the worker executes
+		/// 			other queued tasks while it waits, and returns once the only unfinished tasks are those that
+		/// 			are themselves waiting (i.e. the calling task and any others blocked in wait()).
+		///
+		/// \see muu::task_group (for waiting on a subset of the pool's work)
+		MUU_ALWAYS_INLINE
+		void wait() noexcept
+		{
+			::muu_impl_thread_pool_wait(storage_);
+		}
+
+		/// \brief	Enqueues a task.
+		///
+		/// \details Tasks must be callables with no parameters, or one parameter to recieve
+		/// 		 the index of the worker invoking the task:
+		/// \cpp
+		/// pool.enqueue([](size_t worker_index) noexcept
+		/// {
+		///		// worker_index is in the range [0, pool.max_workers() - 1]
+		///	});
+		/// pool.enqueue([]() noexcept
+		/// {
+		///		//...
+		///	});
+		/// \ecpp
+		///
+		/// \remarks Tasks must be finite, otherwise the pool will fill and wait() calls will never return.
+		/// \remarks Tasks must not throw exceptions.
+		/// \remarks May be called from within a task running on one of the pool's own workers.
+		///
+		/// \tparam	Task	The type of the task being enqueued.
+		/// \param	task  	The task to enqueue.
+		///
+		/// \returns	A reference to the thread pool.
+		template <typename Task>
+		MUU_ALWAYS_INLINE
+		thread_pool& enqueue(Task&& task) noexcept
+		{
+			return enqueue(thread_pool_priority::normal, static_cast<Task&&>(task));
+		}
+
+		/// \brief	Enqueues a task with a specific priority.
+		///
+		/// \details	Identical to #enqueue(Task&&), except the task is placed in the given priority lane:
+		/// \cpp
+		/// pool.for_each(thread_pool_priority::low, bulk_data, process);
+		///
+		/// // runs as soon as a worker is free, without waiting for the for_each() batches above
+		/// pool.enqueue(thread_pool_priority::high, []() noexcept
+		/// {
+		///		//...
+		///	});
+		/// \ecpp
+		///
+		/// \remarks	Priorities are not preemptive; a task that has already started is always run to completion.
+		///
+		/// \tparam	Task		The type of the task being enqueued.
+		/// \param	priority	The task's priority.
+		/// \param	task  		The task to enqueue.
+		///
+		/// \returns	A reference to the thread pool.
+		template <typename Task>
+		thread_pool& enqueue(thread_pool_priority priority, Task&& task) noexcept
+		{
+			static_assert(
+				std::is_nothrow_invocable_v<Task&, size_t> //
+					|| std::is_nothrow_invocable_v<Task&>,
+				"Tasks passed to thread_pool::enqueue() must be callable as void() noexcept or void(size_t) noexcept");
+
+			const auto qindex = ::muu_impl_thread_pool_lock(storage_, priority);
+			enqueue(qindex, static_cast<Task&&>(task));
+			::muu_impl_thread_pool_unlock(storage_, qindex);
+			return *this;
+		}
+
+		/// \brief	Enqueues a task as part of a task group.
+		///
+		/// \details	Identical to #enqueue(Task&&), except the task is also counted by the group so it can be
+		/// 			waited on with task_group::wait().
+		///
+		/// \tparam	Task	The type of the task being enqueued.
+		/// \param	group 	The task group. Must have been created for this thread pool.
+		/// \param	task  	The task to enqueue.
+		///
+		/// \returns	A reference to the thread pool.
+		template <typename Task>
+		thread_pool& enqueue(task_group& group, Task&& task) noexcept
+		{
+			static_assert(
+				std::is_nothrow_invocable_v<Task&, size_t> //
+					|| std::is_nothrow_invocable_v<Task&>,
+				"Tasks passed to thread_pool::enqueue() must be callable as void() noexcept or void(size_t) noexcept");
+			MUU_ASSERT(&group.pool_ == this && "task_group belongs to a different thread_pool");
+
+			const auto qindex = ::muu_impl_thread_pool_lock(storage_, thread_pool_priority::normal);
+			enqueue(qindex, &group.counter_, static_cast<Task&&>(task));
+			::muu_impl_thread_pool_unlock(storage_, qindex);
+			return *this;
+		}
+
+		/// \brief	Enqueues a range of tasks all at once.
+		///
+		/// \details	Equivalent to calling #enqueue(Task&&) for each task in the range, but room for the tasks is
+		/// 			reserved in as few queues as possible and each of those is only locked (and its workers woken)
+		/// 			once, rather than once per task:
+		/// \cpp
+		/// std::vector<my_task> tasks = make_tasks();
+		/// pool.enqueue_bulk(tasks.begin(), tasks.end());
+		/// \ecpp
+		///
+		/// \remarks	Tasks are copied out of the range, unless the iterators produce rvalues
+		/// 			(e.g. `std::make_move_iterator()`).
+		/// \remarks	Use a muu::task_batch to enqueue tasks of different types all at once.
+		///
+		/// \warning	Tasks referenced by lvalue that are too large to be stored in the pool's queues are referenced
+		/// 			by pointer, so the range must outlive them.
+		///
+		/// \tparam	Iter	A forward iterator over the tasks.
+		/// \param	begin	The beginning of the range of tasks.
+		/// \param	end		The end of the range of tasks.
+		///
+		/// \returns	A reference to the thread pool.
+		template <typename Iter>
+		MUU_ALWAYS_INLINE
+		thread_pool& enqueue_bulk(Iter begin, Iter end) noexcept
+		{
+			return enqueue_bulk(thread_pool_priority::normal, begin, end);
+		}
+
+		/// \brief	Enqueues a range of tasks all at once, with a specific priority.
+		///
+		/// \details	Identical to #enqueue_bulk(Iter, Iter), except the tasks are placed in the given priority lane.
+		///
+		/// \tparam	Iter		A forward iterator over the tasks.
+		/// \param	priority	The tasks' priority.
+		/// \param	begin		The beginning of the range of tasks.
+		/// \param	end			The end of the range of tasks.
+		///
+		/// \returns	A reference to the thread pool.
+		template <typename Iter>
+		thread_pool& enqueue_bulk(thread_pool_priority priority, Iter begin, Iter end) noexcept
+		{
+			static_assert(std::is_base_of_v<std::forward_iterator_tag, //
+											typename std::iterator_traits<Iter>::iterator_category>,
+						  "thread_pool::enqueue_bulk() requires forward iterators");
+
+			using task_type = decltype(*begin);
+			static_assert(
+				std::is_nothrow_invocable_v<std::remove_reference_t<task_type>&, size_t> //
+					|| std::is_nothrow_invocable_v<std::remove_reference_t<task_type>&>,
+				"Tasks passed to thread_pool::enqueue_bulk() must be callable as void() noexcept or void(size_t) "
+				"noexcept");
+
+			enqueue_multiple(priority,
+							 static_cast<size_t>(muu::iterator_distance(begin, end)),
+							 [&](size_t queue_index) noexcept
+							 {
+								 enqueue(queue_index, static_cast<task_type>(*begin));
+								 ++begin;
+							 });
+			return *this;
+		}
+
+		/// \brief	Enqueues a collection of tasks all at once.
+		///
+		/// \details	Identical to #enqueue_bulk(Iter, Iter), for the whole of a collection (e.g. a std::vector,
+		/// 			std::array or muu::span of tasks).
+		///
+		/// \tparam	T		The collection type.
+		/// \param	tasks	The collection of tasks. Tasks are copied out of it.
+		///
+		/// \returns	A reference to the thread pool.
+		template <typename T>
+		MUU_ALWAYS_INLINE
+		thread_pool& enqueue_bulk(T&& tasks) noexcept
+		{
+			return enqueue_bulk(thread_pool_priority::normal, begin_iterator(tasks), end_iterator(tasks));
+		}
+
+		/// \brief	Enqueues a collection of tasks all at once, with a specific priority.
+		///
+		/// \details	Identical to #enqueue_bulk(T&&), except the tasks are placed in the given priority lane.
+		///
+		/// \tparam	T			The collection type.
+		/// \param	priority	The tasks' priority.
+		/// \param	tasks		The collection of tasks. Tasks are copied out of it.
+		///
+		/// \returns	A reference to the thread pool.
+		template <typename T>
+		MUU_ALWAYS_INLINE
+		thread_pool& enqueue_bulk(thread_pool_priority priority, T&& tasks) noexcept
+		{
+			return enqueue_bulk(priority, begin_iterator(tasks), end_iterator(tasks));
+		}
+
+		/// \brief	Enqueues a task once a delay has elapsed.
+		///
+		/// \details	The task is held in the pool's timing wheel until it comes due, then enqueued as if by
+		/// 			#enqueue(Task&&):
+		/// \cpp
+		/// pool.enqueue_after(std::chrono::milliseconds{ 250 }, [&]() noexcept
+		/// {
+		///		flush_logs();
+		///	});
+		/// \ecpp
+		///
+		/// \remarks	Timers have a resolution of one millisecond and never fire early. They are serviced by the
+		/// 			pool's workers whenever they go idle (one idle worker sleeps only until the next one is due),
+		/// 			so a timer may fire late if every worker is busy.
+		/// \remarks	wait() does not wait for tasks that haven't come due yet.
+		/// \remarks	The task is always stored by value (lvalues are copied), so it may safely outlive the
+		/// 			enqueuing scope.
+		///
+		/// \tparam	Rep		The duration's representation type.
+		/// \tparam	Period	The duration's tick period.
+		/// \tparam	Task	The type of the task being enqueued.
+		/// \param	delay	How long to wait before enqueuing the task.
+		/// \param	task	The task to enqueue.
+		///
+		/// \returns	A reference to the thread pool.
+		template <typename Rep, typename Period, typename Task>
+		thread_pool& enqueue_after(const std::chrono::duration<Rep, Period>& delay, Task&& task) noexcept
+		{
+			static_assert(
+				std::is_nothrow_invocable_v<Task&, size_t> //
+					|| std::is_nothrow_invocable_v<Task&>,
+				"Tasks passed to thread_pool::enqueue_after() must be callable as void() noexcept or void(size_t) "
+				"noexcept");
+
+			enqueue_timer(delay, std::chrono::nanoseconds{}, static_cast<Task&&>(task));
+			return *this;
+		}
+
+		/// \brief	Enqueues a task repeatedly, at a fixed interval.
+		///
+		/// \details	The task is first enqueued once `period` has elapsed, then again every `period` after that.
+		/// 			Tasks returning a value convertible to `bool` stop repeating once they return `false`;
+		/// 			all others repeat until the pool is destroyed:
+		/// \cpp
+		/// pool.enqueue_every(std::chrono::seconds{ 1 }, [&]() noexcept
+		/// {
+		///		return poll_for_updates(); // false once there's nothing left to poll
+		///	});
+		/// \ecpp
+		///
+		/// \remarks	The next repetition is scheduled once the current one has finished, so a task never overlaps
+		/// 			with itself. Repetitions missed because the task (or the pool) fell behind are skipped
+		/// 			rather than run back-to-back.
+		/// \remarks	The same timing caveats as #enqueue_after() apply.
+		///
+		/// \tparam	Rep		The duration's representation type.
+		/// \tparam	Period	The duration's tick period.
+		/// \tparam	Task	The type of the task being enqueued.
+		/// \param	period	The interval between repetitions. Must be positive.
+		/// \param	task	The task to enqueue.
+		///
+		/// \returns	A reference to the thread pool.
+		template <typename Rep, typename Period, typename Task>
+		thread_pool& enqueue_every(const std::chrono::duration<Rep, Period>& period, Task&& task) noexcept
+		{
+			static_assert(
+				std::is_nothrow_invocable_v<Task&, size_t> //
+					|| std::is_nothrow_invocable_v<Task&>,
+				"Tasks passed to thread_pool::enqueue_every() must be callable as void() noexcept, bool() noexcept, "
+				"void(size_t) noexcept or bool(size_t) noexcept");
+			MUU_ASSERT(period.count() > Rep{} && "The period must be positive");
+
+			enqueue_timer(period, period, static_cast<Task&&>(task));
+			return *this;
+		}
+
+		/// \brief	Enqueues a task and returns a future for its result.
+		///
+		/// \details Tasks follow the same rules as enqueue(), but may return a value:
+		/// \cpp
+		/// auto result = pool.enqueue_with_result([]() noexcept
+		/// {
+		///		return 42;
+		///	});
+		///
+		/// // ...do other things...
+		///
+		/// std::cout << result.get() << "\n"; // 42
+		/// \ecpp
+		///
+		/// \tparam	Task	The type of the task being enqueued.
+		/// \param	task  	The task to enqueue.
+		///
+		/// \returns	A muu::thread_pool_future for the task's result.
+		///
+		/// \see muu::thread_pool_future
+		template <typename Task>
+		MUU_NODISCARD
+		auto enqueue_with_result(Task&& task) noexcept
+		{
+			static_assert(std::is_nothrow_invocable_v<Task&, size_t> //
+							  || std::is_nothrow_invocable_v<Task&>,
+						  "Tasks passed to thread_pool::enqueue_with_result() must be callable as R() noexcept or "
+						  "R(size_t) noexcept");
+
+			using result_type = typename impl::thread_pool_task_result<remove_cvref<Task>>::type;
+			using state_type  = impl::thread_pool_future_state<result_type>;
+
+			auto state = ::new (::muu_impl_thread_pool_allocate(storage_, sizeof(state_type))) state_type{ storage_ };
+			enqueue(impl::thread_pool_result_task<Task&&, result_type>{ state, static_cast<Task&&>(task) });
+
+			return thread_pool_future<result_type>{ state };
+		}
+
+#if MUU_HAS_COROUTINES
+
+		/// \brief	Returns an awaitable that resumes the awaiting coroutine on one of the pool's workers.
+		///
+		/// \details \cpp
+		/// muu::task<int> handle_request(muu::thread_pool& pool, request req)
+		/// {
+		///		auto data = co_await read_async(req); // resumed on some I/O thread...
+		///		co_await pool.schedule();             // ...then hops over to the pool for the heavy lifting
+		///		co_return process(data);
+		/// }
+		/// \ecpp
+		///
+		/// \remarks	The coroutine handle is stored directly in the pool's task queue, so scheduling a coroutine
+		/// 			doesn't allocate.
+		///
+		/// \param	priority	The priority at which the coroutine is resumed.
+		///
+		/// \returns	An awaitable object.
+		MUU_NODISCARD
+		impl::thread_pool_schedule_awaiter schedule(
+			thread_pool_priority priority = thread_pool_priority::normal) noexcept
+		{
+			return { storage_, priority };
+		}
+
+		/// \brief	Starts running a muu::task on the pool and returns a future for its result.
+		///
+		/// \details \cpp
+		/// auto result = pool.spawn(handle_request(pool, req));
+		///
+		/// // ...do other things...
+		///
+		/// std::cout << result.get() << "\n";
+		/// \ecpp
+		///
+		/// \remarks	The pool takes ownership of the task's coroutine, and destroys it once it has finished.
+		/// 			Discarding the returned future is fine if you don't need the result.
+		///
+		/// \tparam	T			The task's result type.
+		/// \param	coroutine	The task. Must not have been started.
+		/// \param	priority	The priority at which the task is started.
+		///
+		/// \returns	A muu::thread_pool_future for the task's result.
+		template <typename T>
+		thread_pool_future<T> spawn(task<T>&& coroutine,
+									thread_pool_priority priority = thread_pool_priority::normal) noexcept
+		{
+			MUU_ASSERT(coroutine.handle_ && "task is not valid");
+			MUU_ASSERT(!coroutine.handle_.done() && "task has already finished");
+
+			using state_type = impl::thread_pool_future_state<T>;
+
+			auto state	= ::new (::muu_impl_thread_pool_allocate(storage_, sizeof(state_type))) state_type{ storage_ };
+			auto handle = std::exchange(coroutine.handle_, nullptr);
+			handle.promise().future_ = state;
+			enqueue(priority, [handle]() noexcept { handle.resume(); });
+
+			return thread_pool_future<T>{ state };
+		}
+
+#endif // MUU_HAS_COROUTINES
+
+	  private:
+		static constexpr size_t no_available_queue = static_cast<size_t>(-1);
+
+		// enqueues count tasks, reserving room for as many of them at a time as a queue can hold so each queue is
+		// only locked (and its workers woken) once per batch. enqueue_next(queue_index) enqueues the next task.
+		template <typename Func>
+		void enqueue_multiple(thread_pool_priority priority, size_t count, Func&& enqueue_next) noexcept
+		{
+			const auto max_batch = muu::max(::muu_impl_thread_pool_max_batch(storage_), size_t{ 1 });
+			while (count)
+			{
+				const auto batch = muu::min(count, max_batch);
+				count -= batch;
+
+				const auto queue_index = ::muu_impl_thread_pool_lock_multiple(storage_, batch, priority);
+				if (queue_index == no_available_queue)
+				{
+					// no queue has room for the whole batch right now; fall back to one at a time
+					for (size_t i = 0; i < batch; i++)
+					{
+						const auto qindex = ::muu_impl_thread_pool_lock(storage_, priority);
+						enqueue_next(qindex);
+						::muu_impl_thread_pool_unlock(storage_, qindex);
+					}
+					continue;
+				}
+
+				for (size_t i = 0; i < batch; i++)
+					enqueue_next(queue_index);
+				::muu_impl_thread_pool_unlock(storage_, queue_index);
+			}
+		}
+
+		template <typename OriginalTask, typename ValueType, size_t Arity, typename Group, typename T, typename Task>
+		void enqueue_for_each_batch(size_t shared_queue_index,
+									Group group,
+									thread_pool_priority priority,
+									T batch_start,
+									T batch_end,
+									[[maybe_unused]] size_t batch_index,
+									Task&& task) noexcept
+		{
+			static_assert(std::is_reference_v<OriginalTask>);
+			static_assert(std::is_same_v<std::remove_reference_t<OriginalTask>, std::remove_reference_t<Task>>);
+			static_assert(Arity <= 2);
+
+			MUU_ASSERT(batch_start < batch_end);
+			MUU_ASSERT(batch_index < workers());
+
+			const auto queue_index = shared_queue_index == no_available_queue //
+									   ? ::muu_impl_thread_pool_lock(storage_, priority)
+									   : shared_queue_index;
+
+			enqueue(queue_index,
+					group,
+					[=, batch = wrap_batched_task<OriginalTask, batch_storage_penalty<Group>>(
+							static_cast<Task&&>(task))]() mutable noexcept
+					{
+						for (; batch_start < batch_end; batch_start++)
+						{
+							if constexpr (!std::is_null_pointer_v<Group>)
+							{
+								if (group->cancelled())
+									break;
+							}
+
+							if constexpr (Arity == 2)
+								batch(static_cast<ValueType>(batch_start), batch_index);
+							else
+								batch(static_cast<ValueType>(batch_start));
+						}
+					});
+
+			if (shared_queue_index == no_available_queue)
+				::muu_impl_thread_pool_unlock(storage_, queue_index);
+		}
+
+		// for_each() using a dynamic or guided partitioner: a small number of tasks (at most one per worker) share the
+		// range, claiming chunks of it from an atomic cursor as they go
+		template <typename Group, typename Source, typename Task, typename Partitioner>
+		thread_pool& for_each_chunked(Group group,
+									  thread_pool_priority priority,
+									  const Source& source,
+									  size_t job_count,
+									  Task&& task,
+									  const Partitioner& partitioner) noexcept
+		{
+			using state_type	 = impl::thread_pool_chunked_for_each<Source, Task>;
+			using elem_reference = typename state_type::element_reference;
+			static_assert(!std::is_same_v<Partitioner, thread_pool_static_partitioner>);
+			static_assert(
+				std::is_nothrow_invocable_v<Task&, elem_reference, size_t> //
+					|| std::is_nothrow_invocable_v<Task&, elem_reference>  //
+					|| std::is_nothrow_invocable_v<Task&>,
+				"Tasks passed to thread_pool::for_each() must be callable as void() noexcept, void(T) noexcept or "
+				"void(T, size_t) noexcept");
+			MUU_ASSERT(job_count);
+
+			const auto worker_count = this->workers();
+			size_t grain;
+			size_t divisor;
+			if constexpr (std::is_same_v<Partitioner, thread_pool_dynamic_partitioner>)
+			{
+				// automatic grain gives each worker ~8 chunks; enough to even out skew without hammering the cursor
+				grain	= partitioner.grain_size ? partitioner.grain_size
+												 : muu::max(job_count / (worker_count * 8u), size_t{ 1 });
+				divisor = 0u;
+			}
+			else
+			{
+				grain	= muu::max(partitioner.min_grain_size, size_t{ 1 });
+				divisor = worker_count * 2u;
+			}
+			const auto task_count = muu::min(worker_count, job_count / grain + (job_count % grain ? 1u : 0u));
+
+			// the group also waits for the state itself, so the callable is gone by the time group.wait() returns
+			if constexpr (!std::is_null_pointer_v<Group>)
+				group->increment();
+
+			auto state = ::new (::muu_impl_thread_pool_allocate(storage_, sizeof(state_type)))
+				state_type{ source, static_cast<Task&&>(task), job_count, grain, divisor, group, task_count };
+
+			// try to get a shared queue for all the allocations
+			const auto shared_queue_index = ::muu_impl_thread_pool_lock_multiple(storage_, task_count, priority);
+
+			for (size_t i = 0; i < task_count; i++)
+			{
+				const auto queue_index = shared_queue_index == no_available_queue //
+										   ? ::muu_impl_thread_pool_lock(storage_, priority)
+										   : shared_queue_index;
+
+				enqueue(queue_index,
+						group,
+						[ref = impl::thread_pool_chunked_for_each_ref<state_type>{ state, storage_ }, i, group]() noexcept
+						{ ref->run(i, group); });
+
+				if (shared_queue_index == no_available_queue)
+					::muu_impl_thread_pool_unlock(storage_, queue_index);
+			}
+
+			// unlock shared queue
+			if (shared_queue_index != no_available_queue)
+				::muu_impl_thread_pool_unlock(storage_, shared_queue_index);
+
+			return *this;
+		}
+
+		template <typename Group,
+				  typename T,
+				  typename Task,
+				  typename Partitioner = thread_pool_static_partitioner>
+		thread_pool& for_each_integral(Group group,
+									   thread_pool_priority priority,
+									   T start,
+									   T end,
+									   Task&& task,
+									   [[maybe_unused]] const Partitioner& partitioner = {}) noexcept
+		{
+			static_assert(std::is_nothrow_invocable_v<Task&, T, size_t> //
+							  || std::is_nothrow_invocable_v<Task&, T>	//
+							  || std::is_nothrow_invocable_v<Task&>,
+						  "Tasks passed to thread_pool::for_each() must be callable as void() noexcept, void(T) "
+						  "noexcept or void(T, size_t) noexcept");
+
+			if (start == end)
+				return *this;
+
+			using value_type  = remove_cvref<T>;
+			using offset_type = largest<remove_enum<value_type>,
+										std::conditional_t<is_signed<remove_enum<value_type>>, signed, unsigned>>;
+			using size_type	  = largest<make_unsigned<offset_type>, size_t>;
+
+			// reverse the start and end if they're backwards (this is a parallel for; order should be irrelevant)
+			if (start > end)
+			{
+				T temp = end;
+				end	   = T{ static_cast<remove_enum<T>>(start) + remove_enum<T>{ 1 } };
+				start  = T{ static_cast<remove_enum<T>>(temp) + remove_enum<T>{ 1 } };
+			}
+
+			// determine batch count and distribute indices
+			const auto job_count =
+				static_cast<size_type>(static_cast<offset_type>(end) - static_cast<offset_type>(start));
+			MUU_ASSERT(job_count);
+
+			if constexpr (!std::is_same_v<Partitioner, thread_pool_static_partitioner>)
+			{
+				return for_each_chunked(group,
+										priority,
+										impl::thread_pool_integral_source<value_type, offset_type>{ unwrap(start) },
+										static_cast<size_t>(job_count),
+										static_cast<Task&&>(task),
+										partitioner);
+			}
+			else
+			{
+				const auto worker_count		 = this->workers();
+				auto batch_generator		 = impl::batch_size_generator<size_type>{ job_count, worker_count };
+				offset_type next_batch_start = unwrap(start);
+				size_type next_batch_size	 = batch_generator();
+				size_t batch_index			 = 0u;
+				auto batch_count			 = muu::min(job_count, worker_count);
+
+				// try to get a shared queue for all the allocations
+				const auto shared_queue_index = ::muu_impl_thread_pool_lock_multiple(storage_, batch_count, priority);
+
+				// dispatch tasks
+				static constexpr size_t task_arity = (std::is_nothrow_invocable_v<Task&, T, size_t> //
+														  ? 2
+														  : (std::is_nothrow_invocable_v<Task&, T> ? 1 : 0));
+				while (true)
+				{
+					const auto batch_start = next_batch_start;
+					next_batch_start	   = static_cast<offset_type>(batch_start + next_batch_size);
+					next_batch_size		   = batch_generator();
+
+					if (next_batch_size)
+						enqueue_for_each_batch<Task&&, value_type, task_arity>(shared_queue_index,
+																			   group,
+																			   priority,
+																			   batch_start,
+																			   next_batch_start,
+																			   batch_index,
+																			   task);
+					else
+					{
+						enqueue_for_each_batch<Task&&, value_type, task_arity>(shared_queue_index,
+																			   group,
+																			   priority,
+																			   batch_start,
+																			   next_batch_start,
+																			   batch_index,
+																			   static_cast<Task&&>(task));
+						break;
+					}
+					batch_index++;
+				}
+
+				// unlock shared queue
+				if (shared_queue_index != no_available_queue)
+					::muu_impl_thread_pool_unlock(storage_, shared_queue_index);
+
+				return *this;
+			}
+		}
+
+	  public:
+		/// \brief	Enqueues a task to execute once for every value in a range.
+		///
+		/// \details	Tasks must be callables which accept at most two arguments: <br>
+		/// 			Argument 0: The current value from the range <br>
+		/// 			Argument 1: The task's batch (in the range `[0, pool.workers() - 1]`) <br>
+		/// \cpp
+		/// pool.for_each(0, 10, [](int i, size_t batch_index) noexcept
+		/// {
+		///		// i is in the range [0, 9]
+		///		// batch_index is in the range [0, pool.workers() - 1]
+		///	});
+		/// pool.for_each(0, 10, [](int i) noexcept
+		/// {
+		///		// i is in the range [0, 9]
+		///	});
+		/// pool.for_each(0, 10, []() noexcept
+		/// {
+		///		// no args is OK too
+		///	});
+		/// \ecpp
+		///
+		/// \remarks Tasks must be finite, otherwise the pool will fill and Wait() calls will never return.
+		/// \remarks Tasks must not throw exceptions.
+		/// \remarks May be called from within a task running on one of the pool's own workers.
+		///
+		/// \tparam	T 			An integer or enum type.
+		/// \tparam	Task		The type of the task being enqueued.
+		/// \param	start		The start of the value range (inclusive).
+		/// \param	end			The end of the value range (exclusive).
+		/// \param	task		The task to enqueue.
+		///
+		/// \return	A reference to the threadpool.
+		MUU_CONSTRAINED_TEMPLATE(muu::is_integral<T>, typename T, typename Task)
+		thread_pool& for_each(T start, T end, Task&& task) noexcept
+		{
+			return for_each_integral(nullptr, thread_pool_priority::normal, start, end, static_cast<Task&&>(task));
+		}
+
+		/// \brief	Enqueues a task to execute once for every value in a range.
+		///
+		/// \details	Tasks must be callables which accept at most two arguments: <br>
+		/// 			Argument 0: The current value from the range <br>
+		/// 			Argument 1: The task's batch (in the range `[0, pool.workers() - 1]`) <br>
+		/// \cpp
+		/// pool.for_each(10, [](int i, size_t batch_index) noexcept
+		/// {
+		///		// i is in the range [0, 9]
+		///		// batch_index is in the range [0, pool.workers() - 1]
+		///	});
+		/// pool.for_each(10, [](int i) noexcept
+		/// {
+		///		// i is in the range [0, 9]
+		///	});
+		/// pool.for_each(10, []() noexcept
+		/// {
+		///		// no args is OK too
+		///	});
+		/// \ecpp
+		///
+		/// \remarks Tasks must be finite, otherwise the pool will fill and Wait() calls will never return.
+		/// \remarks Tasks must not throw exceptions.
+		/// \remarks May be called from within a task running on one of the pool's own workers.
+		///
+		/// \tparam	T 			An integer or enum type.
+		/// \tparam	Task		The type of the task being enqueued.
+		/// \param	end			The end of the value range (exclusive).
+		/// \param	task		The task to enqueue.
+		///
+		/// \return	A reference to the threadpool.
+		MUU_CONSTRAINED_TEMPLATE(muu::is_integral<T>, typename T, typename Task)
+		MUU_ALWAYS_INLINE
+		thread_pool& for_each(T end, Task&& task) noexcept
+		{
+			return for_each(T{}, end, static_cast<Task&&>(task));
+		}
+
+		/// \cond
+		template <typename T, typename Task>
+		MUU_ALWAYS_INLINE
+		thread_pool& for_range(T start, T end, Task&& task) noexcept
+		{
+			return for_each(start, end, static_cast<Task&&>(task));
+		}
+		/// \endcond
+
+	  private:
+		template <typename OriginalTask, size_t Arity, typename Group, typename Iter, typename Task>
+		void enqueue_for_each_with_iterators_batch(size_t shared_queue_index,
+												   Group group,
+												   thread_pool_priority priority,
+												   Iter batch_start,
+												   Iter batch_end,
+												   [[maybe_unused]] size_t batch_index,
+												   Task&& task) noexcept
+		{
+			static_assert(std::is_reference_v<OriginalTask>);
+			static_assert(std::is_same_v<std::remove_reference_t<OriginalTask>, std::remove_reference_t<Task>>);
+			static_assert(Arity <= 2);
+
+			MUU_ASSERT(batch_index < workers());
+
+			const auto queue_index = shared_queue_index == no_available_queue //
+									   ? ::muu_impl_thread_pool_lock(storage_, priority)
+									   : shared_queue_index;
+
+			enqueue(queue_index,
+					group,
+					[=, batch = wrap_batched_task<OriginalTask, batch_storage_penalty<Group>>(
+							static_cast<Task&&>(task))]() mutable noexcept
+					{
+						while (batch_start != batch_end)
+						{
+							if constexpr (!std::is_null_pointer_v<Group>)
+							{
+								if (group->cancelled())
+									break;
+							}
+
+							if constexpr (Arity == 2)
+								batch(*batch_start, batch_index);
+							else
+								batch(*batch_start);
+
+							std::advance(batch_start, 1);
+						}
+					});
+
+			if (shared_queue_index == no_available_queue)
+				::muu_impl_thread_pool_unlock(storage_, queue_index);
+		}
+
+		template <typename Group, typename Begin, typename Task>
+		thread_pool& for_each_with_iterators(Group group,
+											 thread_pool_priority priority,
+											 Begin begin,
+											 size_t job_count,
+											 Task&& task) noexcept
+		{
+			using elem_reference = impl::iter_reference_t<Begin>;
+			static_assert(
+				std::is_nothrow_invocable_v<Task&, elem_reference, size_t> //
+					|| std::is_nothrow_invocable_v<Task&, elem_reference>  //
+					|| std::is_nothrow_invocable_v<Task&>,
+				"Tasks passed to thread_pool::for_each() must be callable as void() noexcept, void(T) noexcept or "
+				"void(T, size_t) noexcept");
+
+			// determine batch count and distribute iterators
+			const auto worker_count = this->workers();
+			auto batch_generator	= impl::batch_size_generator<size_t>{ job_count, worker_count };
+			size_t next_batch_size	= batch_generator();
+			auto batch_start		= begin;
+			auto batch_end			= std::next(begin, static_cast<ptrdiff_t>(next_batch_size));
+			size_t batch_index		= 0u;
+			auto batch_count		= muu::min(job_count, worker_count);
+
+			// try to get a shared queue for all the allocations
+			const auto shared_queue_index = ::muu_impl_thread_pool_lock_multiple(storage_, batch_count, priority);
+
+			// dispatch tasks
+			static constexpr size_t task_arity =
+				(std::is_nothrow_invocable_v<Task&, elem_reference, size_t>
+					 ? 2
+					 : (std::is_nothrow_invocable_v<Task&, elem_reference, size_t> ? 1 : 0));
+			while (true)
+			{
+				next_batch_size = batch_generator();
+				if (next_batch_size)
+				{
+					enqueue_for_each_with_iterators_batch<Task&&, task_arity>(shared_queue_index,
+																			  group,
+																			  priority,
+																			  batch_start,
+																			  batch_end,
+																			  batch_index,
+																			  task);
+					batch_start = batch_end;
+					std::advance(batch_end, static_cast<ptrdiff_t>(next_batch_size));
+				}
+				else
+				{
+					enqueue_for_each_with_iterators_batch<Task&&, task_arity>(shared_queue_index,
+																			  group,
+																			  priority,
+																			  batch_start,
+																			  batch_end,
+																			  batch_index,
+																			  static_cast<Task&&>(task));
+					break;
+				}
+				batch_index++;
+			}
+
+			// unlock shared queue
+			if (shared_queue_index != no_available_queue)
+				::muu_impl_thread_pool_unlock(storage_, shared_queue_index);
+
+			return *this;
+		}
+
+		template <typename Group,
+				  typename Iter,
+				  typename Task,
+				  typename Partitioner = thread_pool_static_partitioner>
+		thread_pool& for_each_iterators(Group group,
+										thread_pool_priority priority,
+										Iter begin,
+										Iter end,
+										Task&& task,
+										[[maybe_unused]] const Partitioner& partitioner = {}) noexcept
+		{
+			if constexpr (has_less_than_or_equal_operator<Iter>)
+			{
+				if (end <= begin)
+					return *this;
+			}
+			else
+			{
+				if constexpr (has_less_than_operator<Iter>)
+				{
+					if (end < begin)
+						return *this;
+				}
+				if (begin == end)
+					return *this;
+			}
+
+			const auto job_count = iterator_distance(begin, end);
+			if (job_count <= 0)
+				return *this;
+
+			// chunked partitioners need to be able to jump straight to any element
+			if constexpr (!std::is_same_v<Partitioner, thread_pool_static_partitioner>
+						  && std::is_base_of_v<std::random_access_iterator_tag,
+											   typename std::iterator_traits<Iter>::iterator_category>)
+			{
+				return for_each_chunked(group,
+										priority,
+										impl::thread_pool_iterator_source<Iter>{ begin },
+										static_cast<size_t>(job_count),
+										static_cast<Task&&>(task),
+										partitioner);
+			}
+			else
+				return for_each_with_iterators(group,
+											   priority,
+											   begin,
+											   static_cast<size_t>(job_count),
+											   static_cast<Task&&>(task));
+		}
+
+	  public:
+		/// \brief	Enqueues a task to execute on every element in a collection.
+		///
 		/// \details	Tasks must be callables which accept at most two arguments: <br>
-		/// 			Argument 0: The current value from the range <br>
+		/// 			Argument 0: The current element from the collection <br>
+		/// 			Argument 1: The task's batch (in the range `[0, pool.workers() - 1]`) <br>
+		/// \cpp
+		/// std::array<int, 10> vals;
+		/// pool.for_each(vals.begin(), vals.end(), [](int& i, size_t batch_index) noexcept
+		/// {
+		///		// i is one of the elements of vals
+		///		// batch_index is in the range [0, pool.workers() - 1]
+		///	});
+		/// pool.for_each(vals.begin(), vals.end(), [](int& i) noexcept
+		/// {
+		///		// i is one of the elements of vals
+		///	});
+		/// pool.for_each(vals.begin(), vals.end(), []() noexcept
+		/// {
+		///		// no args is OK too (though unusual)
+		///	});
+		/// \ecpp
+		///
+		/// \remarks Tasks must be finite, otherwise the pool will fill and wait() calls will never return.
+		/// \remarks Tasks must not throw exceptions.
+		/// \remarks May be called from within a task running on one of the pool's own workers.
+		///
+		/// \tparam	Iter 		Collection iterator type.
+		/// \tparam	Task		The type of the task being enqueued.
+		/// \param	begin		Iterator to the beginning of the collection.
+		/// \param	end			Iterator to the end of the collection.
+		/// \param	task  		The task to execute for each member of the collection.
+		///
+		/// \return	A reference to the thread pool.
+		MUU_CONSTRAINED_TEMPLATE(!muu::is_integral<Iter>, typename Iter, typename Task)
+		thread_pool& for_each(Iter begin, Iter end, Task&& task) noexcept
+		{
+			return for_each_iterators(nullptr, thread_pool_priority::normal, begin, end, static_cast<Task&&>(task));
+		}
+
+	  private:
+		template <typename Group,
+				  typename T,
+				  typename Task,
+				  typename Partitioner = thread_pool_static_partitioner>
+		thread_pool& for_each_collection(Group group,
+										 thread_pool_priority priority,
+										 T&& collection,
+										 Task&& task,
+										 const Partitioner& partitioner = {}) noexcept
+		{
+#define iterator_based_foreach()                                                                                       \
+	for_each_iterators(group,                                                                                          \
+					   priority,                                                                                       \
+					   begin_iterator(static_cast<T&&>(collection)),                                                   \
+					   end_iterator(static_cast<T&&>(collection)),                                                     \
+					   static_cast<Task&&>(task),                                                                      \
+					   partitioner)
+
+			using it_type = decltype(begin_iterator(static_cast<T&&>(collection)));
+
+			// fallback to .data() when the iterator is large (e.g. MSVC iterator debugging =/)
+			if constexpr (sizeof(it_type) > sizeof(void*)		//
+						  && muu::has_data_member_function<T&&> //
+						  && muu::has_size_member_function<T&&>)
+			{
+				using it_ptr_type = remove_cvref<decltype(&(*begin_iterator(static_cast<T&&>(collection))))>;
+				using data_type	  = remove_cvref<decltype(static_cast<T&&>(collection).data())>;
+
+				if constexpr (std::is_same_v<it_ptr_type, data_type>)
+				{
+					return for_each_iterators(
+						group,
+						priority,
+						static_cast<T&&>(collection).data(),
+						static_cast<T&&>(collection).data() + static_cast<T&&>(collection).size(),
+						static_cast<Task&&>(task),
+						partitioner);
+				}
+				else
+					return iterator_based_foreach();
+			}
+			else
+				return iterator_based_foreach();
+
+#undef iterator_based_foreach
+		}
+
+	  public:
+		/// \brief	Enqueues a task to execute on every element in a collection.
+		///
+		/// \details	Tasks must be callables which accept at most two arguments: <br>
+		/// 			Argument 0: The current element from the collection <br>
 		/// 			Argument 1: The task's batch (in the range `[0, pool.workers() - 1]`) <br>
 		/// \cpp
-		/// pool.for_each(10, [](int i, size_t batch_index) noexcept
-		/// {
-		///		// i is in the range [0, 9]
-		///		// batch_index is in the range [0, pool.workers() - 1]
-		///	});
-		/// pool.for_each(10, [](int i) noexcept
-		/// {
-		///		// i is in the range [0, 9]
-		///	});
-		/// pool.for_each(10, []() noexcept
-		/// {
-		///		// no args is OK too
-		///	});
+		/// std::array<int, 10> vals;
+		/// pool.for_each(vals, [](int& i, size_t batch_index) noexcept
+		/// {
+		///		// i is one of the elements of vals
+		///		// batch_index is in the range [0, pool.workers() - 1]
+		///	});
+		/// pool.for_each(vals, [](int& i) noexcept
+		/// {
+		///		// i is one of the elements of vals
+		///	});
+		/// pool.for_each(vals, []() noexcept
+		/// {
+		///		// no args is OK too (though unusual)
+		///	});
+		/// \ecpp
+		///
+		/// \remarks Tasks must be finite, otherwise the pool will fill and wait() calls will never return.
+		/// \remarks Tasks must not throw exceptions.
+		/// \remarks May be called from within a task running on one of the pool's own workers.
+		///
+		/// \tparam	T 			Type of the collection.
+		/// \tparam	Task		The type of the task being enqueued.
+		/// \param	collection	The collection.
+		/// \param	task  		The task to execute for each member of the collection.
+		///
+		/// \return	A reference to the thread pool.
+		MUU_CONSTRAINED_TEMPLATE((!muu::is_integral<T> && muu::is_iterable<T&&>), typename T, typename Task)
+		MUU_ALWAYS_INLINE
+		thread_pool& for_each(T&& collection, Task&& task) noexcept
+		{
+			return for_each_collection(nullptr,
+									   thread_pool_priority::normal,
+									   static_cast<T&&>(collection),
+									   static_cast<Task&&>(task));
+		}
+
+		/// \brief	Enqueues a task to execute once for every value in a range, using a specific partitioner.
+		///
+		/// \details	Identical to #for_each(T, T, Task&&), except the range is divided between workers according to
+		/// 			the given partitioner:
+		/// \cpp
+		/// // elements get progressively more expensive, so let workers grab more as they finish
+		/// pool.for_each(0, 10000, [](int i) noexcept { simulate(i); }, muu::thread_pool_dynamic_partitioner{ 64 });
+		/// \ecpp
+		///
+		/// \tparam	T 			An integer or enum type.
+		/// \tparam	Task		The type of the task being enqueued.
+		/// \tparam	Partitioner	One of muu::thread_pool_static_partitioner, muu::thread_pool_dynamic_partitioner
+		/// 					or muu::thread_pool_guided_partitioner.
+		/// \param	start		The start of the value range (inclusive).
+		/// \param	end			The end of the value range (exclusive).
+		/// \param	task		The task to enqueue.
+		/// \param	partitioner	The partitioner.
+		///
+		/// \return	A reference to the thread pool.
+		MUU_CONSTRAINED_TEMPLATE((muu::is_integral<T> && impl::is_thread_pool_partitioner<Partitioner>),
+								 typename T,
+								 typename Task,
+								 typename Partitioner)
+		thread_pool& for_each(T start, T end, Task&& task, const Partitioner& partitioner) noexcept
+		{
+			return for_each_integral(nullptr,
+									 thread_pool_priority::normal,
+									 start,
+									 end,
+									 static_cast<Task&&>(task),
+									 partitioner);
+		}
+
+		/// \brief	Enqueues a task to execute on every element in a collection, using a specific partitioner.
+		///
+		/// \details	Identical to #for_each(Iter, Iter, Task&&), except the range is divided between workers
+		/// 			according to the given partitioner.
+		///
+		/// \remarks	Dynamic and guided partitioning require random-access iterators; other iterators fall back
+		/// 			to static partitioning.
+		///
+		/// \return	A reference to the thread pool.
+		MUU_CONSTRAINED_TEMPLATE((!muu::is_integral<Iter> && impl::is_thread_pool_partitioner<Partitioner>),
+								 typename Iter,
+								 typename Task,
+								 typename Partitioner)
+		thread_pool& for_each(Iter begin, Iter end, Task&& task, const Partitioner& partitioner) noexcept
+		{
+			return for_each_iterators(nullptr,
+									  thread_pool_priority::normal,
+									  begin,
+									  end,
+									  static_cast<Task&&>(task),
+									  partitioner);
+		}
+
+		/// \brief	Enqueues a task to execute on every element in a collection, using a specific partitioner.
+		///
+		/// \details	Identical to #for_each(T&&, Task&&), except the collection is divided between workers
+		/// 			according to the given partitioner.
+		///
+		/// \remarks	Dynamic and guided partitioning require random-access iterators; other collections fall back
+		/// 			to static partitioning.
+		///
+		/// \return	A reference to the thread pool.
+		MUU_CONSTRAINED_TEMPLATE((!muu::is_integral<T> && muu::is_iterable<T&&>
+								  && impl::is_thread_pool_partitioner<Partitioner>),
+								 typename T,
+								 typename Task,
+								 typename Partitioner)
+		MUU_ALWAYS_INLINE
+		thread_pool& for_each(T&& collection, Task&& task, const Partitioner& partitioner) noexcept
+		{
+			return for_each_collection(nullptr,
+									   thread_pool_priority::normal,
+									   static_cast<T&&>(collection),
+									   static_cast<Task&&>(task),
+									   partitioner);
+		}
+
+		/// \brief	Enqueues a task to execute once for every value in a range, as part of a task group.
+		///
+		/// \details	Identical to #for_each(T, T, Task&&), except the batches are also counted by the group so they
+		/// 			can be waited on with task_group::wait().
+		///
+		/// \return	A reference to the thread pool.
+		MUU_CONSTRAINED_TEMPLATE(muu::is_integral<T>, typename T, typename Task)
+		thread_pool& for_each(task_group& group, T start, T end, Task&& task) noexcept
+		{
+			MUU_ASSERT(&group.pool_ == this && "task_group belongs to a different thread_pool");
+
+			return for_each_integral(&group.counter_,
+									 thread_pool_priority::normal,
+									 start,
+									 end,
+									 static_cast<Task&&>(task));
+		}
+
+		/// \brief	Enqueues a task to execute once for every value in a range, as part of a task group.
+		///
+		/// \details	Identical to #for_each(T, Task&&), except the batches are also counted by the group so they
+		/// 			can be waited on with task_group::wait().
+		///
+		/// \return	A reference to the thread pool.
+		MUU_CONSTRAINED_TEMPLATE(muu::is_integral<T>, typename T, typename Task)
+		MUU_ALWAYS_INLINE
+		thread_pool& for_each(task_group& group, T end, Task&& task) noexcept
+		{
+			return for_each(group, T{}, end, static_cast<Task&&>(task));
+		}
+
+		/// \brief	Enqueues a task to execute on every element in a collection, as part of a task group.
+		///
+		/// \details	Identical to #for_each(Iter, Iter, Task&&), except the batches are also counted by the group so
+		/// 			they can be waited on with task_group::wait().
+		///
+		/// \return	A reference to the thread pool.
+		MUU_CONSTRAINED_TEMPLATE(!muu::is_integral<Iter>, typename Iter, typename Task)
+		thread_pool& for_each(task_group& group, Iter begin, Iter end, Task&& task) noexcept
+		{
+			MUU_ASSERT(&group.pool_ == this && "task_group belongs to a different thread_pool");
+
+			return for_each_iterators(&group.counter_,
+									  thread_pool_priority::normal,
+									  begin,
+									  end,
+									  static_cast<Task&&>(task));
+		}
+
+		/// \brief	Enqueues a task to execute on every element in a collection, as part of a task group.
+		///
+		/// \details	Identical to #for_each(T&&, Task&&), except the batches are also counted by the group so
+		/// 			they can be waited on with task_group::wait().
+		///
+		/// \return	A reference to the thread pool.
+		MUU_CONSTRAINED_TEMPLATE((!muu::is_integral<T> && muu::is_iterable<T&&>), typename T, typename Task)
+		MUU_ALWAYS_INLINE
+		thread_pool& for_each(task_group& group, T&& collection, Task&& task) noexcept
+		{
+			MUU_ASSERT(&group.pool_ == this && "task_group belongs to a different thread_pool");
+
+			return for_each_collection(&group.counter_,
+									   thread_pool_priority::normal,
+									   static_cast<T&&>(collection),
+									   static_cast<Task&&>(task));
+		}
+
+		/// \brief	Enqueues a task to execute once for every value in a range, as part of a task group, using a
+		/// 		specific partitioner.
+		///
+		/// \details	Identical to #for_each(T, T, Task&&, const Partitioner&), except the tasks are also counted by
+		/// 			the group so they can be waited on (or cancelled) with the task_group.
+		///
+		/// \return	A reference to the thread pool.
+		MUU_CONSTRAINED_TEMPLATE((muu::is_integral<T> && impl::is_thread_pool_partitioner<Partitioner>),
+								 typename T,
+								 typename Task,
+								 typename Partitioner)
+		thread_pool& for_each(task_group& group, T start, T end, Task&& task, const Partitioner& partitioner) noexcept
+		{
+			MUU_ASSERT(&group.pool_ == this && "task_group belongs to a different thread_pool");
+
+			return for_each_integral(&group.counter_,
+									 thread_pool_priority::normal,
+									 start,
+									 end,
+									 static_cast<Task&&>(task),
+									 partitioner);
+		}
+
+		/// \brief	Enqueues a task to execute on every element in a collection, as part of a task group, using a
+		/// 		specific partitioner.
+		///
+		/// \details	Identical to #for_each(Iter, Iter, Task&&, const Partitioner&), except the tasks are also
+		/// 			counted by the group so they can be waited on (or cancelled) with the task_group.
+		///
+		/// \return	A reference to the thread pool.
+		MUU_CONSTRAINED_TEMPLATE((!muu::is_integral<Iter> && impl::is_thread_pool_partitioner<Partitioner>),
+								 typename Iter,
+								 typename Task,
+								 typename Partitioner)
+		thread_pool& for_each(task_group& group,
+							  Iter begin,
+							  Iter end,
+							  Task&& task,
+							  const Partitioner& partitioner) noexcept
+		{
+			MUU_ASSERT(&group.pool_ == this && "task_group belongs to a different thread_pool");
+
+			return for_each_iterators(&group.counter_,
+									  thread_pool_priority::normal,
+									  begin,
+									  end,
+									  static_cast<Task&&>(task),
+									  partitioner);
+		}
+
+		/// \brief	Enqueues a task to execute on every element in a collection, as part of a task group, using a
+		/// 		specific partitioner.
+		///
+		/// \details	Identical to #for_each(T&&, Task&&, const Partitioner&), except the tasks are also counted by
+		/// 			the group so they can be waited on (or cancelled) with the task_group.
+		///
+		/// \return	A reference to the thread pool.
+		MUU_CONSTRAINED_TEMPLATE((!muu::is_integral<T> && muu::is_iterable<T&&>
+								  && impl::is_thread_pool_partitioner<Partitioner>),
+								 typename T,
+								 typename Task,
+								 typename Partitioner)
+		MUU_ALWAYS_INLINE
+		thread_pool& for_each(task_group& group, T&& collection, Task&& task, const Partitioner& partitioner) noexcept
+		{
+			MUU_ASSERT(&group.pool_ == this && "task_group belongs to a different thread_pool");
+
+			return for_each_collection(&group.counter_,
+									   thread_pool_priority::normal,
+									   static_cast<T&&>(collection),
+									   static_cast<Task&&>(task),
+									   partitioner);
+		}
+
+		/// \brief	Enqueues a task to execute once for every value in a range, with a specific priority.
+		///
+		/// \details	Identical to #for_each(T, T, Task&&), except the batches are placed in the given priority lane.
+		///
+		/// \return	A reference to the thread pool.
+		MUU_CONSTRAINED_TEMPLATE(muu::is_integral<T>, typename T, typename Task)
+		MUU_ALWAYS_INLINE
+		thread_pool& for_each(thread_pool_priority priority, T start, T end, Task&& task) noexcept
+		{
+			return for_each_integral(nullptr, priority, start, end, static_cast<Task&&>(task));
+		}
+
+		/// \brief	Enqueues a task to execute on every element in a collection, with a specific priority.
+		///
+		/// \details	Identical to #for_each(Iter, Iter, Task&&), except the batches are placed in the given
+		/// 			priority lane.
+		///
+		/// \return	A reference to the thread pool.
+		MUU_CONSTRAINED_TEMPLATE(!muu::is_integral<Iter>, typename Iter, typename Task)
+		MUU_ALWAYS_INLINE
+		thread_pool& for_each(thread_pool_priority priority, Iter begin, Iter end, Task&& task) noexcept
+		{
+			return for_each_iterators(nullptr, priority, begin, end, static_cast<Task&&>(task));
+		}
+
+		/// \brief	Enqueues a task to execute on every element in a collection, with a specific priority.
+		///
+		/// \details	Identical to #for_each(T&&, Task&&), except the batches are placed in the given priority lane.
+		///
+		/// \return	A reference to the thread pool.
+		MUU_CONSTRAINED_TEMPLATE((!muu::is_integral<T> && muu::is_iterable<T&&>), typename T, typename Task)
+		MUU_ALWAYS_INLINE
+		thread_pool& for_each(thread_pool_priority priority, T&& collection, Task&& task) noexcept
+		{
+			return for_each_collection(nullptr, priority, static_cast<T&&>(collection), static_cast<Task&&>(task));
+		}
+
+	  private:
+		// invokes func(batch_index) once for each batch in [0, batch_count) on the pool, and waits for them all
+		template <typename Func>
+		void run_batches(size_t batch_count, Func& func) noexcept
+		{
+			static_assert(std::is_nothrow_invocable_v<Func&, size_t>);
+
+			if (!batch_count)
+				return;
+
+			impl::thread_pool_counter pending{ { 0u } };
+
+			const auto shared_queue_index =
+				::muu_impl_thread_pool_lock_multiple(storage_, batch_count, thread_pool_priority::normal);
+			for (size_t i = 0; i < batch_count; i++)
+			{
+				const auto queue_index = shared_queue_index == no_available_queue //
+										   ? ::muu_impl_thread_pool_lock(storage_, thread_pool_priority::normal)
+										   : shared_queue_index;
+
+				enqueue(queue_index, &pending, [&func, i]() noexcept { func(i); });
+
+				if (shared_queue_index == no_available_queue)
+					::muu_impl_thread_pool_unlock(storage_, queue_index);
+			}
+			if (shared_queue_index != no_available_queue)
+				::muu_impl_thread_pool_unlock(storage_, shared_queue_index);
+
+			if (!pending.done())
+				::muu_impl_thread_pool_wait_for(storage_, &pending);
+		}
+
+		template <typename T, typename Iter, typename Reduce, typename Transform>
+		T reduce_with_iterators(Iter begin, size_t job_count, T init, Reduce& reduce, Transform& transform) noexcept
+		{
+			using elem_reference = impl::iter_reference_t<Iter>;
+			using job_type		 = impl::thread_pool_reduce_job<T, Iter, Reduce, Transform>;
+			using batch_type	 = typename job_type::batch;
+			static_assert(std::is_nothrow_invocable_v<Transform&, elem_reference>,
+						  "Transforms passed to thread_pool::transform_reduce() must be callable as U(T) noexcept");
+			if constexpr (!impl::is_accumulator<T>)
+			{
+				using transformed = std::invoke_result_t<Transform&, elem_reference>;
+				static_assert(std::is_nothrow_invocable_r_v<T, Reduce&, T&&, transformed> //
+								  && std::is_nothrow_invocable_r_v<T, Reduce&, T&&, T&&>,
+							  "Reduction operations passed to thread_pool::reduce() and thread_pool::transform_reduce() "
+							  "must be callable as T(T, U) noexcept and T(T, T) noexcept");
+			}
+
+			if (!job_count)
+				return init;
+
+			// determine batch count and distribute iterators
+			const auto batch_count = muu::min(job_count, this->workers());
+			auto batch_generator   = impl::batch_size_generator<size_t>{ job_count, batch_count };
+			auto batches		   = static_cast<batch_type*>(
+				  ::muu_impl_thread_pool_allocate(storage_, sizeof(batch_type) * batch_count));
+			for (size_t i = 0; i < batch_count; i++)
+			{
+				auto& batch = *::new (static_cast<void*>(batches + i)) batch_type{ begin, batch_generator() };
+				std::advance(begin, static_cast<ptrdiff_t>(batch.count));
+			}
+
+			// dispatch tasks
+			job_type job{ batches, reduce, transform };
+			run_batches(batch_count, job);
+
+			// combine partial results (in batch order, so non-commutative operations behave)
+			for (size_t i = 0; i < batch_count; i++)
+			{
+				if constexpr (impl::is_accumulator<T>)
+					init.add(batches[i].get());
+				else
+					init = reduce(static_cast<T&&>(init), static_cast<T&&>(batches[i].get()));
+
+				batches[i].get().~T();
+				batches[i].~batch_type();
+			}
+			::muu_impl_thread_pool_deallocate(storage_, batches, sizeof(batch_type) * batch_count);
+
+			return init;
+		}
+
+		template <typename T, typename Iter, typename Reduce, typename Transform>
+		MUU_ALWAYS_INLINE
+		T reduce_iterators(Iter begin, Iter end, T&& init, Reduce& reduce, Transform& transform) noexcept
+		{
+			const auto job_count = iterator_distance(begin, end);
+			if (job_count <= 0)
+				return static_cast<T&&>(init);
+
+			return reduce_with_iterators<T>(begin,
+											static_cast<size_t>(job_count),
+											static_cast<T&&>(init),
+											reduce,
+											transform);
+		}
+
+		template <typename T, typename Collection, typename Reduce, typename Transform>
+		MUU_ALWAYS_INLINE
+		T reduce_collection(Collection&& collection, T&& init, Reduce& reduce, Transform& transform) noexcept
+		{
+			return reduce_iterators<T>(begin_iterator(static_cast<Collection&&>(collection)),
+									   end_iterator(static_cast<Collection&&>(collection)),
+									   static_cast<T&&>(init),
+									   reduce,
+									   transform);
+		}
+
+	  public:
+		/// \brief	Reduces a range of values in parallel.
+		///
+		/// \details	The range is split into one batch per worker; each batch is reduced into its own
+		/// 			(cache-line-padded) partial result, then the partial results are combined with `init`
+		/// 			on the calling thread, in order:
+		/// \cpp
+		/// std::vector<int> vals = ...;
+		/// int sum = pool.reduce(vals.begin(), vals.end(), 0, [](int a, int b) noexcept { return a + b; });
+		/// \ecpp
+		///
+		/// \remarks	Like `std::reduce()`, the operation must be associative (but need not be commutative),
+		/// 			and must be callable with any combination of `T` and the range's elements.
+		/// \remarks	Blocks until the reduction is complete. When called from one of the pool's workers the worker
+		/// 			helps execute queued tasks while it waits.
+		///
+		/// \tparam	Iter		Iterator type.
+		/// \tparam	T			The result type.
+		/// \tparam	Reduce		The reduction operation type.
+		/// \param	begin		Iterator to the beginning of the range.
+		/// \param	end			Iterator to the end of the range.
+		/// \param	init		The initial value.
+		/// \param	reduce		The reduction operation.
+		///
+		/// \return	The result of the reduction.
+		template <typename Iter, typename T, typename Reduce>
+		MUU_NODISCARD
+		T reduce(Iter begin, Iter end, T init, Reduce&& reduce) noexcept
+		{
+			impl::thread_pool_identity_transform transform;
+			return reduce_iterators<T>(begin, end, MUU_MOVE(init), reduce, transform);
+		}
+
+		/// \brief	Reduces a collection in parallel.
+		///
+		/// \details	Equivalent to `reduce(begin(collection), end(collection), init, reduce)`.
+		MUU_CONSTRAINED_TEMPLATE((muu::is_iterable<Collection&&> && !impl::is_accumulator<remove_cvref<Reduce>>),
+								 typename Collection,
+								 typename T,
+								 typename Reduce)
+		MUU_NODISCARD
+		T reduce(Collection&& collection, T init, Reduce&& reduce) noexcept
+		{
+			impl::thread_pool_identity_transform transform;
+			return reduce_collection<T>(static_cast<Collection&&>(collection), MUU_MOVE(init), reduce, transform);
+		}
+
+		/// \brief	Accumulates a range of values in parallel using a muu::accumulator.
+		///
+		/// \details	Each batch is fed to its own default-constructed accumulator, which are then
+		/// 			merged into `init` in order:
+		/// \cpp
+		/// std::vector<float> vals = ...;
+		/// auto acc = pool.reduce(vals.begin(), vals.end(), muu::accumulator<float>{}); // Kahan summation
+		/// std::cout << acc.sum() << ", " << acc.min() << ", " << acc.max() << "\n";
+		/// \ecpp
+		///
+		/// \tparam	Iter		Iterator type.
+		/// \tparam	Accumulator	A muu::accumulator specialization.
+		/// \param	begin		Iterator to the beginning of the range.
+		/// \param	end			Iterator to the end of the range.
+		/// \param	init		The initial accumulator state.
+		///
+		/// \return	The combined accumulator.
+		MUU_CONSTRAINED_TEMPLATE(impl::is_accumulator<Accumulator>, typename Iter, typename Accumulator)
+		MUU_NODISCARD
+		Accumulator reduce(Iter begin, Iter end, Accumulator init) noexcept
+		{
+			impl::thread_pool_identity_transform transform;
+			return reduce_iterators<Accumulator>(begin, end, MUU_MOVE(init), transform, transform);
+		}
+
+		/// \brief	Accumulates a collection in parallel using a muu::accumulator.
+		///
+		/// \details	Equivalent to `reduce(begin(collection), end(collection), init)`.
+		MUU_CONSTRAINED_TEMPLATE((muu::is_iterable<Collection&&> && impl::is_accumulator<Accumulator>),
+								 typename Collection,
+								 typename Accumulator)
+		MUU_NODISCARD
+		Accumulator reduce(Collection&& collection, Accumulator init) noexcept
+		{
+			impl::thread_pool_identity_transform transform;
+			return reduce_collection<Accumulator>(static_cast<Collection&&>(collection),
+												  MUU_MOVE(init),
+												  transform,
+												  transform);
+		}
+
+		/// \brief	Transforms and reduces a range of values in parallel.
+		///
+		/// \details	Every element is passed through `transform` before being reduced with `reduce`:
+		/// \cpp
+		/// std::vector<vector3f> vecs = ...;
+		/// float total = pool.transform_reduce(vecs.begin(), vecs.end(), 0.0f,
+		///		[](float a, float b) noexcept { return a + b; },
+		///		[](const vector3f& v) noexcept { return v.length(); });
+		/// \ecpp
+		///
+		/// \tparam	Iter		Iterator type.
+		/// \tparam	T			The result type.
+		/// \tparam	Reduce		The reduction operation type.
+		/// \tparam	Transform	The transform operation type.
+		/// \param	begin		Iterator to the beginning of the range.
+		/// \param	end			Iterator to the end of the range.
+		/// \param	init		The initial value.
+		/// \param	reduce		The reduction operation.
+		/// \param	transform	The transform operation.
+		///
+		/// \return	The result of the reduction.
+		///
+		/// \see reduce(Iter, Iter, T, Reduce&&)
+		template <typename Iter, typename T, typename Reduce, typename Transform>
+		MUU_NODISCARD
+		T transform_reduce(Iter begin, Iter end, T init, Reduce&& reduce, Transform&& transform) noexcept
+		{
+			return reduce_iterators<T>(begin, end, MUU_MOVE(init), reduce, transform);
+		}
+
+		/// \brief	Transforms and reduces a collection in parallel.
+		///
+		/// \details	Equivalent to `transform_reduce(begin(collection), end(collection), init, reduce, transform)`.
+		MUU_CONSTRAINED_TEMPLATE((muu::is_iterable<Collection&&> && !impl::is_accumulator<remove_cvref<Reduce>>),
+								 typename Collection,
+								 typename T,
+								 typename Reduce,
+								 typename Transform)
+		MUU_NODISCARD
+		T transform_reduce(Collection&& collection, T init, Reduce&& reduce, Transform&& transform) noexcept
+		{
+			return reduce_collection<T>(static_cast<Collection&&>(collection), MUU_MOVE(init), reduce, transform);
+		}
+
+		/// \brief	Transforms and accumulates a range of values in parallel using a muu::accumulator.
+		///
+		/// \see reduce(Iter, Iter, Accumulator)
+		MUU_CONSTRAINED_TEMPLATE(impl::is_accumulator<Accumulator>,
+								 typename Iter,
+								 typename Accumulator,
+								 typename Transform)
+		MUU_NODISCARD
+		Accumulator transform_reduce(Iter begin, Iter end, Accumulator init, Transform&& transform) noexcept
+		{
+			return reduce_iterators<Accumulator>(begin, end, MUU_MOVE(init), transform, transform);
+		}
+
+		/// \brief	Transforms and accumulates a collection in parallel using a muu::accumulator.
+		///
+		/// \see reduce(Collection&&, Accumulator)
+		MUU_CONSTRAINED_TEMPLATE((muu::is_iterable<Collection&&> && impl::is_accumulator<Accumulator>),
+								 typename Collection,
+								 typename Accumulator,
+								 typename Transform)
+		MUU_NODISCARD
+		Accumulator transform_reduce(Collection&& collection, Accumulator init, Transform&& transform) noexcept
+		{
+			return reduce_collection<Accumulator>(static_cast<Collection&&>(collection),
+												  MUU_MOVE(init),
+												  transform,
+												  transform);
+		}
+
+	  private:
+		// ranges smaller than this are just sorted on the calling thread
+		static constexpr size_t parallel_sort_threshold = 8192;
+
+		template <typename Iter, typename Compare>
+		void sample_sort(Iter begin, size_t count, Compare& compare) noexcept
+		{
+			using job_type	 = impl::thread_pool_sample_sort_job<Iter, Compare>;
+			using value_type = typename job_type::value_type;
+
+			const auto worker_count = this->workers();
+			const auto batch_count	= muu::min(worker_count, count / (parallel_sort_threshold / 4u));
+			const auto buckets		= muu::min(worker_count * 4u, count / (parallel_sort_threshold / 4u));
+
+			// scratch space
+			constexpr size_t oversampling = 16;
+			const auto sample_count		  = buckets * oversampling;
+			const auto splitters_size	  = apply_alignment<impl::thread_pool_alignment>(sizeof(value_type) * sample_count);
+			const auto offsets_size		  = sizeof(size_t) * (batch_count * buckets + buckets + 1u);
+			const auto buffer_offset	  = apply_alignment<impl::thread_pool_alignment>(splitters_size + offsets_size);
+			const auto scratch_size		  = buffer_offset + sizeof(value_type) * count;
+			auto scratch = static_cast<std::byte*>(::muu_impl_thread_pool_allocate(storage_, scratch_size));
+
+			// choose splitters from an evenly-spaced sample
+			auto samples = reinterpret_cast<value_type*>(scratch);
+			for (size_t i = 0; i < sample_count; i++)
+				::new (static_cast<void*>(samples + i))
+					value_type(begin[static_cast<ptrdiff_t>(impl::thread_pool_batch_start(count, sample_count, i))]);
+			std::sort(samples, samples + sample_count, compare);
+			for (size_t i = 1; i < buckets; i++)
+				samples[i - 1u] = MUU_MOVE(samples[i * oversampling]);
+
+			auto offsets = reinterpret_cast<size_t*>(scratch + splitters_size);
+			for (size_t i = 0, e = batch_count * buckets + buckets + 1u; i < e; i++)
+				offsets[i] = 0u;
+
+			job_type job{ begin,
+						  count,
+						  batch_count,
+						  buckets,
+						  compare,
+						  samples,
+						  offsets,
+						  offsets + batch_count * buckets,
+						  reinterpret_cast<value_type*>(scratch + buffer_offset) };
+
+			// count bucket sizes per batch
+			auto count_batch = [&](size_t b) noexcept { job.count_batch(b); };
+			run_batches(batch_count, count_batch);
+
+			// turn counts into per-batch output positions
+			size_t running = 0;
+			for (size_t k = 0; k < buckets; k++)
+			{
+				job.bucket_starts[k] = running;
+				for (size_t b = 0; b < batch_count; b++)
+				{
+					auto& c		 = offsets[b * buckets + k];
+					const auto n = c;
+					c			 = running;
+					running += n;
+				}
+			}
+			job.bucket_starts[buckets] = running;
+			MUU_ASSERT(running == count);
+
+			// distribute, then sort the buckets
+			auto scatter_batch = [&](size_t b) noexcept { job.scatter_batch(b); };
+			run_batches(batch_count, scatter_batch);
+			auto sort_bucket = [&](size_t k) noexcept { job.sort_bucket(k); };
+			run_batches(buckets, sort_bucket);
+
+			for (size_t i = 0; i < sample_count; i++)
+				samples[i].~value_type();
+			::muu_impl_thread_pool_deallocate(storage_, scratch, scratch_size);
+		}
+
+		template <typename Iter>
+		void radix_sort(Iter begin, size_t count) noexcept
+		{
+			using job_type	 = impl::thread_pool_radix_sort_job<Iter>;
+			using value_type = typename job_type::value_type;
+
+			const auto batch_count = muu::min(this->workers(), count / (parallel_sort_threshold / 4u));
+
+			const auto offsets_size = apply_alignment<impl::thread_pool_alignment>(sizeof(size_t) * job_type::radix
+																				   * batch_count);
+			const auto scratch_size = offsets_size + sizeof(value_type) * count;
+			auto scratch = static_cast<std::byte*>(::muu_impl_thread_pool_allocate(storage_, scratch_size));
+
+			job_type job{ begin,
+						  count,
+						  batch_count,
+						  reinterpret_cast<value_type*>(scratch + offsets_size),
+						  reinterpret_cast<size_t*>(scratch),
+						  0u,
+						  false };
+
+			auto histogram_batch = [&](size_t b) noexcept { job.histogram_batch(b); };
+			auto scatter_batch	 = [&](size_t b) noexcept { job.scatter_batch(b); };
+			for (; job.pass < job_type::passes; job.pass++)
+			{
+				run_batches(batch_count, histogram_batch);
+				if (!job.prefix_sum())
+					continue; // every value has the same digit in this position
+				run_batches(batch_count, scatter_batch);
+				job.in_buffer = !job.in_buffer;
+			}
+			if (job.in_buffer)
+			{
+				auto copy_back_batch = [&](size_t b) noexcept { job.copy_back_batch(b); };
+				run_batches(batch_count, copy_back_batch);
+			}
+
+			::muu_impl_thread_pool_deallocate(storage_, scratch, scratch_size);
+		}
+
+	  public:
+		/// \brief	Sorts a range of elements in parallel.
+		///
+		/// \details	Uses a parallel sample sort: an evenly-spaced sample of the range is used to choose splitters
+		/// 			that partition the elements into buckets, the buckets are distributed in parallel
+		/// 			(one batch per worker), then sorted in parallel with `std::sort()`.
+		/// \cpp
+		/// std::vector<std::string> names = ...;
+		/// pool.sort(names.begin(), names.end(), [](const auto& a, const auto& b) noexcept { return a < b; });
+		/// \ecpp
+		///
+		/// \remarks	The sort is not stable. The comparison must not throw.
+		/// \remarks	Blocks until the sort is complete. When called from one of the pool's workers the worker
+		/// 			helps execute queued tasks while it waits.
+		/// \remarks	Small ranges and element types that are not copy-constructible are sorted on the calling
+		/// 			thread with `std::sort()`.
+		///
+		/// \tparam	Iter		Random-access iterator type.
+		/// \tparam	Compare		Comparison function type.
+		/// \param	begin		Iterator to the beginning of the range.
+		/// \param	end			Iterator to the end of the range.
+		/// \param	compare		A strict weak ordering over the elements.
+		///
+		/// \return	A reference to the thread pool.
+		template <typename Iter, typename Compare>
+		thread_pool& sort(Iter begin, Iter end, Compare&& compare) noexcept
+		{
+			using value_type = remove_cvref<impl::iter_reference_t<Iter>>;
+			static_assert(std::is_base_of_v<std::random_access_iterator_tag,
+											typename std::iterator_traits<Iter>::iterator_category>,
+						  "thread_pool::sort() requires random-access iterators");
+
+			if (end <= begin)
+				return *this;
+
+			const auto count = static_cast<size_t>(end - begin);
+			if constexpr (std::is_copy_constructible_v<value_type>)
+			{
+				if (count >= parallel_sort_threshold && workers() > 1u)
+				{
+					sample_sort(begin, count, compare);
+					return *this;
+				}
+			}
+
+			std::sort(begin, end, compare);
+			return *this;
+		}
+
+		/// \brief	Sorts a range of elements in parallel in ascending order.
+		///
+		/// \details	Integral types and muu::uuid are sorted with a parallel LSD radix sort (one byte per pass,
+		/// 			skipping passes in which every element has the same digit); everything else is sorted with
+		/// 			`operator<` as per #sort(Iter, Iter, Compare&&).
+		///
+		/// \tparam	Iter		Random-access iterator type.
+		/// \param	begin		Iterator to the beginning of the range.
+		/// \param	end			Iterator to the end of the range.
+		///
+		/// \return	A reference to the thread pool.
+		template <typename Iter>
+		thread_pool& sort(Iter begin, Iter end) noexcept
+		{
+			using value_type = remove_cvref<impl::iter_reference_t<Iter>>;
+			static_assert(std::is_base_of_v<std::random_access_iterator_tag,
+											typename std::iterator_traits<Iter>::iterator_category>,
+						  "thread_pool::sort() requires random-access iterators");
+
+			if constexpr (impl::is_radix_sortable<value_type>)
+			{
+				if (end <= begin)
+					return *this;
+
+				const auto count = static_cast<size_t>(end - begin);
+				if (count >= parallel_sort_threshold && workers() > 1u)
+					radix_sort(begin, count);
+				else
+					std::sort(begin, end);
+				return *this;
+			}
+			else
+				return sort(begin, end, impl::thread_pool_less{});
+		}
+
+	  private:
+		// the smallest number of elements worth giving a batch of a parallel scan (smaller scans are done serially)
+		static constexpr size_t parallel_scan_min_batch = 4096;
+
+		template <typename T, bool Exclusive, typename Iter, typename OutIter, typename Op>
+		OutIter scan_iterators(Iter begin, Iter end, OutIter out, Op& op, T* init) noexcept
+		{
+			using job_type	 = impl::thread_pool_scan_job<T, Iter, OutIter, Op, Exclusive>;
+			using batch_type = typename job_type::batch;
+			static_assert(std::is_nothrow_invocable_r_v<T, Op&, T&&, impl::iter_reference_t<Iter>> //
+							  && std::is_nothrow_invocable_r_v<T, Op&, T&, T&&>,
+						  "Operations passed to thread_pool::inclusive_scan() and thread_pool::exclusive_scan() "
+						  "must be callable as T(T, U) noexcept and T(T, T) noexcept");
+
+			const auto distance = iterator_distance(begin, end);
+			if (distance <= 0)
+				return out;
+			const auto job_count = static_cast<size_t>(distance);
+
+			// determine batch count and distribute iterators
+			auto batch_count = muu::min(job_count / parallel_scan_min_batch, this->workers());
+			if (!batch_count)
+				batch_count = 1u;
+			auto batch_generator = impl::batch_size_generator<size_t>{ job_count, batch_count };
+			auto batches		 = static_cast<batch_type*>(
+				::muu_impl_thread_pool_allocate(storage_, sizeof(batch_type) * batch_count));
+			for (size_t i = 0; i < batch_count; i++)
+			{
+				auto& batch = *::new (static_cast<void*>(batches + i)) batch_type{ begin, out, batch_generator() };
+				std::advance(begin, static_cast<ptrdiff_t>(batch.count));
+				std::advance(out, static_cast<ptrdiff_t>(batch.count));
+			}
+			if (init)
+				::new (static_cast<void*>(batches[0].carry)) T{ static_cast<T&&>(*init) };
+
+			// dispatch tasks
+			job_type job{ batches, op, init != nullptr };
+			if (batch_count > 1u)
+			{
+				auto reduce_batch = [&](size_t b) noexcept { job.reduce_batch(b); };
+				run_batches(batch_count - 1u, reduce_batch);
+
+				job.compute_carries(batch_count);
+
+				auto scan_batch = [&](size_t b) noexcept { job.scan_batch(b); };
+				run_batches(batch_count, scan_batch);
+			}
+			else
+				job.scan_batch(0);
+
+			for (size_t i = 0; i < batch_count; i++)
+			{
+				if (i || init)
+					batches[i].get_carry().~T();
+				batches[i].~batch_type();
+			}
+			::muu_impl_thread_pool_deallocate(storage_, batches, sizeof(batch_type) * batch_count);
+
+			return out;
+		}
+
+	  public:
+		/// \brief	Computes an inclusive prefix sum of a range of elements in parallel.
+		///
+		/// \details	The parallel equivalent of `std::inclusive_scan()`. Elements are distributed into batches
+		/// 			(one per worker) in the same way as #for_each(); each batch is first reduced to a partial sum,
+		/// 			then scanned into the output starting from the combined sums of the batches before it.
+		/// \cpp
+		/// std::vector<int> vals{ 1, 2, 3, 4, 5 };
+		/// pool.inclusive_scan(vals.begin(), vals.end(), vals.begin(), [](int a, int b) noexcept { return a + b; });
+		/// // vals is now { 1, 3, 6, 10, 15 }
+		/// \ecpp
+		///
+		/// \remarks	`op` must be associative, and must not throw. It may be called concurrently.
+		/// \remarks	The output range may be the input range (i.e. in-place scans are fine).
+		/// \remarks	Blocks until the scan is complete. When called from one of the pool's workers the worker
+		/// 			helps execute queued tasks while it waits.
+		/// \remarks	Small ranges are scanned on the calling thread.
+		///
+		/// \tparam	Iter		Input iterator type.
+		/// \tparam	OutIter		Output iterator type.
+		/// \tparam	Op			Binary operation type.
+		/// \param	begin		Iterator to the beginning of the input range.
+		/// \param	end			Iterator to the end of the input range.
+		/// \param	out			Iterator to the beginning of the output range.
+		/// \param	op			The binary operation used to combine elements.
+		///
+		/// \returns	An iterator to the end of the output range.
+		template <typename Iter, typename OutIter, typename Op>
+		OutIter inclusive_scan(Iter begin, Iter end, OutIter out, Op&& op) noexcept
+		{
+			using value_type = remove_cvref<impl::iter_reference_t<Iter>>;
+
+			return scan_iterators<value_type, false>(begin, end, out, op, nullptr);
+		}
+
+		/// \brief	Computes an inclusive prefix sum of a range of elements in parallel using `operator+`.
+		///
+		/// \see inclusive_scan(Iter, Iter, OutIter, Op&&)
+		template <typename Iter, typename OutIter>
+		OutIter inclusive_scan(Iter begin, Iter end, OutIter out) noexcept
+		{
+			return inclusive_scan(begin, end, out, impl::thread_pool_plus{});
+		}
+
+		/// \brief	Computes an inclusive prefix sum of a range of elements in parallel,
+		/// 		starting from an initial value.
+		///
+		/// \see inclusive_scan(Iter, Iter, OutIter, Op&&)
+		template <typename Iter, typename OutIter, typename Op, typename T>
+		OutIter inclusive_scan(Iter begin, Iter end, OutIter out, Op&& op, T init) noexcept
+		{
+			return scan_iterators<T, false>(begin, end, out, op, &init);
+		}
+
+		/// \brief	Computes an exclusive prefix sum of a range of elements in parallel.
+		///
+		/// \details	The parallel equivalent of `std::exclusive_scan()`; the i-th output is the combination of
+		/// 			`init` and the first i-1 input elements.
+		/// \cpp
+		/// std::vector<int> vals{ 1, 2, 3, 4, 5 };
+		/// pool.exclusive_scan(vals.begin(), vals.end(), vals.begin(), 0, [](int a, int b) noexcept { return a + b; });
+		/// // vals is now { 0, 1, 3, 6, 10 }
 		/// \ecpp
 		///
-		/// \remarks Tasks must be finite, otherwise the pool will fill and Wait() calls will never return.
-		/// \remarks Tasks must not throw exceptions.
+		/// \remarks	The same requirements as #inclusive_scan() apply.
+		///
+		/// \tparam	Iter		Input iterator type.
+		/// \tparam	OutIter		Output iterator type.
+		/// \tparam	T			Result type.
+		/// \tparam	Op			Binary operation type.
+		/// \param	begin		Iterator to the beginning of the input range.
+		/// \param	end			Iterator to the end of the input range.
+		/// \param	out			Iterator to the beginning of the output range.
+		/// \param	init		The initial value.
+		/// \param	op			The binary operation used to combine elements.
+		///
+		/// \returns	An iterator to the end of the output range.
+		template <typename Iter, typename OutIter, typename T, typename Op>
+		OutIter exclusive_scan(Iter begin, Iter end, OutIter out, T init, Op&& op) noexcept
+		{
+			return scan_iterators<T, true>(begin, end, out, op, &init);
+		}
+
+		/// \brief	Computes an exclusive prefix sum of a range of elements in parallel using `operator+`.
+		///
+		/// \see exclusive_scan(Iter, Iter, OutIter, T, Op&&)
+		template <typename Iter, typename OutIter, typename T>
+		OutIter exclusive_scan(Iter begin, Iter end, OutIter out, T init) noexcept
+		{
+			return exclusive_scan(begin, end, out, MUU_MOVE(init), impl::thread_pool_plus{});
+		}
+	};
+
+	inline void task_group::wait() noexcept
+	{
+		if (!counter_.done())
+			::muu_impl_thread_pool_wait_for(pool_.storage_, &counter_);
+	}
+
+	template <typename Task>
+	inline task_group& task_group::enqueue(Task&& task) noexcept
+	{
+		pool_.enqueue(*this, static_cast<Task&&>(task));
+		return *this;
+	}
+
+	template <typename... Args>
+	inline task_group& task_group::for_each(Args&&... args) noexcept
+	{
+		pool_.for_each(*this, static_cast<Args&&>(args)...);
+		return *this;
+	}
+
+	/// \brief	A graph of interdependent tasks executed on a muu::thread_pool.
+	///
+	/// \details	Nodes are tasks (following the same rules as thread_pool::enqueue()), and edges say which tasks
+	/// 			must finish before which others may start. Running the graph enqueues every node without
+	/// 			predecessors; each node then releases its successors as it finishes, so independent branches of
+	/// 			the graph run in parallel without any intermediate calls to wait():
+	/// \cpp
+	/// muu::thread_pool pool;
+	/// muu::task_graph graph{ pool };
+	///
+	/// const auto input   = graph.add([]() noexcept { read_input(); });
+	/// const auto physics = graph.add([]() noexcept { simulate(); });
+	/// const auto audio   = graph.add([]() noexcept { mix_audio(); });
+	/// const auto render  = graph.add([]() noexcept { draw(); });
+	/// graph.add_edge(input, physics);
+	/// graph.add_edge(input, audio);
+	/// graph.add_edge(physics, render);
+	///
+	/// while (running)
+	///		graph.run().wait(); // physics and audio run concurrently
+	/// \ecpp
+	///
+	/// Node tasks are not consumed by running them, and the graph's structure is only recomputed after it has
+	/// been changed, so a graph can be run over and over (e.g. once per frame) without allocating.
+	///
+	/// \warning	A task_graph must not outlive the thread_pool it was created with, and must not contain cycles.
+	/// 			Tasks passed by lvalue reference that are too large to be stored in the graph are referenced
+	/// 			by pointer, so must outlive it.
+	class task_graph
+	{
+	  private:
+		thread_pool& pool_;
+		impl::thread_pool_counter counter_{ { 0u } };
+		impl::task_graph_node* nodes_  = {};
+		impl::task_graph_edge* edges_  = {};
+		uint32_t* successors_		   = {};
+		size_t node_count_			   = {};
+		size_t node_capacity_		   = {};
+		size_t edge_count_			   = {};
+		size_t edge_capacity_		   = {};
+		thread_pool_priority priority_ = thread_pool_priority::normal;
+		bool dirty_					   = false;
+
+		void enqueue_node(size_t queue_index, uint32_t index) noexcept
+		{
+			pool_.enqueue(queue_index,
+						  &counter_,
+						  [this, index](size_t worker_index) noexcept { execute(index, worker_index); });
+		}
+
+		void execute(uint32_t index, size_t worker_index) noexcept
+		{
+			auto node = nodes_ + index;
+			while (true)
+			{
+				node->task(worker_index);
+
+				// release successors, keeping the first ready one to run on this thread rather than enqueuing it
+				impl::task_graph_node* next = nullptr;
+				for (auto s = successors_ + node->first_successor, e = s + node->successors; s != e; s++)
+				{
+					if (nodes_[*s].pending.fetch_sub(1u, std::memory_order_acq_rel) != 1u)
+						continue;
+
+					if (!next)
+						next = nodes_ + *s;
+					else
+					{
+						const auto queue_index = ::muu_impl_thread_pool_lock(pool_.storage_, priority_);
+						enqueue_node(queue_index, *s);
+						::muu_impl_thread_pool_unlock(pool_.storage_, queue_index);
+					}
+				}
+
+				if (!next)
+					return;
+				node = next;
+			}
+		}
+
+		// rebuilds the per-node predecessor counts and successor lists from the edge list
+		void link() noexcept
+		{
+			for (size_t i = 0; i < node_count_; i++)
+			{
+				nodes_[i].predecessors = 0u;
+				nodes_[i].successors   = 0u;
+			}
+			for (size_t i = 0; i < edge_count_; i++)
+			{
+				nodes_[edges_[i].from].successors++;
+				nodes_[edges_[i].to].predecessors++;
+			}
+
+			uint32_t first = 0u;
+			for (size_t i = 0; i < node_count_; i++)
+			{
+				nodes_[i].first_successor = first;
+				first += nodes_[i].successors;
+				nodes_[i].successors = 0u;
+			}
+			for (size_t i = 0; i < edge_count_; i++)
+			{
+				auto& from											  = nodes_[edges_[i].from];
+				successors_[from.first_successor + from.successors++] = edges_[i].to;
+			}
+
+			// check for cycles by walking the graph in topological order (Kahn's algorithm); any node left unvisited
+			// is part of (or downstream of) a cycle and would never run.
+			// the pending counters are reset by run() anyway so they double as scratch space: a node's counter is
+			// never touched again once it reaches zero, so from then on it links the node into the stack of nodes
+			// ready to be visited.
+			constexpr uint32_t no_node = static_cast<uint32_t>(-1);
+			uint32_t ready			   = no_node;
+			for (size_t i = node_count_; i-- > 0u;)
+			{
+				if (nodes_[i].predecessors)
+					nodes_[i].pending.store(nodes_[i].predecessors, std::memory_order_relaxed);
+				else
+				{
+					nodes_[i].pending.store(ready, std::memory_order_relaxed);
+					ready = static_cast<uint32_t>(i);
+				}
+			}
+			size_t visited = 0;
+			while (ready != no_node)
+			{
+				auto& node = nodes_[ready];
+				ready	   = node.pending.load(std::memory_order_relaxed);
+				visited++;
+				for (auto s = successors_ + node.first_successor, e = s + node.successors; s != e; s++)
+				{
+					auto& succ = nodes_[*s].pending;
+					if (succ.load(std::memory_order_relaxed) == 1u)
+					{
+						succ.store(ready, std::memory_order_relaxed);
+						ready = *s;
+					}
+					else
+						succ.store(succ.load(std::memory_order_relaxed) - 1u, std::memory_order_relaxed);
+				}
+			}
+			MUU_ASSERT(visited == node_count_ && "task_graph must not contain cycles");
+			MUU_UNUSED(visited);
+
+			dirty_ = false;
+		}
+
+		void destroy_nodes() noexcept
+		{
+			for (size_t i = node_count_; i-- > 0u;)
+				nodes_[i].~task_graph_node();
+			node_count_ = 0u;
+		}
+
+	  public:
+		/// \brief	Constructs an empty task graph for the given thread pool.
+		MUU_NODISCARD_CTOR
+		explicit task_graph(thread_pool& pool) noexcept //
+			: pool_{ pool }
+		{}
+
+		/// \brief	Destructor. Waits for the graph to finish if it is still running.
+		~task_graph() noexcept
+		{
+			wait();
+			destroy_nodes();
+			if (nodes_)
+				muu::aligned_free(nodes_);
+			if (edges_)
+				muu::aligned_free(edges_);
+			if (successors_)
+				muu::aligned_free(successors_);
+		}
+
+		MUU_DELETE_COPY(task_graph);
+		MUU_DELETE_MOVE(task_graph);
+
+		/// \brief	The thread pool the graph runs on.
+		MUU_PURE_INLINE_GETTER
+		thread_pool& pool() const noexcept
+		{
+			return pool_;
+		}
+
+		/// \brief	The number of nodes in the graph.
+		MUU_PURE_INLINE_GETTER
+		size_t nodes() const noexcept
+		{
+			return node_count_;
+		}
+
+		/// \brief	The number of edges in the graph.
+		MUU_PURE_INLINE_GETTER
+		size_t edges() const noexcept
+		{
+			return edge_count_;
+		}
+
+		/// \brief	Returns true if the graph is not currently running.
+		MUU_PURE_INLINE_GETTER
+		bool done() const noexcept
+		{
+			return counter_.done();
+		}
+
+		/// \brief	Waits for the current run of the graph to finish.
+		///
+		/// \details	When called from one of the pool's workers, the worker executes other queued tasks while it
+		/// 			waits instead of blocking.
+		void wait() noexcept
+		{
+			if (!counter_.done())
+				::muu_impl_thread_pool_wait_for(pool_.storage_, &counter_);
+		}
+
+		/// \brief	Reserves storage for at least the given number of nodes and edges.
+		///
+		/// \warning	Must not be called while the graph is running.
+		task_graph& reserve(size_t nodes, size_t edges) noexcept
+		{
+			MUU_ASSERT(done() && "task_graph must not be modified while running");
+
+			if (nodes > node_capacity_)
+			{
+				auto new_nodes = static_cast<impl::task_graph_node*>(
+					muu::aligned_alloc(sizeof(impl::task_graph_node) * nodes, alignof(impl::task_graph_node)));
+				MUU_ASSERT(new_nodes);
+				for (size_t i = 0; i < node_count_; i++)
+					::new (static_cast<void*>(new_nodes + i))
+						impl::task_graph_node{ static_cast<impl::task_graph_node&&>(nodes_[i]) };
+
+				const auto node_count = node_count_;
+				destroy_nodes();
+				node_count_ = node_count;
+
+				if (nodes_)
+					muu::aligned_free(nodes_);
+				nodes_		   = new_nodes;
+				node_capacity_ = nodes;
+			}
+
+			if (edges > edge_capacity_)
+			{
+				auto new_edges = static_cast<impl::task_graph_edge*>(
+					muu::aligned_alloc(sizeof(impl::task_graph_edge) * edges, alignof(impl::task_graph_edge)));
+				auto new_successors =
+					static_cast<uint32_t*>(muu::aligned_alloc(sizeof(uint32_t) * edges, alignof(uint32_t)));
+				MUU_ASSERT(new_edges);
+				MUU_ASSERT(new_successors);
+				if (edge_count_)
+				{
+					MUU_MEMCPY(new_edges, edges_, sizeof(impl::task_graph_edge) * edge_count_);
+					MUU_MEMCPY(new_successors, successors_, sizeof(uint32_t) * edge_count_);
+				}
+
+				if (edges_)
+					muu::aligned_free(edges_);
+				if (successors_)
+					muu::aligned_free(successors_);
+				edges_		   = new_edges;
+				successors_	   = new_successors;
+				edge_capacity_ = edges;
+			}
+
+			return *this;
+		}
+
+		/// \brief	Adds a task to the graph as a new node.
 		///
-		/// \warning Do not call this from one of the thread_pool's workers.
+		/// \warning	Must not be called while the graph is running.
 		///
-		/// \tparam	T 			An integer or enum type.
-		/// \tparam	Task		The type of the task being enqueued.
-		/// \param	end			The end of the value range (exclusive).
-		/// \param	task		The task to enqueue.
+		/// \tparam	Task	The type of the task.
+		/// \param	task	The task. Must be callable as `void() noexcept` or `void(size_t) noexcept`,
+		/// 				where the argument is the index of the worker executing it.
 		///
-		/// \return	A reference to the threadpool.
-		MUU_CONSTRAINED_TEMPLATE(muu::is_integral<T>, typename T, typename Task)
-		MUU_ALWAYS_INLINE
-		thread_pool& for_each(T end, Task&& task) noexcept
+		/// \returns	The index of the new node, for use with add_edge().
+		template <typename Task>
+		size_t add(Task&& task) noexcept
 		{
-			return for_each(T{}, end, static_cast<Task&&>(task));
+			static_assert(
+				std::is_nothrow_invocable_v<Task&, size_t> //
+					|| std::is_nothrow_invocable_v<Task&>,
+				"Tasks passed to task_graph::add() must be callable as void() noexcept or void(size_t) noexcept");
+			MUU_ASSERT(done() && "task_graph must not be modified while running");
+			MUU_ASSERT(node_count_ < static_cast<size_t>(static_cast<uint32_t>(-1)));
+
+			if (node_count_ == node_capacity_)
+				reserve(muu::max(node_capacity_ * 2u, size_t{ 16 }), edge_capacity_);
+
+			::new (static_cast<void*>(nodes_ + node_count_)) impl::task_graph_node{ static_cast<Task&&>(task) };
+			dirty_ = true;
+			return node_count_++;
 		}
 
-		/// \cond
-		template <typename T, typename Task>
-		MUU_ALWAYS_INLINE
-		thread_pool& for_range(T start, T end, Task&& task) noexcept
+		/// \brief	Adds an edge to the graph, so that one node must finish before another may start.
+		///
+		/// \warning	Must not be called while the graph is running.
+		///
+		/// \param	from	The index of the node that must finish first.
+		/// \param	to		The index of the node that depends on it.
+		///
+		/// \returns	A reference to the graph.
+		task_graph& add_edge(size_t from, size_t to) noexcept
+		{
+			MUU_ASSERT(done() && "task_graph must not be modified while running");
+			MUU_ASSERT(from < node_count_);
+			MUU_ASSERT(to < node_count_);
+			MUU_ASSERT(from != to && "task_graph must not contain cycles");
+
+			if (edge_count_ == edge_capacity_)
+				reserve(node_capacity_, muu::max(edge_capacity_ * 2u, size_t{ 32 }));
+
+			edges_[edge_count_++] = { static_cast<uint32_t>(from), static_cast<uint32_t>(to) };
+			dirty_				  = true;
+			return *this;
+		}
+
+		/// \brief	Removes all nodes and edges from the graph (keeping its storage for reuse).
+		///
+		/// \details	Waits for the graph to finish first if it is still running.
+		task_graph& clear() noexcept
+		{
+			wait();
+			destroy_nodes();
+			edge_count_ = 0u;
+			dirty_		= false;
+			return *this;
+		}
+
+		/// \brief	Starts running the graph.
+		///
+		/// \details	Every node runs exactly once per run, after all of its predecessors have finished.
+		/// 			Use wait() to wait for the run to complete.
+		///
+		/// \remarks	May be called from within a task running on one of the pool's own workers.
+		///
+		/// \warning	Must not be called while the graph is already running.
+		///
+		/// \param	priority	The priority at which the graph's tasks are enqueued.
+		///
+		/// \returns	A reference to the graph.
+		task_graph& run(thread_pool_priority priority = thread_pool_priority::normal) noexcept
+		{
+			MUU_ASSERT(done() && "task_graph::run() called while the graph was already running");
+
+			if (!node_count_)
+				return *this;
+
+			if (dirty_)
+				link();
+			priority_ = priority;
+
+			size_t roots = 0;
+			for (size_t i = 0; i < node_count_; i++)
+			{
+				nodes_[i].pending.store(nodes_[i].predecessors, std::memory_order_relaxed);
+				if (!nodes_[i].predecessors)
+					roots++;
+			}
+			MUU_ASSERT(roots && "task_graph must not contain cycles");
+
+			// try to get a shared queue for all the roots
+			const auto shared_queue_index = ::muu_impl_thread_pool_lock_multiple(pool_.storage_, roots, priority);
+
+			for (size_t i = 0; i < node_count_; i++)
+			{
+				if (nodes_[i].predecessors)
+					continue;
+
+				const auto queue_index = shared_queue_index == thread_pool::no_available_queue //
+										   ? ::muu_impl_thread_pool_lock(pool_.storage_, priority)
+										   : shared_queue_index;
+
+				enqueue_node(queue_index, static_cast<uint32_t>(i));
+
+				if (shared_queue_index == thread_pool::no_available_queue)
+					::muu_impl_thread_pool_unlock(pool_.storage_, queue_index);
+			}
+
+			if (shared_queue_index != thread_pool::no_available_queue)
+				::muu_impl_thread_pool_unlock(pool_.storage_, shared_queue_index);
+
+			return *this;
+		}
+	};
+
+	/// \brief	A batch of tasks, built up ahead of time and then enqueued on a muu::thread_pool all at once.
+	///
+	/// \details	Tasks may be of different types (following the same rules as thread_pool::enqueue()). They're
+	/// 			constructed in the batch as they're added, and when the batch is submitted they're moved into the
+	/// 			pool's queues in as few goes as possible, each queue only being locked (and its workers woken)
+	/// 			once, rather than once per task:
+	/// \cpp
+	/// muu::thread_pool pool;
+	/// muu::task_batch batch{ pool };
+	///
+	/// for (auto& entity : entities)
+	///		batch.add([&]() noexcept { entity.update(); });
+	/// batch.add([]() noexcept { update_audio(); });
+	///
+	/// batch.submit().wait();
+	/// \ecpp
+	///
+	/// \remarks	Any tasks still in the batch when it is destroyed are submitted to the pool.
+	///
+	/// \warning	A task_batch must not outlive the thread_pool it was created with.
+	/// 			Tasks passed by lvalue reference that are too large to be stored in the batch are referenced
+	/// 			by pointer, so must outlive their execution.
+	///
+	/// \see thread_pool::enqueue_bulk()
+	class task_batch
+	{
+	  private:
+		thread_pool& pool_;
+		impl::thread_pool_task* tasks_ = {};
+		size_t size_				   = {};
+		size_t capacity_			   = {};
+		thread_pool_priority priority_ = thread_pool_priority::normal;
+
+		void destroy_tasks() noexcept
+		{
+			for (size_t i = size_; i-- > 0u;)
+				tasks_[i].~thread_pool_task();
+			size_ = 0u;
+		}
+
+	  public:
+		/// \brief	Constructs an empty batch of tasks for the given thread pool.
+		///
+		/// \param	pool		The thread pool the batch will be submitted to.
+		/// \param	priority	The priority lane the batch's tasks will be placed in.
+		MUU_NODISCARD_CTOR
+		explicit task_batch(thread_pool& pool, thread_pool_priority priority = thread_pool_priority::normal) noexcept
+			: pool_{ pool },
+			  priority_{ priority }
+		{}
+
+		/// \brief	Destructor. Submits any tasks remaining in the batch.
+		~task_batch() noexcept
+		{
+			submit();
+			if (tasks_)
+				muu::aligned_free(tasks_);
+		}
+
+		MUU_DELETE_COPY(task_batch);
+		MUU_DELETE_MOVE(task_batch);
+
+		/// \brief	The thread pool the batch will be submitted to.
+		MUU_PURE_INLINE_GETTER
+		thread_pool& pool() const noexcept
+		{
+			return pool_;
+		}
+
+		/// \brief	The number of tasks waiting in the batch.
+		MUU_PURE_INLINE_GETTER
+		size_t size() const noexcept
+		{
+			return size_;
+		}
+
+		/// \brief	Returns true if the batch does not contain any tasks.
+		MUU_PURE_INLINE_GETTER
+		bool empty() const noexcept
+		{
+			return !size_;
+		}
+
+		/// \brief	Reserves storage for at least the given number of tasks.
+		task_batch& reserve(size_t tasks) noexcept
+		{
+			if (tasks <= capacity_)
+				return *this;
+
+			auto new_tasks = static_cast<impl::thread_pool_task*>(
+				muu::aligned_alloc(sizeof(impl::thread_pool_task) * tasks, alignof(impl::thread_pool_task)));
+			MUU_ASSERT(new_tasks);
+			for (size_t i = 0; i < size_; i++)
+				::new (static_cast<void*>(new_tasks + i))
+					impl::thread_pool_task{ static_cast<impl::thread_pool_task&&>(tasks_[i]) };
+
+			const auto size = size_;
+			destroy_tasks();
+			size_ = size;
+
+			if (tasks_)
+				muu::aligned_free(tasks_);
+			tasks_	  = new_tasks;
+			capacity_ = tasks;
+			return *this;
+		}
+
+		/// \brief	Adds a task to the batch.
+		///
+		/// \tparam	Task	The type of the task.
+		/// \param	task	The task. Must be callable as `void() noexcept` or `void(size_t) noexcept`,
+		/// 				where the argument is the index of the worker executing it.
+		///
+		/// \returns	A reference to the batch.
+		template <typename Task>
+		task_batch& add(Task&& task) noexcept
+		{
+			static_assert(
+				std::is_nothrow_invocable_v<Task&, size_t> //
+					|| std::is_nothrow_invocable_v<Task&>,
+				"Tasks passed to task_batch::add() must be callable as void() noexcept or void(size_t) noexcept");
+
+			if (size_ == capacity_)
+				reserve(muu::max(capacity_ * 2u, size_t{ 16 }));
+
+			::new (static_cast<void*>(tasks_ + size_)) impl::thread_pool_task{ static_cast<Task&&>(task) };
+			size_++;
+			return *this;
+		}
+
+		/// \brief	Enqueues all of the tasks in the batch on the thread pool, leaving the batch empty
+		/// 		(and ready to be reused).
+		///
+		/// \returns	A reference to the thread pool.
+		thread_pool& submit() noexcept
+		{
+			if (size_)
+			{
+				auto next = tasks_;
+				pool_.enqueue_multiple(priority_,
+									   size_,
+									   [&](size_t queue_index) noexcept
+									   { pool_.enqueue(queue_index, static_cast<impl::thread_pool_task&&>(*next++)); });
+				destroy_tasks();
+			}
+			return pool_;
+		}
+
+		/// \brief	Discards all of the tasks in the batch without running them.
+		task_batch& clear() noexcept
+		{
+			destroy_tasks();
+			return *this;
+		}
+	};
+}
+
+#if MUU_HAS_COROUTINES
+
+/// \cond
+namespace muu::impl
+{
+	// coroutine frames are prefixed with a small header recording the pool (if any) they were allocated from
+	struct thread_pool_frame_allocator
+	{
+		static constexpr size_t header_size = aligned_alloc_min_align;
+
+		template <typename T>
+		MUU_PURE_INLINE_GETTER
+		static void* pool_of(T& arg) noexcept
+		{
+			if constexpr (std::is_same_v<remove_cvref<T>, thread_pool>)
+				return arg.storage_;
+			else
+				return nullptr;
+		}
+
+		MUU_NODISCARD
+		static void* allocate(size_t size, void* pool)
+		{
+			void* ptr = pool ? ::muu_impl_thread_pool_allocate(pool, size + header_size)
+							 : ::operator new(size + header_size);
+			MUU_MEMCPY(ptr, &pool, sizeof(void*));
+			return static_cast<std::byte*>(ptr) + header_size;
+		}
+
+		static void deallocate(void* frame, size_t size) noexcept
+		{
+			void* ptr = static_cast<std::byte*>(frame) - header_size;
+			void* pool;
+			MUU_MEMCPY(&pool, ptr, sizeof(void*));
+
+			if (pool)
+				::muu_impl_thread_pool_deallocate(pool, ptr, size + header_size);
+			else
+				::operator delete(ptr, size + header_size);
+		}
+	};
+
+	// one of a coroutine's arguments, as seen by its promise's operator new.
+	// operator new can't just be a variadic template taking the arguments as-is: GCC pairs it with the (necessarily
+	// non-template) operator delete by mangled name, and warns about a mismatched new/delete in every coroutine.
+	struct thread_pool_frame_arg
+	{
+		void* pool = nullptr;
+
+		MUU_NODISCARD_CTOR
+		constexpr thread_pool_frame_arg() noexcept = default;
+
+		template <typename T>
+		MUU_NODISCARD_CTOR
+		thread_pool_frame_arg(T& arg) noexcept //
+			: pool{ thread_pool_frame_allocator::pool_of(arg) }
+		{}
+	};
+
+	template <typename T>
+	class task_promise_base
+	{
+	  public:
+		std::coroutine_handle<> continuation_;
+		thread_pool_future_state<T>* future_ = nullptr;
+
+		// frames of coroutines taking a thread_pool& among their first eight arguments are allocated from that
+		// pool's freelists. coroutines with more arguments fall back to operator new(size) (i.e. the global heap).
+		MUU_NODISCARD
+		static void* operator new(size_t size,
+								  thread_pool_frame_arg a0 = {},
+								  thread_pool_frame_arg a1 = {},
+								  thread_pool_frame_arg a2 = {},
+								  thread_pool_frame_arg a3 = {},
+								  thread_pool_frame_arg a4 = {},
+								  thread_pool_frame_arg a5 = {},
+								  thread_pool_frame_arg a6 = {},
+								  thread_pool_frame_arg a7 = {})
+		{
+			void* const pools[] = { a0.pool, a1.pool, a2.pool, a3.pool, a4.pool, a5.pool, a6.pool, a7.pool };
+			void* pool			= nullptr;
+			for (auto p : pools)
+				pool = pool ? pool : p;
+
+			return thread_pool_frame_allocator::allocate(size, pool);
+		}
+
+		static void operator delete(void* ptr, size_t size) noexcept
+		{
+			thread_pool_frame_allocator::deallocate(ptr, size);
+		}
+
+		struct final_awaiter
+		{
+			MUU_CONST_INLINE_GETTER
+			constexpr bool await_ready() const noexcept
+			{
+				return false;
+			}
+
+			template <typename Promise>
+			std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept
+			{
+				auto& promise = handle.promise();
+
+				// spawned on a pool; deliver the result to the future and clean up
+				if (promise.future_)
+				{
+					promise.deliver();
+					handle.destroy();
+					return std::noop_coroutine();
+				}
+
+				// awaited by another coroutine; resume it
+				if (promise.continuation_)
+					return promise.continuation_;
+
+				return std::noop_coroutine();
+			}
+
+			constexpr void await_resume() const noexcept
+			{}
+		};
+
+		MUU_CONST_INLINE_GETTER
+		std::suspend_always initial_suspend() const noexcept
+		{
+			return {};
+		}
+
+		MUU_CONST_INLINE_GETTER
+		final_awaiter final_suspend() const noexcept
+		{
+			return {};
+		}
+
+		[[noreturn]] void unhandled_exception() const noexcept
 		{
-			return for_each(start, end, static_cast<Task&&>(task));
+			std::terminate();
 		}
-		/// \endcond
+	};
+
+	template <typename T>
+	class task_promise : public task_promise_base<T>
+	{
+		static_assert(!std::is_reference_v<T>, "Tasks returning references are not supported");
 
 	  private:
-		template <typename OriginalTask, size_t Arity, typename Iter, typename Task>
-		void enqueue_for_each_with_iterators_batch(size_t shared_queue_index,
-												   Iter batch_start,
-												   Iter batch_end,
-												   [[maybe_unused]] size_t batch_index,
-												   Task&& task) noexcept
-		{
-			static_assert(std::is_reference_v<OriginalTask>);
-			static_assert(std::is_same_v<std::remove_reference_t<OriginalTask>, std::remove_reference_t<Task>>);
-			static_assert(Arity <= 2);
+		alignas(T) unsigned char value_[sizeof(T)];
+		bool has_value_ = false;
 
-			MUU_ASSERT(batch_index < workers());
+	  public:
+		MUU_NODISCARD_CTOR
+		task_promise() noexcept = default;
 
-			const auto queue_index = shared_queue_index == no_available_queue //
-									   ? ::muu_impl_thread_pool_lock(storage_)
-									   : shared_queue_index;
+		~task_promise() noexcept
+		{
+			if (has_value_)
+				result().~T();
+		}
 
-			enqueue(queue_index,
-					[=, batch = wrap_batched_task<OriginalTask>(static_cast<Task&&>(task))]() mutable noexcept
-					{
-						while (batch_start != batch_end)
-						{
-							if constexpr (Arity == 2)
-								batch(*batch_start, batch_index);
-							else
-								batch(*batch_start);
+		MUU_DELETE_COPY(task_promise);
+		MUU_DELETE_MOVE(task_promise);
 
-							std::advance(batch_start, 1);
-						}
-					});
+		MUU_NODISCARD
+		task<T> get_return_object() noexcept;
 
-			if (shared_queue_index == no_available_queue)
-				::muu_impl_thread_pool_unlock(storage_, queue_index);
+		template <typename U = T>
+		void return_value(U&& value) noexcept
+		{
+			MUU_ASSERT(!has_value_);
+
+			::new (static_cast<void*>(value_)) T(static_cast<U&&>(value));
+			has_value_ = true;
 		}
 
-		template <typename Begin, typename Task>
-		thread_pool& for_each_with_iterators(Begin begin, size_t job_count, Task&& task) noexcept
+		MUU_PURE_INLINE_GETTER
+		T& result() noexcept
 		{
-			using elem_reference = impl::iter_reference_t<Begin>;
-			static_assert(
-				std::is_nothrow_invocable_v<Task&, elem_reference, size_t> //
-					|| std::is_nothrow_invocable_v<Task&, elem_reference>  //
-					|| std::is_nothrow_invocable_v<Task&>,
-				"Tasks passed to thread_pool::for_each() must be callable as void() noexcept, void(T) noexcept or "
-				"void(T, size_t) noexcept");
+			MUU_ASSERT(has_value_);
 
-			// determine batch count and distribute iterators
-			const auto worker_count = this->workers();
-			auto batch_generator	= impl::batch_size_generator<size_t>{ job_count, worker_count };
-			size_t next_batch_size	= batch_generator();
-			auto batch_start		= begin;
-			auto batch_end			= std::next(begin, static_cast<ptrdiff_t>(next_batch_size));
-			size_t batch_index		= 0u;
-			auto batch_count		= muu::min(job_count, worker_count);
+			return *MUU_LAUNDER(reinterpret_cast<T*>(value_));
+		}
 
-			// try to get a shared queue for all the allocations
-			const auto shared_queue_index = ::muu_impl_thread_pool_lock_multiple(storage_, batch_count);
+		void deliver() noexcept
+		{
+			this->future_->set(static_cast<T&&>(result()));
+			std::exchange(this->future_, nullptr)->release();
+		}
+	};
 
-			// dispatch tasks
-			static constexpr size_t task_arity =
-				(std::is_nothrow_invocable_v<Task&, elem_reference, size_t>
-					 ? 2
-					 : (std::is_nothrow_invocable_v<Task&, elem_reference, size_t> ? 1 : 0));
-			while (true)
-			{
-				next_batch_size = batch_generator();
-				if (next_batch_size)
-				{
-					enqueue_for_each_with_iterators_batch<Task&&, task_arity>(shared_queue_index,
-																			  batch_start,
-																			  batch_end,
-																			  batch_index,
-																			  task);
-					batch_start = batch_end;
-					std::advance(batch_end, static_cast<ptrdiff_t>(next_batch_size));
-				}
-				else
-				{
-					enqueue_for_each_with_iterators_batch<Task&&, task_arity>(shared_queue_index,
-																			  batch_start,
-																			  batch_end,
-																			  batch_index,
-																			  static_cast<Task&&>(task));
-					break;
-				}
-				batch_index++;
-			}
+	template <>
+	class task_promise<void> : public task_promise_base<void>
+	{
+	  public:
+		MUU_NODISCARD
+		task<void> get_return_object() noexcept;
 
-			// unlock shared queue
-			if (shared_queue_index != no_available_queue)
-				::muu_impl_thread_pool_unlock(storage_, shared_queue_index);
+		constexpr void return_void() const noexcept
+		{}
 
-			return *this;
+		void deliver() noexcept
+		{
+			this->future_->set();
+			std::exchange(this->future_, nullptr)->release();
 		}
+	};
+}
+/// \endcond
 
+namespace muu
+{
+	/// \brief	A lazily-started coroutine that can run on a muu::thread_pool.
+	///
+	/// \details	A task doesn't start running until it is either awaited by another coroutine (in which case it
+	/// 			runs on the awaiting thread and resumes the awaiter when it finishes), or passed to
+	/// 			thread_pool::spawn(). Use `co_await pool.schedule()` to move a running task onto the pool:
+	/// \cpp
+	/// muu::task<int> square(muu::thread_pool& pool, int x)
+	/// {
+	///		co_await pool.schedule(); // now running on one of the pool's workers
+	///		co_return x * x;
+	/// }
+	///
+	/// muu::task<int> sum_of_squares(muu::thread_pool& pool, int n)
+	/// {
+	///		int sum = 0;
+	///		for (int i = 0; i < n; i++)
+	///			sum += co_await square(pool, i);
+	///		co_return sum;
+	/// }
+	///
+	/// muu::thread_pool pool;
+	/// std::cout << pool.spawn(sum_of_squares(pool, 10)).get() << "\n"; // 285
+	/// \ecpp
+	///
+	/// The coroutine frames of tasks taking a muu::thread_pool& argument (among their first eight) are allocated from
+	/// that pool's internal freelists rather than the global heap.
+	///
+	/// \warning	Exceptions escaping the coroutine body call std::terminate(). A task whose frame was allocated
+	/// 			from a pool (or which is awaiting something scheduled on one) must not outlive the pool.
+	///
+	/// \tparam	T	The task's result type.
+	template <typename T /* = void */>
+	class task
+	{
 	  public:
-		/// \brief	Enqueues a task to execute on every element in a collection.
-		///
-		/// \details	Tasks must be callables which accept at most two arguments: <br>
-		/// 			Argument 0: The current element from the collection <br>
-		/// 			Argument 1: The task's batch (in the range `[0, pool.workers() - 1]`) <br>
-		/// \cpp
-		/// std::array<int, 10> vals;
-		/// pool.for_each(vals.begin(), vals.end(), [](int& i, size_t batch_index) noexcept
-		/// {
-		///		// i is one of the elements of vals
-		///		// batch_index is in the range [0, pool.workers() - 1]
-		///	});
-		/// pool.for_each(vals.begin(), vals.end(), [](int& i) noexcept
-		/// {
-		///		// i is one of the elements of vals
-		///	});
-		/// pool.for_each(vals.begin(), vals.end(), []() noexcept
-		/// {
-		///		// no args is OK too (though unusual)
-		///	});
-		/// \ecpp
-		///
-		/// \remarks Tasks must be finite, otherwise the pool will fill and wait() calls will never return.
-		/// \remarks Tasks must not throw exceptions.
-		///
-		/// \warning Do not call this from one of the thread_pool's workers.
-		///
-		/// \tparam	Iter 		Collection iterator type.
-		/// \tparam	Task		The type of the task being enqueued.
-		/// \param	begin		Iterator to the beginning of the collection.
-		/// \param	end			Iterator to the end of the collection.
-		/// \param	task  		The task to execute for each member of the collection.
-		///
-		/// \return	A reference to the thread pool.
-		MUU_CONSTRAINED_TEMPLATE(!muu::is_integral<Iter>, typename Iter, typename Task)
-		thread_pool& for_each(Iter begin, Iter end, Task&& task) noexcept
+		/// \brief	The coroutine's promise type.
+		using promise_type = impl::task_promise<T>;
+
+	  private:
+		std::coroutine_handle<promise_type> handle_;
+
+		friend class thread_pool;
+		friend class impl::task_promise<T>;
+
+		MUU_NODISCARD_CTOR
+		explicit task(std::coroutine_handle<promise_type> handle) noexcept //
+			: handle_{ handle }
+		{}
+
+		struct awaiter
 		{
-			if constexpr (has_less_than_or_equal_operator<Iter>)
+			std::coroutine_handle<promise_type> handle;
+
+			MUU_PURE_INLINE_GETTER
+			bool await_ready() const noexcept
 			{
-				if (end <= begin)
-					return *this;
+				return !handle || handle.done();
 			}
-			else
+
+			std::coroutine_handle<> await_suspend(std::coroutine_handle<> continuation) noexcept
 			{
-				if constexpr (has_less_than_operator<Iter>)
-				{
-					if (end < begin)
-						return *this;
-				}
-				if (begin == end)
-					return *this;
+				handle.promise().continuation_ = continuation;
+				return handle;
 			}
 
-			const auto job_count = iterator_distance(begin, end);
-			if (job_count <= 0)
-				return *this;
+			T await_resume() const noexcept
+			{
+				MUU_ASSERT(handle && "task is not valid");
+
+				if constexpr (!std::is_void_v<T>)
+					return static_cast<T&&>(handle.promise().result());
+			}
+		};
+
+	  public:
+		/// \brief	Default constructor. Constructs an invalid task.
+		MUU_NODISCARD_CTOR
+		task() noexcept = default;
+
+		/// \brief	Move constructor.
+		MUU_NODISCARD_CTOR
+		task(task&& other) noexcept //
+			: handle_{ std::exchange(other.handle_, nullptr) }
+		{}
 
-			return for_each_with_iterators(begin, static_cast<size_t>(job_count), static_cast<Task&&>(task));
+		/// \brief	Move-assignment operator.
+		task& operator=(task&& rhs) noexcept
+		{
+			if (this != &rhs)
+			{
+				if (handle_)
+					handle_.destroy();
+				handle_ = std::exchange(rhs.handle_, nullptr);
+			}
+			return *this;
 		}
 
-		/// \brief	Enqueues a task to execute on every element in a collection.
-		///
-		/// \details	Tasks must be callables which accept at most two arguments: <br>
-		/// 			Argument 0: The current element from the collection <br>
-		/// 			Argument 1: The task's batch (in the range `[0, pool.workers() - 1]`) <br>
-		/// \cpp
-		/// std::array<int, 10> vals;
-		/// pool.for_each(vals, [](int& i, size_t batch_index) noexcept
-		/// {
-		///		// i is one of the elements of vals
-		///		// batch_index is in the range [0, pool.workers() - 1]
-		///	});
-		/// pool.for_each(vals, [](int& i) noexcept
-		/// {
-		///		// i is one of the elements of vals
-		///	});
-		/// pool.for_each(vals, []() noexcept
-		/// {
-		///		// no args is OK too (though unusual)
-		///	});
-		/// \ecpp
-		///
-		/// \remarks Tasks must be finite, otherwise the pool will fill and wait() calls will never return.
-		/// \remarks Tasks must not throw exceptions.
-		///
-		/// \warning Do not call this from one of the thread_pool's workers.
-		///
-		/// \tparam	T 			Type of the collection.
-		/// \tparam	Task		The type of the task being enqueued.
-		/// \param	collection	The collection.
-		/// \param	task  		The task to execute for each member of the collection.
+		MUU_DELETE_COPY(task);
+
+		/// \brief	Destructor. Destroys the coroutine.
 		///
-		/// \return	A reference to the thread pool.
-		MUU_CONSTRAINED_TEMPLATE((!muu::is_integral<T> && muu::is_iterable<T&&>), typename T, typename Task)
-		MUU_ALWAYS_INLINE
-		thread_pool& for_each(T&& collection, Task&& task) noexcept
+		/// \warning	A task must not be destroyed while its coroutine is running.
+		~task() noexcept
 		{
-#define iterator_based_foreach()                                                                                       \
-	for_each(begin_iterator(static_cast<T&&>(collection)),                                                             \
-			 end_iterator(static_cast<T&&>(collection)),                                                               \
-			 static_cast<Task&&>(task))
+			if (handle_)
+				handle_.destroy();
+		}
 
-			using it_type = decltype(begin_iterator(static_cast<T&&>(collection)));
+		/// \brief	Returns true if the task refers to a coroutine.
+		MUU_PURE_INLINE_GETTER
+		bool valid() const noexcept
+		{
+			return static_cast<bool>(handle_);
+		}
 
-			// fallback to .data() when the iterator is large (e.g. MSVC iterator debugging =/)
-			if constexpr (sizeof(it_type) > sizeof(void*)		//
-						  && muu::has_data_member_function<T&&> //
-						  && muu::has_size_member_function<T&&>)
-			{
-				using it_ptr_type = remove_cvref<decltype(&(*begin_iterator(static_cast<T&&>(collection))))>;
-				using data_type	  = remove_cvref<decltype(static_cast<T&&>(collection).data())>;
+		/// \brief	Returns true if the task refers to a coroutine.
+		MUU_PURE_INLINE_GETTER
+		explicit operator bool() const noexcept
+		{
+			return static_cast<bool>(handle_);
+		}
 
-				if constexpr (std::is_same_v<it_ptr_type, data_type>)
-				{
-					return for_each(static_cast<T&&>(collection).data(),
-									static_cast<T&&>(collection).data() + static_cast<T&&>(collection).size(),
-									static_cast<Task&&>(task));
-				}
-				else
-					return iterator_based_foreach();
-			}
-			else
-				return iterator_based_foreach();
+		/// \brief	Returns true if the task's coroutine has finished.
+		MUU_PURE_INLINE_GETTER
+		bool done() const noexcept
+		{
+			MUU_ASSERT(handle_ && "task is not valid");
 
-#undef iterator_based_foreach
+			return handle_.done();
+		}
+
+		/// \brief	Starts the task (if necessary) and suspends the awaiting coroutine until it has finished.
+		///
+		/// \returns	An awaitable yielding the task's result.
+		MUU_NODISCARD
+		awaiter operator co_await() && noexcept
+		{
+			return awaiter{ handle_ };
 		}
 	};
+
+	/// \cond
+
+	template <typename T>
+	inline task<T> impl::task_promise<T>::get_return_object() noexcept
+	{
+		return task<T>{ std::coroutine_handle<task_promise>::from_promise(*this) };
+	}
+
+	inline task<void> impl::task_promise<void>::get_return_object() noexcept
+	{
+		return task<void>{ std::coroutine_handle<task_promise>::from_promise(*this) };
+	}
+
+	/// \endcond
 }
 
+#endif // MUU_HAS_COROUTINES
+
 MUU_RESET_NDEBUG_OPTIMIZATIONS;
 #include "impl/header_end.h"
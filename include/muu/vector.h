@@ -49,6 +49,7 @@
 #include "impl/std_initializer_list.h"
 #include "impl/vector_types_common.h"
 #include "impl/vector_base.h"
+#include "impl/vector_simd.h"
 #include "impl/core_utils.h"
 #include "impl/header_start.h"
 MUU_FORCE_NDEBUG_OPTIMIZATIONS;
@@ -206,6 +207,27 @@ MUU_PRAGMA_MSVC(float_control(except, off))
 
 #define COMPONENTWISE_ASSIGN(func) COMPONENTWISE_CASTING_OP(func, COMPONENTWISE_ASSIGN_WITH_TRANSFORM)
 
+// runtime-only SIMD fast path (see impl/vector_simd.h); falls through to the scalar code in constant evaluation
+#define SIMD_RETURN(func, ...)                                                                                         \
+	if constexpr (impl::has_vector_simd_<Scalar, Dimensions> && build::supports_is_constant_evaluated)                 \
+	{                                                                                                                  \
+		MUU_IF_RUNTIME                                                                                                 \
+		{                                                                                                              \
+			return impl::vector_simd<Scalar, Dimensions>::func(__VA_ARGS__);                                           \
+		}                                                                                                              \
+	}                                                                                                                  \
+	static_assert(true)
+
+#define SIMD_ASSIGN(func, ...)                                                                                         \
+	if constexpr (impl::has_vector_simd_<Scalar, Dimensions> && build::supports_is_constant_evaluated)                 \
+	{                                                                                                                  \
+		MUU_IF_RUNTIME                                                                                                 \
+		{                                                                                                              \
+			return *this = impl::vector_simd<Scalar, Dimensions>::func(__VA_ARGS__);                                   \
+		}                                                                                                              \
+	}                                                                                                                  \
+	static_assert(true)
+
 #define SPECIALIZED_IF(cond) , bool = (cond)
 
 /// \endcond
@@ -1073,6 +1095,8 @@ namespace muu
 		MUU_PURE_GETTER
 		static constexpr delta_scalar_type MUU_VECTORCALL length_squared(MUU_VPARAM(vector) v) noexcept
 		{
+			SIMD_RETURN(length_squared, v);
+
 			if constexpr (delta_requires_promotion)
 			{
 				return static_cast<delta_scalar_type>(promoted_delta_vec::length_squared(promoted_delta_vec{ v }));
@@ -1220,6 +1244,8 @@ namespace muu
 		MUU_PURE_GETTER
 		static constexpr product_scalar_type MUU_VECTORCALL dot(MUU_VPARAM(vector) v1, MUU_VPARAM(vector) v2) noexcept
 		{
+			SIMD_RETURN(dot, v1, v2);
+
 			if constexpr (product_requires_promotion)
 			{
 				return static_cast<product_scalar_type>(
@@ -1422,6 +1448,8 @@ namespace muu
 		MUU_PURE_GETTER
 		friend constexpr vector MUU_VECTORCALL operator+(MUU_VPARAM(vector) lhs, MUU_VPARAM(vector) rhs) noexcept
 		{
+			SIMD_RETURN(add, lhs, rhs);
+
 			if constexpr (is_small_float)
 			{
 				return vector{ promoted_vec{ lhs } + promoted_vec{ rhs } };
@@ -1441,6 +1469,8 @@ namespace muu
 		/// \brief Componentwise adds another vector to this one.
 		constexpr vector& MUU_VECTORCALL operator+=(MUU_VPARAM(vector) rhs) noexcept
 		{
+			SIMD_ASSIGN(add, *this, rhs);
+
 			if constexpr (is_small_float)
 			{
 				return *this = vector{ promoted_vec{ *this } + promoted_vec{ rhs } };
@@ -1516,6 +1546,8 @@ namespace muu
 		MUU_PURE_GETTER
 		friend constexpr vector MUU_VECTORCALL operator-(MUU_VPARAM(vector) lhs, MUU_VPARAM(vector) rhs) noexcept
 		{
+			SIMD_RETURN(sub, lhs, rhs);
+
 			if constexpr (is_small_float)
 			{
 				return vector{ promoted_vec{ lhs } - promoted_vec{ rhs } };
@@ -1535,6 +1567,8 @@ namespace muu
 		/// \brief Componentwise subtracts another vector from this one.
 		constexpr vector& MUU_VECTORCALL operator-=(MUU_VPARAM(vector) rhs) noexcept
 		{
+			SIMD_ASSIGN(sub, *this, rhs);
+
 			if constexpr (is_small_float)
 			{
 				return *this = vector{ promoted_vec{ *this } - promoted_vec{ rhs } };
@@ -1556,6 +1590,8 @@ namespace muu
 		MUU_PURE_GETTER
 		constexpr vector operator-() const noexcept
 		{
+			SIMD_RETURN(negate, *this);
+
 			// clang-format off
 
 			#define VEC_FUNC(member) -base::member
@@ -1576,6 +1612,8 @@ namespace muu
 		MUU_PURE_GETTER
 		friend constexpr vector MUU_VECTORCALL operator*(MUU_VPARAM(vector) lhs, MUU_VPARAM(vector) rhs) noexcept
 		{
+			SIMD_RETURN(mul, lhs, rhs);
+
 			if constexpr (is_small_float)
 			{
 				return vector{ promoted_vec{ lhs } * promoted_vec{ rhs } };
@@ -1595,6 +1633,8 @@ namespace muu
 		/// \brief Componentwise multiplies this vector by another.
 		constexpr vector& MUU_VECTORCALL operator*=(MUU_VPARAM(vector) rhs) noexcept
 		{
+			SIMD_ASSIGN(mul, *this, rhs);
+
 			if constexpr (is_small_float)
 			{
 				return *this = vector{ promoted_vec{ *this } * promoted_vec{ rhs } };
@@ -1615,6 +1655,8 @@ namespace muu
 		MUU_PURE_GETTER
 		friend constexpr vector MUU_VECTORCALL operator*(MUU_VPARAM(vector) lhs, scalar_type rhs) noexcept
 		{
+			SIMD_RETURN(mul, lhs, rhs);
+
 			if constexpr (is_small_float)
 			{
 				return vector{ promoted_vec{ lhs } * static_cast<promoted_scalar>(rhs) };
@@ -1641,6 +1683,8 @@ namespace muu
 		/// \brief Componentwise multiplies this vector by a scalar.
 		constexpr vector& MUU_VECTORCALL operator*=(scalar_type rhs) noexcept
 		{
+			SIMD_ASSIGN(mul, *this, rhs);
+
 			if constexpr (is_small_float)
 			{
 				return *this = vector{ promoted_vec{ *this } * static_cast<promoted_scalar>(rhs) };
@@ -1709,6 +1753,8 @@ namespace muu
 		MUU_PURE_GETTER
 		friend constexpr vector MUU_VECTORCALL operator/(MUU_VPARAM(vector) lhs, MUU_VPARAM(vector) rhs) noexcept
 		{
+			SIMD_RETURN(div, lhs, rhs);
+
 			if constexpr (is_small_float)
 			{
 				return vector{ promoted_vec{ lhs } / promoted_vec{ rhs } };
@@ -1728,6 +1774,8 @@ namespace muu
 		/// \brief Componentwise divides this vector by another.
 		constexpr vector& MUU_VECTORCALL operator/=(MUU_VPARAM(vector) rhs) noexcept
 		{
+			SIMD_ASSIGN(div, *this, rhs);
+
 			if constexpr (is_small_float)
 			{
 				return *this = vector{ promoted_vec{ *this } / promoted_vec{ rhs } };
@@ -2003,6 +2051,8 @@ namespace muu
 		MUU_NODISCARD
 		static constexpr vector MUU_VECTORCALL normalize(MUU_VPARAM(vector) v, delta_scalar_type& length_out) noexcept
 		{
+			SIMD_RETURN(normalize, v, length_out);
+
 			if constexpr (Dimensions == 1)
 			{
 				length_out = static_cast<delta_scalar_type>(v.x);
@@ -2034,6 +2084,8 @@ namespace muu
 		MUU_PURE_GETTER
 		static constexpr vector MUU_VECTORCALL normalize(MUU_VPARAM(vector) v) noexcept
 		{
+			SIMD_RETURN(normalize, v);
+
 			if constexpr (Dimensions == 1)
 			{
 				MUU_UNUSED(v);
@@ -2390,6 +2442,8 @@ namespace muu
 				return vector::min(v1, vector::min(v2, vecs...));
 			else
 			{
+				SIMD_RETURN(min, v1, v2);
+
 				// clang-format off
 
 				#define VEC_FUNC(member) muu::min(v1.member, v2.member)
@@ -2441,6 +2495,8 @@ namespace muu
 				return vector::max(v1, vector::max(v2, vecs...));
 			else
 			{
+				SIMD_RETURN(max, v1, v2);
+
 				// clang-format off
 
 				#define VEC_FUNC(member) muu::max(v1.member, v2.member)
@@ -2670,6 +2726,8 @@ namespace muu
 													MUU_VPARAM(vector) finish,
 													delta_scalar_type alpha) noexcept
 		{
+			SIMD_RETURN(lerp, start, finish, alpha);
+
 			if constexpr (delta_requires_promotion)
 			{
 				return vector{ promoted_delta_vec::lerp(promoted_delta_vec{ start },
@@ -3774,6 +3832,8 @@ namespace muu
 #undef COMPONENTWISE_ASSIGN_WITH_TRANSFORM
 #undef COMPONENTWISE_ASSIGN
 #undef IDENTITY_TRANSFORM
+#undef SIMD_RETURN
+#undef SIMD_ASSIGN
 #undef SPECIALIZED_IF
 
 MUU_RESET_NDEBUG_OPTIMIZATIONS;
@@ -0,0 +1,788 @@
+// This file is a part of muu and is subject to the the terms of the MIT license.
+// Copyright (c) Mark Gillard <mark.gillard@outlook.com.au>
+// See https://github.com/marzer/muu/blob/master/LICENSE for the full license text.
+// SPDX-License-Identifier: MIT
+#pragma once
+
+/// \file
+/// \brief  Contains the definition of muu::vector_soa.
+
+#include "vector.h"
+#include "span.h"
+#include "bit_floor.h"
+#include "for_sequence.h"
+#include "impl/header_start.h"
+MUU_FORCE_NDEBUG_OPTIMIZATIONS;
+MUU_DISABLE_ARITHMETIC_WARNINGS;
+MUU_PRAGMA_MSVC(float_control(except, off))
+
+//======================================================================================================================
+// IMPLEMENTATION DETAILS
+//======================================================================================================================
+/// \cond
+
+// the lane array of dimension 'dim' (a std::integral_constant from for_sequence) of packet 'v'
+#define SOA_GET(v, dim) v.template get<decltype(dim)::value>()
+
+namespace muu::impl
+{
+	// each component array starts on a boundary suitable for the widest load that covers it (capped at a cache line)
+	template <typename Scalar, size_t Width>
+	inline constexpr size_t vector_soa_alignment =
+		muu::max(alignof(Scalar), muu::min(muu::bit_floor(sizeof(Scalar) * Width), size_t{ 64 }));
+
+	template <typename Scalar, size_t Dimensions, size_t Width>
+	struct vector_soa_base;
+
+	template <typename Scalar, size_t Width>
+	struct vector_soa_base<Scalar, 1, Width>
+	{
+		alignas(vector_soa_alignment<Scalar, Width>) Scalar x[Width];
+	};
+
+	template <typename Scalar, size_t Width>
+	struct vector_soa_base<Scalar, 2, Width>
+	{
+		alignas(vector_soa_alignment<Scalar, Width>) Scalar x[Width];
+		alignas(vector_soa_alignment<Scalar, Width>) Scalar y[Width];
+	};
+
+	template <typename Scalar, size_t Width>
+	struct vector_soa_base<Scalar, 3, Width>
+	{
+		alignas(vector_soa_alignment<Scalar, Width>) Scalar x[Width];
+		alignas(vector_soa_alignment<Scalar, Width>) Scalar y[Width];
+		alignas(vector_soa_alignment<Scalar, Width>) Scalar z[Width];
+	};
+
+	template <typename Scalar, size_t Width>
+	struct vector_soa_base<Scalar, 4, Width>
+	{
+		alignas(vector_soa_alignment<Scalar, Width>) Scalar x[Width];
+		alignas(vector_soa_alignment<Scalar, Width>) Scalar y[Width];
+		alignas(vector_soa_alignment<Scalar, Width>) Scalar z[Width];
+		alignas(vector_soa_alignment<Scalar, Width>) Scalar w[Width];
+	};
+}
+
+/// \endcond
+
+//======================================================================================================================
+// VECTOR SOA
+//======================================================================================================================
+
+namespace muu
+{
+	/// \brief A packet of vectors stored in structure-of-arrays layout.
+	/// \ingroup math
+	///
+	/// \details A `vector_soa<float, 3, 8>` holds eight three-dimensional vectors as `x[8]`, `y[8]` and `z[8]`,
+	///			 so every operation is a straight loop over contiguous, aligned lanes that the compiler can map onto
+	///			 whatever SIMD width the target has. It has the same arithmetic operators and free functions as
+	///			 muu::vector; functions that produce one scalar per vector (dot(), length() etc.) return a
+	///			 single-component packet (#scalar_lanes_type).
+	///
+	/// \cpp
+	/// std::vector<muu::vector<float, 3>> positions = ...;
+	/// std::vector<muu::vector<float, 3>> velocities = ...;
+	///
+	/// using packet = muu::vector_soa<float, 3, 8>;
+	/// std::vector<packet> pos(packet::packet_count(positions.size()));
+	/// std::vector<packet> vel(pos.size());
+	/// packet::gather({ positions.data(), positions.size() }, { pos.data(), pos.size() });
+	/// packet::gather({ velocities.data(), velocities.size() }, { vel.data(), vel.size() });
+	///
+	/// for (size_t i = 0; i < pos.size(); i++)
+	///		pos[i] += vel[i] * delta_time;
+	///
+	/// packet::scatter({ pos.data(), pos.size() }, { positions.data(), positions.size() });
+	/// \ecpp
+	///
+	/// \tparam	Scalar      The scalar component type. Must be a floating-point type (and not a 'small' float).
+	/// \tparam Dimensions  The number of dimensions in each vector (1-4).
+	/// \tparam Width		The number of vectors (lanes) in the packet.
+	///
+	/// \see muu::vector
+	template <typename Scalar, size_t Dimensions, size_t Width>
+	struct MUU_TRIVIAL_ABI vector_soa //
+		MUU_HIDDEN_BASE(impl::vector_soa_base<Scalar, Dimensions, Width>)
+	{
+		static_assert(!is_cvref<Scalar>, "SoA vector scalar type cannot be const, volatile, or a reference");
+		static_assert(is_floating_point<Scalar> && !impl::is_small_float_<Scalar>,
+					  "SoA vector scalar type must be a floating-point type with at least single precision");
+		static_assert(Dimensions >= 1 && Dimensions <= 4, "SoA vectors must have between one and four dimensions");
+		static_assert(Width >= 1, "SoA vectors must have at least one lane");
+
+		/// \brief The number of scalar components in each vector.
+		static constexpr size_t dimensions = Dimensions;
+
+		/// \brief The number of vectors (lanes) in the packet.
+		static constexpr size_t width = Width;
+
+		/// \brief The type of each scalar component stored in this packet.
+		using scalar_type = Scalar;
+
+		/// \brief The (array-of-structures) vector type stored in each lane.
+		using vector_type = vector<scalar_type, dimensions>;
+
+		/// \brief A packet holding one scalar per lane (e.g. the result of dot()).
+		using scalar_lanes_type = vector_soa<scalar_type, 1, width>;
+
+	  private:
+		/// \cond
+
+		template <typename, size_t, size_t>
+		friend struct vector_soa;
+
+		using base = impl::vector_soa_base<Scalar, Dimensions, Width>;
+
+		// out[dim][lane] = func(dim, lane)
+		template <typename Func>
+		MUU_ALWAYS_INLINE
+		static constexpr vector_soa MUU_VECTORCALL componentwise(Func&& func) noexcept
+		{
+			vector_soa out{};
+			for_sequence<Dimensions>(
+				[&](auto dim) noexcept
+				{
+					auto& dest = out.template get<decltype(dim)::value>();
+					for (size_t lane = 0; lane < Width; lane++)
+						dest[lane] = func(dim, lane);
+				});
+			return out;
+		}
+
+		template <typename Func>
+		MUU_ALWAYS_INLINE
+		constexpr vector_soa& MUU_VECTORCALL componentwise_assign(Func&& func) noexcept
+		{
+			for_sequence<Dimensions>(
+				[&](auto dim) noexcept
+				{
+					auto& dest = this->template get<decltype(dim)::value>();
+					for (size_t lane = 0; lane < Width; lane++)
+						dest[lane] = func(dim, lane);
+				});
+			return *this;
+		}
+
+		/// \endcond
+
+	  public:
+#if 1 // constructors ---------------------------------------------------------------------------------------------
+
+		/// \brief Default constructor. Values are not initialized.
+		MUU_NODISCARD_CTOR
+		vector_soa() noexcept = default;
+
+		/// \brief Copy constructor.
+		MUU_NODISCARD_CTOR
+		constexpr vector_soa(const vector_soa&) noexcept = default;
+
+		/// \brief Copy-assigment operator.
+		constexpr vector_soa& operator=(const vector_soa&) noexcept = default;
+
+		/// \brief	Constructs a packet with every scalar component of every lane set to the same value.
+		MUU_NODISCARD_CTOR
+		explicit constexpr vector_soa(scalar_type fill) noexcept //
+			: base{}
+		{
+			componentwise_assign([=](auto, size_t) noexcept { return fill; });
+		}
+
+		/// \brief	Constructs a packet with every lane set to the same vector.
+		MUU_NODISCARD_CTOR
+		explicit constexpr vector_soa(const vector_type& vec) noexcept //
+			: base{}
+		{
+			componentwise_assign([&](auto dim, size_t) noexcept { return SOA_GET(vec, dim); });
+		}
+
+		/// \brief	Constructs a packet by gathering vectors from an array-of-structures span.
+		///
+		/// \see gather()
+		MUU_NODISCARD_CTOR
+		explicit constexpr vector_soa(span<const vector_type> vectors) noexcept //
+			: base{}
+		{
+			*this = gather(vectors);
+		}
+
+#endif // constructors
+
+#if 1 // scalar component accessors -------------------------------------------------------------------------------
+
+		/// \brief Returns a reference to the lane array of the Nth scalar component.
+		///
+		/// \tparam Dimension The index of the dimension to retrieve, where X == 0, Y == 1, etc.
+		template <size_t Dimension>
+		MUU_PURE_INLINE_GETTER
+		constexpr auto& get() noexcept
+		{
+			static_assert(Dimension < Dimensions, "Element index out of range");
+
+			if constexpr (Dimension == 0)
+				return base::x;
+			if constexpr (Dimension == 1)
+				return base::y;
+			if constexpr (Dimension == 2)
+				return base::z;
+			if constexpr (Dimension == 3)
+				return base::w;
+		}
+
+		/// \brief Returns a const reference to the lane array of the Nth scalar component.
+		///
+		/// \tparam Dimension The index of the dimension to retrieve, where X == 0, Y == 1, etc.
+		template <size_t Dimension>
+		MUU_PURE_INLINE_GETTER
+		constexpr const auto& get() const noexcept
+		{
+			static_assert(Dimension < Dimensions, "Element index out of range");
+
+			if constexpr (Dimension == 0)
+				return base::x;
+			if constexpr (Dimension == 1)
+				return base::y;
+			if constexpr (Dimension == 2)
+				return base::z;
+			if constexpr (Dimension == 3)
+				return base::w;
+		}
+
+		/// \brief Returns the vector stored in a lane.
+		MUU_PURE_GETTER
+		constexpr vector_type lane(size_t index) const noexcept
+		{
+			MUU_CONSTEXPR_SAFE_ASSERT(index < Width && "lane index out of range");
+
+			vector_type out{};
+			for_sequence<Dimensions>([&](auto dim) noexcept { SOA_GET(out, dim) = SOA_GET((*this), dim)[index]; });
+			return out;
+		}
+
+		/// \brief Sets the vector stored in a lane.
+		///
+		/// \return	A reference to the packet.
+		constexpr vector_soa& lane(size_t index, const vector_type& vec) noexcept
+		{
+			MUU_CONSTEXPR_SAFE_ASSERT(index < Width && "lane index out of range");
+
+			for_sequence<Dimensions>([&](auto dim) noexcept { SOA_GET((*this), dim)[index] = SOA_GET(vec, dim); });
+			return *this;
+		}
+
+#endif // scalar component accessors
+
+#if 1 // gather/scatter -------------------------------------------------------------------------------------------
+		/// \name Gather & Scatter
+		/// @{
+
+		/// \brief	Returns the number of packets needed to hold a number of vectors.
+		MUU_CONST_INLINE_GETTER
+		static constexpr size_t packet_count(size_t vector_count) noexcept
+		{
+			return (vector_count + (Width - 1u)) / Width;
+		}
+
+		/// \brief	Loads up to #width vectors from an array-of-structures span into a packet.
+		///
+		/// \details Lanes beyond the end of the span are zero-filled.
+		MUU_PURE_GETTER
+		static constexpr vector_soa gather(span<const vector_type> vectors) noexcept
+		{
+			vector_soa out{};
+
+			// all components in the same loop (and a constant trip count where possible) so the compiler
+			// sees an interleaved load it can vectorize with shuffles
+			const auto gather_lanes = [&](size_t count) noexcept
+			{
+				for (size_t lane = 0; lane < count; lane++)
+					for_sequence<Dimensions>([&](auto dim) noexcept
+											 { SOA_GET(out, dim)[lane] = SOA_GET(vectors[lane], dim); });
+			};
+			if (vectors.size() >= Width)
+				gather_lanes(Width);
+			else
+				gather_lanes(vectors.size());
+
+			return out;
+		}
+
+		/// \brief	Stores up to #width lanes out to an array-of-structures span.
+		///
+		/// \details Lanes beyond the end of the span are ignored.
+		constexpr void scatter(span<vector_type> vectors) const noexcept
+		{
+			// see gather()
+			const auto scatter_lanes = [&](size_t count) noexcept
+			{
+				for (size_t lane = 0; lane < count; lane++)
+					for_sequence<Dimensions>([&](auto dim) noexcept
+											 { SOA_GET(vectors[lane], dim) = SOA_GET((*this), dim)[lane]; });
+			};
+			if (vectors.size() >= Width)
+				scatter_lanes(Width);
+			else
+				scatter_lanes(vectors.size());
+		}
+
+		/// \brief	Converts an entire array-of-structures span into packets.
+		///
+		/// \details The unused lanes of the last packet are zero-filled.
+		///
+		/// \param	vectors	The source vectors.
+		/// \param	packets	The destination packets. Must hold at least `packet_count(vectors.size())` packets.
+		static constexpr void gather(span<const vector_type> vectors, span<vector_soa> packets) noexcept
+		{
+			MUU_CONSTEXPR_SAFE_ASSERT(packets.size() >= packet_count(vectors.size()) && "not enough packets");
+
+			for (size_t i = 0, e = packet_count(vectors.size()); i < e; i++)
+				packets[i] = gather(vectors.subspan(i * Width));
+		}
+
+		/// \brief	Converts an entire span of packets back into array-of-structures vectors.
+		///
+		/// \param	packets	The source packets.
+		/// \param	vectors	The destination vectors. Any lanes beyond the end of this span are ignored.
+		static constexpr void scatter(span<const vector_soa> packets, span<vector_type> vectors) noexcept
+		{
+			for (size_t i = 0, e = muu::min(packets.size(), packet_count(vectors.size())); i < e; i++)
+				packets[i].scatter(vectors.subspan(i * Width));
+		}
+
+		/// @}
+#endif // gather/scatter
+
+#if 1 // equality -------------------------------------------------------------------------------------------------
+		/// \name Equality
+		/// @{
+
+		/// \brief		Returns true if every lane of two packets is exactly equal.
+		MUU_PURE_GETTER
+		friend constexpr bool MUU_VECTORCALL operator==(const vector_soa& lhs, const vector_soa& rhs) noexcept
+		{
+			bool eq = true;
+			for_sequence<Dimensions>(
+				[&](auto dim) noexcept
+				{
+					for (size_t lane = 0; lane < Width; lane++)
+						eq = eq && SOA_GET(lhs, dim)[lane] == SOA_GET(rhs, dim)[lane];
+				});
+			return eq;
+		}
+
+		/// \brief	Returns true if any lane of two packets is not exactly equal.
+		MUU_PURE_INLINE_GETTER
+		friend constexpr bool MUU_VECTORCALL operator!=(const vector_soa& lhs, const vector_soa& rhs) noexcept
+		{
+			return !(lhs == rhs);
+		}
+
+		/// @}
+#endif // equality
+
+#if 1 // arithmetic -----------------------------------------------------------------------------------------------
+		/// \name Arithmetic
+		/// @{
+
+		/// \brief Returns the componentwise addition of two packets.
+		MUU_PURE_GETTER
+		friend constexpr vector_soa MUU_VECTORCALL operator+(const vector_soa& lhs, const vector_soa& rhs) noexcept
+		{
+			return componentwise([&](auto dim, size_t i) noexcept
+								 { return SOA_GET(lhs, dim)[i] + SOA_GET(rhs, dim)[i]; });
+		}
+
+		/// \brief Componentwise adds another packet to this one.
+		constexpr vector_soa& MUU_VECTORCALL operator+=(const vector_soa& rhs) noexcept
+		{
+			return componentwise_assign([&](auto dim, size_t i) noexcept
+										{ return SOA_GET((*this), dim)[i] + SOA_GET(rhs, dim)[i]; });
+		}
+
+		/// \brief Returns the componentwise subtraction of two packets.
+		MUU_PURE_GETTER
+		friend constexpr vector_soa MUU_VECTORCALL operator-(const vector_soa& lhs, const vector_soa& rhs) noexcept
+		{
+			return componentwise([&](auto dim, size_t i) noexcept
+								 { return SOA_GET(lhs, dim)[i] - SOA_GET(rhs, dim)[i]; });
+		}
+
+		/// \brief Componentwise subtracts another packet from this one.
+		constexpr vector_soa& MUU_VECTORCALL operator-=(const vector_soa& rhs) noexcept
+		{
+			return componentwise_assign([&](auto dim, size_t i) noexcept
+										{ return SOA_GET((*this), dim)[i] - SOA_GET(rhs, dim)[i]; });
+		}
+
+		/// \brief Returns a componentwise negation of a packet.
+		MUU_PURE_GETTER
+		constexpr vector_soa operator-() const noexcept
+		{
+			return componentwise([&](auto dim, size_t i) noexcept { return -SOA_GET((*this), dim)[i]; });
+		}
+
+		/// \brief Returns the componentwise multiplication of two packets.
+		MUU_PURE_GETTER
+		friend constexpr vector_soa MUU_VECTORCALL operator*(const vector_soa& lhs, const vector_soa& rhs) noexcept
+		{
+			return componentwise([&](auto dim, size_t i) noexcept
+								 { return SOA_GET(lhs, dim)[i] * SOA_GET(rhs, dim)[i]; });
+		}
+
+		/// \brief Componentwise multiplies this packet by another.
+		constexpr vector_soa& MUU_VECTORCALL operator*=(const vector_soa& rhs) noexcept
+		{
+			return componentwise_assign([&](auto dim, size_t i) noexcept
+										{ return SOA_GET((*this), dim)[i] * SOA_GET(rhs, dim)[i]; });
+		}
+
+		/// \brief Returns a packet with every lane scaled by the corresponding lane of a scalar packet.
+		///
+		/// \availability This operator is only available when #dimensions &gt; 1.
+		MUU_HIDDEN_CONSTRAINT(Dims != 1, size_t Dims = Dimensions)
+		MUU_PURE_GETTER
+		friend constexpr vector_soa MUU_VECTORCALL operator*(const vector_soa& lhs,
+															 const scalar_lanes_type& rhs) noexcept
+		{
+			return componentwise([&](auto dim, size_t i) noexcept { return SOA_GET(lhs, dim)[i] * rhs.x[i]; });
+		}
+
+		/// \brief Returns a packet with every component multiplied by a scalar.
+		MUU_PURE_GETTER
+		friend constexpr vector_soa MUU_VECTORCALL operator*(const vector_soa& lhs, scalar_type rhs) noexcept
+		{
+			return componentwise([&](auto dim, size_t i) noexcept { return SOA_GET(lhs, dim)[i] * rhs; });
+		}
+
+		/// \brief Returns a packet with every component multiplied by a scalar.
+		MUU_PURE_INLINE_GETTER
+		friend constexpr vector_soa MUU_VECTORCALL operator*(scalar_type lhs, const vector_soa& rhs) noexcept
+		{
+			return rhs * lhs;
+		}
+
+		/// \brief Multiplies every component of this packet by a scalar.
+		constexpr vector_soa& MUU_VECTORCALL operator*=(scalar_type rhs) noexcept
+		{
+			return componentwise_assign([&](auto dim, size_t i) noexcept { return SOA_GET((*this), dim)[i] * rhs; });
+		}
+
+		/// \brief Returns the componentwise division of two packets.
+		MUU_PURE_GETTER
+		friend constexpr vector_soa MUU_VECTORCALL operator/(const vector_soa& lhs, const vector_soa& rhs) noexcept
+		{
+			return componentwise([&](auto dim, size_t i) noexcept
+								 { return SOA_GET(lhs, dim)[i] / SOA_GET(rhs, dim)[i]; });
+		}
+
+		/// \brief Componentwise divides this packet by another.
+		constexpr vector_soa& MUU_VECTORCALL operator/=(const vector_soa& rhs) noexcept
+		{
+			return componentwise_assign([&](auto dim, size_t i) noexcept
+										{ return SOA_GET((*this), dim)[i] / SOA_GET(rhs, dim)[i]; });
+		}
+
+		/// \brief Returns a packet with every component divided by a scalar.
+		MUU_PURE_GETTER
+		friend constexpr vector_soa MUU_VECTORCALL operator/(const vector_soa& lhs, scalar_type rhs) noexcept
+		{
+			return lhs * (scalar_type{ 1 } / rhs);
+		}
+
+		/// \brief Divides every component of this packet by a scalar.
+		constexpr vector_soa& MUU_VECTORCALL operator/=(scalar_type rhs) noexcept
+		{
+			return *this *= (scalar_type{ 1 } / rhs);
+		}
+
+		/// @}
+#endif // arithmetic
+
+#if 1 // geometry -------------------------------------------------------------------------------------------------
+		/// \name Geometry
+		/// @{
+
+		/// \brief	Returns the dot product of each pair of lanes.
+		MUU_PURE_GETTER
+		static constexpr scalar_lanes_type MUU_VECTORCALL dot(const vector_soa& v1, const vector_soa& v2) noexcept
+		{
+			scalar_lanes_type out{};
+			for (size_t i = 0; i < Width; i++)
+				out.x[i] = v1.x[i] * v2.x[i];
+
+			for_sequence<Dimensions - 1u>(
+				[&](auto d) noexcept
+				{
+					constexpr size_t dim = decltype(d)::value + 1u;
+					for (size_t i = 0; i < Width; i++)
+						out.x[i] += v1.template get<dim>()[i] * v2.template get<dim>()[i];
+				});
+			return out;
+		}
+
+		/// \brief	Returns the dot product of each lane of this packet with another.
+		MUU_PURE_INLINE_GETTER
+		constexpr scalar_lanes_type MUU_VECTORCALL dot(const vector_soa& v) const noexcept
+		{
+			return dot(*this, v);
+		}
+
+		/// \brief	Returns the cross product of each pair of lanes.
+		///
+		/// \availability		This function is only available when #dimensions == 3.
+		MUU_HIDDEN_CONSTRAINT(Dims == 3, size_t Dims = Dimensions)
+		MUU_PURE_GETTER
+		static constexpr vector_soa MUU_VECTORCALL cross(const vector_soa& v1, const vector_soa& v2) noexcept
+		{
+			vector_soa out{};
+			for (size_t i = 0; i < Width; i++)
+			{
+				out.x[i] = v1.y[i] * v2.z[i] - v1.z[i] * v2.y[i];
+				out.y[i] = v1.z[i] * v2.x[i] - v1.x[i] * v2.z[i];
+				out.z[i] = v1.x[i] * v2.y[i] - v1.y[i] * v2.x[i];
+			}
+			return out;
+		}
+
+		/// \brief	Returns the cross product of each lane of this packet with another.
+		///
+		/// \availability		This function is only available when #dimensions == 3.
+		MUU_HIDDEN_CONSTRAINT(Dims == 3, size_t Dims = Dimensions)
+		MUU_PURE_INLINE_GETTER
+		constexpr vector_soa MUU_VECTORCALL cross(const vector_soa& v) const noexcept
+		{
+			return cross(*this, v);
+		}
+
+		/// \brief	Returns the squared length of each lane.
+		MUU_PURE_INLINE_GETTER
+		static constexpr scalar_lanes_type MUU_VECTORCALL length_squared(const vector_soa& v) noexcept
+		{
+			return dot(v, v);
+		}
+
+		/// \brief	Returns the squared length of each lane.
+		MUU_PURE_INLINE_GETTER
+		constexpr scalar_lanes_type length_squared() const noexcept
+		{
+			return dot(*this, *this);
+		}
+
+		/// \brief	Returns the length (magnitude) of each lane.
+		MUU_PURE_GETTER
+		static constexpr scalar_lanes_type MUU_VECTORCALL length(const vector_soa& v) noexcept
+		{
+			auto out = dot(v, v);
+			for (size_t i = 0; i < Width; i++)
+				out.x[i] = muu::sqrt(out.x[i]);
+			return out;
+		}
+
+		/// \brief	Returns the length (magnitude) of each lane.
+		MUU_PURE_INLINE_GETTER
+		constexpr scalar_lanes_type length() const noexcept
+		{
+			return length(*this);
+		}
+
+		/// \brief	Normalizes each lane of a packet.
+		///
+		/// \param v			The packet to normalize.
+		/// \param length_out	An output param to receive the length of each lane pre-normalization.
+		MUU_NODISCARD
+		static constexpr vector_soa MUU_VECTORCALL normalize(const vector_soa& v, scalar_lanes_type& length_out) noexcept
+		{
+			length_out = length(v);
+
+			scalar_lanes_type inv_length{};
+			for (size_t i = 0; i < Width; i++)
+				inv_length.x[i] = scalar_type{ 1 } / length_out.x[i];
+
+			return componentwise([&](auto dim, size_t i) noexcept { return SOA_GET(v, dim)[i] * inv_length.x[i]; });
+		}
+
+		/// \brief	Normalizes each lane of a packet.
+		MUU_PURE_GETTER
+		static constexpr vector_soa MUU_VECTORCALL normalize(const vector_soa& v) noexcept
+		{
+			scalar_lanes_type length_out{};
+			return normalize(v, length_out);
+		}
+
+		/// \brief	Normalizes each lane of this packet (in-place).
+		///
+		/// \return	A reference to the packet.
+		constexpr vector_soa& normalize() noexcept
+		{
+			return *this = normalize(*this);
+		}
+
+		/// @}
+#endif // geometry
+
+#if 1 // misc -----------------------------------------------------------------------------------------------------
+
+		/// \brief	Performs a linear interpolation between each pair of lanes.
+		///
+		/// \param	start	The values at the start of the interpolation range.
+		/// \param	finish	The values at the end of the interpolation range.
+		/// \param	alpha 	The blend factor.
+		MUU_PURE_GETTER
+		static constexpr vector_soa MUU_VECTORCALL lerp(const vector_soa& start,
+														const vector_soa& finish,
+														scalar_type alpha) noexcept
+		{
+			const auto inv_alpha = scalar_type{ 1 } - alpha;
+
+			return componentwise([&](auto dim, size_t i) noexcept
+								 { return SOA_GET(start, dim)[i] * inv_alpha + SOA_GET(finish, dim)[i] * alpha; });
+		}
+
+		/// \brief	Linearly interpolates each lane of this packet towards another (in-place).
+		///
+		/// \return	A reference to the packet.
+		constexpr vector_soa& MUU_VECTORCALL lerp(const vector_soa& target, scalar_type alpha) noexcept
+		{
+			return *this = lerp(*this, target, alpha);
+		}
+
+		/// \brief	Returns the componentwise minimum of two packets.
+		MUU_PURE_GETTER
+		static constexpr vector_soa MUU_VECTORCALL min(const vector_soa& v1, const vector_soa& v2) noexcept
+		{
+			return componentwise([&](auto dim, size_t i) noexcept
+								 { return muu::min(SOA_GET(v1, dim)[i], SOA_GET(v2, dim)[i]); });
+		}
+
+		/// \brief	Returns the componentwise maximum of two packets.
+		MUU_PURE_GETTER
+		static constexpr vector_soa MUU_VECTORCALL max(const vector_soa& v1, const vector_soa& v2) noexcept
+		{
+			return componentwise([&](auto dim, size_t i) noexcept
+								 { return muu::max(SOA_GET(v1, dim)[i], SOA_GET(v2, dim)[i]); });
+		}
+
+#endif // misc
+	};
+}
+
+//======================================================================================================================
+// FREE FUNCTIONS
+//======================================================================================================================
+
+namespace muu
+{
+	/// \relatesalso muu::vector_soa
+	///
+	/// \brief Returns a packet with every lane scaled by the corresponding lane of a scalar packet.
+	MUU_CONSTRAINED_TEMPLATE(D != 1, typename S, size_t D, size_t W)
+	MUU_PURE_INLINE_GETTER
+	constexpr vector_soa<S, D, W> MUU_VECTORCALL operator*(const vector_soa<S, 1, W>& lhs,
+														   const vector_soa<S, D, W>& rhs) noexcept
+	{
+		return rhs * lhs;
+	}
+
+	/// \relatesalso muu::vector_soa
+	///
+	/// \brief	Returns the dot product of each pair of lanes.
+	template <typename S, size_t D, size_t W>
+	MUU_PURE_INLINE_GETTER
+	constexpr vector_soa<S, 1, W> dot(const vector_soa<S, D, W>& v1, const vector_soa<S, D, W>& v2) noexcept
+	{
+		return vector_soa<S, D, W>::dot(v1, v2);
+	}
+
+	/// \relatesalso muu::vector_soa
+	///
+	/// \brief	Returns the cross product of each pair of lanes.
+	template <typename S, size_t W>
+	MUU_PURE_INLINE_GETTER
+	constexpr vector_soa<S, 3, W> cross(const vector_soa<S, 3, W>& v1, const vector_soa<S, 3, W>& v2) noexcept
+	{
+		return vector_soa<S, 3, W>::cross(v1, v2);
+	}
+
+	/// \relatesalso muu::vector_soa
+	///
+	/// \brief	Returns the squared length of each lane.
+	template <typename S, size_t D, size_t W>
+	MUU_PURE_INLINE_GETTER
+	constexpr vector_soa<S, 1, W> length_squared(const vector_soa<S, D, W>& v) noexcept
+	{
+		return vector_soa<S, D, W>::length_squared(v);
+	}
+
+	/// \relatesalso muu::vector_soa
+	///
+	/// \brief	Returns the length (magnitude) of each lane.
+	template <typename S, size_t D, size_t W>
+	MUU_PURE_INLINE_GETTER
+	constexpr vector_soa<S, 1, W> length(const vector_soa<S, D, W>& v) noexcept
+	{
+		return vector_soa<S, D, W>::length(v);
+	}
+
+	/// \relatesalso muu::vector_soa
+	///
+	/// \brief	Normalizes each lane of a packet.
+	template <typename S, size_t D, size_t W>
+	MUU_PURE_INLINE_GETTER
+	constexpr vector_soa<S, D, W> normalize(const vector_soa<S, D, W>& v) noexcept
+	{
+		return vector_soa<S, D, W>::normalize(v);
+	}
+
+	/// \relatesalso muu::vector_soa
+	///
+	/// \brief	Normalizes each lane of a packet.
+	///
+	/// \param v			The packet to normalize.
+	/// \param length_out	An output param to receive the length of each lane pre-normalization.
+	template <typename S, size_t D, size_t W>
+	MUU_NODISCARD
+	constexpr vector_soa<S, D, W> normalize(const vector_soa<S, D, W>& v, vector_soa<S, 1, W>& length_out) noexcept
+	{
+		return vector_soa<S, D, W>::normalize(v, length_out);
+	}
+
+	/// \ingroup lerp
+	/// \relatesalso muu::vector_soa
+	///
+	/// \brief	Performs a linear interpolation between each pair of lanes.
+	template <typename S, size_t D, size_t W>
+	MUU_PURE_INLINE_GETTER
+	constexpr vector_soa<S, D, W> MUU_VECTORCALL lerp(const vector_soa<S, D, W>& start,
+													  const vector_soa<S, D, W>& finish,
+													  S alpha) noexcept
+	{
+		return vector_soa<S, D, W>::lerp(start, finish, alpha);
+	}
+
+	/// \relatesalso muu::vector_soa
+	///
+	/// \brief	Returns the componentwise minimum of two packets.
+	template <typename S, size_t D, size_t W>
+	MUU_PURE_INLINE_GETTER
+	constexpr vector_soa<S, D, W> min(const vector_soa<S, D, W>& v1, const vector_soa<S, D, W>& v2) noexcept
+	{
+		return vector_soa<S, D, W>::min(v1, v2);
+	}
+
+	/// \relatesalso muu::vector_soa
+	///
+	/// \brief	Returns the componentwise maximum of two packets.
+	template <typename S, size_t D, size_t W>
+	MUU_PURE_INLINE_GETTER
+	constexpr vector_soa<S, D, W> max(const vector_soa<S, D, W>& v1, const vector_soa<S, D, W>& v2) noexcept
+	{
+		return vector_soa<S, D, W>::max(v1, v2);
+	}
+}
+
+#undef SOA_GET
+
+MUU_RESET_NDEBUG_OPTIMIZATIONS;
+#include "impl/header_end.h"
@@ -11,13 +11,13 @@
 #include "muu/strings.h"
 #include "muu/scope_guard.h"
 #include "muu/math.h"
+#include "muu/bit.h"
 #include "muu/thread_name.h"
 #include "muu/impl/std_string.h"
 #include "muu/pause.h"
+#include "muu/spin_mutex.h"
 #include "os.h"
-#if !MUU_HAS_EXCEPTIONS
-	#include "muu/impl/std_exception.h" // std::terminate()
-#endif
+#include "muu/impl/std_exception.h" // std::terminate()
 
 MUU_DISABLE_WARNINGS;
 #include <atomic>
@@ -25,6 +25,13 @@ MUU_DISABLE_WARNINGS;
 #include <condition_variable>
 #include <thread>
 #include <optional>
+#include <vector>
+#include <cstdio>
+#if MUU_LINUX
+	#include <linux/futex.h>
+	#include <sched.h>
+	#include <pthread.h>
+#endif
 MUU_ENABLE_WARNINGS;
 
 #include "source_start.h"
@@ -32,6 +39,7 @@ MUU_FORCE_NDEBUG_OPTIMIZATIONS;
 MUU_PRAGMA_MSVC(warning(disable : 26110)) // core guidelines: Caller failing to hold lock (false-positive)
 MUU_PRAGMA_MSVC(warning(disable : 26495)) // core guidelines: uninitialized member
 MUU_PRAGMA_MSVC(warning(disable : 4305))  // truncation from size_t to bool (false-positive)
+MUU_PRAGMA_MSVC(warning(disable : 4324))  // structure was padded due to alignment specifier
 
 using namespace std::chrono_literals;
 using namespace std::string_literals;
@@ -45,280 +53,743 @@ namespace
 {
 	using thread_pool_byte_span = aligned_byte_span<impl::thread_pool_alignment>;
 
-#if defined(__cpp_lib_atomic_wait) && __cpp_lib_atomic_wait >= 201907 && 0
+	//--- waiting on an address --------------------------------------------------------------------------------------
+	//
+	// std::atomic::wait() where available, a raw futex on linux when it isn't (pre-C++20 toolchains),
+	// and a small table of mutex + condition_variable pairs hashed by address everywhere else.
 
-	class thread_pool_monitor
+#if defined(__cpp_lib_atomic_wait) && __cpp_lib_atomic_wait >= 201907
+
+	static void wait_on_address(std::atomic<uint32_t>& value, uint32_t expected) noexcept
 	{
-	  private:
-	#if defined(__cpp_lib_atomic_lock_free_type_aliases) && __cpp_lib_atomic_lock_free_type_aliases >= 201907L
-		std::atomic_unsigned_lock_free count_ = 0u;
-	#else
-		std::atomic_uint_fast32_t count_ = 0u;
-	#endif
+		value.wait(expected, std::memory_order_acquire);
+	}
 
-	  public:
-		void wait() noexcept
-		{
-			auto val = count_.load();
-			while (val)
-			{
-				count_.wait(val);
-				val = count_.load();
-			}
-		}
+	static void wake_all_on_address(std::atomic<uint32_t>& value) noexcept
+	{
+		value.notify_all();
+	}
 
-		void increment(size_t i = 1u) noexcept
+#elif MUU_LINUX
+
+	static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t));
+	static_assert(std::atomic<uint32_t>::is_always_lock_free);
+
+	static void wait_on_address(std::atomic<uint32_t>& value, uint32_t expected) noexcept
+	{
+		// spurious wake-ups, EAGAIN (value already changed) and EINTR are all handled by the caller re-checking
+		syscall(SYS_futex, reinterpret_cast<uint32_t*>(&value), FUTEX_WAIT_PRIVATE, expected, nullptr, nullptr, 0);
+	}
+
+	static void wake_all_on_address(std::atomic<uint32_t>& value) noexcept
+	{
+		syscall(SYS_futex,
+				reinterpret_cast<uint32_t*>(&value),
+				FUTEX_WAKE_PRIVATE,
+				static_cast<int>(constants<int>::highest),
+				nullptr,
+				nullptr,
+				0);
+	}
+
+#else
+
+	struct address_wait_bucket
+	{
+		std::mutex mutex;
+		std::condition_variable cv;
+	};
+
+	MUU_PURE_GETTER
+	static address_wait_bucket& get_address_wait_bucket(const void* address) noexcept
+	{
+		static address_wait_bucket buckets[32];
+		return buckets[(reinterpret_cast<uintptr_t>(address) / impl::thread_pool_alignment) % std::size(buckets)];
+	}
+
+	static void wait_on_address(std::atomic<uint32_t>& value, uint32_t expected) noexcept
+	{
+		auto& bucket = get_address_wait_bucket(&value);
+		std::unique_lock lock{ bucket.mutex };
+		while (value.load(std::memory_order_acquire) == expected)
+			bucket.cv.wait(lock);
+	}
+
+	static void wake_all_on_address(std::atomic<uint32_t>& value) noexcept
+	{
+		auto& bucket = get_address_wait_bucket(&value);
 		{
-			count_ += i;
-			count_.notify_all();
+			std::lock_guard lock{ bucket.mutex };
 		}
+		bucket.cv.notify_all();
+	}
 
-		void decrement(size_t i = 1u) noexcept
+#endif
+
+	//--- counters -------------------------------------------------------------------------------------------------
+	//
+	// incrementing and decrementing are a single atomic RMW; the (comparatively expensive) wake-up is only
+	// performed when the count reaches zero and somebody is actually blocked waiting for it to do so.
+
+	static void wait_on_counter(impl::thread_pool_counter& counter) noexcept
+	{
+		using counter_type = impl::thread_pool_counter;
+
+		auto val = counter.value.load(std::memory_order_acquire);
+		while (val & counter_type::count_mask)
 		{
-			count_ -= i;
-			count_.notify_all();
+			// make sure whoever takes the count to zero knows to wake us
+			if (!(val & counter_type::waiting_bit))
+			{
+				counter.value.compare_exchange_weak(val, val | counter_type::waiting_bit, std::memory_order_acquire);
+				continue;
+			}
+
+			wait_on_address(counter.value, val);
+			val = counter.value.load(std::memory_order_acquire);
 		}
-	};
 
-#else
+		// clear the flag again so subsequent zero-crossings don't pay for the wake-up
+		if (val & counter_type::waiting_bit)
+			counter.value.compare_exchange_strong(val, val & ~counter_type::waiting_bit, std::memory_order_relaxed);
+	}
+
+	// wakes any workers parked waiting for the counter (see thread_pool_counter_waiters below)
+	static void notify_counter_waiters(const impl::thread_pool_counter& counter) noexcept;
+
+	static void wake_counter(impl::thread_pool_counter& counter) noexcept
+	{
+		wake_all_on_address(counter.value);
+		notify_counter_waiters(counter);
+	}
 
 	class thread_pool_monitor
 	{
+		// counts the tasks that have been enqueued but not yet finished.
+
 	  private:
-		size_t busy = {};
-		mutable std::mutex mutex;
-		mutable std::condition_variable cv;
+		impl::thread_pool_counter counter_{ { 0u } };
 
 	  public:
+		MUU_ALWAYS_INLINE
 		void wait() noexcept
 		{
-			std::unique_lock lock{ mutex };
-			while (busy)
-				cv.wait(lock);
+			wait_on_counter(counter_);
 		}
 
+		MUU_ALWAYS_INLINE
 		void increment(size_t i = 1u) noexcept
 		{
-			std::lock_guard lock{ mutex };
-			busy += i;
+			MUU_ASSERT(i <= constants<uint32_t>::highest);
+
+			counter_.increment(static_cast<uint32_t>(i));
 		}
 
+		MUU_ALWAYS_INLINE
 		void decrement(size_t i = 1u) noexcept
 		{
-			bool notify = false;
+			MUU_ASSERT(i <= constants<uint32_t>::highest);
+
+			using counter_type = impl::thread_pool_counter;
+
+			const auto prev = counter_.value.fetch_sub(static_cast<uint32_t>(i), std::memory_order_acq_rel);
+			if (!(prev & counter_type::waiting_bit))
+				return;
+
+			// workers waiting in thread_pool_impl::wait() are done before the count reaches zero,
+			// so they need waking on every decrement (and check for themselves)
+			if ((prev & counter_type::count_mask) != i)
 			{
-				std::lock_guard lock{ mutex };
-				busy -= i;
-				notify = !busy;
+				notify_counter_waiters(counter_);
+				return;
 			}
-			if (notify)
-				cv.notify_all();
+
+			// clear the flag again so subsequent zero-crossings don't pay for the wake-up
+			auto val = prev - static_cast<uint32_t>(i);
+			counter_.value.compare_exchange_strong(val, val & ~counter_type::waiting_bit, std::memory_order_relaxed);
+			wake_counter(counter_);
+		}
+
+		MUU_PURE_INLINE_GETTER
+		impl::thread_pool_counter& counter() noexcept
+		{
+			return counter_;
+		}
+
+		MUU_PURE_INLINE_GETTER
+		size_t pending() const noexcept
+		{
+			return counter_.value.load(std::memory_order_acquire) & impl::thread_pool_counter::count_mask;
 		}
 	};
 
-#endif
+	//--- eventcount -------------------------------------------------------------------------------------------------
+	//
+	// lets a worker park without missing a wake-up: it announces it's about to park (prepare_wait()), re-checks
+	// for work, then either backs out (cancel_wait()) or sleeps until somebody bumps the epoch (wait()).
+	// notifiers only pay for the (comparatively expensive) wake-up when the worker is actually parked.
+	//
+	// waiting on an address can't time out everywhere, so timed waits (see thread_pool_impl::park()) sleep on a
+	// condition_variable instead, and say so when parking so notifiers know which one to wake.
 
-	class thread_pool_queue
+	class alignas(impl::thread_pool_alignment) thread_pool_eventcount
 	{
 	  private:
-		thread_pool_byte_span pool;
-		thread_pool_monitor& monitor;
-		size_t capacity, front = {}, back = {};
-		size_t enqueues_ = {};
-		mutable std::mutex mutex;
-		mutable std::condition_variable cv;
-		std::atomic_bool terminated_ = false;
-
-		using task = impl::thread_pool_task;
-
-		MUU_PURE_GETTER
-		MUU_ATTR(returns_nonnull)
-		MUU_ATTR(assume_aligned(impl::thread_pool_alignment))
-		task* get_task(size_t i) noexcept
+		enum class states : uint8_t
 		{
-			return MUU_LAUNDER(reinterpret_cast<task*>(muu::assume_aligned<impl::thread_pool_alignment>(pool.data())
-													   + impl::thread_pool_alignment * ((front + i) % capacity)));
-		}
+			awake,
+			parked,
+			parked_timed
+		};
+
+		std::atomic<uint32_t> epoch_ = 0u;
+		std::atomic<states> parked_	 = states::awake;
+		std::mutex timed_mutex_;
+		std::condition_variable timed_cv_;
 
+	  public:
 		MUU_NODISCARD
-		MUU_ATTR(returns_nonnull)
-		MUU_ATTR(assume_aligned(impl::thread_pool_alignment))
-		task* pop_front_task() noexcept
+		uint32_t prepare_wait(bool timed = false) noexcept
 		{
-			MUU_ASSERT(back > front);
+			const auto key = epoch_.load(std::memory_order_acquire);
+			parked_.store(timed ? states::parked_timed : states::parked, std::memory_order_relaxed);
 
-			auto t = get_task({});
-			MUU_ASSERT(t->action_invoker);
+			// pairs with the fence in notifiers - either they see us parked, or we see their work when re-checking
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			return key;
+		}
 
-			front++;
-			return t;
+		void cancel_wait() noexcept
+		{
+			parked_.store(states::awake, std::memory_order_relaxed);
 		}
 
-		MUU_NODISCARD
-		MUU_ATTR(nonnull)
-		MUU_ATTR(returns_nonnull)
-		MUU_ATTR(assume_aligned(impl::thread_pool_alignment))
-		task* pop_front_task(void* buf) noexcept
+		void wait(uint32_t key) noexcept
 		{
-			MUU_ASSERT(back > front);
+			MUU_ASSERT(parked_.load(std::memory_order_relaxed) != states::parked_timed);
 
-			auto t = pop_front_task();
-			MUU_ASSERT(t->action_invoker);
+			while (epoch_.load(std::memory_order_acquire) == key)
+				wait_on_address(epoch_, key);
+			parked_.store(states::awake, std::memory_order_relaxed);
+		}
 
-			auto result = ::new (muu::assume_aligned<impl::thread_pool_alignment>(buf)) task{ MUU_MOVE(*t) };
-			MUU_ASSERT(result->action_invoker);
+		// for waits prepared with prepare_wait(true)
+		template <typename TimePoint>
+		void wait_until(uint32_t key, const TimePoint& deadline) noexcept
+		{
+			MUU_ASSERT(parked_.load(std::memory_order_relaxed) != states::parked);
 
-			t->~task();
-			return result;
+			{
+				std::unique_lock lock{ timed_mutex_ };
+				timed_cv_.wait_until(lock,
+									 deadline,
+									 [&]() noexcept { return epoch_.load(std::memory_order_acquire) != key; });
+			}
+			parked_.store(states::awake, std::memory_order_relaxed);
 		}
 
-	  public:
-		MUU_NODISCARD_CTOR
-		thread_pool_queue(thread_pool_byte_span tp, thread_pool_monitor& mon) noexcept //
-			: pool{ tp },
-			  monitor{ mon },
-			  capacity{ pool.size() / impl::thread_pool_alignment }
+		MUU_PURE_INLINE_GETTER
+		bool parked() const noexcept
 		{
-			MUU_ASSERT(!pool.empty());
-			MUU_ASSERT(capacity);
+			return parked_.load(std::memory_order_relaxed) != states::awake;
 		}
 
-		~thread_pool_queue() noexcept
+		// returns true if the worker was parked (and has now been woken)
+		bool notify() noexcept
 		{
-			std::lock_guard lock{ mutex };
-			if (const auto remaining = size())
+			if (parked_.load(std::memory_order_relaxed) == states::awake)
+				return false;
+
+			const auto state = parked_.exchange(states::awake);
+			if (state == states::awake)
+				return false;
+
+			epoch_.fetch_add(1u, std::memory_order_release);
+			if (state == states::parked_timed)
 			{
-				while (!empty())
-					pop_front_task()->~task();
-				monitor.decrement(remaining);
+				{
+					std::lock_guard lock{ timed_mutex_ };
+				}
+				timed_cv_.notify_all();
 			}
+			else
+				wake_all_on_address(epoch_);
+			return true;
 		}
+	};
 
-		MUU_DELETE_COPY(thread_pool_queue);
-		MUU_DELETE_MOVE(thread_pool_queue);
+	//--- counter waiters -------------------------------------------------------------------------------------------
+	//
+	// workers waiting for a counter (see thread_pool_impl::wait_for()) park on their own eventcount rather than the
+	// counter itself so that new work can still wake them up. whoever wakes the counter finds them in a small table
+	// of lists hashed by the counter's address.
 
-		void terminate() noexcept
-		{
-			terminated_ = true;
-			cv.notify_all();
-		}
+	struct thread_pool_counter_waiter
+	{
+		const impl::thread_pool_counter* counter;
+		thread_pool_eventcount* event;
+		thread_pool_counter_waiter* next;
+	};
 
-		MUU_PURE_INLINE_GETTER
-		bool terminated() const noexcept
+	class thread_pool_counter_waiters
+	{
+	  private:
+		struct bucket
 		{
-			return terminated_;
-		}
+			std::mutex mutex;
+			thread_pool_counter_waiter* head = nullptr;
+			std::atomic<size_t> count		 = 0_sz; // so notify() can skip the lock when nobody's waiting
+		};
 
-		MUU_PURE_INLINE_GETTER
-		size_t size() const noexcept
+		MUU_PURE_GETTER
+		static bucket& get_bucket(const void* address) noexcept
 		{
-			return back - front;
+			static bucket buckets[32];
+			return buckets[(reinterpret_cast<uintptr_t>(address) / impl::thread_pool_alignment) % std::size(buckets)];
 		}
 
-		MUU_PURE_INLINE_GETTER
-		bool full() const noexcept
+	  public:
+		// must happen before the waiter sets the counter's waiting_bit
+		static void add(thread_pool_counter_waiter& waiter) noexcept
 		{
-			return size() >= capacity;
+			MUU_ASSERT(waiter.counter);
+			MUU_ASSERT(waiter.event);
+
+			auto& b = get_bucket(waiter.counter);
+			std::lock_guard lock{ b.mutex };
+			waiter.next = b.head;
+			b.head		= &waiter;
+			b.count.fetch_add(1u, std::memory_order_relaxed);
 		}
 
-		MUU_PURE_INLINE_GETTER
-		bool empty() const noexcept
+		static void remove(thread_pool_counter_waiter& waiter) noexcept
 		{
-			return back == front;
+			auto& b = get_bucket(waiter.counter);
+			std::lock_guard lock{ b.mutex };
+			for (auto w = &b.head; *w; w = &(*w)->next)
+			{
+				if (*w == &waiter)
+				{
+					*w = waiter.next;
+					break;
+				}
+			}
+			b.count.fetch_sub(1u, std::memory_order_relaxed);
 		}
 
-		MUU_PURE_INLINE_GETTER
-		size_t available() const noexcept
+		// only called by whoever saw the counter's waiting_bit, so any add() preceding it is visible
+		static void notify(const impl::thread_pool_counter& counter) noexcept
 		{
-			return capacity - size();
+			auto& b = get_bucket(&counter);
+			if (!b.count.load(std::memory_order_relaxed))
+				return;
+
+			// pairs with the fence in event.prepare_wait() - either we see them parked, or they see the new count
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+
+			std::lock_guard lock{ b.mutex };
+			for (auto w = b.head; w; w = w->next)
+				if (w->counter == &counter)
+					w->event->notify();
 		}
+	};
 
-		MUU_NODISCARD
-		bool try_lock() noexcept
-		{
-			if (!mutex.try_lock())
-				return false;
+	static void notify_counter_waiters(const impl::thread_pool_counter& counter) noexcept
+	{
+		thread_pool_counter_waiters::notify(counter);
+	}
 
-			enqueues_ = {};
+	//--- slab allocator ---------------------------------------------------------------------------------------------
+	//
+	// small, short-lived allocations made on behalf of the pool's users (e.g. future shared states).
+	// blocks are carved out of 64 KB chunks in power-of-two size classes and recycled through a free-list;
+	// chunks are only returned to the system when the pool is destroyed.
 
-			return true;
-		}
+	class thread_pool_slab
+	{
+	  private:
+		static constexpr size_t min_block_size = impl::thread_pool_alignment;
+		static constexpr size_t max_block_size = 4_kb;
+		static constexpr size_t chunk_size	   = 64_kb;
+		static constexpr size_t class_count	   = 7; // 64, 128, 256, 512, 1024, 2048, 4096
+		static_assert((min_block_size << (class_count - 1u)) == max_block_size);
 
-		// void lock() noexcept
-		//{
-		//	mutex.lock();
-		//	enqueues_ = {};
-		//}
+		struct free_block
+		{
+			free_block* next;
+		};
 
-		MUU_NODISCARD
-		MUU_ATTR(returns_nonnull)
-		MUU_ATTR(assume_aligned(impl::thread_pool_alignment))
-		void* acquire() noexcept
+		struct alignas(impl::thread_pool_alignment) size_class
 		{
-			MUU_ASSERT(!full());
+			spin_mutex mutex;
+			free_block* free_list = nullptr;
+			free_block* chunks	  = nullptr; // first block of each chunk is reserved to link them together
+		};
 
-			enqueues_++;
+		size_class classes_[class_count];
 
-			return muu::assume_aligned<impl::thread_pool_alignment>(pool.data())
-				 + impl::thread_pool_alignment * (back++ % capacity);
+		MUU_CONST_GETTER
+		static constexpr size_t size_class_index(size_t size) noexcept
+		{
+			size_t idx = 0;
+			for (size_t block = min_block_size; block < size; block <<= 1)
+				idx++;
+			return idx;
 		}
 
-		void unlock() noexcept
+	  public:
+		MUU_NODISCARD_CTOR
+		thread_pool_slab() noexcept = default;
+
+		MUU_DELETE_COPY(thread_pool_slab);
+		MUU_DELETE_MOVE(thread_pool_slab);
+
+		~thread_pool_slab() noexcept
 		{
-			const auto enq = enqueues_;
-			if (enq)
+			for (auto& cls : classes_)
 			{
-				monitor.increment(enq);
-				MUU_ASSERT(get_task(back - front - 1u)->action_invoker);
+				while (cls.chunks)
+					muu::aligned_free(std::exchange(cls.chunks, cls.chunks->next));
 			}
-
-			mutex.unlock();
-
-			if (enq)
-				cv.notify_all();
 		}
 
 		MUU_NODISCARD
-		MUU_ATTR(nonnull)
+		MUU_ATTR(returns_nonnull)
 		MUU_ATTR(assume_aligned(impl::thread_pool_alignment))
-		task* try_pop(void* buf) noexcept
+		void* allocate(size_t size) noexcept
 		{
-			std::unique_lock lock{ mutex, std::try_to_lock };
-			if (!lock || empty() || terminated())
-				return nullptr;
+			MUU_ASSUME(size > 0u);
+
+			void* ptr = nullptr;
+			if (size > max_block_size)
+				ptr = muu::aligned_alloc(size, impl::thread_pool_alignment);
+			else
+			{
+				const auto idx = size_class_index(size);
+				auto& cls	   = classes_[idx];
+
+				std::lock_guard lock{ cls.mutex };
+				if (!cls.free_list)
+				{
+					const auto block_size = min_block_size << idx;
+					auto chunk = static_cast<std::byte*>(muu::aligned_alloc(chunk_size, impl::thread_pool_alignment));
+					if (chunk)
+					{
+						auto link  = ::new (static_cast<void*>(chunk)) free_block{ cls.chunks };
+						cls.chunks = link;
+
+						for (size_t offset = block_size; offset + block_size <= chunk_size; offset += block_size)
+							cls.free_list = ::new (static_cast<void*>(chunk + offset)) free_block{ cls.free_list };
+					}
+				}
+				if (cls.free_list)
+				{
+					ptr			  = cls.free_list;
+					cls.free_list = cls.free_list->next;
+				}
+			}
+
+			MUU_ASSERT(ptr && "allocate() failed!");
+			if (!ptr)
+				std::terminate();
 
-			return pop_front_task(muu::assume_aligned<impl::thread_pool_alignment>(buf));
+			return muu::assume_aligned<impl::thread_pool_alignment>(ptr);
 		}
 
-		MUU_NODISCARD
 		MUU_ATTR(nonnull)
-		MUU_ATTR(assume_aligned(impl::thread_pool_alignment))
-		task* pop(void* buf, std::chrono::milliseconds timeoout) noexcept
+		void deallocate(void* ptr, size_t size) noexcept
 		{
-			std::unique_lock lock{ mutex };
-			cv.wait_for(lock, timeoout, [this]() noexcept { return !empty() || terminated(); });
+			MUU_ASSUME(ptr != nullptr);
+			MUU_ASSUME(size > 0u);
 
-			if (empty() || terminated())
-				return nullptr;
+			if (size > max_block_size)
+			{
+				muu::aligned_free(ptr);
+				return;
+			}
 
-			return pop_front_task(muu::assume_aligned<impl::thread_pool_alignment>(buf));
+			auto& cls = classes_[size_class_index(size)];
+			std::lock_guard lock{ cls.mutex };
+			cls.free_list = ::new (ptr) free_block{ cls.free_list };
 		}
 	};
 
-	static constexpr size_t thread_pool_spin_wait_iterations_per_queue = 100;
-
-	class thread_pool_worker
+	//--- timing wheel -----------------------------------------------------------------------------------------------
+	//
+	// holds the tasks scheduled with enqueue_after() and enqueue_every() until they come due.
+	//
+	// a hierarchical timing wheel (Varghese & Lauck, "Hashed and Hierarchical Timing Wheels", 1987): each level has
+	// 64 slots, each slot on level N spanning 64^N ticks. timers are filed on the level of the highest base-64 digit
+	// in which their due tick differs from the current one, so insertion is O(1) and a timer is only ever touched
+	// again when the wheel reaches its slot (to either expire it, or 'cascade' it down to a finer level).
+	// timers due further out than the wheel spans wait in an overflow list that is redistributed whenever the
+	// top level wraps around.
+	//
+	// not thread-safe; guarded by thread_pool_impl::timer_mutex.
+
+	class thread_pool_timing_wheel
 	{
 	  private:
-		std::thread thread;
-		std::atomic_bool terminated_ = false;
-		using task					 = impl::thread_pool_task;
+		using timer = impl::thread_pool_timer;
 
-	  public:
-		MUU_ALWAYS_INLINE
-		void terminate() noexcept
+		static constexpr size_t level_bits		= 6;
+		static constexpr size_t slots_per_level = 1_sz << level_bits;
+		static constexpr size_t level_count		= 4; // 2^24 ticks (~4.5 hours at 1ms per tick)
+		static constexpr uint64_t slot_mask		= slots_per_level - 1u;
+
+		timer* slots_[level_count][slots_per_level] = {};
+		uint64_t occupied_[level_count]				= {}; // one bit per non-empty slot
+		timer* overflow_							= {};
+		uint64_t now_								= {};
+		size_t size_								= {};
+
+		MUU_CONST_GETTER
+		static constexpr size_t digit(uint64_t tick, size_t level) noexcept
 		{
-			terminated_ = true;
+			return static_cast<size_t>((tick >> (level * level_bits)) & slot_mask);
+		}
+
+		// the occupied slots on a level that come after the given one
+		MUU_PURE_GETTER
+		uint64_t occupied_after(size_t level, size_t slot) const noexcept
+		{
+			return slot == slot_mask ? uint64_t{} : occupied_[level] & (~uint64_t{} << (slot + 1u));
+		}
+
+		MUU_ATTR(nonnull)
+		void file(timer* t) noexcept
+		{
+			MUU_ASSUME(t != nullptr);
+			MUU_ASSERT(t->due >= now_);
+
+			const auto diff	 = t->due ^ now_;
+			const auto level = diff ? static_cast<size_t>(bit_width(diff) - 1u) / level_bits : 0_sz;
+			if (level >= level_count)
+			{
+				t->next	  = overflow_;
+				overflow_ = t;
+				return;
+			}
+
+			const auto slot		= digit(t->due, level);
+			t->next				= slots_[level][slot];
+			slots_[level][slot] = t;
+			occupied_[level] |= uint64_t{ 1 } << slot;
+		}
+
+		MUU_NODISCARD
+		timer* take(size_t level, size_t slot) noexcept
+		{
+			occupied_[level] &= ~(uint64_t{ 1 } << slot);
+			return std::exchange(slots_[level][slot], nullptr);
+		}
+
+		void refile(timer* list) noexcept
+		{
+			while (list)
+				file(std::exchange(list, list->next));
+		}
+
+	  public:
+		MUU_NODISCARD_CTOR
+		thread_pool_timing_wheel() noexcept = default;
+
+		MUU_DELETE_COPY(thread_pool_timing_wheel);
+		MUU_DELETE_MOVE(thread_pool_timing_wheel);
+
+		// the last tick the wheel was advanced to; everything due at or before it has already expired
+		MUU_PURE_INLINE_GETTER
+		uint64_t now() const noexcept
+		{
+			return now_;
+		}
+
+		MUU_PURE_INLINE_GETTER
+		size_t size() const noexcept
+		{
+			return size_;
+		}
+
+		MUU_ATTR(nonnull)
+		void insert(timer* t) noexcept
+		{
+			MUU_ASSUME(t != nullptr);
+			MUU_ASSERT(t->due > now_);
+
+			file(t);
+			size_++;
+		}
+
+		// the next tick at which the wheel has something to do (expire timers, or cascade them down a level).
+		// timers filed on the coarser levels are only cascaded when the wheel gets to them, so this may be earlier
+		// than the next timer is actually due, but never later.
+		MUU_PURE_GETTER
+		uint64_t next_event() const noexcept
+		{
+			if (!size_)
+				return constants<uint64_t>::highest;
+
+			for (size_t level = 0; level < level_count; level++)
+			{
+				if (const auto slots = occupied_after(level, digit(now_, level)))
+				{
+					const auto span_bits = (level + 1u) * level_bits;
+					return ((now_ >> span_bits) << span_bits)
+						 | (static_cast<uint64_t>(countr_zero(slots)) << (level * level_bits));
+				}
+			}
+
+			// only the overflow list left; it gets redistributed when the top level wraps around
+			MUU_ASSERT(overflow_);
+			constexpr auto span_bits = level_count * level_bits;
+			return ((now_ >> span_bits) + 1u) << span_bits;
+		}
+
+		// advances the wheel up to (and including) the given tick, returning the timers that expired as a list
+		MUU_NODISCARD
+		timer* advance(uint64_t tick) noexcept
+		{
+			timer* expired = nullptr;
+			while (size_)
+			{
+				const auto next = next_event();
+				if (next > tick)
+					break;
+				now_ = next;
+
+				// cascade from the coarsest level down; everything below the level that ticked over is at zero
+				if (!(now_ & ((uint64_t{ 1 } << (level_count * level_bits)) - 1u)))
+					refile(std::exchange(overflow_, nullptr));
+				for (size_t level = level_count; level-- > 1u;)
+				{
+					if (now_ & ((uint64_t{ 1 } << (level * level_bits)) - 1u))
+						continue;
+					const auto slot = digit(now_, level);
+					if (occupied_[level] & (uint64_t{ 1 } << slot))
+						refile(take(level, slot));
+				}
+
+				// everything left in the current slot of the finest level is due now
+				for (auto t = take(0u, digit(now_, 0u)); t;)
+				{
+					MUU_ASSERT(t->due == now_);
+					auto next_timer = t->next;
+					t->next			= expired;
+					expired			= t;
+					t				= next_timer;
+					size_--;
+				}
+			}
+
+			now_ = max(now_, tick);
+			return expired;
+		}
+
+		// removes every timer from the wheel, returning them as a list
+		MUU_NODISCARD
+		timer* clear() noexcept
+		{
+			timer* all = std::exchange(overflow_, nullptr);
+			for (size_t level = 0; level < level_count; level++)
+			{
+				for (size_t slot = 0; slot < slots_per_level; slot++)
+				{
+					for (auto t = take(level, slot); t;)
+					{
+						auto next_timer = t->next;
+						t->next			= all;
+						all				= t;
+						t				= next_timer;
+					}
+				}
+			}
+			size_ = {};
+			return all;
+		}
+	};
+
+	class thread_pool_queue
+	{
+	  private:
+		thread_pool_byte_span pool;
+		thread_pool_monitor& monitor;
+		size_t capacity, front = {}, back = {};
+		size_t enqueues_ = {};
+		mutable std::mutex mutex;
+		std::atomic<size_t> size_hint_ = 0_sz; // size() as of the last unlock() or pop, readable without the lock
+		std::atomic_bool terminated_   = false;
+
+		using task = impl::thread_pool_task;
+
+		MUU_PURE_GETTER
+		MUU_ATTR(returns_nonnull)
+		MUU_ATTR(assume_aligned(impl::thread_pool_alignment))
+		task* get_task(size_t i) noexcept
+		{
+			return MUU_LAUNDER(reinterpret_cast<task*>(muu::assume_aligned<impl::thread_pool_alignment>(pool.data())
+													   + impl::thread_pool_alignment * ((front + i) % capacity)));
+		}
+
+		MUU_NODISCARD
+		MUU_ATTR(returns_nonnull)
+		MUU_ATTR(assume_aligned(impl::thread_pool_alignment))
+		task* pop_front_task() noexcept
+		{
+			MUU_ASSERT(back > front);
+
+			auto t = get_task({});
+			MUU_ASSERT(t->action_invoker);
+
+			front++;
+			return t;
+		}
+
+		MUU_NODISCARD
+		MUU_ATTR(nonnull)
+		MUU_ATTR(returns_nonnull)
+		MUU_ATTR(assume_aligned(impl::thread_pool_alignment))
+		task* pop_front_task(void* buf) noexcept
+		{
+			MUU_ASSERT(back > front);
+
+			auto t = pop_front_task();
+			MUU_ASSERT(t->action_invoker);
+
+			auto result = ::new (muu::assume_aligned<impl::thread_pool_alignment>(buf)) task{ MUU_MOVE(*t) };
+			MUU_ASSERT(result->action_invoker);
+
+			t->~task();
+			return result;
+		}
+
+	  public:
+		MUU_NODISCARD_CTOR
+		thread_pool_queue(thread_pool_byte_span tp, thread_pool_monitor& mon) noexcept //
+			: pool{ tp },
+			  monitor{ mon },
+			  capacity{ pool.size() / impl::thread_pool_alignment }
+		{
+			MUU_ASSERT(!pool.empty());
+			MUU_ASSERT(capacity);
+		}
+
+		~thread_pool_queue() noexcept
+		{
+			std::lock_guard lock{ mutex };
+			if (const auto remaining = size())
+			{
+				while (!empty())
+					pop_front_task()->~task();
+				monitor.decrement(remaining);
+			}
+		}
+
+		MUU_DELETE_COPY(thread_pool_queue);
+		MUU_DELETE_MOVE(thread_pool_queue);
+
+		void terminate() noexcept
+		{
+			terminated_ = true;
 		}
 
 		MUU_PURE_INLINE_GETTER
@@ -327,293 +798,1905 @@ namespace
 			return terminated_;
 		}
 
-		MUU_NODISCARD_CTOR
-		thread_pool_worker(size_t worker_index,
-						   std::string&& worker_name,
-						   span<thread_pool_queue> queues,
-						   thread_pool_monitor& monitor_)
+		MUU_PURE_INLINE_GETTER
+		size_t size() const noexcept
 		{
-			thread =
-				std::thread{ [this, worker_index, name = MUU_MOVE(worker_name), queues, monitor = &monitor_]() noexcept
-							 {
-								 MUU_ASSUME(monitor != nullptr);
+			return back - front;
+		}
 
-#if MUU_WINDOWS
-								 MUU_UNUSED(CoInitializeEx(nullptr, COINIT_MULTITHREADED));
-								 auto at_exit = scope_guard{ []() noexcept { CoUninitialize(); } };
-#endif
+		MUU_PURE_INLINE_GETTER
+		bool full() const noexcept
+		{
+			return size() >= capacity;
+		}
 
-								 set_thread_name(name);
-
-								 alignas(impl::thread_pool_alignment) std::byte pop_buffer[impl::thread_pool_alignment];
-
-								 const size_t tries = queues.size() * thread_pool_spin_wait_iterations_per_queue;
-
-								 while (!terminated())
-								 {
-									 task* t = nullptr;
-									 while (!t && !terminated())
-									 {
-										 for (size_t i = worker_index, e = i + tries; i < e && !t; i++)
-										 {
-											 MUU_PAUSE();
-											 t = queues[i % queues.size()].try_pop(pop_buffer);
-										 }
-										 if (!t)
-											 t = queues[worker_index].pop(pop_buffer, 100ms); // blocks until timeout
-									 }
-									 if (t)
-									 {
-										 (*t)(worker_index);
-										 monitor->decrement();
-										 t->~task();
-									 }
-								 }
-							 } };
+		MUU_PURE_INLINE_GETTER
+		bool empty() const noexcept
+		{
+			return back == front;
 		}
 
-		~thread_pool_worker() noexcept
+		MUU_PURE_INLINE_GETTER
+		size_t available() const noexcept
 		{
-			if (thread.joinable())
-				thread.join();
+			return capacity - size();
 		}
 
-		MUU_DELETE_COPY(thread_pool_worker);
-		MUU_DELETE_MOVE(thread_pool_worker);
+		MUU_NODISCARD
+		bool try_lock() noexcept
+		{
+			if (!mutex.try_lock())
+				return false;
+
+			enqueues_ = {};
+
+			return true;
+		}
+
+		// void lock() noexcept
+		//{
+		//	mutex.lock();
+		//	enqueues_ = {};
+		//}
+
+		MUU_NODISCARD
+		MUU_ATTR(returns_nonnull)
+		MUU_ATTR(assume_aligned(impl::thread_pool_alignment))
+		void* acquire() noexcept
+		{
+			MUU_ASSERT(!full());
+
+			enqueues_++;
+
+			return muu::assume_aligned<impl::thread_pool_alignment>(pool.data())
+				 + impl::thread_pool_alignment * (back++ % capacity);
+		}
+
+		// returns the number of tasks enqueued while the queue was locked
+		size_t unlock() noexcept
+		{
+			const auto enq = enqueues_;
+			if (enq)
+			{
+				monitor.increment(enq);
+				size_hint_.store(size(), std::memory_order_relaxed);
+				MUU_ASSERT(get_task(back - front - 1u)->action_invoker);
+			}
+
+			mutex.unlock();
+			return enq;
+		}
+
+		// may be stale, but never reports a queue as empty once an unlock() that filled it has returned
+		MUU_PURE_INLINE_GETTER
+		bool empty_hint() const noexcept
+		{
+			return !size_hint_.load(std::memory_order_relaxed);
+		}
+
+		MUU_NODISCARD
+		MUU_ATTR(nonnull)
+		MUU_ATTR(assume_aligned(impl::thread_pool_alignment))
+		task* try_pop(void* buf) noexcept
+		{
+			std::unique_lock lock{ mutex, std::try_to_lock };
+			if (!lock || empty() || terminated())
+				return nullptr;
+
+			auto t = pop_front_task(muu::assume_aligned<impl::thread_pool_alignment>(buf));
+			size_hint_.store(size(), std::memory_order_relaxed);
+			return t;
+		}
 	};
 
-	MUU_PURE_GETTER
-	static size_t calc_thread_pool_workers(size_t worker_count) noexcept
+	class thread_pool_deque
 	{
-		static constexpr auto absolute_max_workers = 1024_sz;
-		static const auto concurrency			= max(static_cast<size_t>(std::thread::hardware_concurrency()), 1_sz);
-		static const auto effective_max_workers = min(concurrency * 64_sz, absolute_max_workers);
+		// fixed-capacity Chase-Lev deque, based on:
+		// "Correct and Efficient Work-Stealing for Weak Memory Models" (Le, Pop, Cohen & Zappa Nardelli, 2013)
+		// https://fzn.fr/readings/ppopp13.pdf
+		//
+		// tasks are stored inline in the slots and are not trivially copyable, so thieves can't speculatively
+		// copy them before claiming them the way the original algorithm does. instead each slot has an 'occupied'
+		// flag; a task is only moved out of a slot once the slot has been claimed, and the owner won't reuse a slot
+		// until whoever claimed it has finished moving it out.
 
-		return min(worker_count ? worker_count : concurrency, effective_max_workers);
-	}
+	  private:
+		using task = impl::thread_pool_task;
 
-	MUU_PURE_GETTER
-	static constexpr size_t calc_thread_pool_worker_queue_size(size_t worker_count, size_t task_queue_size) noexcept
-	{
-		constexpr size_t max_buffer_size		 = 256_mb; // 4M tasks on x64
-		constexpr size_t default_buffer_size	 = 64_kb;  // 1024 tasks on x64
-		constexpr size_t max_task_queue_size	 = max_buffer_size / impl::thread_pool_alignment;
-		constexpr size_t default_task_queue_size = default_buffer_size / impl::thread_pool_alignment;
-		static_assert(max_task_queue_size > 0);
-		static_assert(default_task_queue_size > 0);
-		MUU_ASSUME(worker_count > 0);
+		thread_pool_byte_span pool;
+		std::atomic_bool* occupied;
+		thread_pool_monitor& monitor;
+		ptrdiff_t capacity;
+		ptrdiff_t pending_ = {}; // owner-only
+
+		alignas(impl::thread_pool_alignment) std::atomic<ptrdiff_t> top_ = 0;
+		alignas(impl::thread_pool_alignment) std::atomic<ptrdiff_t> bottom_ = 0;
+
+		MUU_PURE_GETTER
+		MUU_ATTR(returns_nonnull)
+		MUU_ATTR(assume_aligned(impl::thread_pool_alignment))
+		std::byte* get_slot(ptrdiff_t i) noexcept
+		{
+			MUU_ASSUME(i >= 0);
+
+			return muu::assume_aligned<impl::thread_pool_alignment>(pool.data())
+				 + impl::thread_pool_alignment * static_cast<size_t>(i % capacity);
+		}
+
+		MUU_NODISCARD
+		MUU_ATTR(nonnull)
+		MUU_ATTR(returns_nonnull)
+		MUU_ATTR(assume_aligned(impl::thread_pool_alignment))
+		task* move_out(ptrdiff_t i, void* buf) noexcept
+		{
+			auto& flag = occupied[i % capacity];
+			while (!flag.load(std::memory_order_acquire))
+				MUU_PAUSE();
+
+			auto t = MUU_LAUNDER(reinterpret_cast<task*>(get_slot(i)));
+			MUU_ASSERT(t->action_invoker);
+
+			auto result = ::new (muu::assume_aligned<impl::thread_pool_alignment>(buf)) task{ MUU_MOVE(*t) };
+			MUU_ASSERT(result->action_invoker);
+
+			t->~task();
+			flag.store(false, std::memory_order_release);
+			return result;
+		}
+
+	  public:
+		MUU_NODISCARD_CTOR
+		thread_pool_deque(thread_pool_byte_span tp, std::atomic_bool* flags, thread_pool_monitor& mon) noexcept //
+			: pool{ tp },
+			  occupied{ flags },
+			  monitor{ mon },
+			  capacity{ static_cast<ptrdiff_t>(pool.size() / impl::thread_pool_alignment) }
+		{
+			MUU_ASSERT(!pool.empty());
+			MUU_ASSERT(occupied);
+			MUU_ASSERT(capacity);
+
+			for (ptrdiff_t i = 0; i < capacity; i++)
+				::new (static_cast<void*>(occupied + i)) std::atomic_bool{ false };
+		}
+
+		~thread_pool_deque() noexcept
+		{
+			const auto t = top_.load();
+			const auto b = bottom_.load();
+			if (b > t)
+			{
+				for (auto i = t; i < b; i++)
+					MUU_LAUNDER(reinterpret_cast<task*>(get_slot(i)))->~task();
+				monitor.decrement(static_cast<size_t>(b - t));
+			}
+		}
+
+		MUU_DELETE_COPY(thread_pool_deque);
+		MUU_DELETE_MOVE(thread_pool_deque);
+
+		MUU_PURE_INLINE_GETTER
+		bool empty() const noexcept
+		{
+			return bottom_.load(std::memory_order_acquire) <= top_.load(std::memory_order_acquire);
+		}
+
+		// owner-only: true if there's room for another 'required' tasks
+		MUU_NODISCARD
+		bool try_lock(size_t required = 1u) noexcept
+		{
+			MUU_ASSERT(!pending_);
+
+			const auto b = bottom_.load(std::memory_order_relaxed);
+			const auto t = top_.load(std::memory_order_acquire);
+			return (b - t) + static_cast<ptrdiff_t>(required) <= capacity;
+		}
+
+		// owner-only
+		MUU_NODISCARD
+		MUU_ATTR(returns_nonnull)
+		MUU_ATTR(assume_aligned(impl::thread_pool_alignment))
+		void* acquire() noexcept
+		{
+			const auto i = bottom_.load(std::memory_order_relaxed) + pending_++;
+
+			// the slot may still be in the process of being vacated by a thief
+			auto& flag = occupied[i % capacity];
+			while (flag.load(std::memory_order_acquire))
+				MUU_PAUSE();
+
+			return get_slot(i);
+		}
+
+		// owner-only
+		void unlock() noexcept
+		{
+			const auto count = std::exchange(pending_, ptrdiff_t{});
+			if (!count)
+				return;
+
+			monitor.increment(static_cast<size_t>(count));
+
+			const auto b = bottom_.load(std::memory_order_relaxed);
+			for (auto i = b; i < b + count; i++)
+			{
+				MUU_ASSERT(MUU_LAUNDER(reinterpret_cast<task*>(get_slot(i)))->action_invoker);
+				occupied[i % capacity].store(true, std::memory_order_release);
+			}
+			bottom_.store(b + count, std::memory_order_release);
+		}
+
+		// owner-only (LIFO end)
+		MUU_NODISCARD
+		MUU_ATTR(nonnull)
+		MUU_ATTR(assume_aligned(impl::thread_pool_alignment))
+		task* pop(void* buf) noexcept
+		{
+			const auto b = bottom_.load(std::memory_order_relaxed) - 1;
+			bottom_.store(b, std::memory_order_release);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			auto t = top_.load(std::memory_order_relaxed);
+
+			if (t > b) // empty
+			{
+				bottom_.store(b + 1, std::memory_order_release);
+				return nullptr;
+			}
+
+			if (t == b) // last task; race any thieves for it
+			{
+				const bool won =
+					top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+				bottom_.store(b + 1, std::memory_order_release);
+				if (!won)
+					return nullptr;
+			}
+
+			return move_out(b, buf);
+		}
+
+		// any thread (FIFO end)
+		MUU_NODISCARD
+		MUU_ATTR(nonnull)
+		MUU_ATTR(assume_aligned(impl::thread_pool_alignment))
+		task* steal(void* buf) noexcept
+		{
+			auto t = top_.load(std::memory_order_acquire);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			const auto b = bottom_.load(std::memory_order_acquire);
+
+			if (t >= b)
+				return nullptr;
+
+			if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+				return nullptr;
+
+			return move_out(t, buf);
+		}
+	};
+
+	class thread_pool_injection_queue
+	{
+		// bounded lock-free MPMC queue, based on Dmitry Vyukov's:
+		// https://www.1024cores.net/home/lock-free-algorithms/queues/bounded-mpmc-queue
+		//
+		// the sequence numbers live in their own array since the tasks occupy the entire slot.
+		// producers may reserve multiple consecutive slots at once (e.g. for for_each() batches);
+		// reservations are tracked per-thread between lock() and unlock().
+
+	  private:
+		using task = impl::thread_pool_task;
+
+		struct reservation
+		{
+			size_t pos;
+			size_t count;
+			size_t acquired;
+		};
+		static thread_local reservation reservation_;
+
+		thread_pool_byte_span pool;
+		std::atomic<size_t>* sequences;
+		thread_pool_monitor& monitor;
+		size_t capacity;
+
+		alignas(impl::thread_pool_alignment) std::atomic<size_t> enqueue_pos_ = 0_sz;
+		alignas(impl::thread_pool_alignment) std::atomic<size_t> dequeue_pos_ = 0_sz;
+
+		MUU_PURE_GETTER
+		MUU_ATTR(returns_nonnull)
+		MUU_ATTR(assume_aligned(impl::thread_pool_alignment))
+		std::byte* get_slot(size_t pos) noexcept
+		{
+			return muu::assume_aligned<impl::thread_pool_alignment>(pool.data())
+				 + impl::thread_pool_alignment * (pos % capacity);
+		}
+
+		MUU_PURE_INLINE_GETTER
+		std::atomic<size_t>& sequence(size_t pos) noexcept
+		{
+			return sequences[pos % capacity];
+		}
+
+	  public:
+		MUU_NODISCARD_CTOR
+		thread_pool_injection_queue(thread_pool_byte_span tp, std::atomic<size_t>* seqs, thread_pool_monitor& mon) noexcept
+			: pool{ tp },
+			  sequences{ seqs },
+			  monitor{ mon },
+			  capacity{ pool.size() / impl::thread_pool_alignment }
+		{
+			MUU_ASSERT(!pool.empty());
+			MUU_ASSERT(sequences);
+			MUU_ASSERT(capacity >= 2u);
+
+			for (size_t i = 0; i < capacity; i++)
+				::new (static_cast<void*>(sequences + i)) std::atomic<size_t>{ i };
+		}
+
+		~thread_pool_injection_queue() noexcept
+		{
+			const auto back = enqueue_pos_.load();
+			auto front		= dequeue_pos_.load();
+			if (back > front)
+			{
+				const auto remaining = back - front;
+				for (; front < back; front++)
+					MUU_LAUNDER(reinterpret_cast<task*>(get_slot(front)))->~task();
+				monitor.decrement(remaining);
+			}
+		}
+
+		MUU_DELETE_COPY(thread_pool_injection_queue);
+		MUU_DELETE_MOVE(thread_pool_injection_queue);
+
+		MUU_PURE_INLINE_GETTER
+		bool empty() const noexcept
+		{
+			return enqueue_pos_.load(std::memory_order_acquire) <= dequeue_pos_.load(std::memory_order_acquire);
+		}
+
+		MUU_PURE_INLINE_GETTER
+		size_t max_size() const noexcept
+		{
+			return capacity;
+		}
+
+		// reserves 'required' consecutive slots for the calling thread
+		MUU_NODISCARD
+		bool try_lock(size_t required = 1u) noexcept
+		{
+			MUU_ASSUME(required >= 1u);
+
+			if (required > capacity)
+				return false;
+
+			auto pos = enqueue_pos_.load(std::memory_order_relaxed);
+			while (true)
+			{
+				// slots only ever go from 'in use' to 'free' without moving enqueue_pos_,
+				// so if they're all free now they'll still be free if the CAS succeeds
+				bool free = true;
+				for (size_t i = required; i-- > 0_sz && free;)
+				{
+					const auto seq = sequence(pos + i).load(std::memory_order_acquire);
+					const auto diff =
+						static_cast<ptrdiff_t>(seq) - static_cast<ptrdiff_t>(pos + i);
+					if (diff < 0) // full
+						return false;
+					free = diff == 0;
+				}
+
+				if (free)
+				{
+					if (enqueue_pos_.compare_exchange_weak(pos, pos + required, std::memory_order_relaxed))
+					{
+						reservation_ = { pos, required, 0_sz };
+						return true;
+					}
+				}
+				else
+					pos = enqueue_pos_.load(std::memory_order_relaxed);
+
+				MUU_PAUSE();
+			}
+		}
+
+		MUU_NODISCARD
+		MUU_ATTR(returns_nonnull)
+		MUU_ATTR(assume_aligned(impl::thread_pool_alignment))
+		void* acquire() noexcept
+		{
+			MUU_ASSERT(reservation_.acquired < reservation_.count);
+
+			return get_slot(reservation_.pos + reservation_.acquired++);
+		}
+
+		void unlock() noexcept
+		{
+			const auto res = std::exchange(reservation_, reservation{});
+			MUU_ASSERT(res.acquired == res.count);
+
+			monitor.increment(res.count);
+
+			for (size_t i = 0; i < res.count; i++)
+			{
+				MUU_ASSERT(MUU_LAUNDER(reinterpret_cast<task*>(get_slot(res.pos + i)))->action_invoker);
+				sequence(res.pos + i).store(res.pos + i + 1u, std::memory_order_release);
+			}
+		}
+
+		MUU_NODISCARD
+		MUU_ATTR(nonnull)
+		MUU_ATTR(assume_aligned(impl::thread_pool_alignment))
+		task* try_pop(void* buf) noexcept
+		{
+			auto pos = dequeue_pos_.load(std::memory_order_relaxed);
+			while (true)
+			{
+				auto& seq		= sequence(pos);
+				const auto diff = static_cast<ptrdiff_t>(seq.load(std::memory_order_acquire))
+								- static_cast<ptrdiff_t>(pos + 1u);
+				if (diff < 0) // empty (or the producer hasn't finished yet)
+					return nullptr;
+
+				if (diff == 0)
+				{
+					if (dequeue_pos_.compare_exchange_weak(pos, pos + 1u, std::memory_order_relaxed))
+					{
+						auto t = MUU_LAUNDER(reinterpret_cast<task*>(get_slot(pos)));
+						MUU_ASSERT(t->action_invoker);
+
+						auto result =
+							::new (muu::assume_aligned<impl::thread_pool_alignment>(buf)) task{ MUU_MOVE(*t) };
+						MUU_ASSERT(result->action_invoker);
+
+						t->~task();
+						seq.store(pos + capacity, std::memory_order_release);
+						return result;
+					}
+				}
+				else
+					pos = dequeue_pos_.load(std::memory_order_relaxed);
+			}
+		}
+	};
+
+	thread_local thread_pool_injection_queue::reservation thread_pool_injection_queue::reservation_ = {};
+
+	static constexpr size_t thread_pool_spin_wait_iterations_per_queue = 100;
+
+	// idle workers sweep every queue once per round, pausing before each attempt for twice as long as they did in the
+	// previous round (up to max_backoff pauses), and park once they've gone the given number of rounds without work.
+	struct thread_pool_idle_params
+	{
+		size_t rounds;
+		size_t max_backoff;
+	};
+
+	MUU_CONST_GETTER
+	static constexpr thread_pool_idle_params calc_thread_pool_idle_params(thread_pool_idle_strategy strategy) noexcept
+	{
+		switch (strategy)
+		{
+			case thread_pool_idle_strategy::low_latency: return { 64u, 64u };
+			case thread_pool_idle_strategy::low_power: return { 1u, 1u };
+			case thread_pool_idle_strategy::balanced: [[fallthrough]];
+			default: return { 8u, 16u };
+		}
+	}
+
+	// one injection queue per thread_pool_priority
+	static constexpr size_t thread_pool_priority_count = 3;
+	static_assert(static_cast<size_t>(thread_pool_priority::high) == thread_pool_priority_count - 1u);
+
+	//--- processor topology -----------------------------------------------------------------------------------------
+
+	// the logical processors the process may run on, grouped by NUMA node (neither the list nor any node is empty)
+	using thread_pool_topology = std::vector<std::vector<unsigned>>;
+
+#if MUU_LINUX
+
+	// parses a sysfs cpu list (e.g. "0-3,8-11")
+	static std::vector<unsigned> parse_cpu_list(const char* path)
+	{
+		std::vector<unsigned> cpus;
+
+		auto file = std::fopen(path, "r");
+		if (!file)
+			return cpus;
+		const auto close_file = scope_guard{ [=]() noexcept { std::fclose(file); } };
+
+		unsigned first{}, last{};
+		char sep{};
+		while (std::fscanf(file, "%u", &first) == 1)
+		{
+			last = first;
+			if (std::fscanf(file, "%c", &sep) == 1 && sep == '-')
+			{
+				if (std::fscanf(file, "%u", &last) != 1)
+					break;
+				if (std::fscanf(file, "%c", &sep) != 1)
+					sep = '\0';
+			}
+			for (auto cpu = first; cpu <= last && cpu < CPU_SETSIZE; cpu++)
+				cpus.push_back(cpu);
+			if (sep != ',')
+				break;
+		}
+		return cpus;
+	}
+
+	static thread_pool_topology read_thread_pool_topology()
+	{
+		cpu_set_t allowed;
+		CPU_ZERO(&allowed);
+		if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0)
+		{
+			for (unsigned i = 0, e = max(std::thread::hardware_concurrency(), 1u); i < e && i < CPU_SETSIZE; i++)
+				CPU_SET(i, &allowed);
+		}
+
+		thread_pool_topology nodes;
+		for (auto node : parse_cpu_list("/sys/devices/system/node/online"))
+		{
+			char path[64];
+			std::snprintf(path, sizeof(path), "/sys/devices/system/node/node%u/cpulist", node);
+
+			auto cpus = parse_cpu_list(path);
+			cpus.erase(std::remove_if(cpus.begin(), cpus.end(), [&](unsigned cpu) { return !CPU_ISSET(cpu, &allowed); }),
+					   cpus.end());
+			for (auto cpu : cpus)
+				CPU_CLR(cpu, &allowed);
+			if (!cpus.empty())
+				nodes.push_back(MUU_MOVE(cpus));
+		}
+
+		// anything not belonging to a node (e.g. no NUMA support in the kernel) gets lumped into the first one
+		if (nodes.empty())
+			nodes.emplace_back();
+		for (unsigned cpu = 0; cpu < CPU_SETSIZE; cpu++)
+			if (CPU_ISSET(cpu, &allowed))
+				nodes.front().push_back(cpu);
+		if (nodes.front().empty())
+			nodes.front().push_back(0u);
+
+		return nodes;
+	}
+
+	static void pin_current_thread(const unsigned* cpus, size_t count) noexcept
+	{
+		cpu_set_t set;
+		CPU_ZERO(&set);
+		for (size_t i = 0; i < count; i++)
+			CPU_SET(cpus[i], &set);
+		MUU_UNUSED(pthread_setaffinity_np(pthread_self(), sizeof(set), &set));
+	}
+
+#else
+
+	static thread_pool_topology read_thread_pool_topology()
+	{
+		thread_pool_topology nodes(1u);
+		for (unsigned i = 0, e = max(std::thread::hardware_concurrency(), 1u); i < e; i++)
+			nodes.front().push_back(i);
+		return nodes;
+	}
+
+	static void pin_current_thread(const unsigned* cpus, size_t count) noexcept
+	{
+	#if MUU_WINDOWS
+		DWORD_PTR mask = {};
+		for (size_t i = 0; i < count; i++)
+			if (cpus[i] < sizeof(DWORD_PTR) * CHAR_BIT)
+				mask |= DWORD_PTR{ 1 } << cpus[i];
+		if (mask)
+			MUU_UNUSED(SetThreadAffinityMask(GetCurrentThread(), mask));
+	#else
+		MUU_UNUSED(cpus);
+		MUU_UNUSED(count);
+	#endif
+	}
+
+#endif
+
+	static const thread_pool_topology& get_thread_pool_topology()
+	{
+		static const auto topology = read_thread_pool_topology();
+		return topology;
+	}
+
+	// where a worker runs, and which other workers share its NUMA node
+	struct thread_pool_worker_placement
+	{
+		const unsigned* cpus; // nullptr == unpinned
+		size_t cpu_count;
+		size_t node_first; // index of the first worker on the same node
+		size_t node_size;  // number of workers on the same node
+	};
+
+	static std::vector<thread_pool_worker_placement> calc_thread_pool_placement(size_t worker_count,
+																				 thread_pool_affinity affinity)
+	{
+		std::vector<thread_pool_worker_placement> placement(worker_count,
+															thread_pool_worker_placement{ nullptr, 0u, 0u, worker_count });
+		if (affinity == thread_pool_affinity::none)
+			return placement;
+
+		const auto& nodes = get_thread_pool_topology();
+		size_t total_cpus = {};
+		for (auto& node : nodes)
+			total_cpus += node.size();
+
+		// workers are handed out to nodes in contiguous blocks, in proportion to the number of cpus in each node
+		size_t cpus_before = {};
+		for (auto& node : nodes)
+		{
+			const auto first = worker_count * cpus_before / total_cpus;
+			cpus_before += node.size();
+			const auto last = worker_count * cpus_before / total_cpus;
+
+			for (auto i = first; i < last; i++)
+			{
+				auto& p		 = placement[i];
+				p.node_first = first;
+				p.node_size	 = last - first;
+				if (affinity == thread_pool_affinity::cores)
+				{
+					p.cpus		= node.data() + (i - first) % node.size();
+					p.cpu_count = 1u;
+				}
+				else
+				{
+					p.cpus		= node.data();
+					p.cpu_count = node.size();
+				}
+			}
+		}
+		return placement;
+	}
+
+	struct thread_pool_impl;
+
+	// the counters behind thread_pool_worker_stats.
+	// they're mostly only written by the worker itself, but reset_stats() may zero them from any thread at any time,
+	// so they're bumped with relaxed RMWs (a plain load+store could write a stale total back over a reset).
+	struct alignas(impl::thread_pool_alignment) thread_pool_worker_counters
+	{
+		std::atomic<uint64_t> tasks_executed   = {};
+		std::atomic<uint64_t> steal_attempts   = {};
+		std::atomic<uint64_t> steals		   = {};
+		std::atomic<uint64_t> failed_pops	   = {};
+		std::atomic<uint64_t> sleeps		   = {};
+		std::atomic<uint64_t> busy_nanoseconds = {};
+		std::atomic<uint64_t> idle_nanoseconds = {};
+
+		MUU_ALWAYS_INLINE
+		static void add(std::atomic<uint64_t>& counter, uint64_t n = 1u) noexcept
+		{
+			counter.fetch_add(n, std::memory_order_relaxed);
+		}
+
+		MUU_ALWAYS_INLINE
+		static void add(std::atomic<uint64_t>& counter, std::chrono::steady_clock::duration d) noexcept
+		{
+			add(counter, static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(d).count()));
+		}
+
+		void accumulate(thread_pool_worker_stats& out) const noexcept
+		{
+			out.tasks_executed += tasks_executed.load(std::memory_order_relaxed);
+			out.steal_attempts += steal_attempts.load(std::memory_order_relaxed);
+			out.steals += steals.load(std::memory_order_relaxed);
+			out.failed_pops += failed_pops.load(std::memory_order_relaxed);
+			out.sleeps += sleeps.load(std::memory_order_relaxed);
+			out.busy_nanoseconds += busy_nanoseconds.load(std::memory_order_relaxed);
+			out.idle_nanoseconds += idle_nanoseconds.load(std::memory_order_relaxed);
+		}
+
+		void reset() noexcept
+		{
+			for (auto c : { &tasks_executed,
+							&steal_attempts,
+							&steals,
+							&failed_pops,
+							&sleeps,
+							&busy_nanoseconds,
+							&idle_nanoseconds })
+				c->store(0u, std::memory_order_relaxed);
+		}
+	};
+
+	// a slot for one of the pool's workers. slots are allocated for the pool's maximum number of workers up-front,
+	// but only have a thread running in them while they're active (or retiring).
+	class thread_pool_worker
+	{
+	  private:
+		enum class states : uint8_t
+		{
+			retired, // no thread running (or it has stopped looking for work and is about to exit)
+			active,
+			retiring // thread still running, but will exit as soon as it gets the chance
+		};
+
+		std::thread thread;
+		std::atomic_bool terminated_ = false;
+		std::atomic<states> state_	 = states::retired;
+		const size_t index_;
+		const std::string name_;
+		const thread_pool_worker_placement placement_;
+		thread_pool_impl& pool_;
+
+	  public:
+		const size_t node_first; // index of the first worker on the same NUMA node
+		const size_t node_size;	 // number of workers on the same NUMA node
+		thread_pool_worker_counters counters;
+
+		thread_pool_eventcount event; // parked on when idle
+
+		// when the worker parked (steady_clock ticks), or zero while it's awake. only tracked by auto-scaling pools.
+		std::atomic<std::chrono::steady_clock::rep> parked_since = {};
+
+		void terminate() noexcept
+		{
+			terminated_ = true;
+
+			// pairs with the fence in event.prepare_wait()
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			event.notify();
+		}
+
+		MUU_PURE_INLINE_GETTER
+		bool terminated() const noexcept
+		{
+			return terminated_;
+		}
+
+		// true if the worker should stop looking for work (because the pool is shutting down or it's being retired)
+		MUU_PURE_INLINE_GETTER
+		bool stopping() const noexcept
+		{
+			return terminated_.load(std::memory_order_relaxed)
+				|| state_.load(std::memory_order_relaxed) != states::active;
+		}
+
+		// called by the worker thread once stopping() - returns false if it was reactivated in the meantime
+		MUU_NODISCARD
+		bool try_exit() noexcept
+		{
+			if (terminated_)
+				return true;
+
+			auto expected = states::retiring;
+			return state_.compare_exchange_strong(expected, states::retired, std::memory_order_acq_rel)
+				|| expected == states::retired;
+		}
+
+		// (re)starts the worker (must be serialized with retire())
+		void start();
+
+		// asks the worker to exit once it's done with its current task (must be serialized with start())
+		void retire() noexcept
+		{
+			auto expected = states::active;
+			if (!state_.compare_exchange_strong(expected, states::retiring, std::memory_order_acq_rel))
+				return;
+
+			// pairs with the fence in event.prepare_wait()
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			event.notify();
+		}
+
+		MUU_NODISCARD_CTOR
+		thread_pool_worker(size_t worker_index,
+						   std::string&& worker_name,
+						   const thread_pool_worker_placement& placement,
+						   thread_pool_impl& pool) noexcept //
+			: index_{ worker_index },
+			  name_{ MUU_MOVE(worker_name) },
+			  placement_{ placement },
+			  pool_{ pool },
+			  node_first{ placement.node_first },
+			  node_size{ placement.node_size }
+		{}
+
+		~thread_pool_worker() noexcept
+		{
+			if (thread.joinable())
+				thread.join();
+		}
+
+		MUU_DELETE_COPY(thread_pool_worker);
+		MUU_DELETE_MOVE(thread_pool_worker);
+	};
+
+	// identifies the pool (and worker index) the calling thread belongs to, if any
+	struct thread_pool_worker_context
+	{
+		const thread_pool_impl* pool;
+		size_t index;
+	};
+	static thread_local thread_pool_worker_context current_worker = {};
+
+	MUU_PURE_GETTER
+	static size_t calc_thread_pool_workers(size_t worker_count) noexcept
+	{
+		static constexpr auto absolute_max_workers = 1024_sz;
+		static const auto concurrency			= max(static_cast<size_t>(std::thread::hardware_concurrency()), 1_sz);
+		static const auto effective_max_workers = min(concurrency * 64_sz, absolute_max_workers);
+
+		return min(worker_count ? worker_count : concurrency, effective_max_workers);
+	}
+
+	// how a pool's task_queue_size is split between its queues:
+	// - half goes to the worker queues (which also serve as the overflow for the normal-priority injection lane)
+	// - a quarter goes to the normal-priority injection lane
+	// - an eighth each goes to the high- and low-priority injection lanes
+	struct thread_pool_queue_sizes
+	{
+		size_t worker; // per worker
+		size_t injection[thread_pool_priority_count];
+	};
+
+	MUU_PURE_GETTER
+	static constexpr thread_pool_queue_sizes calc_thread_pool_queue_sizes(size_t worker_count,
+																		  size_t task_queue_size) noexcept
+	{
+		constexpr size_t max_buffer_size		 = 256_mb; // 4M tasks on x64
+		constexpr size_t default_buffer_size	 = 64_kb;  // 1024 tasks on x64
+		constexpr size_t max_task_queue_size	 = max_buffer_size / impl::thread_pool_alignment;
+		constexpr size_t default_task_queue_size = default_buffer_size / impl::thread_pool_alignment;
+		static_assert(max_task_queue_size > 0);
+		static_assert(default_task_queue_size > 0);
+		MUU_ASSUME(worker_count > 0);
+
+		if (!task_queue_size)
+			task_queue_size = default_task_queue_size;
+		task_queue_size = min(task_queue_size, max_task_queue_size);
+
+		thread_pool_queue_sizes sizes{};
+		sizes.worker = max(min(static_cast<size_t>(std::ceil(static_cast<double>(task_queue_size / 2u)
+															 / static_cast<double>(worker_count))),
+							   (max_task_queue_size / 2u) / worker_count),
+						   1_sz);
+
+		// injection lanes need at least two slots, otherwise their sequence numbers can't tell full from empty
+		sizes.injection[static_cast<size_t>(thread_pool_priority::low)]	   = max(task_queue_size / 8u, 2_sz);
+		sizes.injection[static_cast<size_t>(thread_pool_priority::normal)] = max(task_queue_size / 4u, 2_sz);
+		sizes.injection[static_cast<size_t>(thread_pool_priority::high)]   = max(task_queue_size / 8u, 2_sz);
+		return sizes;
+	}
+
+	// thread_pool_options, with the defaults filled in
+	struct thread_pool_settings
+	{
+		size_t initial_workers;
+		thread_pool_scheduler scheduler;
+		thread_pool_affinity affinity;
+		thread_pool_idle_strategy idle_strategy;
+		bool collect_stats;
+		bool auto_scale;
+		std::chrono::milliseconds idle_timeout;
+	};
+
+	struct thread_pool_buffers
+	{
+		thread_pool_byte_span queues;
+		thread_pool_byte_span workers;
+		thread_pool_byte_span tasks;
+		thread_pool_byte_span deques;		// work-stealing only
+		thread_pool_byte_span deque_tasks;	// work-stealing only
+		thread_pool_byte_span deque_flags;	// work-stealing only
+		thread_pool_byte_span injection_tasks[thread_pool_priority_count];
+		thread_pool_byte_span injection_sequences[thread_pool_priority_count];
+	};
+
+	// enqueued when a timer comes due; runs the timer's task, then reschedules or destroys the timer
+	class thread_pool_timer_fire_task
+	{
+	  private:
+		thread_pool_impl* pool_;
+		impl::thread_pool_timer* timer_;
+
+	  public:
+		MUU_NODISCARD_CTOR
+		thread_pool_timer_fire_task(thread_pool_impl& pool, impl::thread_pool_timer* timer) noexcept //
+			: pool_{ &pool },
+			  timer_{ timer }
+		{}
+
+		MUU_NODISCARD_CTOR
+		thread_pool_timer_fire_task(thread_pool_timer_fire_task&& other) noexcept //
+			: pool_{ other.pool_ },
+			  timer_{ std::exchange(other.timer_, nullptr) }
+		{}
+
+		thread_pool_timer_fire_task& operator=(thread_pool_timer_fire_task&&) = delete;
+		thread_pool_timer_fire_task(const thread_pool_timer_fire_task&)		  = delete;
+		thread_pool_timer_fire_task& operator=(const thread_pool_timer_fire_task&) = delete;
+
+		inline ~thread_pool_timer_fire_task() noexcept;
+
+		inline void operator()(size_t worker_index) noexcept;
+	};
+
+	struct thread_pool_impl
+	{
+		thread_pool_byte_span queue_buffer;
+		thread_pool_byte_span worker_buffer;
+		thread_pool_byte_span task_buffer;
+		thread_pool_byte_span deque_buffer;
+		size_t worker_count{}; // also the queue count
+		size_t worker_queue_size{};
+		thread_pool_scheduler scheduler{};
+		thread_pool_idle_params idle_params{};
+		bool collect_stats{};
+		std::atomic<size_t> next_queue		 = 0_sz;
+		std::atomic<size_t> next_wake		 = 0_sz;
+		std::atomic<size_t> sleeping_workers = 0_sz; // workers parked (or about to park) on their eventcount
+		std::atomic<size_t> active_workers	 = 0_sz; // workers [0, active_workers) have a thread running
+		std::mutex resize_mutex;
+		std::atomic<size_t> waiting_tasks	 = 0_sz; // tasks blocked in wait() on one of the workers
+		thread_pool_slab slab; // must outlive any tasks still in the queues at destruction
+		mutable thread_pool_monitor monitor;
+		thread_pool_injection_queue injection[thread_pool_priority_count]; // indexed by thread_pool_priority
+
+		// auto-scaling
+		bool auto_scale{};
+		size_t min_workers{};
+		std::chrono::milliseconds idle_timeout{};
+		std::atomic_bool grow_requested = false;
+		std::thread scaler;
+		std::mutex scaler_mutex;
+		std::condition_variable scaler_cv;
+		bool scaler_terminated = false;
+
+		// delayed and periodic tasks
+		using timer_clock = std::chrono::steady_clock;
+		spin_mutex timer_mutex;
+		thread_pool_timing_wheel timers;
+		static constexpr size_t no_timekeeper	  = static_cast<size_t>(-1);
+		const timer_clock::time_point timer_epoch = timer_clock::now(); // tick zero
+		bool timers_terminated					  = false;
+		std::atomic<size_t> timer_count			  = 0_sz; // timers.size(), readable without the lock
+		std::atomic<uint64_t> next_timer_tick	  = constants<uint64_t>::highest; // timers.next_event(), likewise
+		std::atomic<size_t> timekeeper			  = no_timekeeper; // the worker sleeping until next_timer_tick
+
+		// pool-wide statistics (the per-worker ones live in thread_pool_worker::counters)
+		alignas(impl::thread_pool_alignment) std::atomic<uint64_t> enqueue_spins = {};
+		std::atomic<uint64_t> enqueue_sleeps									  = {};
+		std::atomic<size_t> queue_high_water_mark								  = {};
+
+		MUU_PURE_INLINE_GETTER
+		bool work_stealing() const noexcept
+		{
+			return scheduler == thread_pool_scheduler::work_stealing;
+		}
+
+		MUU_PURE_INLINE_GETTER
+		thread_pool_deque& deque(size_t idx) noexcept
+		{
+			MUU_ASSERT(work_stealing());
+			MUU_ASSERT(idx < worker_count);
+			return *MUU_LAUNDER(
+				reinterpret_cast<thread_pool_deque*>(deque_buffer.data() + sizeof(thread_pool_deque) * idx));
+		}
+
+		// queue indices handed out by lock() are either a shared queue ([0, worker_count)),
+		// the calling worker's own deque ([worker_count, worker_count * 2)),
+		// or one of the lock-free injection queues ([worker_count * 2, worker_count * 2 + priority count)).
+		MUU_PURE_INLINE_GETTER
+		bool is_deque_index(size_t queue_index) const noexcept
+		{
+			return queue_index >= worker_count && queue_index < worker_count * 2u;
+		}
+
+		MUU_PURE_INLINE_GETTER
+		bool is_injection_index(size_t queue_index) const noexcept
+		{
+			return queue_index >= worker_count * 2u;
+		}
+
+		MUU_PURE_INLINE_GETTER
+		size_t injection_index(thread_pool_priority priority) const noexcept
+		{
+			return worker_count * 2u + static_cast<size_t>(priority);
+		}
+
+		MUU_PURE_INLINE_GETTER
+		thread_pool_injection_queue& injection_queue(thread_pool_priority priority) noexcept
+		{
+			MUU_ASSERT(static_cast<size_t>(priority) < thread_pool_priority_count);
+			return injection[static_cast<size_t>(priority)];
+		}
+
+		// the index of the calling thread if it's one of this pool's workers, or -1.
+		MUU_PURE_INLINE_GETTER
+		size_t current_worker_index() const noexcept
+		{
+			return current_worker.pool == this ? current_worker.index : static_cast<size_t>(-1);
+		}
+
+		MUU_PURE_INLINE_GETTER
+		thread_pool_queue& queue(size_t idx) noexcept
+		{
+			MUU_ASSERT(idx < worker_count);
+			return *MUU_LAUNDER(
+				reinterpret_cast<thread_pool_queue*>(queue_buffer.data() + sizeof(thread_pool_queue) * idx));
+		}
+
+		MUU_PURE_INLINE_GETTER
+		thread_pool_worker& worker(size_t idx) noexcept
+		{
+			MUU_ASSERT(idx < worker_count);
+			return *MUU_LAUNDER(
+				reinterpret_cast<thread_pool_worker*>(worker_buffer.data() + sizeof(thread_pool_worker) * idx));
+		}
+
+		MUU_NODISCARD_CTOR
+		thread_pool_impl(string_param&& name, const thread_pool_settings& settings, const thread_pool_buffers& buffers)
+			: queue_buffer{ buffers.queues },
+			  worker_buffer{ buffers.workers },
+			  task_buffer{ buffers.tasks },
+			  deque_buffer{ buffers.deques },
+			  scheduler{ settings.scheduler },
+			  idle_params{ calc_thread_pool_idle_params(settings.idle_strategy) },
+			  collect_stats{ settings.collect_stats },
+			  injection{ { buffers.injection_tasks[0],
+						   reinterpret_cast<std::atomic<size_t>*>(buffers.injection_sequences[0].data()),
+						   monitor },
+						 { buffers.injection_tasks[1],
+						   reinterpret_cast<std::atomic<size_t>*>(buffers.injection_sequences[1].data()),
+						   monitor },
+						 { buffers.injection_tasks[2],
+						   reinterpret_cast<std::atomic<size_t>*>(buffers.injection_sequences[2].data()),
+						   monitor } },
+			  auto_scale{ settings.auto_scale },
+			  min_workers{ settings.initial_workers },
+			  idle_timeout{ settings.idle_timeout }
+		{
+			MUU_ASSERT(!queue_buffer.empty());
+			MUU_ASSERT(!worker_buffer.empty());
+			MUU_ASSERT(!task_buffer.empty());
+			MUU_ASSERT(queue_buffer.size() % sizeof(thread_pool_queue) == 0_sz);
+			MUU_ASSERT(worker_buffer.size() % sizeof(thread_pool_worker) == 0_sz);
+			MUU_ASSERT(task_buffer.size() % impl::thread_pool_alignment == 0_sz);
+			MUU_ASSERT(reinterpret_cast<uintptr_t>(task_buffer.data()) % impl::thread_pool_alignment == 0_sz);
+
+			worker_count	  = worker_buffer.size() / sizeof(thread_pool_worker);
+			worker_queue_size = task_buffer.size() / impl::thread_pool_alignment / worker_count;
+			MUU_ASSERT(queue_buffer.size() / sizeof(thread_pool_queue) == worker_count);
+
+			for (size_t i = 0; i < worker_count; i++)
+			{
+				thread_pool_byte_span pool{ task_buffer.data() + impl::thread_pool_alignment * worker_queue_size * i,
+											impl::thread_pool_alignment * worker_queue_size };
+				::new (static_cast<void*>(queue_buffer.data() + sizeof(thread_pool_queue) * i))
+					thread_pool_queue{ pool, monitor };
+			}
+			auto unwind_queues = scope_guard{ [&]() noexcept
+											  {
+												  for (size_t i = worker_count; i-- > 0_sz;)
+													  queue(i).~thread_pool_queue();
+											  } };
+
+			if (work_stealing())
+			{
+				MUU_ASSERT(deque_buffer.size() == sizeof(thread_pool_deque) * worker_count);
+				MUU_ASSERT(buffers.deque_tasks.size() == task_buffer.size());
+				MUU_ASSERT(buffers.deque_flags.size() >= sizeof(std::atomic_bool) * worker_queue_size * worker_count);
+
+				for (size_t i = 0; i < worker_count; i++)
+				{
+					thread_pool_byte_span pool{ buffers.deque_tasks.data()
+													+ impl::thread_pool_alignment * worker_queue_size * i,
+												impl::thread_pool_alignment * worker_queue_size };
+					auto flags = reinterpret_cast<std::atomic_bool*>(buffers.deque_flags.data())
+							   + worker_queue_size * i;
+					::new (static_cast<void*>(deque_buffer.data() + sizeof(thread_pool_deque) * i))
+						thread_pool_deque{ pool, flags, monitor };
+				}
+			}
+			auto unwind_deques = scope_guard{ [&]() noexcept
+											  {
+												  if (work_stealing())
+												  {
+													  for (size_t i = worker_count; i-- > 0_sz;)
+														  deque(i).~thread_pool_deque();
+												  }
+											  } };
+
+			const auto placement		 = calc_thread_pool_placement(worker_count, settings.affinity);
+			std::string_view worker_name = name ? std::string_view{ name } : "muu::thread_pool"sv;
+			size_t constructed_workers	 = {};
+			auto unwind_workers			 = scope_guard{ [&]() noexcept
+												{
+												   for (size_t i = constructed_workers; i-- > 0_sz;)
+													   worker(i).terminate();
+												   for (size_t i = constructed_workers; i-- > 0_sz;)
+													   worker(i).~thread_pool_worker();
+											   } };
+			for (size_t i = 0; i < worker_count; i++)
+			{
+				std::string n;
+				n.reserve(worker_name.length() + 5u);
+				n.append(worker_name);
+				n.append(" ["sv);
+				n.append(std::to_string(i));
+				n += ']';
+
+				::new (static_cast<void*>(worker_buffer.data() + sizeof(thread_pool_worker) * i))
+					thread_pool_worker{ i, MUU_MOVE(n), placement[i], *this };
+				constructed_workers++;
+			}
+
+			MUU_ASSERT(settings.initial_workers >= 1u);
+			MUU_ASSERT(settings.initial_workers <= worker_count);
+			for (size_t i = 0; i < settings.initial_workers; i++)
+			{
+				worker(i).start();
+				active_workers.store(i + 1u, std::memory_order_relaxed);
+			}
+
+			if (auto_scale)
+				scaler = std::thread{ [this]() noexcept { scaler_main(); } };
+
+			unwind_queues.dismiss();
+			unwind_deques.dismiss();
+			unwind_workers.dismiss();
+		}
+
+		~thread_pool_impl() noexcept
+		{
+			if (scaler.joinable())
+			{
+				{
+					std::lock_guard lock{ scaler_mutex };
+					scaler_terminated = true;
+				}
+				scaler_cv.notify_all();
+				scaler.join();
+			}
+
+			// timers that haven't come due yet are never run
+			impl::thread_pool_timer* pending_timers;
+			{
+				std::lock_guard lock{ timer_mutex };
+				timers_terminated = true;
+				pending_timers	  = timers.clear();
+				timer_count.store(0u, std::memory_order_relaxed);
+				next_timer_tick.store(constants<uint64_t>::highest, std::memory_order_relaxed);
+			}
+			while (pending_timers)
+				destroy_timer(std::exchange(pending_timers, pending_timers->next));
+
+			for (size_t i = worker_count; i-- > 0_sz;)
+				queue(i).terminate();
+			for (size_t i = worker_count; i-- > 0_sz;)
+			{
+				worker(i).terminate();
+				worker(i).~thread_pool_worker();
+			}
+			if (work_stealing())
+			{
+				for (size_t i = worker_count; i-- > 0_sz;)
+					deque(i).~thread_pool_deque();
+			}
+			for (size_t i = worker_count; i-- > 0_sz;)
+				queue(i).~thread_pool_queue();
+		}
+
+		// true if there's (probably) work in any of the queues.
+		// a false positive only costs an idle worker another round of spinning.
+		MUU_PURE_GETTER
+		bool has_work() noexcept
+		{
+			for (auto& lane : injection)
+				if (!lane.empty())
+					return true;
+
+			for (size_t i = 0; i < worker_count; i++)
+				if (!queue(i).empty_hint())
+					return true;
+
+			if (work_stealing())
+			{
+				for (size_t i = 0; i < worker_count; i++)
+					if (!deque(i).empty())
+						return true;
+			}
+
+			return false;
+		}
+
+		// wakes up one parked worker (if any), preferring the given one, after new work has been published
+		void wake_one(size_t preferred = static_cast<size_t>(-1)) noexcept
+		{
+			// pairs with the fence in park() - either we see them as parked,
+			// or they see our work in has_work() before going to sleep
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			if (!sleeping_workers.load(std::memory_order_relaxed))
+			{
+				if (auto_scale)
+					request_growth();
+				return;
+			}
+
+			if (preferred < worker_count && worker(preferred).event.notify())
+				return;
+
+			// auto-scaling pools always wake the lowest-numbered workers first
+			// so the highest-numbered ones are left idle long enough to be retired
+			const auto start = auto_scale ? 0_sz : next_wake.fetch_add(1u, std::memory_order_relaxed);
+			for (size_t i = start, e = i + worker_count; i < e; i++)
+				if (worker(i % worker_count).event.notify())
+					return;
+		}
+
+		//--- timers -----------------------------------------------------------------------------------------------
+
+		MUU_NODISCARD
+		uint64_t current_tick() const noexcept
+		{
+			return static_cast<uint64_t>(
+				std::chrono::duration_cast<std::chrono::milliseconds>(timer_clock::now() - timer_epoch).count());
+		}
+
+		MUU_ATTR(nonnull)
+		void schedule(impl::thread_pool_timer* timer, uint64_t delay_ns, uint64_t period_ns) noexcept
+		{
+			MUU_ASSUME(timer != nullptr);
+
+			constexpr uint64_t ns_per_tick = 1000000u;
+			constexpr uint64_t max_ns	   = constants<uint64_t>::highest / 4u; // ~36 years
+			const auto elapsed			   = static_cast<uint64_t>(
+				  std::chrono::duration_cast<std::chrono::nanoseconds>(timer_clock::now() - timer_epoch).count());
+
+			// timers never fire early, so round up to whole ticks
+			timer->due	  = (elapsed + min(delay_ns, max_ns) + ns_per_tick - 1u) / ns_per_tick;
+			timer->period = (min(period_ns, max_ns) + ns_per_tick - 1u) / ns_per_tick;
+			add_timer(timer);
+		}
+
+		MUU_ATTR(nonnull)
+		void add_timer(impl::thread_pool_timer* timer) noexcept
+		{
+			MUU_ASSUME(timer != nullptr);
+
+			bool discard  = false;
+			bool due_now  = false;
+			bool earliest = false;
+			size_t keeper = no_timekeeper;
+			{
+				std::lock_guard lock{ timer_mutex };
+				if (timers_terminated)
+					discard = true;
+				else if (timer->due <= timers.now())
+					due_now = true;
+				else
+				{
+					timers.insert(timer);
+					timer_count.store(timers.size(), std::memory_order_relaxed);
+
+					const auto next = timers.next_event();
+					earliest		= next < next_timer_tick.load(std::memory_order_relaxed);
+					next_timer_tick.store(next, std::memory_order_relaxed);
+					keeper = timekeeper.load(std::memory_order_relaxed);
+				}
+			}
+
+			if (discard)
+				destroy_timer(timer);
+			else if (due_now)
+				fire_timer(timer);
+			else if (earliest)
+			{
+				// the timekeeper needs to wake up sooner than it planned to (or somebody needs to become one)
+				if (keeper != no_timekeeper)
+					worker(keeper).event.notify();
+				else
+					wake_one();
+			}
+		}
+
+		MUU_ATTR(nonnull)
+		void fire_timer(impl::thread_pool_timer* timer) noexcept
+		{
+			MUU_ASSUME(timer != nullptr);
+
+			const auto qindex = lock(thread_pool_priority::normal);
+			::new (acquire(qindex)) impl::thread_pool_task{ thread_pool_timer_fire_task{ *this, timer } };
+			unlock(qindex);
+		}
+
+		MUU_ATTR(nonnull)
+		void run_timer(impl::thread_pool_timer* timer, size_t worker_index) noexcept
+		{
+			MUU_ASSUME(timer != nullptr);
+
+			timer->task(worker_index);
+			if (!timer->period)
+			{
+				destroy_timer(timer);
+				return;
+			}
+
+			// skip any repetitions that have already been missed rather than running them back-to-back
+			const auto now = current_tick();
+			timer->due += timer->period;
+			if (timer->due <= now)
+				timer->due += ((now - timer->due) / timer->period + 1u) * timer->period;
+			add_timer(timer);
+		}
+
+		MUU_ATTR(nonnull)
+		void destroy_timer(impl::thread_pool_timer* timer) noexcept
+		{
+			MUU_ASSUME(timer != nullptr);
+
+			timer->~thread_pool_timer();
+			slab.deallocate(timer, sizeof(impl::thread_pool_timer));
+		}
+
+		// enqueues any timers that have come due. called by workers whenever they go looking for work.
+		void service_timers() noexcept
+		{
+			if (!timer_count.load(std::memory_order_relaxed))
+				return;
+
+			const auto now = current_tick();
+			if (now < next_timer_tick.load(std::memory_order_relaxed))
+				return;
+
+			impl::thread_pool_timer* expired;
+			{
+				std::unique_lock lock{ timer_mutex, std::try_to_lock };
+				if (!lock)
+					return; // somebody else is already on it (or scheduling a timer; we'll be back)
+
+				expired = timers.advance(now);
+				timer_count.store(timers.size(), std::memory_order_relaxed);
+				next_timer_tick.store(timers.next_event(), std::memory_order_relaxed);
+			}
+
+			while (expired)
+				fire_timer(std::exchange(expired, expired->next));
+		}
+
+		// when the timekeeper next needs to wake up to service the timing wheel
+		MUU_NODISCARD
+		timer_clock::time_point next_timer_deadline() noexcept
+		{
+			std::lock_guard lock{ timer_mutex };
+
+			// (no timers left means a timed wait is as good as an untimed one; just keep the deadline sane)
+			const auto tick = min(timers.next_event(), current_tick() + 3600000u);
+			return timer_epoch + std::chrono::milliseconds{ static_cast<std::chrono::milliseconds::rep>(tick) };
+		}
+
+		//--- resizing ---------------------------------------------------------------------------------------------
+
+		size_t set_workers(size_t count) noexcept
+		{
+			std::lock_guard lock{ resize_mutex };
+
+			count		= muu::clamp(count, 1_sz, worker_count);
+			auto active = active_workers.load(std::memory_order_relaxed);
+
+			for (; active > count; active--)
+				worker(active - 1u).retire();
+
+			for (; active < count; active++)
+			{
+#if MUU_HAS_EXCEPTIONS
+				try
+				{
+					worker(active).start();
+				}
+				catch (...)
+				{
+					break; // couldn't start a thread; make do with what we have
+				}
+#else
+				worker(active).start();
+#endif
+			}
+
+			active_workers.store(active, std::memory_order_relaxed);
+			return active;
+		}
+
+		// called by enqueuers when all the active workers are busy
+		void request_growth() noexcept
+		{
+			if (active_workers.load(std::memory_order_relaxed) >= worker_count
+				|| grow_requested.load(std::memory_order_relaxed) || grow_requested.exchange(true))
+				return;
+
+			scaler_cv.notify_one();
+		}
+
+		// grows the pool while work is left waiting with nobody idle to pick it up,
+		// and retires the highest-numbered worker once it has been idle for too long.
+		void scaler_main() noexcept
+		{
+			using clock = std::chrono::steady_clock;
+
+			set_thread_name("muu::thread_pool scaler"sv);
+
+			const auto tick = muu::clamp(idle_timeout / 4, //
+										 std::chrono::milliseconds{ 1 },
+										 std::chrono::milliseconds{ 250 });
+
+			std::unique_lock lock{ scaler_mutex };
+			while (true)
+			{
+				scaler_cv.wait_for(lock,
+								   tick,
+								   [this]() noexcept
+								   { return scaler_terminated || grow_requested.load(std::memory_order_relaxed); });
+				if (scaler_terminated)
+					return;
+				lock.unlock();
+
+				if (grow_requested.load(std::memory_order_relaxed))
+				{
+					// give the existing workers a moment to catch up first so short bursts don't cause growth
+					std::this_thread::sleep_for(std::chrono::milliseconds{ 1 });
+					if (!sleeping_workers.load(std::memory_order_relaxed) && has_work())
+						set_workers(active_workers.load(std::memory_order_relaxed) + 1u);
+					grow_requested.store(false, std::memory_order_relaxed);
+				}
+				else if (const auto active = active_workers.load(std::memory_order_relaxed); active > min_workers)
+				{
+					const auto since = worker(active - 1u).parked_since.load(std::memory_order_relaxed);
+					if (since && clock::now() - clock::time_point{ clock::duration{ since } } >= idle_timeout)
+						set_workers(active - 1u);
+				}
+
+				lock.lock();
+			}
+		}
+
+		MUU_NODISCARD
+		MUU_ATTR(nonnull)
+		MUU_ATTR(assume_aligned(impl::thread_pool_alignment))
+		impl::thread_pool_task* steal(size_t worker_index, size_t victim, void* buf) noexcept
+		{
+			auto t = deque(victim).steal(buf);
+			if (collect_stats)
+			{
+				auto& counters = worker(worker_index).counters;
+				thread_pool_worker_counters::add(counters.steal_attempts);
+				if (t)
+					thread_pool_worker_counters::add(counters.steals);
+			}
+			return t;
+		}
+
+		MUU_NODISCARD
+		MUU_ATTR(nonnull)
+		MUU_ATTR(assume_aligned(impl::thread_pool_alignment))
+		impl::thread_pool_task* try_pop(size_t worker_index, size_t iteration, void* buf) noexcept
+		{
+			// high-priority tasks always come first
+			if (auto t = injection_queue(thread_pool_priority::high).try_pop(buf))
+				return t;
+
+			// then our own deque (LIFO)
+			if (work_stealing())
+			{
+				if (auto t = deque(worker_index).pop(buf))
+					return t;
+			}
+
+			// then normal-priority tasks enqueued from outside the pool
+			if (auto t = injection_queue(thread_pool_priority::normal).try_pop(buf))
+				return t;
+
+			// then steal from the other workers, preferring those on the same NUMA node
+			// (without pinning every worker is considered to be on the same node)
+			if (work_stealing())
+			{
+				const auto& self = worker(worker_index);
+				if (self.node_size > 1u)
+				{
+					const auto victim =
+						self.node_first + (worker_index - self.node_first + 1u + iteration) % self.node_size;
+					if (victim != worker_index)
+					{
+						if (auto t = steal(worker_index, victim, buf))
+							return t;
+					}
+				}
+				if (self.node_size < worker_count && iteration % 4u == 3u)
+				{
+					const auto victim = (worker_index + 1u + iteration / 4u) % worker_count;
+					if (victim - self.node_first >= self.node_size) // not on our node
+					{
+						if (auto t = steal(worker_index, victim, buf))
+							return t;
+					}
+				}
+			}
+
+			// then the overflow queues
+			if (auto t = queue((worker_index + iteration) % worker_count).try_pop(buf))
+				return t;
+
+			// and finally low-priority tasks
+			if (auto t = injection_queue(thread_pool_priority::low).try_pop(buf))
+				return t;
+
+			if (collect_stats)
+				thread_pool_worker_counters::add(worker(worker_index).counters.failed_pops);
+			return nullptr;
+		}
+
+		void worker_main(size_t worker_index) noexcept
+		{
+			using task = impl::thread_pool_task;
+
+			current_worker = { this, worker_index };
+
+			alignas(impl::thread_pool_alignment) std::byte pop_buffer[impl::thread_pool_alignment];
+
+			auto& self = worker(worker_index);
+
+			using clock		= std::chrono::steady_clock;
+			auto idle_start = collect_stats ? clock::now() : clock::time_point{};
+
+			while (true)
+			{
+				if (self.stopping())
+				{
+					// a retiring worker finishes off its own deque first since nobody else pops from the bottom
+					if (!self.terminated() && work_stealing())
+					{
+						while (auto t = deque(worker_index).pop(pop_buffer))
+							execute(worker_index, t);
+					}
+
+					if (self.try_exit())
+						break;
+					continue; // reactivated
+				}
+
+				task* t		   = nullptr;
+				bool parked	   = false;
+				bool kept_time = false;
+				while (!t && !self.stopping())
+				{
+					t = spin(worker_index, pop_buffer);
+					if (!t)
+					{
+						kept_time = park(worker_index);
+						parked	  = true;
+					}
+				}
+				if (!t)
+					continue;
 
-		if (!task_queue_size)
-			task_queue_size = default_task_queue_size;
+				// enqueuers only wake one worker per unlock() (and may have 'woken' us just as we were backing
+				// out of parking), so if there's still more work left, pass the wake-up along.
+				// likewise if we were keeping time for the timers, somebody else needs to take over.
+				if (parked
+					&& (has_work() || (kept_time && timer_count.load(std::memory_order_relaxed))))
+					wake_one();
 
-		return min(
-			static_cast<size_t>(std::ceil(static_cast<double>(task_queue_size) / static_cast<double>(worker_count))),
-			max_task_queue_size / worker_count);
-	}
+				if (collect_stats)
+				{
+					const auto busy_start = clock::now();
+					thread_pool_worker_counters::add(self.counters.idle_nanoseconds, busy_start - idle_start);
+					execute(worker_index, t);
+					idle_start = clock::now();
+					thread_pool_worker_counters::add(self.counters.busy_nanoseconds, idle_start - busy_start);
+				}
+				else
+					execute(worker_index, t);
+			}
 
-	struct thread_pool_impl
-	{
-		thread_pool_byte_span queue_buffer;
-		thread_pool_byte_span worker_buffer;
-		thread_pool_byte_span task_buffer;
-		size_t worker_count{}; // also the queue count
-		size_t worker_queue_size{};
-		std::atomic<size_t> next_queue = 0_sz;
-		mutable thread_pool_monitor monitor;
+			current_worker = {};
+		}
 
-		MUU_PURE_INLINE_GETTER
-		thread_pool_queue& queue(size_t idx) noexcept
+		// looks for work with exponential backoff between rounds, according to the pool's idle strategy
+		MUU_NODISCARD
+		MUU_ATTR(nonnull)
+		MUU_ATTR(assume_aligned(impl::thread_pool_alignment))
+		impl::thread_pool_task* spin(size_t worker_index, void* buf) noexcept
 		{
-			MUU_ASSERT(idx < worker_count);
-			return *MUU_LAUNDER(
-				reinterpret_cast<thread_pool_queue*>(queue_buffer.data() + sizeof(thread_pool_queue) * idx));
+			service_timers();
+
+			auto& self	 = worker(worker_index);
+			size_t pause = 1u;
+			for (size_t round = 0; round < idle_params.rounds && !self.stopping(); round++)
+			{
+				for (size_t i = 0; i < worker_count; i++)
+				{
+					for (size_t p = 0; p < pause; p++)
+						MUU_PAUSE();
+
+					if (auto t = try_pop(worker_index, round * worker_count + i, buf))
+						return t;
+				}
+				pause = min(pause * 2u, idle_params.max_backoff);
+			}
+			return nullptr;
 		}
 
-		MUU_PURE_INLINE_GETTER
-		thread_pool_worker& worker(size_t idx) noexcept
+		// parks the worker until there's new work (or the pool is shutting down).
+		// while there are timers pending one parked worker keeps time, sleeping only until the next one is due.
+		// returns true if this worker was the one keeping time.
+		//
+		// workers blocked waiting for something (see wait_for()) pass a predicate to re-check before going to sleep,
+		// and keep waiting even if they're asked to retire (they'll do that once they're back in worker_main()).
+		template <typename Done = std::nullptr_t>
+		bool park(size_t worker_index, [[maybe_unused]] Done&& done = nullptr) noexcept
 		{
-			MUU_ASSERT(idx < worker_count);
-			return *MUU_LAUNDER(
-				reinterpret_cast<thread_pool_worker*>(worker_buffer.data() + sizeof(thread_pool_worker) * idx));
-		}
+			constexpr bool idle = std::is_null_pointer_v<remove_cvref<Done>>;
 
-		MUU_NODISCARD_CTOR
-		thread_pool_impl(string_param&& name,
-						 thread_pool_byte_span queue_buffer_,
-						 thread_pool_byte_span worker_buffer_,
-						 thread_pool_byte_span task_buffer_)
-			: queue_buffer{ queue_buffer_ },
-			  worker_buffer{ worker_buffer_ },
-			  task_buffer{ task_buffer_ }
-		{
-			MUU_ASSERT(!queue_buffer_.empty());
-			MUU_ASSERT(!worker_buffer_.empty());
-			MUU_ASSERT(!task_buffer_.empty());
-			MUU_ASSERT(queue_buffer_.size() % sizeof(thread_pool_queue) == 0_sz);
-			MUU_ASSERT(worker_buffer_.size() % sizeof(thread_pool_worker) == 0_sz);
-			MUU_ASSERT(task_buffer_.size() % impl::thread_pool_alignment == 0_sz);
-			MUU_ASSERT(reinterpret_cast<uintptr_t>(task_buffer_.data()) % impl::thread_pool_alignment == 0_sz);
-
-			worker_count	  = worker_buffer_.size() / sizeof(thread_pool_worker);
-			worker_queue_size = task_buffer.size() / impl::thread_pool_alignment / worker_count;
-			MUU_ASSERT(queue_buffer_.size() / sizeof(thread_pool_queue) == worker_count);
+			auto& self = worker(worker_index);
 
-			for (size_t i = 0; i < worker_count; i++)
+			auto keeper			 = no_timekeeper;
+			const bool keep_time = timer_count.load(std::memory_order_relaxed)
+								&& timekeeper.compare_exchange_strong(keeper, worker_index, std::memory_order_relaxed);
+
+			sleeping_workers.fetch_add(1u, std::memory_order_relaxed);
+			const auto key = self.event.prepare_wait(keep_time); // fence; see wake_one()
+
+			bool cancelled;
+			if constexpr (idle)
+				cancelled = self.stopping();
+			else
+				cancelled = done();
+
+			// (a timer scheduled just before we parked might have found nobody to wake up - see add_timer())
+			if (cancelled || has_work()
+				|| (!keep_time && timer_count.load(std::memory_order_relaxed)
+					&& timekeeper.load(std::memory_order_relaxed) == no_timekeeper))
+				self.event.cancel_wait();
+			else
 			{
-				thread_pool_byte_span pool{ task_buffer.data() + impl::thread_pool_alignment * worker_queue_size * i,
-											impl::thread_pool_alignment * worker_queue_size };
-				::new (static_cast<void*>(queue_buffer.data() + sizeof(thread_pool_queue) * i))
-					thread_pool_queue{ pool, monitor };
+				if (collect_stats)
+					thread_pool_worker_counters::add(self.counters.sleeps);
+
+				// (workers blocked in the middle of a task aren't idle, so mustn't be considered for retirement)
+				if (idle && auto_scale)
+					self.parked_since.store(std::chrono::steady_clock::now().time_since_epoch().count(),
+											std::memory_order_relaxed);
+
+				if (keep_time)
+					self.event.wait_until(key, next_timer_deadline());
+				else
+					self.event.wait(key);
+
+				if (idle && auto_scale)
+					self.parked_since.store({}, std::memory_order_relaxed);
 			}
-			auto unwind_queues = scope_guard{ [&]() noexcept
-											  {
-												  for (size_t i = worker_count; i-- > 0_sz;)
-													  queue(i).~thread_pool_queue();
-											  } };
 
-			std::string_view worker_name = name ? std::string_view{ name } : "muu::thread_pool"sv;
-			size_t constructed_workers	 = {};
-			auto unwind_workers			 = scope_guard{ [&]() noexcept
-												{
-												   for (size_t i = constructed_workers; i-- > 0_sz;)
-													   worker(i).~thread_pool_worker();
-											   } };
-			for (size_t i = 0; i < worker_count; i++)
+			sleeping_workers.fetch_sub(1u, std::memory_order_relaxed);
+
+			if (keep_time)
 			{
-				std::string n;
-				n.reserve(worker_name.length() + 5u);
-				n.append(worker_name);
-				n.append(" ["sv);
-				n.append(std::to_string(i));
-				n += ']';
+				timekeeper.store(no_timekeeper, std::memory_order_relaxed);
 
-				::new (static_cast<void*>(worker_buffer.data() + sizeof(thread_pool_worker) * i))
-					thread_pool_worker{ i, // worker_index
-										MUU_MOVE(n),
-										span<thread_pool_queue>{ &queue(0), worker_count }, // queues
-										monitor };
-				constructed_workers++;
+				// retiring; hand the timers over to somebody else
+				if (idle && self.stopping() && timer_count.load(std::memory_order_relaxed))
+					wake_one();
 			}
+			return keep_time;
+		}
 
-			unwind_queues.dismiss();
-			unwind_workers.dismiss();
+		// parks a worker blocked waiting for a counter until done() (or there's new work).
+		// whoever next wakes the counter wakes the worker too, so that's when done() gets re-checked.
+		template <typename Done>
+		void park_waiting(size_t worker_index, impl::thread_pool_counter& counter, Done&& done) noexcept
+		{
+			using counter_type = impl::thread_pool_counter;
+
+			thread_pool_counter_waiter waiter{ &counter, &worker(worker_index).event, nullptr };
+			thread_pool_counter_waiters::add(waiter);
+
+			// make sure whoever wakes the counter knows to look for us
+			counter.value.fetch_or(counter_type::waiting_bit, std::memory_order_acq_rel);
+
+			park(worker_index, done);
+
+			thread_pool_counter_waiters::remove(waiter);
 		}
 
-		~thread_pool_impl() noexcept
+		MUU_ALWAYS_INLINE
+		MUU_ATTR(nonnull)
+		void execute(size_t worker_index, impl::thread_pool_task* t) noexcept
 		{
-			for (size_t i = worker_count; i-- > 0_sz;)
-				queue(i).terminate();
-			for (size_t i = worker_count; i-- > 0_sz;)
-			{
-				worker(i).terminate();
-				worker(i).~thread_pool_worker();
-			}
-			for (size_t i = worker_count; i-- > 0_sz;)
-				queue(i).~thread_pool_queue();
+			MUU_ASSUME(t != nullptr);
+
+			(*t)(worker_index);
+			if (collect_stats) // before the decrement so it's visible to anyone returning from wait()
+				thread_pool_worker_counters::add(worker(worker_index).counters.tasks_executed);
+			monitor.decrement();
+			t->~thread_pool_task();
 		}
 
-	  private:
-		template <typename Action, typename Delay>
-		static constexpr auto repeat_with_delay(Action&& action, Delay, size_t max_attempts) noexcept
+		void record_high_water_mark() noexcept
 		{
-			using result_type = decltype(static_cast<Action&&>(action)());
+			const auto pending = monitor.pending();
+			auto mark		   = queue_high_water_mark.load(std::memory_order_relaxed);
+			while (pending > mark
+				   && !queue_high_water_mark.compare_exchange_weak(mark, pending, std::memory_order_relaxed))
+				;
+		}
 
-			if constexpr (Delay::value > 0)
+		// waits for a counter to reach zero.
+		// workers keep executing other tasks while they wait so that waiting on work enqueued from within a task
+		// can't deadlock the pool; everyone else simply blocks.
+		void wait_for(impl::thread_pool_counter& counter) noexcept
+		{
+			const auto worker_index = current_worker_index();
+			if (worker_index >= worker_count)
 			{
-				for (size_t i = 0; i < max_attempts; i++)
-				{
-					if (auto q = static_cast<decltype(action)&&>(action)())
-						return q;
-					std::this_thread::sleep_for(std::chrono::milliseconds{ Delay::value });
-				}
+				wait_on_counter(counter);
+				return;
 			}
-			else
+
+			alignas(impl::thread_pool_alignment) std::byte pop_buffer[impl::thread_pool_alignment];
+
+			const auto done	   = [&]() noexcept { return counter.done(); };
+			const size_t tries = worker_count * thread_pool_spin_wait_iterations_per_queue;
+			size_t idle		   = {};
+			bool parked		   = false;
+			for (size_t i = 0; !done(); i++)
 			{
-				for (size_t i = 0; i < max_attempts; i++)
+				if (auto t = try_pop(worker_index, i, pop_buffer))
 				{
-					if (auto q = static_cast<decltype(action)&&>(action)())
-						return q;
-
+					execute(worker_index, t);
+					idle = {};
+				}
+				else if (++idle < tries)
 					MUU_PAUSE();
+				else
+				{
+					service_timers();
+					park_waiting(worker_index, counter, done);
+					parked = true;
+					idle   = {};
 				}
 			}
 
-			return result_type{};
+			// clear the flag again so subsequent zero-crossings don't pay for the wake-up
+			using counter_type = impl::thread_pool_counter;
+			auto val		   = counter.value.load(std::memory_order_acquire);
+			if ((val & counter_type::waiting_bit) && !(val & counter_type::count_mask))
+				counter.value.compare_exchange_strong(val, val & ~counter_type::waiting_bit, std::memory_order_relaxed);
+
+			// we may have been woken for new work and left before taking it (see worker_main())
+			if (parked && has_work())
+				wake_one();
 		}
 
-	  public:
+	  private:
+		// looks for room for 'required' more tasks at the given priority without ever blocking on a mutex.
+		// the priority's injection lane is always tried first; once that fills up normal-priority work may spill over
+		// into the overflow queues (only ever try_lock()'d), but high- and low-priority work has nowhere else to go
+		// without changing its place in line, so it just keeps retrying its own lane.
 		MUU_NODISCARD
-		std::optional<size_t> lock_multiple(size_t required) noexcept
+		std::optional<size_t> find_queue(size_t required, thread_pool_priority priority) noexcept
 		{
-			MUU_ASSUME(required >= 1);
-
-			if (required > worker_queue_size)
-				return {};
-
-			const auto find_queue = [queue_count = worker_count,
-									 iterations	 = worker_count * thread_pool_spin_wait_iterations_per_queue,
-									 required,
-									 this]() noexcept
+			const auto iterations = worker_count * thread_pool_spin_wait_iterations_per_queue;
+			const auto start	  = next_queue++;
+			for (size_t i = start, e = i + iterations; i < e; i++)
 			{
-				const auto start = next_queue++;
-				for (size_t i = start, e = i + iterations; i < e; i++)
+				if (injection_queue(priority).try_lock(required))
+					return injection_index(priority);
+
+				if (priority == thread_pool_priority::normal)
 				{
-					const auto queue_index = i % queue_count;
+					const auto queue_index = i % worker_count;
 					auto& q				   = queue(queue_index);
 					if (q.try_lock())
 					{
 						if (q.available() >= required)
-							return std::optional<size_t>{ queue_index };
+							return queue_index;
 						q.unlock();
 					}
-					MUU_PAUSE();
 				}
-				return std::optional<size_t>{};
-			};
 
-			using millis = std::chrono::milliseconds::rep;
-			auto qindex	 = find_queue();
-			if (!qindex)
-				qindex = repeat_with_delay(find_queue, std::integral_constant<millis, 0>{}, 100);
+				MUU_PAUSE();
+			}
+			if (collect_stats)
+				enqueue_spins.fetch_add(iterations, std::memory_order_relaxed);
+			return {};
+		}
+
+	  public:
+		MUU_NODISCARD
+		std::optional<size_t> lock_multiple(size_t required, thread_pool_priority priority) noexcept
+		{
+			MUU_ASSUME(required >= 1);
+
+			if (required > worker_queue_size)
+				return {};
+
+			// tasks enqueued by a worker go to its own queue.
+			// worker deques are always drained in LIFO order so they can only hold normal-priority work.
+			if (const auto w = current_worker_index(); w < worker_count && priority == thread_pool_priority::normal)
+			{
+				if (work_stealing())
+				{
+					if (deque(w).try_lock(required))
+						return worker_count + w;
+				}
+				else if (auto& q = queue(w); q.try_lock())
+				{
+					if (q.available() >= required)
+						return w;
+					q.unlock();
+				}
+			}
 
-			return qindex;
+			// if there's still no room for the whole batch after a while the caller falls back to
+			// enqueuing its tasks one at a time
+			for (size_t round = 0; round < thread_pool_spin_wait_iterations_per_queue; round++)
+				if (auto qindex = find_queue(required, priority))
+					return qindex;
+
+			return {};
 		}
 
 		MUU_NODISCARD
-		size_t lock() noexcept
+		size_t lock(thread_pool_priority priority) noexcept
 		{
-			const auto find_queue = [queue_count = worker_count,
-									 iterations	 = worker_count * thread_pool_spin_wait_iterations_per_queue,
-									 this]() noexcept
+			// tasks enqueued by a worker go to its own queue (see lock_multiple())
+			const auto worker_index = current_worker_index();
+			if (worker_index < worker_count && priority == thread_pool_priority::normal)
 			{
-				const auto start = next_queue++;
-				for (size_t i = start, e = i + iterations; i < e; i++)
+				if (work_stealing())
 				{
-					const auto queue_index = i % queue_count;
-					auto& q				   = queue(queue_index);
-					if (q.try_lock())
+					if (deque(worker_index).try_lock())
+						return worker_count + worker_index;
+				}
+				else if (auto& q = queue(worker_index); q.try_lock())
+				{
+					if (!q.full())
+						return worker_index;
+					q.unlock();
+				}
+			}
+
+			if (injection_queue(priority).try_lock())
+				return injection_index(priority);
+
+			// a worker can't just wait until space frees up; it may well be the one that has to free it.
+			// instead it helps drain the queues until there's room.
+			if (worker_index < worker_count)
+			{
+				alignas(impl::thread_pool_alignment) std::byte pop_buffer[impl::thread_pool_alignment];
+				for (size_t i = 0;; i++)
+				{
+					if (auto qindex = find_queue(1u, priority))
+						return *qindex;
+
+					if (auto t = try_pop(worker_index, i, pop_buffer))
+						execute(worker_index, t);
+					else
 					{
-						if (!q.full())
-							return std::optional<size_t>{ queue_index };
-						q.unlock();
+						if (collect_stats)
+							enqueue_sleeps.fetch_add(1u, std::memory_order_relaxed);
+						std::this_thread::yield();
 					}
-					MUU_PAUSE();
 				}
-				return std::optional<size_t>{};
-			};
+			}
 
-			using millis = std::chrono::milliseconds::rep;
-			auto qindex	 = find_queue();
-			if (!qindex)
-				qindex = repeat_with_delay(find_queue, std::integral_constant<millis, 0>{}, 100);
-			if (!qindex)
-				qindex = repeat_with_delay(find_queue, std::integral_constant<millis, 10>{}, 10);
-			if (!qindex)
-				qindex =
-					repeat_with_delay(find_queue, std::integral_constant<millis, 100>{}, constants<size_t>::highest);
+			// everyone else spins, yielding between rounds. nobody ever sleeps or blocks on a mutex here.
+			while (true)
+			{
+				if (auto qindex = find_queue(1u, priority))
+					return *qindex;
 
-			MUU_ASSERT(qindex);
-			return *qindex;
+				if (collect_stats)
+					enqueue_sleeps.fetch_add(1u, std::memory_order_relaxed);
+				std::this_thread::yield();
+			}
 		}
 
 		MUU_NODISCARD
@@ -622,22 +2705,134 @@ namespace
 		MUU_ATTR(assume_aligned(muu::impl::thread_pool_alignment))
 		void* acquire(size_t queue_index) noexcept
 		{
+			if (is_injection_index(queue_index))
+				return injection[queue_index - worker_count * 2u].acquire();
+
+			if (is_deque_index(queue_index))
+				return deque(queue_index - worker_count).acquire();
+
 			return queue(queue_index).acquire();
 		}
 
 		MUU_ALWAYS_INLINE
 		void unlock(size_t queue_index) noexcept
 		{
-			queue(queue_index).unlock();
+			if (collect_stats)
+				record_high_water_mark();
+
+			if (is_injection_index(queue_index))
+			{
+				injection[queue_index - worker_count * 2u].unlock();
+				wake_one();
+				return;
+			}
+
+			if (is_deque_index(queue_index))
+			{
+				deque(queue_index - worker_count).unlock();
+				wake_one();
+				return;
+			}
+
+			if (!queue(queue_index).unlock())
+				return;
+
+			// a worker enqueuing into its own queue will get to the work itself eventually,
+			// so there's no point preferring it over some other parked worker
+			wake_one(queue_index == current_worker_index() ? static_cast<size_t>(-1) : queue_index);
 		}
 
-		MUU_ALWAYS_INLINE
-		void wait() const noexcept
+		void wait() noexcept
 		{
-			monitor.wait();
+			const auto worker_index = current_worker_index();
+			if (worker_index >= worker_count)
+			{
+				monitor.wait();
+				return;
+			}
+
+			// the tasks currently blocked in wait() can't finish until it returns,
+			// so from a worker we're done once they're the only ones left.
+			waiting_tasks.fetch_add(1u, std::memory_order_relaxed);
+			const auto leave = scope_guard{ [this]() noexcept
+											{ waiting_tasks.fetch_sub(1u, std::memory_order_relaxed); } };
+
+			alignas(impl::thread_pool_alignment) std::byte pop_buffer[impl::thread_pool_alignment];
+
+			const auto done = [&]() noexcept
+			{ return monitor.pending() <= waiting_tasks.load(std::memory_order_relaxed); };
+			const size_t tries = worker_count * thread_pool_spin_wait_iterations_per_queue;
+			size_t idle		   = {};
+			bool parked		   = false;
+			for (size_t i = 0; !done(); i++)
+			{
+				if (auto t = try_pop(worker_index, i, pop_buffer))
+				{
+					execute(worker_index, t);
+					idle = {};
+				}
+				else if (++idle < tries)
+					MUU_PAUSE();
+				else
+				{
+					service_timers();
+					park_waiting(worker_index, monitor.counter(), done);
+					parked = true;
+					idle   = {};
+				}
+			}
+
+			// we may have been woken for new work and left before taking it (see worker_main())
+			if (parked && has_work())
+				wake_one();
 		}
 	};
 
+	thread_pool_timer_fire_task::~thread_pool_timer_fire_task() noexcept
+	{
+		// never run (the pool was destroyed first)
+		if (timer_)
+			pool_->destroy_timer(timer_);
+	}
+
+	void thread_pool_timer_fire_task::operator()(size_t worker_index) noexcept
+	{
+		MUU_ASSUME(timer_ != nullptr);
+
+		pool_->run_timer(std::exchange(timer_, nullptr), worker_index);
+	}
+
+	void thread_pool_worker::start()
+	{
+		// a retiring worker that hasn't gotten around to exiting yet can just keep going
+		auto expected = states::retiring;
+		if (state_.compare_exchange_strong(expected, states::active, std::memory_order_acq_rel))
+			return;
+		MUU_ASSERT(expected == states::retired);
+
+		// otherwise its old thread (if any) has stopped looking for work and is on its way out
+		if (thread.joinable())
+			thread.join();
+
+		state_.store(states::active, std::memory_order_release);
+		const auto undo = scope_fail{ [this]() noexcept { state_.store(states::retired); } };
+
+		thread = std::thread{ [this]() noexcept
+							  {
+								  if (placement_.cpus)
+									  pin_current_thread(placement_.cpus, placement_.cpu_count);
+
+#if MUU_WINDOWS
+								  MUU_UNUSED(CoInitializeEx(nullptr, COINIT_MULTITHREADED));
+								  auto at_exit = scope_guard{ []() noexcept { CoUninitialize(); } };
+#endif
+
+								  set_thread_name(name_);
+
+								  pool_.worker_main(index_);
+							  } };
+	}
+
 	struct thread_pool_storage
 	{
 		thread_pool_byte_span buffer;
@@ -663,25 +2858,71 @@ extern "C" //
 	void* MUU_CALLCONV muu_impl_thread_pool_create(size_t worker_count,
 												   size_t task_queue_size,
 												   string_param* name,
-												   void* /*unused - future proofing*/)
+												   const thread_pool_options* options)
 	{
 		MUU_ASSUME(name != nullptr);
 
-		worker_count				 = calc_thread_pool_workers(worker_count);
-		const auto worker_queue_size = calc_thread_pool_worker_queue_size(worker_count, task_queue_size);
-		task_queue_size				 = worker_count * worker_queue_size;
+		thread_pool_settings settings{};
+		if (options)
+		{
+			settings.scheduler	   = options->scheduler;
+			settings.affinity	   = options->affinity;
+			settings.idle_strategy = options->idle_strategy;
+			settings.collect_stats = options->collect_stats;
+			settings.auto_scale	   = options->auto_scale;
+			settings.idle_timeout  = std::chrono::milliseconds{ options->idle_timeout_ms ? options->idle_timeout_ms
+																						: 1000u };
+		}
+		const bool stealing = settings.scheduler == thread_pool_scheduler::work_stealing;
+
+		// auto-scaling pools start small and may grow to fill the machine by default;
+		// everything else is fixed-size by default
+		const size_t max_workers = options ? options->max_workers : 0_sz;
+		settings.initial_workers =
+			calc_thread_pool_workers(settings.auto_scale ? max(worker_count, 1_sz) : worker_count);
+
+		size_t slots = settings.initial_workers;
+		if (max_workers)
+			slots = max(max_workers, settings.initial_workers);
+		else if (settings.auto_scale)
+			slots = 0u; // one per hardware thread
+		worker_count = max(calc_thread_pool_workers(slots), settings.initial_workers);
+
+		const auto queue_sizes = calc_thread_pool_queue_sizes(worker_count, task_queue_size);
+		task_queue_size		   = worker_count * queue_sizes.worker; // from here on just the worker queues
+		size_t injection_task_offsets[thread_pool_priority_count + 1u]{};
+		size_t injection_seq_offsets[thread_pool_priority_count + 1u]{};
+		for (size_t i = 0; i < thread_pool_priority_count; i++)
+		{
+			injection_task_offsets[i + 1u] =
+				injection_task_offsets[i] + impl::thread_pool_alignment * queue_sizes.injection[i];
+			injection_seq_offsets[i + 1u] =
+				injection_seq_offsets[i]
+				+ apply_alignment<impl::thread_pool_alignment>(sizeof(std::atomic<size_t>) * queue_sizes.injection[i]);
+		}
 
 		static_assert(impl::thread_pool_alignment >= sizeof(impl::thread_pool_task));
+		static_assert(alignof(thread_pool_deque) <= impl::thread_pool_alignment);
 
 		constexpr auto storage_start = 0_sz;
 		const auto queues_start =
 			apply_alignment<impl::thread_pool_alignment>(storage_start + sizeof(thread_pool_storage));
-		const auto queues_end		= queues_start + sizeof(thread_pool_queue) * worker_count;
-		const auto workers_start	= apply_alignment<impl::thread_pool_alignment>(queues_end);
-		const auto workers_end		= workers_start + sizeof(thread_pool_worker) * worker_count;
-		const auto tasks_start		= apply_alignment<impl::thread_pool_alignment>(workers_end);
-		const auto tasks_end		= tasks_start + impl::thread_pool_alignment * task_queue_size;
-		const auto total_allocation = tasks_end - storage_start;
+		const auto queues_end		   = queues_start + sizeof(thread_pool_queue) * worker_count;
+		const auto workers_start	   = apply_alignment<impl::thread_pool_alignment>(queues_end);
+		const auto workers_end		   = workers_start + sizeof(thread_pool_worker) * worker_count;
+		const auto tasks_start		   = apply_alignment<impl::thread_pool_alignment>(workers_end);
+		const auto tasks_end		   = tasks_start + impl::thread_pool_alignment * task_queue_size;
+		const auto deques_start		   = apply_alignment<impl::thread_pool_alignment>(tasks_end);
+		const auto deques_end		   = deques_start + (stealing ? sizeof(thread_pool_deque) * worker_count : 0_sz);
+		const auto deque_tasks_start   = apply_alignment<impl::thread_pool_alignment>(deques_end);
+		const auto deque_tasks_end	   = deque_tasks_start + (stealing ? tasks_end - tasks_start : 0_sz);
+		const auto deque_flags_start   = apply_alignment<impl::thread_pool_alignment>(deque_tasks_end);
+		const auto deque_flags_end	   = deque_flags_start + (stealing ? sizeof(std::atomic_bool) * task_queue_size : 0_sz);
+		const auto injection_tasks_start = apply_alignment<impl::thread_pool_alignment>(deque_flags_end);
+		const auto injection_tasks_end	 = injection_tasks_start + injection_task_offsets[thread_pool_priority_count];
+		const auto injection_seqs_start	 = injection_tasks_end;
+		const auto injection_seqs_end	 = injection_seqs_start + injection_seq_offsets[thread_pool_priority_count];
+		const auto total_allocation = apply_alignment<impl::thread_pool_alignment>(injection_seqs_end) - storage_start;
 
 		static_assert(alignof(thread_pool_storage) <= impl::thread_pool_alignment);
 		auto buffer_ptr = muu::assume_aligned<impl::thread_pool_alignment>(
@@ -698,13 +2939,29 @@ extern "C" //
 		const auto unwind = scope_fail{ [=]() noexcept { muu::aligned_free(buffer_ptr); } };
 
 		thread_pool_byte_span buffer{ static_cast<std::byte*>(buffer_ptr), total_allocation };
-		thread_pool_byte_span queue_buffer{ buffer.data() + queues_start, queues_end - queues_start };
-		thread_pool_byte_span worker_buffer{ buffer.data() + workers_start, workers_end - workers_start };
-		thread_pool_byte_span task_buffer{ buffer.data() + tasks_start, tasks_end - tasks_start };
+		thread_pool_buffers buffers;
+		buffers.queues		= { buffer.data() + queues_start, queues_end - queues_start };
+		buffers.workers		= { buffer.data() + workers_start, workers_end - workers_start };
+		buffers.tasks		= { buffer.data() + tasks_start, tasks_end - tasks_start };
+		buffers.deques		= { buffer.data() + deques_start, deques_end - deques_start };
+		buffers.deque_tasks = { buffer.data() + deque_tasks_start, deque_tasks_end - deque_tasks_start };
+		buffers.deque_flags = { buffer.data() + deque_flags_start, deque_flags_end - deque_flags_start };
+		for (size_t i = 0; i < thread_pool_priority_count; i++)
+		{
+			buffers.injection_tasks[i] = {
+				buffer.data() + injection_tasks_start + injection_task_offsets[i],
+				impl::thread_pool_alignment * queue_sizes.injection[i]
+			};
+			buffers.injection_sequences[i] = {
+				buffer.data() + injection_seqs_start + injection_seq_offsets[i],
+				sizeof(std::atomic<size_t>) * queue_sizes.injection[i]
+			};
+		}
 
-		return ::new (buffer_ptr)
-			thread_pool_storage{ buffer,
-								 thread_pool_impl{ MUU_MOVE(*name), queue_buffer, worker_buffer, task_buffer } };
+		return ::new (buffer_ptr) thread_pool_storage{
+			buffer,
+			thread_pool_impl{ MUU_MOVE(*name), settings, buffers }
+		};
 	}
 
 	void MUU_CALLCONV muu_impl_thread_pool_destroy(void* storage_) noexcept
@@ -717,22 +2974,24 @@ extern "C" //
 		muu::aligned_free(buffer.data());
 	}
 
-	size_t MUU_CALLCONV muu_impl_thread_pool_lock_multiple(void* storage_, size_t required) noexcept
+	size_t MUU_CALLCONV muu_impl_thread_pool_lock_multiple(void* storage_,
+														   size_t required,
+														   thread_pool_priority priority) noexcept
 	{
 		MUU_ASSUME(storage_ != nullptr);
 		MUU_ASSUME(required >= 1u);
 
-		const auto queue = storage_cast(storage_).impl.lock_multiple(required);
+		const auto queue = storage_cast(storage_).impl.lock_multiple(required, priority);
 		if (queue)
 			return queue.value();
 		return static_cast<size_t>(-1);
 	}
 
-	size_t MUU_CALLCONV muu_impl_thread_pool_lock(void* storage_) noexcept
+	size_t MUU_CALLCONV muu_impl_thread_pool_lock(void* storage_, thread_pool_priority priority) noexcept
 	{
 		MUU_ASSUME(storage_ != nullptr);
 
-		return storage_cast(storage_).impl.lock();
+		return storage_cast(storage_).impl.lock(priority);
 	}
 
 	void* MUU_CALLCONV muu_impl_thread_pool_acquire(void* storage_, size_t qindex) noexcept
@@ -756,16 +3015,129 @@ extern "C" //
 		storage_cast(storage_).impl.wait();
 	}
 
+	void* MUU_CALLCONV muu_impl_thread_pool_allocate(void* storage_, size_t size) noexcept
+	{
+		MUU_ASSUME(storage_ != nullptr);
+
+		return storage_cast(storage_).impl.slab.allocate(size);
+	}
+
+	void MUU_CALLCONV muu_impl_thread_pool_deallocate(void* storage_, void* ptr, size_t size) noexcept
+	{
+		MUU_ASSUME(storage_ != nullptr);
+		MUU_ASSUME(ptr != nullptr);
+
+		storage_cast(storage_).impl.slab.deallocate(ptr, size);
+	}
+
+	void MUU_CALLCONV muu_impl_thread_pool_schedule(void* storage_,
+													impl::thread_pool_timer* timer,
+													uint64_t delay_ns,
+													uint64_t period_ns) noexcept
+	{
+		MUU_ASSUME(storage_ != nullptr);
+		MUU_ASSUME(timer != nullptr);
+
+		storage_cast(storage_).impl.schedule(timer, delay_ns, period_ns);
+	}
+
+	void MUU_CALLCONV muu_impl_thread_pool_wait_for(void* storage_, impl::thread_pool_counter* counter) noexcept
+	{
+		MUU_ASSUME(storage_ != nullptr);
+		MUU_ASSUME(counter != nullptr);
+
+		storage_cast(storage_).impl.wait_for(*counter);
+	}
+
+	void MUU_CALLCONV muu_impl_thread_pool_counter_wake(impl::thread_pool_counter* counter) noexcept
+	{
+		MUU_ASSUME(counter != nullptr);
+
+		wake_counter(*counter);
+	}
+
 	MUU_PURE_GETTER
 	size_t MUU_CALLCONV muu_impl_thread_pool_workers(void* storage_) noexcept
+	{
+		return storage_ ? storage_cast(storage_).impl.active_workers.load(std::memory_order_relaxed) : 0_sz;
+	}
+
+	MUU_PURE_GETTER
+	size_t MUU_CALLCONV muu_impl_thread_pool_max_workers(void* storage_) noexcept
 	{
 		return storage_ ? storage_cast(storage_).impl.worker_count : 0_sz;
 	}
 
+	size_t MUU_CALLCONV muu_impl_thread_pool_set_workers(void* storage_, size_t worker_count) noexcept
+	{
+		MUU_ASSUME(storage_ != nullptr);
+
+		return storage_cast(storage_).impl.set_workers(worker_count);
+	}
+
 	MUU_PURE_GETTER
 	size_t MUU_CALLCONV muu_impl_thread_pool_capacity(void* storage_) noexcept
 	{
-		return storage_ ? storage_cast(storage_).impl.worker_count * storage_cast(storage_).impl.worker_queue_size
-						: 0_sz;
+		if (!storage_)
+			return 0_sz;
+
+		auto& impl	  = storage_cast(storage_).impl;
+		size_t result = impl.worker_count * impl.worker_queue_size;
+		for (auto& lane : impl.injection)
+			result += lane.max_size();
+		return result;
+	}
+
+	MUU_PURE_GETTER
+	size_t MUU_CALLCONV muu_impl_thread_pool_max_batch(void* storage_) noexcept
+	{
+		if (!storage_)
+			return 0_sz;
+
+		auto& impl	  = storage_cast(storage_).impl;
+		size_t result = impl.worker_queue_size;
+		for (auto& lane : impl.injection)
+			result = min(result, lane.max_size());
+		return result;
+	}
+
+	void MUU_CALLCONV muu_impl_thread_pool_stats(void* storage_, thread_pool_stats* stats) noexcept
+	{
+		MUU_ASSUME(storage_ != nullptr);
+		MUU_ASSUME(stats != nullptr);
+
+		auto& impl = storage_cast(storage_).impl;
+		*stats	   = {};
+		for (size_t i = 0; i < impl.worker_count; i++)
+			impl.worker(i).counters.accumulate(stats->workers);
+		stats->enqueue_spins		 = impl.enqueue_spins.load(std::memory_order_relaxed);
+		stats->enqueue_sleeps		 = impl.enqueue_sleeps.load(std::memory_order_relaxed);
+		stats->queue_high_water_mark = impl.queue_high_water_mark.load(std::memory_order_relaxed);
+	}
+
+	void MUU_CALLCONV muu_impl_thread_pool_worker_stats(void* storage_,
+														size_t worker_index,
+														thread_pool_worker_stats* stats) noexcept
+	{
+		MUU_ASSUME(storage_ != nullptr);
+		MUU_ASSUME(stats != nullptr);
+
+		auto& impl = storage_cast(storage_).impl;
+		MUU_ASSERT(worker_index < impl.worker_count);
+
+		*stats = {};
+		impl.worker(worker_index).counters.accumulate(*stats);
+	}
+
+	void MUU_CALLCONV muu_impl_thread_pool_reset_stats(void* storage_) noexcept
+	{
+		MUU_ASSUME(storage_ != nullptr);
+
+		auto& impl = storage_cast(storage_).impl;
+		for (size_t i = 0; i < impl.worker_count; i++)
+			impl.worker(i).counters.reset();
+		impl.enqueue_spins.store(0u, std::memory_order_relaxed);
+		impl.enqueue_sleeps.store(0u, std::memory_order_relaxed);
+		impl.queue_high_water_mark.store(0u, std::memory_order_relaxed);
 	}
 }
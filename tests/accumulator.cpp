@@ -62,6 +62,24 @@ BATCHED_TEST_CASE("accumulator", accumulators<ALL_ARITHMETIC>)
 				CHECK(static_cast<big>(accum.max()) == Approx(static_cast<big>(data::values_max)));
 			}
 		}
+
+		BATCHED_SECTION("add(accumulator)")
+		{
+			const auto mid = std::begin(data::values) + std::size(data::values) / 2u;
+			accumulator accum, lower{ std::begin(data::values), mid }, upper{ mid, std::end(data::values) };
+			accum.add(lower);
+			CHECK(accum.sample_count() == lower.sample_count());
+			accum.add(upper);
+			accum.add(accumulator{});
+			CHECK(accum.sample_count() == std::size(data::values));
+			CHECK(static_cast<big>(accum.sum()) >= static_cast<big>(data::values_sum_low));
+			CHECK(static_cast<big>(accum.sum()) <= static_cast<big>(data::values_sum_high));
+			if constexpr (sizeof(T) > 2u)
+			{
+				CHECK(static_cast<big>(accum.min()) == Approx(static_cast<big>(data::values_min)));
+				CHECK(static_cast<big>(accum.max()) == Approx(static_cast<big>(data::values_max)));
+			}
+		}
 	}
 	else
 	{
@@ -0,0 +1,352 @@
+// This file is a part of muu and is subject to the the terms of the MIT license.
+// Copyright (c) Mark Gillard <mark.gillard@outlook.com.au>
+// See https://github.com/marzer/muu/blob/master/LICENSE for the full license text.
+// SPDX-License-Identifier: MIT
+
+#include "tests.h"
+#include "../include/muu/matrix.h"
+#include "../include/muu/thread_pool.h"
+
+using namespace muu;
+
+namespace
+{
+	// the SIMD kernels only run outside of constant evaluation, so anything computed here goes through the scalar code
+	template <typename T>
+	inline constexpr matrix<T, 4, 4> affine4 = matrix<T, 4, 4>{ T{ 2 }, T{ 1 },	 T{ 0 }, T{ 5 },  //
+																T{ 0 }, T{ 3 },	 T{ 1 }, T{ -2 }, //
+																T{ 1 }, T{ 0 },	 T{ 4 }, T{ 7 },  //
+																T{ 0 }, T{ 0 },	 T{ 0 }, T{ 1 } };
+
+	template <typename T>
+	inline constexpr matrix<T, 4, 4> general4 = matrix<T, 4, 4>{ T{ 3 }, T{ 4 }, T{ 3 }, T{ 1 }, //
+																 T{ 1 }, T{ 3 }, T{ 5 }, T{ 4 }, //
+																 T{ 1 }, T{ 1 }, T{ 2 }, T{ 4 }, //
+																 T{ 1 }, T{ 1 }, T{ 1 }, T{ 1 } };
+
+	template <typename T>
+	inline constexpr auto affine4_inverse = matrix<T, 4, 4>::invert_affine(affine4<T>);
+
+	template <typename T>
+	inline constexpr auto affine3x4_inverse = matrix<T, 3, 4>::invert_affine(matrix<T, 3, 4>{ affine4<T> });
+
+	template <typename T>
+	inline constexpr auto general4_inverse = matrix<T, 4, 4>::invert(general4<T>);
+
+	template <typename T>
+	inline constexpr auto general4_product = general4<T> * affine4<T>;
+
+	template <typename T>
+	inline constexpr auto affine4_position = affine4<T>.transform_position(vector<T, 3>{ T{ 1 }, T{ -2 }, T{ 3 } });
+
+	template <typename T>
+	inline constexpr auto general4_position = general4<T>.transform_position(vector<T, 3>{ T{ 1 }, T{ -2 }, T{ 3 } });
+
+	template <typename T, size_t R, size_t C>
+	static matrix<T, R, C> random_matrix(T min, T max) noexcept
+	{
+		matrix<T, R, C> m;
+		for (size_t c = 0; c < C; c++)
+			for (size_t r = 0; r < R; r++)
+				m(r, c) = random<T>(min, max);
+		return m;
+	}
+
+	// well-conditioned affine transform (diagonally-dominant 3x3 part + translation)
+	template <typename T, size_t R>
+	static matrix<T, R, 4> random_affine() noexcept
+	{
+		auto m = random_matrix<T, R, 4>(T{ -1 }, T{ 1 });
+		for (size_t i = 0; i < 3; i++)
+			m(i, i) += T{ 4 };
+		for (size_t i = 0; i < 3; i++)
+			m(i, 3) *= T{ 10 };
+		if constexpr (R == 4)
+		{
+			for (size_t i = 0; i < 3; i++)
+				m(3, i) = T{};
+			m(3, 3) = T{ 1 };
+		}
+		return m;
+	}
+
+	template <typename T>
+	static T tolerance(T expected) noexcept
+	{
+		return constants<T>::default_epsilon * (muu::abs(expected) + T{ 1 });
+	}
+
+#define CHECK_MATRIX_NEAR(actual, expected)                                                                            \
+	do                                                                                                                 \
+	{                                                                                                                  \
+		for (size_t r = 0; r < decltype(actual)::rows; r++)                                                            \
+			for (size_t c = 0; c < decltype(actual)::columns; c++)                                                     \
+				CHECK_APPROX_EQUAL_EPS(actual(r, c), expected(r, c), tolerance((expected)(r, c)));                     \
+	}                                                                                                                  \
+	while (false)
+
+	template <typename T, size_t R, size_t K, size_t C>
+	static void check_simd_product()
+	{
+		TEST_INFO("matrix<"sv << nameof<T> << ", "sv << R << ", "sv << K << "> * matrix<"sv << nameof<T> << ", "sv << K
+							  << ", "sv << C << ">"sv);
+
+		RANDOM_ITERATIONS
+		{
+			const auto lhs = random_matrix<T, R, K>(T{ -10 }, T{ 10 });
+			const auto rhs = random_matrix<T, K, C>(T{ -10 }, T{ 10 });
+			const auto vec = vector<T, K>{ random_array<T, K>(-10, 10) };
+
+			matrix<T, R, C> expected;
+			for (size_t r = 0; r < R; r++)
+			{
+				for (size_t c = 0; c < C; c++)
+				{
+					expected(r, c) = lhs(r, 0) * rhs(0, c);
+					for (size_t k = 1; k < K; k++)
+						expected(r, c) += lhs(r, k) * rhs(k, c);
+				}
+			}
+			// each term is at most 10 * 10 in magnitude, so cancellation can leave rounding error in proportion to that
+			const auto eps = tolerance(T{ 100 * K });
+
+			const auto product = lhs * rhs;
+			for (size_t r = 0; r < R; r++)
+				for (size_t c = 0; c < C; c++)
+					CHECK_APPROX_EQUAL_EPS(product(r, c), expected(r, c), eps);
+
+			for (size_t r = 0; r < R; r++)
+			{
+				auto expected_elem = lhs(r, 0) * vec[0];
+				for (size_t k = 1; k < K; k++)
+					expected_elem += lhs(r, k) * vec[k];
+				CHECK_APPROX_EQUAL_EPS((lhs * vec)[r], expected_elem, eps);
+			}
+		}
+	}
+
+	template <typename T, size_t R>
+	static void check_simd_transforms()
+	{
+		TEST_INFO("matrix<"sv << nameof<T> << ", "sv << R << ", 4>"sv);
+		using vec3 = vector<T, 3>;
+		using mat  = matrix<T, R, 4>;
+
+		RANDOM_ITERATIONS
+		{
+			auto xform = random_matrix<T, R, 4>(T{ -10 }, T{ 10 });
+			if constexpr (R == 4)
+			{
+				// keep w well away from zero
+				for (size_t i = 0; i < 3; i++)
+					xform(3, i) = random<T>(T{ -0.1 }, T{ 0.1 });
+				xform(3, 3) = T{ 10 };
+			}
+			const auto pos = vec3{ random_array<T, 3>(-10, 10) };
+			const auto eps = tolerance(T{ 400 });
+
+			vector<T, R> expected;
+			for (size_t r = 0; r < R; r++)
+				expected[r] = xform(r, 0) * pos.x + xform(r, 1) * pos.y + xform(r, 2) * pos.z;
+
+			const auto dir = xform.transform_without_translating(pos);
+			for (size_t r = 0; r < 3; r++)
+				CHECK_APPROX_EQUAL_EPS(dir[r], expected[r], eps);
+
+			for (size_t r = 0; r < R; r++)
+				expected[r] += xform(r, 3);
+			if constexpr (R == 4)
+			{
+				const auto inv_w = T{ 1 } / expected.w;
+				for (size_t r = 0; r < 3; r++)
+					expected[r] *= inv_w;
+			}
+
+			const auto transformed = xform.transform_position(pos);
+			for (size_t r = 0; r < 3; r++)
+				CHECK_APPROX_EQUAL_EPS(transformed[r], expected[r], eps);
+			CHECK(xform * pos == transformed);
+		}
+
+		// affine inverse round-trips positions and matches the general inverse
+		RANDOM_ITERATIONS
+		{
+			const auto xform   = random_affine<T, R>();
+			const auto inverse = mat::invert_affine(xform);
+			CHECK(muu::invert_affine(xform) == inverse);
+
+			const auto pos = vec3{ random_array<T, 3>(-10, 10) };
+			const auto eps = T{ 100 } * constants<T>::default_epsilon;
+			CHECK(approx_equal(inverse.transform_position(xform.transform_position(pos)), pos, eps));
+
+			matrix<T, 4, 4> xform4{ xform };
+			xform4.m[3].w		 = T{ 1 };
+			const auto expected = matrix<T, 4, 4>::invert(xform4);
+			for (size_t r = 0; r < R; r++)
+				for (size_t c = 0; c < 4; c++)
+					CHECK_APPROX_EQUAL_EPS(inverse(r, c), expected(r, c), eps * (muu::abs(expected(r, c)) + T{ 1 }));
+		}
+
+		// columns narrower than a register must not touch their neighbours
+		mat arr[3] = { mat{ T{ 1 } }, mat{ T{ 2 } }, mat{ T{ 3 } } };
+		arr[1]	   = mat::invert_affine(random_affine<T, R>());
+		CHECK(arr[0] == mat{ T{ 1 } });
+		CHECK(arr[2] == mat{ T{ 3 } });
+	}
+
+	template <typename T>
+	static void check_simd_inverse()
+	{
+		TEST_INFO("matrix<"sv << nameof<T> << ", 4, 4>"sv);
+		using mat = matrix<T, 4, 4>;
+
+		// runtime (SIMD) vs constant-evaluated (scalar) results
+		auto affine	 = affine4<T>;
+		auto general = general4<T>;
+		CHECK_MATRIX_NEAR(mat::invert_affine(affine), affine4_inverse<T>);
+		const auto affine3x4 = matrix<T, 3, 4>{ affine };
+		CHECK_MATRIX_NEAR(muu::invert_affine(affine3x4), affine3x4_inverse<T>);
+		CHECK_MATRIX_NEAR(mat::invert(general), general4_inverse<T>);
+		CHECK_MATRIX_NEAR(mat::invert(affine), affine4_inverse<T>);
+		CHECK(general * affine == general4_product<T>);
+
+		const auto pos = vector<T, 3>{ T{ 1 }, T{ -2 }, T{ 3 } };
+		CHECK(affine.transform_position(pos) == affine4_position<T>);
+		CHECK(general.transform_position(pos) == general4_position<T>);
+
+		RANDOM_ITERATIONS
+		{
+			auto m = random_matrix<T, 4, 4>(T{ -1 }, T{ 1 });
+			for (size_t i = 0; i < 4; i++)
+				m(i, i) += T{ 5 };
+
+			const auto eps = T{ 100 } * constants<T>::default_epsilon;
+			CHECK(approx_equal(m * mat::invert(m), mat::constants::identity, eps));
+			CHECK(approx_equal(mat::invert(m) * m, mat::constants::identity, eps));
+		}
+	}
+
+	template <typename T, size_t R, size_t C>
+	static void check_batch_transforms(thread_pool& pool)
+	{
+		TEST_INFO("matrix<"sv << nameof<T> << ", "sv << R << ", "sv << C << ">"sv);
+		using vec3 = vector<T, 3>;
+		using mat  = matrix<T, R, C>;
+
+		auto xform = random_matrix<T, R, C>(T{ -2 }, T{ 2 });
+		for (size_t i = 0; i < 3; i++)
+			xform(i, i) += T{ 4 };
+		if constexpr (R == 4)
+		{
+			// keep w well away from zero
+			for (size_t i = 0; i < 3; i++)
+				xform(3, i) = random<T>(T{ -0.01 }, T{ 0.01 });
+			xform(3, 3) = T{ 1 };
+		}
+
+		// enough for the thread_pool overloads to split the work, plus a partial block at the end
+		std::vector<vec3> input(3u * impl::batch_transform_min_task_size + 5u);
+		for (auto& v : input)
+		{
+			v = vec3{ random_array<T, 3>(-10, 10) };
+			v.x += v.x < T{} ? T{ -1 } : T{ 1 }; // no zero-length directions
+		}
+		const auto in = span<const vec3>{ input.data(), input.size() };
+
+		std::vector<vec3> output(input.size() + 1u, vec3{ T{ 42 } });
+		const auto out = span<vec3>{ output.data(), input.size() };
+
+		const auto eps = T{ 100 } * constants<T>::default_epsilon;
+		const auto check = [&](auto&& single) noexcept
+		{
+			size_t mismatches = 0;
+			for (size_t i = 0; i < input.size(); i++)
+			{
+				const auto expected = single(input[i]);
+				if (!approx_equal(output[i], expected, eps * (vec3::length(expected) + T{ 1 })))
+					mismatches++;
+			}
+			CHECK(mismatches == 0u);
+			CHECK(output.back() == vec3{ T{ 42 } }); // past the end of the output span
+		};
+
+		const auto position = [&](const vec3& v) noexcept { return xform.transform_position(v); };
+		mat::transform_position(xform, in, out);
+		check(position);
+		std::fill(output.begin(), output.end() - 1, vec3{});
+		xform.transform_position(in, out, pool);
+		check(position);
+		std::copy(input.begin(), input.end(), output.begin());
+		xform.transform_position(out);
+		check(position);
+
+		const auto without_translating = [&](const vec3& v) noexcept { return xform.transform_without_translating(v); };
+		mat::transform_without_translating(xform, in, out);
+		check(without_translating);
+		std::copy(input.begin(), input.end(), output.begin());
+		mat::transform_without_translating(xform, out, pool);
+		check(without_translating);
+
+		const auto direction = [&](const vec3& v) noexcept { return xform.transform_direction(v); };
+		xform.transform_direction(in, out);
+		check(direction);
+		std::copy(input.begin(), input.end(), output.begin());
+		xform.transform_direction(out, pool);
+		check(direction);
+
+		// fewer vectors than a single block
+		std::fill(output.begin(), output.end() - 1, vec3{});
+		xform.transform_position(in.subspan(0, 3), out);
+		for (size_t i = 0; i < 3; i++)
+			CHECK(output[i] == xform.transform_position(input[i]));
+		CHECK(output[3] == vec3{});
+	}
+
+	// constant-evaluated
+	inline constexpr auto batch_constexpr_check = []() noexcept
+	{
+		constexpr auto xform = matrix<float, 3, 4>{ 1.0f, 0.0f, 0.0f, 1.0f, //
+													0.0f, 2.0f, 0.0f, 2.0f, //
+													0.0f, 0.0f, 3.0f, 3.0f };
+
+		vector<float, 3> vectors[] = { { 1.0f, 1.0f, 1.0f }, { 2.0f, 2.0f, 2.0f } };
+		xform.transform_position(span<vector<float, 3>>{ vectors, 2u });
+		return vectors[0] == vector<float, 3>{ 2.0f, 4.0f, 6.0f } && vectors[1] == vector<float, 3>{ 3.0f, 6.0f, 9.0f };
+	}();
+	static_assert(batch_constexpr_check);
+}
+
+TEST_CASE("matrix simd")
+{
+	check_simd_product<float, 2, 2, 2>();
+	check_simd_product<float, 3, 3, 3>();
+	check_simd_product<float, 4, 4, 4>();
+	check_simd_product<float, 3, 4, 4>();
+	check_simd_product<float, 4, 3, 2>();
+	check_simd_product<double, 2, 2, 2>();
+	check_simd_product<double, 3, 3, 3>();
+	check_simd_product<double, 4, 4, 4>();
+	check_simd_product<double, 3, 4, 4>();
+
+	check_simd_transforms<float, 3>();
+	check_simd_transforms<float, 4>();
+	check_simd_transforms<double, 3>();
+	check_simd_transforms<double, 4>();
+
+	check_simd_inverse<float>();
+	check_simd_inverse<double>();
+}
+
+TEST_CASE("matrix batch transforms")
+{
+	thread_pool pool{ 4 };
+
+	check_batch_transforms<float, 3, 3>(pool);
+	check_batch_transforms<float, 3, 4>(pool);
+	check_batch_transforms<float, 4, 4>(pool);
+	check_batch_transforms<double, 3, 4>(pool);
+	check_batch_transforms<double, 4, 4>(pool);
+#if MUU_HAS_FLOAT16
+	check_batch_transforms<_Float16, 4, 4>(pool);
+#endif
+}
@@ -12,6 +12,7 @@
 #include "tests.h"
 #include "batching.h"
 #include "../include/muu/quaternion.h"
+#include "../include/muu/thread_pool.h"
 
 namespace
 {
@@ -610,3 +611,49 @@ BATCHED_TEST_CASE("quaternion multiplication", all_quaternions)
 	axis_angle			= slerp3.to_axis_angle();
 	CHECK_APPROX_EQUAL(angle2, axis_angle.angle);
 }
+
+BATCHED_TEST_CASE("quaternion batch rotation", all_quaternions)
+{
+	using quat_t = TestType;
+	using T		 = typename quat_t::scalar_type;
+	using vec3_t = vector<T, 3>;
+	TEST_INFO("quaternion<"sv << nameof<T> << ">");
+
+	const auto rot =
+		quat_t::from_axis_angle(normalize(vec3_t{ static_cast<T>(4.3), static_cast<T>(7.6), static_cast<T>(1.2) }),
+								static_cast<T>(1.2));
+
+	// enough for the thread_pool overloads to split the work, plus a partial block at the end
+	std::vector<vec3_t> input(3u * impl::batch_transform_min_task_size + 5u);
+	for (auto& v : input)
+		v = vec3_t{ random_array<T, 3>(-10, 10) };
+	const auto in = span<const vec3_t>{ input.data(), input.size() };
+
+	std::vector<vec3_t> output(input.size());
+	const auto out = span<vec3_t>{ output.data(), output.size() };
+
+	const auto check = [&]() noexcept
+	{
+		size_t mismatches = 0;
+		for (size_t i = 0; i < input.size(); i++)
+			if (!approx_equal(output[i], rot * input[i], constants<T>::default_epsilon * T{ 100 }))
+				mismatches++;
+		CHECK(mismatches == 0u);
+	};
+
+	quat_t::rotate_vector(rot, in, out);
+	check();
+
+	std::copy(input.begin(), input.end(), output.begin());
+	rot.rotate_vector(out);
+	check();
+
+	thread_pool pool{ 4 };
+	std::fill(output.begin(), output.end(), vec3_t{});
+	rot.rotate_vector(in, out, pool);
+	check();
+
+	std::copy(input.begin(), input.end(), output.begin());
+	quat_t::rotate_vector(rot, out, pool);
+	check();
+}
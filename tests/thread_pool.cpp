@@ -5,9 +5,19 @@
 
 #include "tests.h"
 #include "../include/muu/thread_pool.h"
+#include "../include/muu/accumulator.h"
+#include "../include/muu/uuid.h"
 MUU_DISABLE_WARNINGS;
 #include <thread>
 #include <atomic>
+#include <algorithm>
+#include <chrono>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <vector>
 MUU_ENABLE_WARNINGS;
 MUU_DISABLE_SPAM_WARNINGS;
 
@@ -416,3 +426,1683 @@ TEST_CASE("thread_pool - for_each (iterators)")
 	}
 
 }
+
+TEST_CASE("thread_pool - partitioners")
+{
+	thread_pool pool{ min(std::thread::hardware_concurrency(), 16u) };
+
+	std::vector<std::atomic_int> values(5000);
+	std::atomic_bool batch_in_range;
+
+	const auto reset = [&]() noexcept
+	{
+		for (auto& v : values)
+			v = 0;
+		batch_in_range = true;
+	};
+	const auto check = [&](int expected) noexcept
+	{
+		pool.wait();
+		CHECK(batch_in_range);
+		for (auto& v : values)
+			CHECK(v == expected);
+	};
+
+	// later elements are much more expensive than earlier ones
+	const auto skewed = [&](size_t i, size_t batch) noexcept
+	{
+		if (batch >= pool.workers())
+			batch_in_range = false;
+		volatile unsigned sink = 0;
+		for (size_t j = 0; j < i / 16u; j++)
+			sink = sink + static_cast<unsigned>(j);
+		values[i]++;
+	};
+
+	const auto run = [&](auto partitioner)
+	{
+		{
+			TEST_INFO("integral");
+			reset();
+			pool.for_each(0_sz, values.size(), skewed, partitioner);
+			check(1);
+
+			TEST_INFO("integral (reversed)");
+			reset();
+			pool.for_each(
+				static_cast<int>(values.size()) - 1,
+				-1,
+				[&](int i) noexcept { values[static_cast<size_t>(i)]++; },
+				partitioner);
+			check(1);
+
+			TEST_INFO("integral (empty)");
+			reset();
+			pool.for_each(10, 10, [&]() noexcept { values[0]++; }, partitioner);
+			check(0);
+		}
+
+		{
+			TEST_INFO("iterators");
+			reset();
+			pool.for_each(values.begin(), values.end(), [](std::atomic_int& v) noexcept { v++; }, partitioner);
+			check(1);
+
+			TEST_INFO("collection");
+			reset();
+			pool.for_each(values, [](std::atomic_int& v) noexcept { v++; }, partitioner);
+			pool.for_each(values, [](std::atomic_int& v, size_t) noexcept { v++; }, partitioner);
+			check(2);
+
+			TEST_INFO("collection (non-random-access)");
+			std::list<int> list(1000, 0);
+			pool.for_each(list, [](int& v) noexcept { v++; }, partitioner);
+			pool.wait();
+			for (auto& v : list)
+				CHECK(v == 1);
+		}
+
+		{
+			TEST_INFO("move semantics");
+			std::atomic_size_t val = 0_sz;
+			pool.for_each(values, callable_counter{ val }, partitioner);
+			pool.wait();
+			CHECK(val == values.size());
+		}
+	};
+
+	{
+		TEST_INFO("static");
+		run(thread_pool_static_partitioner{});
+	}
+	{
+		TEST_INFO("dynamic (automatic grain)");
+		run(thread_pool_dynamic_partitioner{});
+	}
+	{
+		TEST_INFO("dynamic (fixed grain)");
+		run(thread_pool_dynamic_partitioner{ 7 });
+	}
+	{
+		TEST_INFO("dynamic (grain larger than range)");
+		run(thread_pool_dynamic_partitioner{ 100000 });
+	}
+	{
+		TEST_INFO("guided");
+		run(thread_pool_guided_partitioner{});
+	}
+	{
+		TEST_INFO("guided (minimum grain)");
+		run(thread_pool_guided_partitioner{ 32 });
+	}
+}
+
+TEST_CASE("thread_pool - work stealing")
+{
+	thread_pool_options options{};
+	options.worker_count = min(std::thread::hardware_concurrency(), 16u);
+	options.scheduler	 = thread_pool_scheduler::work_stealing;
+	thread_pool pool{ options, "work stealing"sv };
+
+	{
+		TEST_INFO("tasks enqueued from outside the pool");
+		std::atomic_int i = 0;
+		for (int j = 0; j < 1000; j++)
+			pool.enqueue([&]() noexcept { i++; });
+		pool.wait();
+		CHECK(i == 1000);
+	}
+
+	{
+		TEST_INFO("tasks enqueued from the pool's own workers");
+		std::atomic_int i = 0;
+		pool.for_each(0, 32, [&]() noexcept
+		{
+			for (int j = 0; j < 16; j++)
+				pool.enqueue([&]() noexcept { i++; });
+		});
+		pool.wait();
+		CHECK(i == 32 * 16);
+	}
+
+	{
+		TEST_INFO("for_each enqueued from the pool's own workers");
+		std::array<int, 1000> values{};
+		pool.enqueue([&]() noexcept
+		{
+			pool.for_each(values, [](auto& v) noexcept { v++; });
+		});
+		pool.wait();
+		for (auto& v : values)
+			CHECK(v == 1);
+	}
+}
+
+TEST_CASE("thread_pool - affinity")
+{
+	for (auto affinity : { thread_pool_affinity::none, thread_pool_affinity::cores, thread_pool_affinity::numa_nodes })
+	{
+		for (auto scheduler : { thread_pool_scheduler::shared_queues, thread_pool_scheduler::work_stealing })
+		{
+			TEST_INFO("affinity: " << static_cast<int>(affinity) << ", scheduler: " << static_cast<int>(scheduler));
+
+			thread_pool_options options{};
+			options.worker_count = 6; // more workers than cores and/or nodes on most test machines
+			options.scheduler	 = scheduler;
+			options.affinity	 = affinity;
+			thread_pool pool{ options };
+			CHECK(pool.workers() == 6u);
+
+			std::atomic_int i = 0;
+			pool.for_each(0, 64, [&]() noexcept
+			{
+				for (int j = 0; j < 16; j++)
+					pool.enqueue([&]() noexcept { i++; });
+			});
+			pool.wait();
+			CHECK(i == 64 * 16);
+		}
+	}
+}
+
+TEST_CASE("thread_pool - idle strategies")
+{
+	for (auto strategy : { thread_pool_idle_strategy::balanced,
+						   thread_pool_idle_strategy::low_latency,
+						   thread_pool_idle_strategy::low_power })
+	{
+		for (auto scheduler : { thread_pool_scheduler::shared_queues, thread_pool_scheduler::work_stealing })
+		{
+			TEST_INFO("strategy: " << static_cast<int>(strategy) << ", scheduler: " << static_cast<int>(scheduler));
+
+			thread_pool_options options{};
+			options.worker_count  = 4u;
+			options.scheduler	  = scheduler;
+			options.idle_strategy = strategy;
+			options.collect_stats = true;
+			thread_pool pool{ options };
+
+			// let the workers go idle (and park) between bursts, so every burst has to wake them back up
+			std::atomic_int i = 0;
+			for (int burst = 0; burst < 20; burst++)
+			{
+				std::this_thread::sleep_for(std::chrono::milliseconds{ 2 });
+				for (int j = 0; j < 16; j++)
+					pool.enqueue([&]() noexcept { i++; });
+				pool.wait();
+			}
+			CHECK(i == 20 * 16);
+
+			// work enqueued by a worker into somewhere other than its own queue
+			std::this_thread::sleep_for(std::chrono::milliseconds{ 10 });
+			pool.enqueue([&]() noexcept
+			{
+				for (int j = 0; j < 64; j++)
+					pool.enqueue(thread_pool_priority::high, [&]() noexcept { i++; });
+			});
+			pool.wait();
+			CHECK(i == 20 * 16 + 64);
+
+			if (strategy == thread_pool_idle_strategy::low_power)
+				CHECK(pool.stats().workers.sleeps > 0u);
+		}
+	}
+}
+
+TEST_CASE("thread_pool - resizing")
+{
+	for (auto scheduler : { thread_pool_scheduler::shared_queues, thread_pool_scheduler::work_stealing })
+	{
+		TEST_INFO("scheduler: " << static_cast<int>(scheduler));
+
+		// manual resizing
+		{
+			thread_pool_options options{};
+			options.worker_count = 2u;
+			options.max_workers	 = 6u;
+			options.scheduler	 = scheduler;
+			thread_pool pool{ options };
+			CHECK(pool.workers() == 2u);
+			CHECK(pool.max_workers() == 6u);
+
+			CHECK(pool.set_workers(6u).workers() == 6u);
+			CHECK(pool.set_workers(100u).workers() == 6u);
+			CHECK(pool.set_workers(0u).workers() == 1u);
+
+			// resizing with work in flight doesn't lose anything
+			std::atomic_int i = 0;
+			for (size_t size : { 4u, 1u, 6u, 2u, 3u })
+			{
+				for (int j = 0; j < 200; j++)
+					pool.enqueue([&]() noexcept
+					{
+						std::this_thread::yield();
+						i++;
+					});
+				pool.set_workers(size);
+				CHECK(pool.workers() == size);
+			}
+			pool.wait();
+			CHECK(i == 1000);
+
+			// resizing from within tasks, including retiring the worker doing the resizing
+			pool.set_workers(4u);
+			i = 0;
+			for (int j = 0; j < 64; j++)
+				pool.enqueue([&, j]() noexcept
+				{
+					if (j % 16 == 0)
+						pool.set_workers(j % 32 ? 4u : 1u);
+					i++;
+				});
+			pool.wait();
+			CHECK(i == 64);
+
+			// queued work stranded on retired workers is still picked up by the ones that are left
+			pool.set_workers(6u);
+			i = 0;
+			pool.enqueue([&]() noexcept
+			{
+				for (int j = 0; j < 256; j++)
+					pool.enqueue([&]() noexcept { i++; });
+				pool.set_workers(1u);
+			});
+			pool.wait();
+			CHECK(i == 256);
+			CHECK(pool.workers() == 1u);
+		}
+
+		// fixed-size pools can't grow past their initial size
+		{
+			thread_pool_options options{};
+			options.worker_count = 2u;
+			options.scheduler	 = scheduler;
+			thread_pool pool{ options };
+			CHECK(pool.max_workers() == 2u);
+			CHECK(pool.set_workers(4u).workers() == 2u);
+		}
+
+		// automatic scaling
+		{
+			thread_pool_options options{};
+			options.worker_count	= 1u;
+			options.max_workers		= 4u;
+			options.scheduler		= scheduler;
+			options.auto_scale		= true;
+			options.idle_timeout_ms = 20u;
+			thread_pool pool{ options };
+			CHECK(pool.workers() == 1u);
+			CHECK(pool.max_workers() == 4u);
+
+			// keep the pool saturated with blocking tasks until it grows
+			std::atomic_int i = 0;
+			const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds{ 10 };
+			while (pool.workers() < 4u && std::chrono::steady_clock::now() < deadline)
+			{
+				for (int j = 0; j < 8; j++)
+					pool.enqueue([&]() noexcept
+					{
+						std::this_thread::sleep_for(std::chrono::milliseconds{ 2 });
+						i++;
+					});
+				std::this_thread::sleep_for(std::chrono::milliseconds{ 4 });
+			}
+			pool.wait();
+			CHECK(pool.workers() == 4u);
+
+			// then shrink back down once idle
+			while (pool.workers() > 1u && std::chrono::steady_clock::now() < deadline + std::chrono::seconds{ 10 })
+				std::this_thread::sleep_for(std::chrono::milliseconds{ 5 });
+			CHECK(pool.workers() == 1u);
+
+			// and still work afterwards
+			const int before = i;
+			for (int j = 0; j < 64; j++)
+				pool.enqueue([&]() noexcept { i++; });
+			pool.wait();
+			CHECK(i == before + 64);
+		}
+	}
+}
+
+TEST_CASE("thread_pool - timers")
+{
+	using clock = std::chrono::steady_clock;
+	using namespace std::chrono_literals;
+
+	// polls until the condition is met (or gives up after a generous timeout)
+	const auto eventually = [](auto&& cond) noexcept
+	{
+		const auto deadline = clock::now() + 10s;
+		while (!cond() && clock::now() < deadline)
+			std::this_thread::sleep_for(1ms);
+		return cond();
+	};
+
+	for (auto scheduler : { thread_pool_scheduler::shared_queues, thread_pool_scheduler::work_stealing })
+	{
+		TEST_INFO("scheduler: " << static_cast<int>(scheduler));
+
+		thread_pool_options options{};
+		options.worker_count = 2u;
+		options.scheduler	 = scheduler;
+
+		// one-shot timers never fire early, and fire in order of their deadlines
+		{
+			thread_pool pool{ options };
+
+			std::mutex mutex;
+			std::vector<int> order;
+			std::atomic_int early = 0;
+			const auto start	  = clock::now();
+			for (int ms : { 30, 10, 50, 20, 40 })
+			{
+				pool.enqueue_after(std::chrono::milliseconds{ ms },
+								   [&, ms]() noexcept
+								   {
+									   if (clock::now() - start < std::chrono::milliseconds{ ms })
+										   early++;
+									   std::lock_guard lock{ mutex };
+									   order.push_back(ms);
+								   });
+			}
+			CHECK(eventually(
+				[&]() noexcept
+				{
+					std::lock_guard lock{ mutex };
+					return order.size() == 5u;
+				}));
+			CHECK(early == 0);
+			CHECK(order == std::vector<int>{ 10, 20, 30, 40, 50 });
+		}
+
+		// zero and negative delays are enqueued straight away
+		{
+			thread_pool pool{ options };
+
+			std::atomic_int i = 0;
+			pool.enqueue_after(0ms, [&]() noexcept { i++; });
+			pool.enqueue_after(-5s, [&](size_t) noexcept { i++; });
+			CHECK(eventually([&]() noexcept { return i == 2; }));
+		}
+
+		// lots of timers at once, scheduled from inside the pool as well as outside
+		{
+			thread_pool pool{ options };
+
+			std::atomic_int fired = 0;
+			std::atomic_int early = 0;
+			const auto check	  = [&](clock::time_point due) noexcept
+			{
+				if (clock::now() < due)
+					early++;
+				fired++;
+			};
+			for (int i = 0; i < 500; i++)
+			{
+				const auto delay = std::chrono::milliseconds{ (i * 7) % 150 };
+				pool.enqueue_after(delay, [=, due = clock::now() + delay]() noexcept { check(due); });
+			}
+			pool.enqueue(
+				[&]() noexcept
+				{
+					for (int i = 0; i < 500; i++)
+					{
+						const auto delay = std::chrono::milliseconds{ (i * 13) % 150 };
+						pool.enqueue_after(delay, [=, due = clock::now() + delay]() noexcept { check(due); });
+					}
+				});
+			CHECK(eventually([&]() noexcept { return fired == 1000; }));
+			CHECK(early == 0);
+		}
+
+		// periodic timers repeat until they return false
+		{
+			thread_pool pool{ options };
+
+			std::atomic_int i = 0;
+			pool.enqueue_every(5ms, [&]() noexcept { return ++i < 10; });
+			CHECK(eventually([&]() noexcept { return i == 10; }));
+			std::this_thread::sleep_for(50ms);
+			CHECK(i == 10);
+		}
+
+		// periodic timers never overlap with themselves, even when they run longer than their period
+		{
+			thread_pool pool{ options };
+
+			std::atomic_int running = 0;
+			std::atomic_int overlap = 0;
+			std::atomic_int i		= 0;
+			pool.enqueue_every(1ms,
+							   [&](size_t) noexcept
+							   {
+								   if (running++)
+									   overlap++;
+								   std::this_thread::sleep_for(3ms);
+								   running--;
+								   return ++i < 10;
+							   });
+			CHECK(eventually([&]() noexcept { return i == 10; }));
+			CHECK(overlap == 0);
+		}
+
+		// tasks are held by value, and pending ones are destroyed (without being run) along with the pool
+		{
+			auto alive		  = std::make_shared<int>(0);
+			std::atomic_int i = 0;
+			{
+				thread_pool pool{ options };
+
+				{
+					auto lvalue = [alive, &i]() noexcept { i++; };
+					pool.enqueue_after(5ms, lvalue);
+					pool.enqueue_after(10h, lvalue); // further out than the timing wheel spans
+					pool.enqueue_every(1h, lvalue);
+					pool.enqueue_every(1ms, lvalue);
+				}
+				CHECK(eventually([&]() noexcept { return i >= 3; }));
+			}
+			CHECK(alive.use_count() == 1);
+		}
+	}
+}
+
+TEST_CASE("thread_pool - stats")
+{
+	{
+		TEST_INFO("stats disabled");
+		thread_pool pool{ 4u };
+		for (int j = 0; j < 100; j++)
+			pool.enqueue([]() noexcept {});
+		pool.wait();
+
+		const auto stats = pool.stats();
+		CHECK(stats.workers.tasks_executed == 0u);
+		CHECK(stats.enqueue_spins == 0u);
+		CHECK(stats.queue_high_water_mark == 0u);
+	}
+
+	for (auto scheduler : { thread_pool_scheduler::shared_queues, thread_pool_scheduler::work_stealing })
+	{
+		TEST_INFO("scheduler: " << static_cast<int>(scheduler));
+
+		thread_pool_options options{};
+		options.worker_count  = 4u;
+		options.scheduler	  = scheduler;
+		options.collect_stats = true;
+		thread_pool pool{ options };
+
+		std::atomic_int i = 0;
+		for (int j = 0; j < 1000; j++)
+			pool.enqueue([&]() noexcept { i++; });
+		pool.wait();
+		CHECK(i == 1000);
+
+		auto stats = pool.stats();
+		CHECK(stats.workers.tasks_executed == 1000u);
+		CHECK(stats.queue_high_water_mark > 0u);
+		CHECK(stats.queue_high_water_mark <= pool.capacity());
+		CHECK(stats.workers.steals <= stats.workers.steal_attempts);
+		if (scheduler == thread_pool_scheduler::shared_queues)
+			CHECK(stats.workers.steal_attempts == 0u);
+
+		uint64_t executed = 0;
+		for (size_t w = 0; w < pool.workers(); w++)
+			executed += pool.stats(w).tasks_executed;
+		CHECK(executed == 1000u);
+
+		pool.reset_stats();
+		stats = pool.stats();
+		CHECK(stats.workers.tasks_executed == 0u);
+		CHECK(stats.workers.steals == 0u);
+		CHECK(stats.enqueue_spins == 0u);
+		CHECK(stats.enqueue_sleeps == 0u);
+		CHECK(stats.queue_high_water_mark == 0u);
+
+		pool.enqueue([&]() noexcept { i++; });
+		pool.wait();
+		CHECK(pool.stats().workers.tasks_executed == 1u);
+	}
+}
+
+TEST_CASE("thread_pool - priorities")
+{
+	for (auto scheduler : { thread_pool_scheduler::shared_queues, thread_pool_scheduler::work_stealing })
+	{
+		TEST_INFO("scheduler: " << static_cast<int>(scheduler));
+
+		thread_pool_options options{};
+		options.worker_count = 1; // so the execution order is deterministic
+		options.scheduler	 = scheduler;
+		thread_pool pool{ options };
+
+		// block the worker while the queues are filled
+		std::atomic_bool release = false;
+		pool.enqueue([&]() noexcept
+		{
+			while (!release)
+				std::this_thread::yield();
+		});
+
+		std::vector<thread_pool_priority> order;
+		const auto record = [&](thread_pool_priority priority) noexcept
+		{
+			return [&order, priority]() noexcept { order.push_back(priority); };
+		};
+		for (int i = 0; i < 10; i++)
+		{
+			pool.enqueue(thread_pool_priority::low, record(thread_pool_priority::low));
+			pool.enqueue(record(thread_pool_priority::normal));
+			pool.enqueue(thread_pool_priority::high, record(thread_pool_priority::high));
+		}
+		pool.for_each(thread_pool_priority::low, 0, 10, [&]() noexcept { order.push_back(thread_pool_priority::low); });
+		std::array<int, 10> vals{};
+		pool.for_each(thread_pool_priority::high, vals, [&]() noexcept { order.push_back(thread_pool_priority::high); });
+		pool.for_each(thread_pool_priority::normal,
+					  vals.begin(),
+					  vals.end(),
+					  [&]() noexcept { order.push_back(thread_pool_priority::normal); });
+
+		release = true;
+		pool.wait();
+
+		REQUIRE(order.size() == 60u);
+		CHECK(std::is_sorted(order.begin(),
+							 order.end(),
+							 [](thread_pool_priority lhs, thread_pool_priority rhs) noexcept { return lhs > rhs; }));
+		CHECK(std::count(order.begin(), order.end(), thread_pool_priority::high) == 20);
+		CHECK(std::count(order.begin(), order.end(), thread_pool_priority::normal) == 20);
+		CHECK(std::count(order.begin(), order.end(), thread_pool_priority::low) == 20);
+	}
+}
+
+namespace
+{
+	static void parallel_sum_tree(thread_pool& pool, std::atomic_int& sum, int depth) noexcept
+	{
+		sum++;
+		if (!depth)
+			return;
+
+		task_group group{ pool };
+		group.enqueue([&, depth]() noexcept { parallel_sum_tree(pool, sum, depth - 1); });
+		group.enqueue([&, depth]() noexcept { parallel_sum_tree(pool, sum, depth - 1); });
+		group.wait();
+	}
+}
+
+TEST_CASE("thread_pool - nested submission")
+{
+	for (auto scheduler : { thread_pool_scheduler::shared_queues, thread_pool_scheduler::work_stealing })
+	{
+		TEST_INFO("scheduler: " << static_cast<int>(scheduler));
+
+		thread_pool_options options{};
+		options.worker_count	= 4;
+		options.task_queue_size = 32; // small enough that nested submissions will fill the queues
+		options.scheduler		= scheduler;
+		thread_pool pool{ options };
+
+		{
+			TEST_INFO("recursive task groups");
+			std::atomic_int sum = 0;
+			pool.enqueue([&]() noexcept { parallel_sum_tree(pool, sum, 10); });
+			pool.wait();
+			CHECK(sum == (1 << 11) - 1);
+		}
+
+		{
+			TEST_INFO("enqueueing more tasks than the pool can hold from a worker");
+			std::atomic_int i = 0;
+			pool.enqueue([&]() noexcept
+			{
+				for (int j = 0; j < 1000; j++)
+					pool.enqueue([&]() noexcept { i++; });
+			});
+			pool.wait();
+			CHECK(i == 1000);
+		}
+
+		{
+			TEST_INFO("wait() from workers");
+			std::atomic_int i = 0;
+			pool.for_each(0, 8, [&]() noexcept
+			{
+				pool.for_each(0, 100, [&]() noexcept { i++; });
+				pool.wait();
+			});
+			pool.wait();
+			CHECK(i == 800);
+		}
+
+		{
+			TEST_INFO("workers waiting for slow work (long enough to park) are woken when it finishes");
+			std::atomic_bool release = false;
+			std::atomic_int i		 = 0;
+			task_group group{ pool };
+			group.enqueue(
+				[&]() noexcept
+				{
+					while (!release)
+						std::this_thread::sleep_for(1ms);
+					i++;
+				});
+			pool.for_each(0, 3, [&]() noexcept
+			{
+				group.wait();
+				i++;
+			});
+			std::this_thread::sleep_for(50ms);
+			release = true;
+			pool.wait();
+			CHECK(i == 4);
+		}
+	}
+}
+
+TEST_CASE("thread_pool - multiple producers")
+{
+	const auto run = [](thread_pool& pool, int producers, int tasks_per_producer)
+	{
+		std::atomic_int i = 0;
+		std::vector<std::thread> threads;
+		for (int p = 0; p < producers; p++)
+		{
+			threads.emplace_back([&]() noexcept
+			{
+				for (int j = 0; j < tasks_per_producer; j++)
+					pool.enqueue([&]() noexcept { i++; });
+			});
+		}
+		for (auto& t : threads)
+			t.join();
+		pool.wait();
+		CHECK(i == producers * tasks_per_producer);
+	};
+
+	{
+		TEST_INFO("default queue size");
+		thread_pool pool{ min(std::thread::hardware_concurrency(), 16u) };
+		run(pool, 8, 5000);
+	}
+
+	{
+		TEST_INFO("tiny queue size (overflowing the injection queue)");
+		thread_pool pool{ 2u, 4u };
+		run(pool, 8, 1000);
+	}
+}
+
+TEST_CASE("thread_pool - wait")
+{
+	thread_pool pool{ min(std::thread::hardware_concurrency(), 16u) };
+
+	// lots of short enqueue -> wait cycles to shake out lost wake-ups
+	std::atomic_int i = 0;
+	for (int j = 1; j <= 2000; j++)
+	{
+		pool.enqueue([&]() noexcept { i++; });
+		pool.wait();
+		CHECK(i == j);
+	}
+
+	// waiting on an idle pool returns immediately
+	pool.wait();
+	pool.wait();
+}
+
+TEST_CASE("thread_pool - enqueue_with_result")
+{
+	for (auto scheduler : { thread_pool_scheduler::shared_queues, thread_pool_scheduler::work_stealing })
+	{
+		thread_pool_options options{};
+		options.worker_count = min(std::thread::hardware_concurrency(), 16u);
+		options.scheduler	 = scheduler;
+		thread_pool pool{ options };
+
+		{
+			TEST_INFO("scalar results");
+			std::vector<thread_pool_future<int>> futures;
+			for (int j = 0; j < 500; j++)
+				futures.push_back(pool.enqueue_with_result([j]() noexcept { return j * 2; }));
+			for (int j = 0; j < 500; j++)
+			{
+				CHECK(futures[static_cast<size_t>(j)].valid());
+				CHECK(futures[static_cast<size_t>(j)].get() == j * 2);
+				CHECK(futures[static_cast<size_t>(j)].ready());
+			}
+		}
+
+		{
+			TEST_INFO("void results");
+			std::atomic_int i = 0;
+			auto f = pool.enqueue_with_result([&]() noexcept { i++; });
+			f.wait();
+			CHECK(f.ready());
+			CHECK(i == 1);
+		}
+
+		{
+			TEST_INFO("non-trivial results");
+			auto f = pool.enqueue_with_result([](size_t worker) noexcept { return std::string(100u, 'a') + std::to_string(worker); });
+			auto str = std::move(f).get();
+			CHECK(str.length() > 100u);
+			CHECK(str.substr(0, 100u) == std::string(100u, 'a'));
+		}
+
+		{
+			TEST_INFO("large results");
+			auto f = pool.enqueue_with_result([]() noexcept
+			{
+				std::array<int, 2000> arr{};
+				arr.back() = 42;
+				return arr;
+			});
+			CHECK(f.get().back() == 42);
+		}
+
+		{
+			TEST_INFO("futures that are never waited on");
+			for (int j = 0; j < 100; j++)
+				[[maybe_unused]] auto f = pool.enqueue_with_result([]() noexcept { return std::string(100u, 'b'); });
+			pool.wait();
+		}
+
+		{
+			TEST_INFO("waiting on futures from within the pool's own workers");
+			auto outer = pool.enqueue_with_result([&]() noexcept
+			{
+				std::vector<thread_pool_future<int>> inner;
+				for (int j = 0; j < 32; j++)
+					inner.push_back(pool.enqueue_with_result([j]() noexcept { return j; }));
+				int sum = 0;
+				for (auto& f : inner)
+					sum += f.get();
+				return sum;
+			});
+			CHECK(outer.get() == (31 * 32) / 2);
+		}
+	}
+
+	{
+		TEST_INFO("futures outstanding when the pool is destroyed");
+		thread_pool pool{ 1u };
+		std::atomic_bool go = false;
+		pool.enqueue([&]() noexcept { while (!go) std::this_thread::yield(); });
+		for (int j = 0; j < 10; j++)
+			[[maybe_unused]] auto f = pool.enqueue_with_result([]() noexcept { return std::string(100u, 'c'); });
+		go = true;
+	}
+}
+
+TEST_CASE("thread_pool - task_group")
+{
+	for (auto scheduler : { thread_pool_scheduler::shared_queues, thread_pool_scheduler::work_stealing })
+	{
+		thread_pool_options options{};
+		options.worker_count = 2u;
+		options.scheduler	 = scheduler;
+		thread_pool pool{ options };
+
+		{
+			TEST_INFO("waiting on a group ignores the rest of the pool's work");
+
+			std::atomic_bool release = false;
+			pool.enqueue([&]() noexcept { while (!release) std::this_thread::yield(); });
+
+			task_group group{ pool };
+			std::atomic_int i = 0;
+			std::array<int, 100> values{};
+			for (int j = 0; j < 100; j++)
+				group.enqueue([&]() noexcept { i++; });
+			group.for_each(0, 100, [&](int) noexcept { i++; });
+			group.for_each(values, [](int& v) noexcept { v++; });
+			group.for_each(values.begin(), values.end(), [](int& v) noexcept { v++; });
+			group.wait();
+
+			CHECK(group.done());
+			CHECK(i == 200);
+			for (auto& v : values)
+				CHECK(v == 2);
+			CHECK(!release);
+
+			release = true;
+			pool.wait();
+		}
+
+		{
+			TEST_INFO("multiple independent groups");
+
+			std::atomic_int a = 0, b = 0;
+			task_group group_a{ pool };
+			task_group group_b{ pool };
+			for (int j = 0; j < 500; j++)
+			{
+				group_a.enqueue([&]() noexcept { a++; });
+				pool.enqueue(group_b, [&]() noexcept { b++; });
+			}
+			group_a.wait();
+			CHECK(a == 500);
+			group_b.wait();
+			CHECK(b == 500);
+		}
+
+		{
+			TEST_INFO("waiting on a group from within the pool's own workers");
+
+			std::atomic_int i = 0;
+			task_group outer{ pool };
+			outer.for_each(8, [&]() noexcept
+			{
+				task_group inner{ pool };
+				inner.for_each(100, [&]() noexcept { i++; });
+				inner.wait();
+			});
+			outer.wait();
+			CHECK(i == 800);
+		}
+
+		{
+			TEST_INFO("groups wait on destruction");
+
+			std::atomic_int i = 0;
+			{
+				task_group group{ pool };
+				for (int j = 0; j < 100; j++)
+					group.enqueue([&]() noexcept { i++; });
+			}
+			CHECK(i == 100);
+		}
+	}
+}
+
+TEST_CASE("thread_pool - cancellation")
+{
+	CHECK(!cancellation_token{}.cancelled());
+
+	for (auto scheduler : { thread_pool_scheduler::shared_queues, thread_pool_scheduler::work_stealing })
+	{
+		TEST_INFO("scheduler: " << static_cast<int>(scheduler));
+
+		thread_pool_options options{};
+		options.worker_count = 2u;
+		options.scheduler	 = scheduler;
+		thread_pool pool{ options };
+
+		// queued tasks are dropped without being run
+		{
+			std::atomic_bool gate	= false;
+			std::atomic_int blocked	= 0;
+			std::atomic_int i		= 0;
+			task_group group{ pool };
+			const auto token = group.token();
+			CHECK(!group.cancelled());
+			CHECK(!token.cancelled());
+
+			// keep both workers busy so nothing else gets started
+			for (int j = 0; j < 2; j++)
+				pool.enqueue(
+					[&]() noexcept
+					{
+						blocked++;
+						while (!gate)
+							std::this_thread::yield();
+					});
+			while (blocked < 2)
+				std::this_thread::yield();
+			for (int j = 0; j < 100; j++)
+				group.enqueue([&]() noexcept { i++; });
+
+			group.cancel();
+			CHECK(group.cancelled());
+			CHECK(token.cancelled());
+			gate = true;
+			group.wait();
+			CHECK(i == 0);
+			CHECK(group.done());
+
+			// still cancelled
+			group.enqueue([&]() noexcept { i++; });
+			group.wait();
+			CHECK(i == 0);
+		}
+
+		// running for_each() batches stop between elements
+		for (int partitioner = 0; partitioner < 3; partitioner++)
+		{
+			TEST_INFO("partitioner: " << partitioner);
+
+			constexpr int count = 1000000;
+			std::atomic_int i	= 0;
+			task_group group{ pool };
+			const auto body = [&](int) noexcept
+			{
+				if (i++ == 1000)
+					group.cancel();
+			};
+			if (partitioner == 0)
+				group.for_each(0, count, body);
+			else if (partitioner == 1)
+				group.for_each(0, count, body, thread_pool_dynamic_partitioner{ 64 });
+			else
+				group.for_each(0, count, body, thread_pool_guided_partitioner{});
+			group.wait();
+			CHECK(group.cancelled());
+			CHECK(i > 1000);
+			CHECK(i < count);
+		}
+
+		// iterator ranges too
+		{
+			std::vector<int> values(100000);
+			std::atomic_int i = 0;
+			task_group group{ pool };
+			group.for_each(values,
+						   [&](int& v) noexcept
+						   {
+							   v = 1;
+							   if (i++ == 100)
+								   group.cancel();
+						   });
+			group.wait();
+			CHECK(i < static_cast<int>(values.size()));
+			CHECK(std::count(values.begin(), values.end(), 1) == i);
+		}
+
+		// long-running tasks can poll the token
+		{
+			std::atomic_int polls = 0;
+			task_group group{ pool };
+			group.enqueue(
+				[&, token = group.token()]() noexcept
+				{
+					while (!token.cancelled())
+					{
+						polls++;
+						std::this_thread::yield();
+					}
+				});
+			while (!polls)
+				std::this_thread::yield();
+			group.cancel();
+			group.wait();
+			CHECK(polls > 0);
+		}
+
+		// cancelling one group doesn't affect anything else
+		{
+			std::atomic_int i = 0;
+			task_group cancelled{ pool };
+			task_group other{ pool };
+			cancelled.cancel();
+			for (int j = 0; j < 100; j++)
+			{
+				cancelled.enqueue([&]() noexcept { i += 1000; });
+				other.enqueue([&]() noexcept { i++; });
+				pool.enqueue([&]() noexcept { i++; });
+			}
+			pool.wait();
+			CHECK(i == 200);
+			CHECK(!other.cancelled());
+		}
+
+		// callables of partitioned for_each() tasks that were dropped without ever running are still destroyed
+		for (int partitioner = 0; partitioner < 3; partitioner++)
+		{
+			TEST_INFO("partitioner: " << partitioner);
+
+			struct body
+			{
+				std::atomic_int* live;
+				std::atomic_int* calls;
+
+				body(std::atomic_int& live_, std::atomic_int& calls_) noexcept //
+					: live{ &live_ },
+					  calls{ &calls_ }
+				{
+					(*live)++;
+				}
+				body(const body& other) noexcept //
+					: live{ other.live },
+					  calls{ other.calls }
+				{
+					(*live)++;
+				}
+				~body() noexcept
+				{
+					(*live)--;
+				}
+				void operator()(int) const noexcept
+				{
+					(*calls)++;
+				}
+			};
+
+			std::atomic_int live  = 0;
+			std::atomic_int calls = 0;
+			{
+				task_group group{ pool };
+				group.cancel();
+				if (partitioner == 0)
+					group.for_each(0, 100000, body{ live, calls });
+				else if (partitioner == 1)
+					group.for_each(0, 100000, body{ live, calls }, thread_pool_dynamic_partitioner{ 64 });
+				else
+					group.for_each(0, 100000, body{ live, calls }, thread_pool_guided_partitioner{});
+				group.wait();
+				CHECK(live == 0);
+			}
+			CHECK(calls == 0);
+		}
+	}
+}
+
+TEST_CASE("thread_pool - bulk enqueue")
+{
+	for (auto scheduler : { thread_pool_scheduler::shared_queues, thread_pool_scheduler::work_stealing })
+	{
+		TEST_INFO("scheduler: " << static_cast<int>(scheduler));
+
+		thread_pool_options options{};
+		options.worker_count	= 4u;
+		options.task_queue_size = 256u;
+		options.scheduler		= scheduler;
+		thread_pool pool{ options };
+
+		struct counting_task
+		{
+			std::atomic_int* counter;
+			int amount;
+
+			void operator()() noexcept
+			{
+				*counter += amount;
+			}
+		};
+
+		{
+			TEST_INFO("iterators (more tasks than the pool can hold at once)");
+			std::atomic_int i = 0;
+			std::vector<counting_task> tasks(pool.capacity() * 3u + 7u, counting_task{ &i, 1 });
+			pool.enqueue_bulk(tasks.begin(), tasks.end()).wait();
+			CHECK(i == static_cast<int>(tasks.size()));
+		}
+
+		{
+			TEST_INFO("empty range");
+			std::vector<counting_task> tasks;
+			pool.enqueue_bulk(tasks.begin(), tasks.end()).wait();
+			pool.enqueue_bulk(tasks).wait();
+		}
+
+		{
+			TEST_INFO("collections and priorities");
+			std::atomic_int i = 0;
+			std::array<counting_task, 100> tasks;
+			tasks.fill(counting_task{ &i, 2 });
+			pool.enqueue_bulk(tasks);
+			pool.enqueue_bulk(thread_pool_priority::high, tasks);
+			pool.enqueue_bulk(thread_pool_priority::low, tasks.begin(), tasks.end());
+			pool.wait();
+			CHECK(i == 600);
+		}
+
+		{
+			TEST_INFO("move iterators");
+			std::atomic_int i = 0;
+			struct move_only_task
+			{
+				std::unique_ptr<int> value;
+				std::atomic_int* counter;
+
+				void operator()() noexcept
+				{
+					*counter += *value;
+				}
+			};
+			std::vector<move_only_task> tasks;
+			for (int j = 0; j < 500; j++)
+				tasks.push_back(move_only_task{ std::make_unique<int>(j), &i });
+			pool.enqueue_bulk(std::make_move_iterator(tasks.begin()), std::make_move_iterator(tasks.end())).wait();
+			CHECK(i == 499 * 500 / 2);
+			for (auto& t : tasks)
+				CHECK(!t.value);
+		}
+
+		{
+			TEST_INFO("from the pool's own workers");
+			std::atomic_int i = 0;
+			std::vector<counting_task> tasks(100, counting_task{ &i, 1 });
+			pool.for_each(0, 8, [&]() noexcept { pool.enqueue_bulk(tasks); });
+			pool.wait();
+			CHECK(i == 800);
+		}
+
+		{
+			TEST_INFO("task_batch");
+			std::atomic_int i = 0;
+			task_batch batch{ pool };
+			CHECK(batch.empty());
+			CHECK(&batch.pool() == &pool);
+
+			for (int j = 0; j < 1000; j++)
+			{
+				if (j % 3 == 0)
+					batch.add(counting_task{ &i, 1 });
+				else if (j % 3 == 1)
+					batch.add([&]() noexcept { i++; });
+				else
+					batch.add([&](size_t worker_index) noexcept { i += worker_index < pool.workers() ? 1 : 1000; });
+			}
+			CHECK(batch.size() == 1000u);
+
+			batch.submit().wait();
+			CHECK(batch.empty());
+			CHECK(i == 1000);
+
+			// reusing the batch
+			batch.add([&]() noexcept { i++; });
+			batch.submit().wait();
+			CHECK(i == 1001);
+
+			// discarding
+			batch.add([&]() noexcept { i++; });
+			batch.clear();
+			CHECK(batch.empty());
+			batch.submit().wait();
+			CHECK(i == 1001);
+		}
+
+		{
+			TEST_INFO("task_batch submits on destruction");
+			std::atomic_int i = 0;
+			{
+				task_batch batch{ pool, thread_pool_priority::high };
+				batch.reserve(64);
+				for (int j = 0; j < 64; j++)
+					batch.add([&]() noexcept { i++; });
+			}
+			pool.wait();
+			CHECK(i == 64);
+		}
+	}
+}
+
+TEST_CASE("thread_pool - task_graph")
+{
+	for (auto scheduler : { thread_pool_scheduler::shared_queues, thread_pool_scheduler::work_stealing })
+	{
+		TEST_INFO("scheduler: " << static_cast<int>(scheduler));
+
+		thread_pool_options options{};
+		options.worker_count = 4u;
+		options.scheduler	 = scheduler;
+		thread_pool pool{ options };
+
+		{
+			TEST_INFO("empty graph");
+
+			task_graph graph{ pool };
+			graph.run().wait();
+			CHECK(graph.done());
+			CHECK(graph.nodes() == 0u);
+		}
+
+		{
+			TEST_INFO("diamond");
+
+			task_graph graph{ pool };
+			std::atomic_int step = 0;
+			int a = -1, b = -1, c = -1, d = -1;
+			size_t c_worker = {};
+			const auto na	= graph.add([&]() noexcept { a = step++; });
+			const auto nb	= graph.add([&]() noexcept { b = step++; });
+			const auto nc	= graph.add([&](size_t worker) noexcept
+			{
+				c		 = step++;
+				c_worker = worker;
+			});
+			const auto nd = graph.add([&]() noexcept { d = step++; });
+			graph.add_edge(na, nb).add_edge(na, nc).add_edge(nb, nd).add_edge(nc, nd);
+			CHECK(graph.nodes() == 4u);
+			CHECK(graph.edges() == 4u);
+
+			for (int run = 0; run < 10; run++)
+			{
+				step = 0;
+				graph.run().wait();
+				CHECK(a == 0);
+				CHECK(b > a);
+				CHECK(c > a);
+				CHECK(d == 3);
+				CHECK(c_worker < pool.workers());
+			}
+		}
+
+		{
+			TEST_INFO("random DAG re-executed many times");
+
+			constexpr size_t node_count = 200;
+			std::mt19937 rng{ 42u };
+			std::vector<std::pair<size_t, size_t>> edges;
+			for (size_t to = 1; to < node_count; to++)
+			{
+				const auto preds = std::uniform_int_distribution<size_t>{ 0u, muu::min(to, size_t{ 4 }) }(rng);
+				for (size_t p = 0; p < preds; p++)
+					edges.emplace_back(std::uniform_int_distribution<size_t>{ 0u, to - 1u }(rng), to);
+			}
+
+			std::atomic_size_t sequence = 0;
+			std::vector<size_t> order(node_count);
+			std::vector<size_t> runs(node_count);
+
+			task_graph graph{ pool };
+			graph.reserve(node_count, edges.size());
+			for (size_t i = 0; i < node_count; i++)
+				graph.add([&, i]() noexcept
+				{
+					order[i] = sequence++;
+					runs[i]++;
+				});
+			for (auto [from, to] : edges)
+				graph.add_edge(from, to);
+
+			for (size_t frame = 1; frame <= 20; frame++)
+			{
+				graph.run().wait();
+				CHECK(sequence == node_count * frame);
+				for (size_t i = 0; i < node_count; i++)
+					CHECK(runs[i] == frame);
+				for (auto [from, to] : edges)
+					CHECK(order[from] < order[to]);
+			}
+
+			TEST_INFO("modifying the graph between runs");
+			const auto extra = graph.add([&]() noexcept { sequence++; });
+			graph.add_edge(node_count - 1u, extra);
+			sequence = 0;
+			graph.run(thread_pool_priority::high).wait();
+			CHECK(sequence == node_count + 1u);
+
+			graph.clear();
+			CHECK(graph.nodes() == 0u);
+			CHECK(graph.edges() == 0u);
+		}
+
+		{
+			TEST_INFO("running a graph from within the pool's own workers");
+
+			std::atomic_int i = 0;
+			task_group outer{ pool };
+			outer.for_each(4, [&]() noexcept
+			{
+				task_graph graph{ pool };
+				const auto first = graph.add([&]() noexcept { i++; });
+				for (int j = 0; j < 10; j++)
+					graph.add_edge(first, graph.add([&]() noexcept { i++; }));
+				graph.run().wait();
+			});
+			outer.wait();
+			CHECK(i == 44);
+		}
+
+		{
+			TEST_INFO("graphs wait on destruction");
+
+			std::atomic_int i = 0;
+			{
+				task_graph graph{ pool };
+				auto prev = graph.add([&]() noexcept { i++; });
+				for (int j = 0; j < 99; j++)
+				{
+					const auto next = graph.add([&]() noexcept { i++; });
+					graph.add_edge(prev, next);
+					prev = next;
+				}
+				graph.run();
+			}
+			CHECK(i == 100);
+		}
+	}
+}
+
+#if MUU_HAS_COROUTINES
+
+namespace
+{
+	static task<std::thread::id> worker_thread_id(thread_pool& pool) noexcept
+	{
+		co_await pool.schedule();
+		co_return std::this_thread::get_id();
+	}
+
+	static task<int> add_on_pool(thread_pool& pool, int a, int b) noexcept
+	{
+		co_await pool.schedule(thread_pool_priority::high);
+		co_return a + b;
+	}
+
+	static task<int> sum_on_pool(thread_pool& pool, int n) noexcept
+	{
+		int sum = 0;
+		for (int i = 0; i < n; i++)
+			sum += co_await add_on_pool(pool, i, 1);
+		co_return sum;
+	}
+
+	static task<> increment_on_pool(thread_pool& pool, std::atomic_int& value) noexcept
+	{
+		co_await pool.schedule();
+		value++;
+	}
+
+	static task<std::string> not_on_pool(std::string str) noexcept
+	{
+		co_return str + "!";
+	}
+}
+
+TEST_CASE("thread_pool - coroutines")
+{
+	for (auto scheduler : { thread_pool_scheduler::shared_queues, thread_pool_scheduler::work_stealing })
+	{
+		TEST_INFO("scheduler: " << static_cast<int>(scheduler));
+
+		thread_pool_options options{};
+		options.worker_count = 4u;
+		options.scheduler	 = scheduler;
+		thread_pool pool{ options };
+
+		{
+			TEST_INFO("schedule() resumes on a worker");
+			CHECK(pool.spawn(worker_thread_id(pool)).get() != std::this_thread::get_id());
+		}
+
+		{
+			TEST_INFO("awaiting tasks");
+			auto future = pool.spawn(sum_on_pool(pool, 100));
+			CHECK(future.get() == 5050);
+		}
+
+		{
+			TEST_INFO("tasks without a pool argument");
+			auto t = not_on_pool("hello");
+			CHECK(t.valid());
+			CHECK(!t.done());
+			CHECK(pool.spawn(std::move(t)).get() == "hello!");
+			CHECK(!t.valid());
+		}
+
+		{
+			TEST_INFO("fire-and-forget");
+			std::atomic_int value = 0;
+			for (int i = 0; i < 1000; i++)
+				(void)pool.spawn(increment_on_pool(pool, value));
+			pool.wait();
+			CHECK(value == 1000);
+		}
+
+		{
+			TEST_INFO("destroying a task that never started");
+			std::atomic_int value = 0;
+			{
+				auto t = increment_on_pool(pool, value);
+			}
+			pool.wait();
+			CHECK(value == 0);
+		}
+	}
+}
+
+#endif // MUU_HAS_COROUTINES
+
+TEST_CASE("thread_pool - reduce")
+{
+	thread_pool pool{ min(std::thread::hardware_concurrency(), 16u) };
+	const auto plus = [](auto a, auto b) noexcept { return a + b; };
+
+	{
+		TEST_INFO("empty ranges");
+		std::vector<int> vals;
+		CHECK(pool.reduce(vals.begin(), vals.end(), 7, plus) == 7);
+		CHECK(pool.reduce(vals, 7, plus) == 7);
+		CHECK(pool.reduce(vals, accumulator<int>{}).empty());
+	}
+
+	{
+		TEST_INFO("integers");
+		std::vector<int> vals(10000u);
+		for (size_t i = 0; i < vals.size(); i++)
+			vals[i] = static_cast<int>(i);
+		CHECK(pool.reduce(vals.begin(), vals.end(), 5, plus) == 5 + (9999 * 10000) / 2);
+		CHECK(pool.reduce(vals, 0, plus) == (9999 * 10000) / 2);
+		CHECK(pool.transform_reduce(vals, 0ll, plus, [](int v) noexcept { return static_cast<long long>(v) * 2; })
+			  == 9999ll * 10000ll);
+
+		const auto acc = pool.reduce(vals, accumulator<int>{});
+		CHECK(acc.sample_count() == vals.size());
+		CHECK(acc.sum() == (9999 * 10000) / 2);
+		CHECK(acc.min() == 0);
+		CHECK(acc.max() == 9999);
+	}
+
+	{
+		TEST_INFO("non-commutative operations");
+		std::vector<std::string> vals;
+		std::string expected = "x";
+		for (int i = 0; i < 100; i++)
+		{
+			vals.push_back(std::to_string(i));
+			expected += vals.back();
+		}
+		const auto concat = [](std::string a, const std::string& b) noexcept
+		{
+			a += b;
+			return a;
+		};
+		CHECK(pool.reduce(vals.begin(), vals.end(), std::string{ "x" }, concat) == expected);
+	}
+
+	{
+		TEST_INFO("floats with kahan summation");
+		std::vector<float> vals(100000u, 0.1f);
+		const auto acc = pool.reduce(vals, accumulator<float>{});
+		CHECK(acc.sample_count() == vals.size());
+		CHECK(acc.sum() == Approx(10000.0f).epsilon(0.0001));
+
+		const auto squares = pool.transform_reduce(vals.begin(), vals.end(), accumulator<double>{},
+												   [](float v) noexcept { return static_cast<double>(v) * 2.0; });
+		CHECK(squares.sum() == Approx(20000.0).epsilon(0.0001));
+	}
+
+	{
+		TEST_INFO("reducing from within the pool's own workers");
+		std::vector<int> vals(1000u, 1);
+		auto f = pool.enqueue_with_result([&]() noexcept { return pool.reduce(vals, 0, plus); });
+		CHECK(f.get() == 1000);
+	}
+}
+
+namespace
+{
+	template <typename T, typename... Compare>
+	static void sort_and_check(thread_pool& pool, std::vector<T> vals, Compare... compare)
+	{
+		auto expected = vals;
+		std::sort(expected.begin(), expected.end(), compare...);
+		pool.sort(vals.begin(), vals.end(), compare...);
+		CHECK(vals == expected);
+	}
+}
+
+TEST_CASE("thread_pool - sort")
+{
+	thread_pool pool{ 4 };
+	std::mt19937_64 rng{ 0xC0FFEEu };
+
+	for (size_t count : { 0_sz, 1_sz, 2_sz, 100_sz, 8191_sz, 8192_sz, 10000_sz, 100000_sz })
+	{
+		TEST_INFO("count: " << count);
+
+		std::vector<int32_t> ints(count);
+		for (auto& v : ints)
+			v = static_cast<int32_t>(rng());
+		sort_and_check(pool, ints);
+		sort_and_check(pool, ints, [](int32_t a, int32_t b) noexcept { return a > b; });
+
+		std::vector<uint64_t> u64s(count);
+		for (auto& v : u64s)
+			v = rng() % 1000u; // lots of duplicates + passes with a single digit
+		sort_and_check(pool, u64s);
+
+		std::vector<int8_t> i8s(count);
+		for (auto& v : i8s)
+			v = static_cast<int8_t>(rng());
+		sort_and_check(pool, i8s);
+
+		std::vector<uuid> uuids(count);
+		for (auto& v : uuids)
+		{
+			const auto a = rng();
+			const auto b = rng();
+			v			 = uuid{ static_cast<uint32_t>(a >> 32),
+						 static_cast<uint16_t>(a >> 16),
+						 static_cast<uint16_t>(a),
+						 static_cast<uint16_t>(b >> 48),
+						 b & 0xFFFFFFFFFFFFull };
+		}
+		sort_and_check(pool, uuids);
+
+		std::vector<double> doubles(count);
+		for (auto& v : doubles)
+			v = static_cast<double>(rng() % 100000u) * 0.25 - 1000.0;
+		sort_and_check(pool, doubles);
+
+		std::vector<std::string> strings(count);
+		for (auto& v : strings)
+			v = std::to_string(rng() % 50000u);
+		sort_and_check(pool, strings, [](const std::string& a, const std::string& b) noexcept { return a < b; });
+	}
+
+	{
+		TEST_INFO("already-sorted and reversed ranges");
+		std::vector<int> vals(50000u);
+		for (size_t i = 0; i < vals.size(); i++)
+			vals[i] = static_cast<int>(i);
+		sort_and_check(pool, vals);
+		std::reverse(vals.begin(), vals.end());
+		sort_and_check(pool, vals);
+		sort_and_check(pool, std::vector<int>(50000u, 42));
+	}
+
+	{
+		TEST_INFO("duplicate-heavy ranges");
+		const auto less = [](int a, int b) noexcept { return a < b; };
+		sort_and_check(pool, std::vector<int>(50000u, 42), less);
+
+		std::vector<int> vals(50000u);
+		for (auto& v : vals)
+			v = static_cast<int>(rng() % 3u);
+		sort_and_check(pool, vals, less);
+
+		for (auto& v : vals)
+			v = rng() % 10u ? 7 : static_cast<int>(rng() % 1000u);
+		sort_and_check(pool, vals, less);
+
+		std::vector<std::string> strings(50000u);
+		for (auto& v : strings)
+			v = rng() % 4u ? "muu" : std::to_string(rng() % 100u);
+		sort_and_check(pool, strings, [](const std::string& a, const std::string& b) noexcept { return a < b; });
+	}
+
+	{
+		TEST_INFO("sorting from within the pool's own workers");
+		std::vector<uint32_t> vals(50000u);
+		for (auto& v : vals)
+			v = static_cast<uint32_t>(rng());
+		auto expected = vals;
+		std::sort(expected.begin(), expected.end());
+		pool.enqueue_with_result([&]() noexcept { pool.sort(vals.begin(), vals.end()); }).wait();
+		CHECK(vals == expected);
+	}
+}
+
+TEST_CASE("thread_pool - scan")
+{
+	thread_pool pool{ 4 };
+	std::mt19937_64 rng{ 0xBEEFu };
+	const auto plus = [](auto a, auto b) noexcept { return a + b; };
+
+	for (size_t count : { 0_sz, 1_sz, 2_sz, 100_sz, 4095_sz, 4096_sz, 8192_sz, 10000_sz, 100001_sz })
+	{
+		TEST_INFO("count: " << count);
+
+		std::vector<int64_t> vals(count);
+		for (auto& v : vals)
+			v = static_cast<int64_t>(rng() % 1000u) - 500;
+
+		std::vector<int64_t> expected(count);
+		std::vector<int64_t> actual(count);
+
+		// inclusive
+		for (size_t i = 0; i < count; i++)
+			expected[i] = vals[i] + (i ? expected[i - 1u] : 0);
+		CHECK(pool.inclusive_scan(vals.begin(), vals.end(), actual.begin()) == actual.end());
+		CHECK(actual == expected);
+
+		std::fill(actual.begin(), actual.end(), 0);
+		pool.inclusive_scan(vals.begin(), vals.end(), actual.begin(), plus);
+		CHECK(actual == expected);
+
+		// inclusive with init
+		for (auto& v : expected)
+			v += 7;
+		pool.inclusive_scan(vals.begin(), vals.end(), actual.begin(), plus, int64_t{ 7 });
+		CHECK(actual == expected);
+
+		// exclusive
+		for (size_t i = 0; i < count; i++)
+			expected[i] = i ? expected[i - 1u] + vals[i - 1u] : 100;
+		CHECK(pool.exclusive_scan(vals.begin(), vals.end(), actual.begin(), int64_t{ 100 }) == actual.end());
+		CHECK(actual == expected);
+
+		// in-place
+		auto in_place = vals;
+		pool.exclusive_scan(in_place.begin(), in_place.end(), in_place.begin(), int64_t{ 100 }, plus);
+		CHECK(in_place == expected);
+
+		// non-commutative
+		std::vector<std::string> strings(count / 16u);
+		for (auto& s : strings)
+			s = static_cast<char>('a' + rng() % 26u);
+		std::vector<std::string> expected_strings(strings.size());
+		for (size_t i = 0; i < strings.size(); i++)
+			expected_strings[i] = (i ? expected_strings[i - 1u] : std::string{}) + strings[i];
+		std::vector<std::string> actual_strings(strings.size());
+		pool.inclusive_scan(strings.begin(),
+							strings.end(),
+							actual_strings.begin(),
+							[](const std::string& a, const std::string& b) noexcept { return a + b; });
+		CHECK(actual_strings == expected_strings);
+	}
+
+	{
+		TEST_INFO("forward iterators");
+		std::list<int> vals;
+		for (int i = 0; i < 20000; i++)
+			vals.push_back(1);
+		std::vector<int> out(vals.size());
+		pool.exclusive_scan(vals.begin(), vals.end(), out.begin(), 0);
+		for (size_t i = 0; i < out.size(); i++)
+			REQUIRE(out[i] == static_cast<int>(i));
+	}
+
+	{
+		TEST_INFO("scanning from within the pool's own workers");
+		std::vector<int> vals(50000u, 1);
+		pool.enqueue_with_result([&]() noexcept { pool.inclusive_scan(vals.begin(), vals.end(), vals.begin()); })
+			.wait();
+		CHECK(vals.back() == 50000);
+	}
+}
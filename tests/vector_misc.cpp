@@ -51,3 +51,89 @@ static_assert(!vector_param_by_value<pfloat, 4>);
 static_assert(!vector_param_by_value<pfloat, 5>);
 
 #endif
+
+// the SIMD kernels only run outside of constant evaluation; make sure the scalar path is still usable at compile time
+static_assert(vector<float, 4>{ 1, 2, 3, 4 }.dot(vector<float, 4>{ 1, 1, 1, 1 }) == 10.0f);
+static_assert((vector<float, 3>{ 1, 2, 3 } + vector<float, 3>{ 3, 2, 1 }) == vector<float, 3>{ 4, 4, 4 });
+static_assert((vector<double, 2>{ 1, 2 } * 2.0) == vector<double, 2>{ 2, 4 });
+static_assert(vector<double, 4>::max(vector<double, 4>{ 1, 5, 3, 7 }, vector<double, 4>{ 4, 2, 6, 0 })
+			  == vector<double, 4>{ 4, 5, 6, 7 });
+
+namespace
+{
+	template <typename T, size_t D>
+	static void check_simd_against_scalar()
+	{
+		TEST_INFO("vector<"sv << nameof<T> << ", "sv << D << ">"sv);
+		using vec = vector<T, D>;
+
+		RANDOM_ITERATIONS
+		{
+			const auto a = random_array<T, D>(-10, 10);
+			const auto b = random_array<T, D>(1, 10);
+			const auto s = random<T>(1, 10);
+			const vec va{ a }, vb{ b };
+
+			// componentwise operations are exact
+			for (size_t i = 0; i < D; i++)
+			{
+				CHECK((va + vb)[i] == a[i] + b[i]);
+				CHECK((va - vb)[i] == a[i] - b[i]);
+				CHECK((va * vb)[i] == a[i] * b[i]);
+				CHECK((va / vb)[i] == a[i] / b[i]);
+				CHECK((va * s)[i] == a[i] * s);
+				CHECK((-va)[i] == -a[i]);
+				CHECK(vec::min(va, vb)[i] == muu::min(a[i], b[i]));
+				CHECK(vec::max(va, vb)[i] == muu::max(a[i], b[i]));
+			}
+
+			auto vc = va;
+			vc += vb;
+			CHECK(vc == va + vb);
+			vc -= vb;
+			vc *= vb;
+			CHECK(vc == (va + vb - vb) * vb);
+			vc /= vb;
+			vc *= s;
+			CHECK(vc == ((va + vb - vb) * vb) / vb * s);
+
+			T dot{}, len_sq{};
+			for (size_t i = 0; i < D; i++)
+			{
+				dot += a[i] * b[i];
+				len_sq += a[i] * a[i];
+			}
+			// the manual sums above may have been contracted into FMAs, so allow for a few ulps of difference
+			CHECK_APPROX_EQUAL_EPS(vec::dot(va, vb), dot, default_epsilon<T> * muu::abs(dot) + default_epsilon<T>);
+			CHECK_APPROX_EQUAL_EPS(va.length_squared(), len_sq, default_epsilon<T> * len_sq);
+
+			T len{};
+			const auto norm = vec::normalize(vb, len);
+			CHECK_APPROX_EQUAL(len, vb.length());
+			CHECK(norm == vec::normalize(vb));
+			CHECK(norm.normalized());
+
+			const auto lerped = vec::lerp(va, vb, T{ 0.25 });
+			for (size_t i = 0; i < D; i++)
+				CHECK_APPROX_EQUAL(lerped[i], a[i] * T{ 0.75 } + b[i] * T{ 0.25 });
+		}
+
+		// vectors narrower than a register must not touch their neighbours
+		vec arr[3] = { vec{ T{ 1 } }, vec{ T{ 2 } }, vec{ T{ 3 } } };
+		arr[1] += vec{ T{ 1 } };
+		arr[1] = vec::normalize(arr[1]) * T{ 4 };
+		arr[1] = -arr[1];
+		CHECK(arr[0] == vec{ T{ 1 } });
+		CHECK(arr[2] == vec{ T{ 3 } });
+	}
+}
+
+TEST_CASE("vector simd")
+{
+	check_simd_against_scalar<float, 2>();
+	check_simd_against_scalar<float, 3>();
+	check_simd_against_scalar<float, 4>();
+	check_simd_against_scalar<double, 2>();
+	check_simd_against_scalar<double, 3>();
+	check_simd_against_scalar<double, 4>();
+}
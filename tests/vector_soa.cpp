@@ -0,0 +1,205 @@
+// This file is a part of muu and is subject to the the terms of the MIT license.
+// Copyright (c) Mark Gillard <mark.gillard@outlook.com.au>
+// See https://github.com/marzer/muu/blob/master/LICENSE for the full license text.
+// SPDX-License-Identifier: MIT
+
+#include "tests.h"
+#include "../include/muu/vector_soa.h"
+
+using namespace muu;
+
+namespace
+{
+	template <typename T, size_t D, size_t W>
+	static vector_soa<T, D, W> random_packet(T min, T max) noexcept
+	{
+		vector_soa<T, D, W> p;
+		for (size_t i = 0; i < W; i++)
+			p.lane(i, vector<T, D>{ random_array<T, D>(min, max) });
+		return p;
+	}
+
+	template <typename T>
+	static T tolerance(T expected) noexcept
+	{
+		return constants<T>::default_epsilon * (muu::abs(expected) + T{ 1 });
+	}
+
+	template <typename T, size_t D, size_t W>
+	static void check_packet()
+	{
+		TEST_INFO("vector_soa<"sv << nameof<T> << ", "sv << D << ", "sv << W << ">"sv);
+		using packet = vector_soa<T, D, W>;
+		using vec	 = vector<T, D>;
+
+		static_assert(sizeof(packet) >= sizeof(T) * D * W);
+		static_assert((W & (W - 1u)) || sizeof(packet) == sizeof(T) * D * W);
+		static_assert(alignof(packet) >= alignof(T));
+
+		// construction
+		{
+			const packet filled{ T{ 2 } };
+			const packet broadcast{ vec{ T{ 2 } } };
+			CHECK(filled == broadcast);
+			for (size_t i = 0; i < W; i++)
+				CHECK(filled.lane(i) == vec{ T{ 2 } });
+		}
+
+		RANDOM_ITERATIONS
+		{
+			const auto a	 = random_packet<T, D, W>(T{ -10 }, T{ 10 });
+			const auto b	 = random_packet<T, D, W>(T{ 1 }, T{ 10 });
+			const auto s	 = random<T>(T{ 1 }, T{ 10 });
+			const auto alpha = random<T>(T{ 0 }, T{ 1 });
+			const auto eps	 = tolerance(T{ 100 * D });
+
+			const auto sum		 = a + b;
+			const auto diff		 = a - b;
+			const auto product	 = a * b;
+			const auto quotient	 = a / b;
+			const auto scaled	 = a * s;
+			const auto divided	 = a / s;
+			const auto negated	 = -a;
+			const auto dots		 = dot(a, b);
+			const auto lens		 = length(b);
+			const auto lens_sq	 = length_squared(b);
+			const auto norms	 = normalize(b);
+			const auto lerped	 = lerp(a, b, alpha);
+			const auto minimums	 = muu::min(a, b);
+			const auto maximums	 = muu::max(a, b);
+			const auto lane_mul = [&]() noexcept
+			{
+				if constexpr (D > 1)
+					return a * lens;
+				else
+					return a * b;
+			}();
+
+			for (size_t i = 0; i < W; i++)
+			{
+				const auto va = a.lane(i);
+				const auto vb = b.lane(i);
+
+				CHECK(sum.lane(i) == va + vb);
+				CHECK(diff.lane(i) == va - vb);
+				CHECK(product.lane(i) == va * vb);
+				CHECK(approx_equal(quotient.lane(i), va / vb, eps));
+				CHECK(scaled.lane(i) == va * s);
+				CHECK(approx_equal(divided.lane(i), va / s, eps));
+				CHECK(negated.lane(i) == -va);
+				CHECK_APPROX_EQUAL_EPS(dots.x[i], vec::dot(va, vb), eps);
+				CHECK_APPROX_EQUAL_EPS(lens.x[i], vec::length(vb), eps);
+				CHECK_APPROX_EQUAL_EPS(lens_sq.x[i], vec::length_squared(vb), eps);
+				CHECK(approx_equal(norms.lane(i), vec::normalize(vb), eps));
+				CHECK(approx_equal(lerped.lane(i), vec::lerp(va, vb, alpha), eps));
+				CHECK(minimums.lane(i) == vec::min(va, vb));
+				CHECK(maximums.lane(i) == vec::max(va, vb));
+				if constexpr (D > 1)
+				{
+					CHECK(approx_equal(lane_mul.lane(i), va * vec::length(vb), eps));
+					CHECK((lens * a).lane(i) == lane_mul.lane(i));
+				}
+
+				if constexpr (D == 3)
+					CHECK(approx_equal(cross(a, b).lane(i), vec::cross(va, vb), eps));
+			}
+
+			// compound assignment
+			auto c = a;
+			c += b;
+			CHECK(c == sum);
+			c = a;
+			c -= b;
+			CHECK(c == diff);
+			c = a;
+			c *= b;
+			CHECK(c == product);
+			c = a;
+			c *= s;
+			CHECK(c == scaled);
+			c = b;
+			c.normalize();
+			CHECK(c == norms);
+		}
+	}
+
+	template <typename T, size_t D, size_t W>
+	static void check_gather_scatter()
+	{
+		TEST_INFO("vector_soa<"sv << nameof<T> << ", "sv << D << ", "sv << W << ">"sv);
+		using packet = vector_soa<T, D, W>;
+		using vec	 = vector<T, D>;
+
+		// a length that leaves the last packet partially filled
+		constexpr size_t count = W * 3u + 1u;
+		static_assert(packet::packet_count(count) == 4u);
+		static_assert(packet::packet_count(W * 3u) == 3u);
+		static_assert(packet::packet_count(0) == 0u);
+
+		std::vector<vec> src(count);
+		for (auto& v : src)
+			v = vec{ random_array<T, D>(-10, 10) };
+
+		std::vector<packet> packets(packet::packet_count(count));
+		packet::gather({ src.data(), src.size() }, { packets.data(), packets.size() });
+		for (size_t i = 0; i < count; i++)
+			CHECK(packets[i / W].lane(i % W) == src[i]);
+		for (size_t i = 1; i < W; i++)
+			CHECK(packets.back().lane(i) == vec{});
+
+		std::vector<vec> dest(count, vec{ T{ 42 } });
+		packet::scatter({ packets.data(), packets.size() }, { dest.data(), dest.size() });
+		CHECK(dest == src);
+
+		// single packets
+		const auto p = packet{ span<const vec>{ src.data(), W - 1u } };
+		for (size_t i = 0; i < W - 1u; i++)
+			CHECK(p.lane(i) == src[i]);
+		CHECK(p.lane(W - 1u) == vec{});
+
+		// scattering into a short span must not write past the end of it
+		std::vector<vec> partial(W, vec{ T{ 42 } });
+		packets[0].scatter({ partial.data(), W - 1u });
+		for (size_t i = 0; i < W - 1u; i++)
+			CHECK(partial[i] == src[i]);
+		CHECK(partial.back() == vec{ T{ 42 } });
+	}
+
+	// constant-evaluated
+	inline constexpr auto soa_constexpr_check = []() noexcept
+	{
+		using packet = vector_soa<float, 3, 4>;
+
+		packet a{ vector<float, 3>{ 1.0f, 0.0f, 0.0f } };
+		a.lane(1, vector<float, 3>{ 0.0f, 3.0f, 4.0f });
+		const packet b{ vector<float, 3>{ 0.0f, 1.0f, 0.0f } };
+
+		const auto c   = cross(a, b);
+		const auto d   = dot(a, b);
+		const auto len = length_squared(a);
+		return c.lane(0) == vector<float, 3>{ 0.0f, 0.0f, 1.0f } //
+			&& c.lane(1) == vector<float, 3>{ -4.0f, 0.0f, 0.0f }
+			&& d.x[0] == 0.0f && d.x[1] == 3.0f		 //
+			&& len.x[0] == 1.0f && len.x[1] == 25.0f //
+			&& (a + b) - b == a;
+	}();
+	static_assert(soa_constexpr_check);
+}
+
+TEST_CASE("vector_soa")
+{
+	check_packet<float, 1, 4>();
+	check_packet<float, 2, 4>();
+	check_packet<float, 3, 8>();
+	check_packet<float, 4, 16>();
+	check_packet<double, 2, 8>();
+	check_packet<double, 3, 4>();
+	check_packet<double, 4, 8>();
+	check_packet<float, 3, 3>();
+
+	check_gather_scatter<float, 3, 4>();
+	check_gather_scatter<float, 3, 8>();
+	check_gather_scatter<float, 4, 16>();
+	check_gather_scatter<double, 3, 4>();
+	check_gather_scatter<double, 2, 8>();
+}